@@ -12,9 +12,11 @@
 #include <ppltasks.h>
 #include <winerror.h>
 
+#include <cstring>
+
 #include "core/dawn_player/coroutine/sync_wait.hpp"
-#include "core/dawn_player/default_task_service.hpp"
 #include "core/dawn_player/error.hpp"
+#include "core/dawn_player/pooled_task_service.hpp"
 
 using namespace concurrency;
 using namespace dawn_player;
@@ -80,7 +82,9 @@ namespace winrt::DawnPlayer::implementation
     {
         winrt::apartment_context caller;
         co_await winrt::resume_background();
-        auto tsk_service = std::make_shared<default_task_service>();
+        // All players share one pool of worker threads, each player runs on its own strand.
+        static task_service_pool shared_pool;
+        auto tsk_service = shared_pool.create_task_service();
         auto player = std::make_shared<flv_player>(tsk_service, stream_proxy);
         std::map<std::string, std::string> info;
         try {
@@ -109,7 +113,36 @@ namespace winrt::DawnPlayer::implementation
         // It seems that H.264 only supports even numbered dimensions.
         vep.Width(video_width - (video_width % 2));
         vep.Height(video_height - (video_height % 2));
+        auto iter_frame_rate = info.find("FrameRate");
+        if (iter_frame_rate != info.end()) {
+            vep.FrameRate().Numerator(static_cast<std::uint32_t>(std::stod(std::get<1>(*iter_frame_rate)) * 1000 + 0.5));
+            vep.FrameRate().Denominator(1000);
+        }
         auto vsd = VideoStreamDescriptor(vep);
+        // The decoder takes a new configuration from the parameter sets that
+        // prefix its first key frame, keep the stream descriptor in step.
+        player->set_video_format_changed_handler([vsd, codec = player->get_video_codec()](const parameter_sets& sets) {
+            dawn_player::parser::sps_info sps_info;
+            bool is_parsed = codec == video_codec::hevc
+                ? dawn_player::parser::parse_hevc_sps(sets.sps.data(), sets.sps.size(), sps_info)
+                : dawn_player::parser::parse_h264_sps(sets.sps.data(), sets.sps.size(), sps_info);
+            if (!is_parsed) {
+                return;
+            }
+            try {
+                auto properties = vsd.EncodingProperties();
+                properties.Width(sps_info.width - (sps_info.width % 2));
+                properties.Height(sps_info.height - (sps_info.height % 2));
+                if (sps_info.frame_rate > 0.0) {
+                    properties.FrameRate().Numerator(static_cast<std::uint32_t>(sps_info.frame_rate * 1000 + 0.5));
+                    properties.FrameRate().Denominator(1000);
+                }
+            }
+            catch (...) {
+                // Called on the task service thread right before a sample is
+                // handed out, playback goes on with the old properties.
+            }
+        });
         auto mss = MediaStreamSource(asd);
         mss.AddStreamDescriptor(vsd);
         mss.CanSeek(info["CanSeek"] == "True");
@@ -153,78 +186,83 @@ namespace winrt::DawnPlayer::implementation
         auto request = args.Request();
         auto player = this->player_;
         if (player) {
+            // Complete the request from the player's task service instead of
+            // blocking the media pipeline thread until a sample is read.
             if (request.StreamDescriptor().try_as<AudioStreamDescriptor>()) {
-                try {
-                    auto sample = coroutine::sync_wait_task(player->get_audio_sample());
-                    auto data_writer = DataWriter();
-                    for (auto byte : sample.data) {
-                        data_writer.WriteByte(byte);
-                    }
-                    auto stream_sample = MediaStreamSample::CreateFromBuffer(data_writer.DetachBuffer(), TimeSpan{ sample.timestamp });
-                    request.Sample(stream_sample);
-                }
-                catch (const get_sample_error& gse) {
-                    if (gse.code() == get_sample_error_code::end_of_stream) {
-                        request.Sample(nullptr);
+                auto deferral = request.GetDeferral();
+                player->request_audio_sample([sender, request, deferral](std::exception_ptr error, audio_sample&& sample) {
+                    try {
+                        if (error) {
+                            std::rethrow_exception(error);
+                        }
+                        auto stream_sample = MediaStreamSample::CreateFromBuffer(FlvMediaStreamSource::CreateBufferFromBytes(sample.data), TimeSpan{ sample.timestamp });
+                        request.Sample(stream_sample);
                     }
-                    else if (gse.code() != get_sample_error_code::cancel) {
-                        sender.NotifyError(MediaStreamSourceErrorStatus::Other);
+                    catch (...) {
+                        FlvMediaStreamSource::handle_sample_error(sender, request);
                     }
-                }
+                    deferral.Complete();
+                });
             }
             else if (request.StreamDescriptor().try_as<VideoStreamDescriptor>()) {
-                try {
-                    video_sample sample = coroutine::sync_wait_task(player->get_video_sample());
-                    auto data_writer = DataWriter();
-                    if (sample.is_key_frame) {
-                        if (player->get_video_codec() == video_codec::hevc) {
-                            const auto& vps = player->get_vps();
-                            if (!vps.empty()) {
-                                data_writer.WriteByte(0);
-                                data_writer.WriteByte(0);
-                                data_writer.WriteByte(1);
-                                for (auto byte : vps) {
-                                    data_writer.WriteByte(byte);
-                                }
-                            }
-                        }
-                        const auto& sps = player->get_sps();
-                        if (!sps.empty()) {
-                            data_writer.WriteByte(0);
-                            data_writer.WriteByte(0);
-                            data_writer.WriteByte(1);
-                            for (auto byte : sps) {
-                                data_writer.WriteByte(byte);
-                            }
-                        }
-                        const auto& pps = player->get_pps();
-                        if (!pps.empty()) {
-                            data_writer.WriteByte(0);
-                            data_writer.WriteByte(0);
-                            data_writer.WriteByte(1);
-                            for (auto byte : pps) {
-                                data_writer.WriteByte(byte);
-                            }
+                auto deferral = request.GetDeferral();
+                player->request_video_sample([sender, request, deferral, player](std::exception_ptr error, video_sample&& sample) {
+                    try {
+                        if (error) {
+                            std::rethrow_exception(error);
                         }
+                        auto timestamp = sample.timestamp;
+                        auto dts = sample.dts;
+                        auto is_key_frame = sample.is_key_frame;
+                        auto data = player->package_video_sample(std::move(sample));
+                        auto stream_sample = MediaStreamSample::CreateFromBuffer(FlvMediaStreamSource::CreateBufferFromBytes(data), TimeSpan{ timestamp });
+                        stream_sample.DecodeTimestamp(TimeSpan{ dts });
+                        stream_sample.KeyFrame(is_key_frame);
+                        request.Sample(stream_sample);
                     }
-                    for (auto byte : sample.data) {
-                        data_writer.WriteByte(byte);
+                    catch (...) {
+                        FlvMediaStreamSource::handle_sample_error(sender, request);
                     }
-                    auto stream_sample = MediaStreamSample::CreateFromBuffer(data_writer.DetachBuffer(), TimeSpan{ sample.timestamp });
-                    stream_sample.DecodeTimestamp(TimeSpan{sample.dts});
-                    stream_sample.KeyFrame(sample.is_key_frame);
-                    request.Sample(stream_sample);
+                    deferral.Complete();
+                });
+            }
+        }
+    }
+
+    void FlvMediaStreamSource::handle_sample_error(MediaStreamSource sender, MediaStreamSourceSampleRequest request)
+    {
+        // Called from the sample request callbacks, which must not throw. A
+        // source that is already shut down fails NotifyError as well, and
+        // nothing is left to report that to.
+        try {
+            try {
+                throw;
+            }
+            catch (const get_sample_error& gse) {
+                if (gse.code() == get_sample_error_code::end_of_stream) {
+                    request.Sample(nullptr);
                 }
-                catch (const get_sample_error& gse) {
-                    if (gse.code() == get_sample_error_code::end_of_stream) {
-                        request.Sample(nullptr);
-                    }
-                    else if (gse.code() != get_sample_error_code::cancel) {
-                        sender.NotifyError(MediaStreamSourceErrorStatus::Other);
-                    }
+                else if (gse.code() != get_sample_error_code::cancel) {
+                    sender.NotifyError(MediaStreamSourceErrorStatus::Other);
                 }
             }
+            catch (...) {
+                sender.NotifyError(MediaStreamSourceErrorStatus::Other);
+            }
+        }
+        catch (...) {
+        }
+    }
+
+    IBuffer FlvMediaStreamSource::CreateBufferFromBytes(const std::vector<std::uint8_t>& bytes)
+    {
+        auto size = static_cast<std::uint32_t>(bytes.size());
+        auto buffer = Buffer(size);
+        if (size != 0) {
+            std::memcpy(buffer.data(), bytes.data(), size);
         }
+        buffer.Length(size);
+        return buffer;
     }
 
     VideoEncodingProperties FlvMediaStreamSource::CreateVideoEncodingProperties(video_codec vc)
@@ -8,8 +8,10 @@
 #ifndef DAWN_PLAYER_FLV_MEDIA_STREAM_SOURCE_H
 #define DAWN_PLAYER_FLV_MEDIA_STREAM_SOURCE_H
 
+#include <cstdint>
 #include <memory>
 #include <optional>
+#include <vector>
 
 #include <winrt/Windows.Foundation.h>
 #include <winrt/Windows.Media.Core.h>
@@ -17,7 +19,7 @@
 #include <winrt/Windows.Media.MediaProperties.h>
 
 #include "core/dawn_player/flv_player.hpp"
-#include "core/dawn_player/io.hpp"
+#include "core/dawn_player/winrt_io.hpp"
 #include "core/dawn_player/task_service.hpp"
 
 #include "FlvMediaStreamSource.g.h"
@@ -51,8 +53,11 @@ namespace winrt::DawnPlayer::implementation
         void on_sample_requested(MediaStreamSource sender, MediaStreamSourceSampleRequestedEventArgs args);
         void handle_starting(MediaStreamSource sender, MediaStreamSourceStartingEventArgs args);
         void handle_sample_requested(MediaStreamSource sender, MediaStreamSourceSampleRequestedEventArgs args);
+        // Must be called from a catch block.
+        static void handle_sample_error(MediaStreamSource sender, MediaStreamSourceSampleRequest request);
         std::optional<winrt::event_token> starting_event_token;
         std::optional<winrt::event_token> sample_requested_event_token;
+        static IBuffer CreateBufferFromBytes(const std::vector<std::uint8_t>& bytes);
         static VideoEncodingProperties CreateVideoEncodingProperties(video_codec vc);
     };
 }
@@ -0,0 +1,42 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/core/dawn_player/amf_types.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/amf_types.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/amf_types.cpp.o.d"
+  "/root/repo/core/dawn_player/annexb.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/annexb.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/annexb.cpp.o.d"
+  "/root/repo/core/dawn_player/bit_reader.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/bit_reader.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/bit_reader.cpp.o.d"
+  "/root/repo/core/dawn_player/cache_io.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/cache_io.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/cache_io.cpp.o.d"
+  "/root/repo/core/dawn_player/default_task_service.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/default_task_service.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/default_task_service.cpp.o.d"
+  "/root/repo/core/dawn_player/disk_cache_io.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/disk_cache_io.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/disk_cache_io.cpp.o.d"
+  "/root/repo/core/dawn_player/error.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/error.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/error.cpp.o.d"
+  "/root/repo/core/dawn_player/flv_parser.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_parser.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_parser.cpp.o.d"
+  "/root/repo/core/dawn_player/flv_player.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_player.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_player.cpp.o.d"
+  "/root/repo/core/dawn_player/flv_recorder.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_recorder.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_recorder.cpp.o.d"
+  "/root/repo/core/dawn_player/flv_tools.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_tools.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_tools.cpp.o.d"
+  "/root/repo/core/dawn_player/flv_writer.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_writer.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_writer.cpp.o.d"
+  "/root/repo/core/dawn_player/fmp4_remuxer.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/fmp4_remuxer.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/fmp4_remuxer.cpp.o.d"
+  "/root/repo/core/dawn_player/http_io.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/http_io.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/http_io.cpp.o.d"
+  "/root/repo/core/dawn_player/parallel_io.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/parallel_io.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/parallel_io.cpp.o.d"
+  "/root/repo/core/dawn_player/pooled_task_service.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/pooled_task_service.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/pooled_task_service.cpp.o.d"
+  "/root/repo/core/dawn_player/posix_io.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/posix_io.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/posix_io.cpp.o.d"
+  "/root/repo/core/dawn_player/sample_packager.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/sample_packager.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/sample_packager.cpp.o.d"
+  "/root/repo/core/dawn_player/samples.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/samples.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/samples.cpp.o.d"
+  "/root/repo/core/dawn_player/sps_parser.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/sps_parser.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/sps_parser.cpp.o.d"
+  "/root/repo/core/dawn_player/task_service.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/task_service.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/task_service.cpp.o.d"
+  "/root/repo/core/dawn_player/timeshift_io.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/timeshift_io.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/timeshift_io.cpp.o.d"
+  "/root/repo/core/dawn_player/uring_io.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/uring_io.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/uring_io.cpp.o.d"
+  "/root/repo/core/dawn_player/work_stealing_task_service.cpp" "CMakeFiles/dawn_player_core.dir/core/dawn_player/work_stealing_task_service.cpp.o" "gcc" "CMakeFiles/dawn_player_core.dir/core/dawn_player/work_stealing_task_service.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
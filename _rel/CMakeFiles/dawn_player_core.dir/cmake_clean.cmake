@@ -0,0 +1,57 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/amf_types.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/amf_types.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/annexb.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/annexb.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/bit_reader.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/bit_reader.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/cache_io.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/cache_io.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/default_task_service.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/default_task_service.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/disk_cache_io.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/disk_cache_io.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/error.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/error.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_parser.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_parser.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_player.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_player.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_recorder.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_recorder.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_tools.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_tools.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_writer.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/flv_writer.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/fmp4_remuxer.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/fmp4_remuxer.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/http_io.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/http_io.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/parallel_io.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/parallel_io.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/pooled_task_service.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/pooled_task_service.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/posix_io.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/posix_io.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/sample_packager.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/sample_packager.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/samples.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/samples.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/sps_parser.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/sps_parser.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/task_service.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/task_service.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/timeshift_io.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/timeshift_io.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/uring_io.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/uring_io.cpp.o.d"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/work_stealing_task_service.cpp.o"
+  "CMakeFiles/dawn_player_core.dir/core/dawn_player/work_stealing_task_service.cpp.o.d"
+  "libdawn_player_core.a"
+  "libdawn_player_core.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/dawn_player_core.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
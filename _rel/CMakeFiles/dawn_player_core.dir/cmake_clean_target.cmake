@@ -0,0 +1,3 @@
+file(REMOVE_RECURSE
+  "libdawn_player_core.a"
+)
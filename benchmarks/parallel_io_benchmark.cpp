@@ -0,0 +1,81 @@
+/*
+ *    parallel_io_benchmark.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "coroutine/sync_wait.hpp"
+#include "http_io.hpp"
+#include "http_test_server.hpp"
+#include "parallel_io.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+std::vector<std::uint8_t> read_to_end(io::read_stream_proxy& proxy)
+{
+    std::vector<std::uint8_t> data;
+    std::vector<std::uint8_t> buffer(64 * 1024);
+    for (;;) {
+        auto size = coroutine::sync_wait_task(proxy.read(buffer.data(), static_cast<std::uint32_t>(buffer.size())));
+        if (size == 0) {
+            return data;
+        }
+        data.insert(data.end(), buffer.begin(), buffer.begin() + size);
+    }
+}
+
+// Seconds to read the whole body over connection_count connections, best
+// of three.
+double measure(const http_test_server& server, std::size_t connection_count, const std::vector<std::uint8_t>& expected)
+{
+    auto url = server.get_url("/a.flv");
+    double best = 0.0;
+    for (int round = 0; round < 3; ++round) {
+        io::parallel_read_stream_proxy proxy([url]() {
+            return std::make_shared<io::http_range_read_stream_proxy>(url);
+        }, connection_count);
+        auto start = std::chrono::steady_clock::now();
+        auto data = read_to_end(proxy);
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (data != expected) {
+            std::printf("wrong result\n");
+        }
+        if (round == 0 || seconds < best) {
+            best = seconds;
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main()
+{
+    // About the size of the ten seconds of synthetic FLV in the tests.
+    std::vector<std::uint8_t> body(8 * 1024 * 1024);
+    std::mt19937 engine(1);
+    for (auto& byte : body) {
+        byte = static_cast<std::uint8_t>(engine());
+    }
+    http_test_server server(body);
+    // A window of 64 KiB per 20 ms round trip, about 3 MB/s per connection.
+    server.set_latency(std::chrono::milliseconds(20), 64 * 1024);
+    std::printf("%zu bytes, 20 ms per 64 KiB\n", body.size());
+    for (std::size_t connection_count : { 1, 2, 4, 8 }) {
+        auto seconds = measure(server, connection_count, body);
+        std::printf("%zu connection(s)            %8.3f s %8.1f MB/s\n", connection_count, seconds, body.size() / seconds / 1e6);
+    }
+    return 0;
+}
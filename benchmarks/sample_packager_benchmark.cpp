@@ -0,0 +1,130 @@
+/*
+ *    sample_packager_benchmark.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "sample_packager.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::sample;
+
+namespace {
+
+// One second of 25 fps video at about 4 Mbit/s: a 64 KiB key frame
+// followed by 24 frames of 16 KiB.
+std::vector<video_sample> make_gop()
+{
+    std::vector<video_sample> samples(25);
+    for (std::size_t i = 0; i < samples.size(); ++i) {
+        samples[i].dts = samples[i].timestamp = static_cast<std::int64_t>(i) * 400000;
+        samples[i].is_key_frame = i == 0;
+        samples[i].has_parameter_sets = false;
+        samples[i].config_generation = 1;
+        samples[i].data.assign(i == 0 ? 64 * 1024 : 16 * 1024, static_cast<std::uint8_t>(i));
+    }
+    return samples;
+}
+
+const std::vector<std::uint8_t> sps(27, 0x67);
+const std::vector<std::uint8_t> pps(6, 0x68);
+
+// The platform buffer a packaged sample ends up in, like the IBuffer
+// FlvMediaStreamSource hands to the media pipeline.
+struct platform_buffer {
+    std::unique_ptr<std::uint8_t[]> data;
+    std::size_t size;
+};
+
+// FlvMediaStreamSource before the packager: the start-coded parameter sets
+// were written in front of every key frame, and every byte went through the
+// buffer writer one at a time. A growing std::vector stands in for the
+// DataWriter, which is not available here.
+platform_buffer package_per_byte(const video_sample& sample)
+{
+    std::vector<std::uint8_t> writer;
+    auto write_nalu = [&writer](const std::vector<std::uint8_t>& nalu) {
+        writer.push_back(0);
+        writer.push_back(0);
+        writer.push_back(1);
+        for (auto byte : nalu) {
+            writer.push_back(byte);
+        }
+    };
+    if (sample.is_key_frame) {
+        write_nalu(sps);
+        write_nalu(pps);
+    }
+    for (auto byte : sample.data) {
+        writer.push_back(byte);
+    }
+    platform_buffer buffer{ std::make_unique<std::uint8_t[]>(writer.size()), writer.size() };
+    std::memcpy(buffer.data.get(), writer.data(), writer.size());
+    return buffer;
+}
+
+// The packager, then one copy into the platform buffer.
+platform_buffer package_with_packager(const video_sample_packager& packager, video_sample&& sample)
+{
+    auto data = packager.package(std::move(sample));
+    platform_buffer buffer{ std::make_unique<std::uint8_t[]>(data.size()), data.size() };
+    std::memcpy(buffer.data.get(), data.data(), data.size());
+    return buffer;
+}
+
+// Megabytes of samples per second through package(sample), best of three.
+template <typename Package>
+double measure(Package package, int gop_count)
+{
+    auto gop = make_gop();
+    double best = 0.0;
+    for (int round = 0; round < 3; ++round) {
+        std::size_t size = 0;
+        std::size_t checksum = 0;
+        double seconds = 0.0;
+        for (int i = 0; i < gop_count; ++i) {
+            // The packager takes its samples by value, copy them outside the
+            // timed part.
+            auto samples = gop;
+            auto start = std::chrono::steady_clock::now();
+            for (auto& sample : samples) {
+                auto buffer = package(sample);
+                size += buffer.size;
+                checksum += buffer.data[buffer.size - 1];
+            }
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        if (checksum == 0) {
+            std::printf("wrong result\n");
+        }
+        best = std::max(best, size / seconds / 1e6);
+    }
+    return best;
+}
+
+} // namespace
+
+int main()
+{
+    constexpr int gop_count = 200;
+    video_sample_packager packager;
+    packager.set_parameter_sets(1, {}, sps, pps);
+    auto per_byte = measure([](video_sample& sample) {
+        return package_per_byte(sample);
+    }, gop_count);
+    auto packaged = measure([&packager](video_sample& sample) {
+        return package_with_packager(packager, std::move(sample));
+    }, gop_count);
+    std::printf("%-28s %8.0f MB/s\n", "per-byte writer", per_byte);
+    std::printf("%-28s %8.0f MB/s\n", "video_sample_packager", packaged);
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ *    sync_wait_benchmark.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <coroutine>
+#include <cstdio>
+#include <future>
+#include <type_traits>
+#include <vector>
+
+#include "coroutine/sync_wait.hpp"
+#include "coroutine/task.hpp"
+#include "default_task_service.hpp"
+
+using namespace dawn_player;
+
+// sync_wait_task as it was before the stack-based bridge: the task is
+// awaited by a coroutine whose promise is a std::promise, and the caller
+// blocks on the std::future.
+namespace future_sync_wait {
+
+struct as_coroutine {};
+
+} // namespace future_sync_wait
+
+template<typename T, typename... Args>
+    requires(!std::is_void_v<T> && !std::is_reference_v<T>)
+struct std::coroutine_traits<std::future<T>, future_sync_wait::as_coroutine, Args...>
+{
+    struct promise_type : std::promise<T>
+    {
+        std::future<T> get_return_object() noexcept
+        {
+            return this->get_future();
+        }
+
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+
+        void return_value(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            this->set_value(std::move(value));
+        }
+
+        void unhandled_exception() noexcept
+        {
+            this->set_exception(std::current_exception());
+        }
+    };
+};
+
+namespace future_sync_wait {
+
+template<typename T>
+std::future<T> task_to_future(as_coroutine, const coroutine::task<T>& task)
+{
+    T result = co_await task;
+    co_return result;
+}
+
+template<typename T>
+T sync_wait_task(const coroutine::task<T>& task)
+{
+    return task_to_future({}, task).get();
+}
+
+} // namespace future_sync_wait
+
+namespace {
+
+coroutine::task<std::vector<int>> make_values(task_service* service)
+{
+    if (service != nullptr) {
+        co_await switch_to_task_service(service);
+    }
+    co_return std::vector<int>(100, 1);
+}
+
+// Nanoseconds per sync_wait_task() call through wait, for a task that hops
+// to service and returns 100 integers, or completes inline without one.
+template <typename Wait>
+double measure(Wait wait, task_service* service, int call_count)
+{
+    double best = 0.0;
+    for (int round = 0; round < 3; ++round) {
+        std::size_t sum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < call_count; ++i) {
+            sum += wait(make_values(service)).size();
+        }
+        auto result = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / call_count;
+        if (sum != static_cast<std::size_t>(call_count) * 100) {
+            std::printf("wrong result\n");
+        }
+        best = round == 0 ? result : std::min(best, result);
+    }
+    return best;
+}
+
+template <typename Wait>
+void run(const char* name, Wait wait)
+{
+    constexpr int call_count = 200000;
+    default_task_service service;
+    auto hop = measure(wait, &service, call_count);
+    auto inline_ = measure(wait, nullptr, call_count);
+    std::printf("%-28s %8.1f ns/call (hop)  %8.1f ns/call (inline)\n", name, hop, inline_);
+}
+
+} // namespace
+
+int main()
+{
+    run("std::future sync_wait_task", [](coroutine::task<std::vector<int>>&& task) {
+        return future_sync_wait::sync_wait_task(task);
+    });
+    run("sync_wait_task", [](coroutine::task<std::vector<int>>&& task) {
+        return coroutine::sync_wait_task(std::move(task));
+    });
+    return 0;
+}
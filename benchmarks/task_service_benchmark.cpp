@@ -0,0 +1,170 @@
+/*
+ *    task_service_benchmark.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "coroutine/sync_wait.hpp"
+#include "coroutine/task.hpp"
+#include "default_task_service.hpp"
+
+using namespace dawn_player;
+
+namespace {
+
+// default_task_service as it was before the lock-free queue: a mutex, a
+// std::queue of std::function and a condition variable.
+class mutex_task_service : public task_service {
+public:
+    mutex_task_service()
+    {
+        this->thread = std::thread([this]() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lck(this->mtx);
+                    this->cv.wait(lck, [this]() { return !this->task_queue.empty(); });
+                    task = std::move(this->task_queue.front());
+                    this->task_queue.pop();
+                }
+                if (task == nullptr) {
+                    break;
+                }
+                task();
+            }
+        });
+    }
+    virtual ~mutex_task_service()
+    {
+        this->post_task(nullptr);
+        this->thread.join();
+    }
+    virtual void post_task(std::function<void()>&& task)
+    {
+        {
+            std::unique_lock<std::mutex> lck(this->mtx);
+            this->task_queue.push(std::move(task));
+        }
+        this->cv.notify_one();
+    }
+    virtual std::thread::id get_thread_id()
+    {
+        return this->thread.get_id();
+    }
+private:
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::queue<std::function<void()>> task_queue;
+    std::thread thread;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Millions of tasks per second posted by producer_count threads at once
+// through post(service, task), each task capturing three pointers and three
+// integers.
+template <typename Service, typename Post>
+double measure_posts(Service& service, Post post, int producer_count, int task_count)
+{
+    std::int64_t sum = 0;
+    std::atomic<int> done_count{ 0 };
+    std::promise<void> done;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producer_count; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < task_count; ++i) {
+                post(service, [&sum, &done_count, &done, p, i, total = producer_count * task_count]() {
+                    sum += p + i;
+                    if (done_count.fetch_add(1, std::memory_order_relaxed) + 1 == total) {
+                        done.set_value();
+                    }
+                });
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    done.get_future().wait();
+    return producer_count * static_cast<double>(task_count) / seconds_since(start) / 1e6;
+}
+
+coroutine::task<void> ping_pong(task_service* a, task_service* b, int hop_count)
+{
+    for (int i = 0; i < hop_count; i += 2) {
+        co_await switch_to_task_service(a);
+        co_await switch_to_task_service(b);
+    }
+}
+
+// Nanoseconds per switch_to_task_service() hop between two services.
+double measure_hops(task_service& a, task_service& b, int hop_count)
+{
+    auto start = std::chrono::steady_clock::now();
+    coroutine::sync_wait_task(ping_pong(&a, &b, hop_count));
+    return seconds_since(start) * 1e9 / hop_count;
+}
+
+template <typename Service, typename Post>
+void run(const char* name, Post post)
+{
+    constexpr int task_count = 1000000;
+    constexpr int hop_count = 400000;
+    // Warm up the threads and the allocator.
+    {
+        Service service;
+        measure_posts(service, post, 4, task_count / 10);
+    }
+    double single_posts = 0.0;
+    double posts = 0.0;
+    double hops = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        {
+            Service service;
+            single_posts = std::max(single_posts, measure_posts(service, post, 1, task_count));
+        }
+        {
+            Service service;
+            posts = std::max(posts, measure_posts(service, post, 4, task_count));
+        }
+        Service a;
+        Service b;
+        auto result = measure_hops(a, b, hop_count);
+        hops = hops == 0.0 ? result : std::min(hops, result);
+    }
+    std::printf("%-32s %6.2f / %6.2f M posts/s (1 / 4 producers)  %7.1f ns/hop\n", name, single_posts, posts, hops);
+}
+
+} // namespace
+
+int main()
+{
+    auto post_task = [](task_service& service, std::function<void()>&& task) {
+        service.post_task(std::move(task));
+    };
+    run<mutex_task_service>("mutex_task_service::post_task", post_task);
+    run<default_task_service>("default_task_service::post_task", post_task);
+    run<default_task_service>("default_task_service::post", [](task_service& service, auto&& task) {
+        service.post(std::move(task));
+    });
+    return 0;
+}
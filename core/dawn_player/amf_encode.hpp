@@ -0,0 +1,221 @@
+/*
+ *    amf_encode.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_AMF_ENCODE_HPP
+#define DAWN_PLAYER_AMF_ENCODE_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <string>
+
+#include "amf_types.hpp"
+
+namespace dawn_player {
+namespace amf {
+
+class encode_amf_error : public std::exception {
+    const char* _msg;
+public:
+    explicit encode_amf_error(const char* msg) : _msg(msg) {}
+    const char* what() const throw() {
+        return this->_msg;
+    }
+    ~encode_amf_error() throw() {
+    }
+};
+
+// The encoders write AMF0 to out and return the iterator past the last byte
+// written, the counterparts of the decode_amf* functions.
+template <typename OutputIterator>
+OutputIterator encode_amf(const amf_base& value, OutputIterator out);
+
+template <typename OutputIterator>
+OutputIterator encode_amf_number(const amf_number& value, OutputIterator out);
+
+template <typename OutputIterator>
+OutputIterator encode_amf_boolean(const amf_boolean& value, OutputIterator out);
+
+template <typename OutputIterator>
+OutputIterator encode_amf_string(const amf_string& value, OutputIterator out);
+
+template <typename OutputIterator>
+OutputIterator encode_amf_object(const amf_object& value, OutputIterator out);
+
+template <typename OutputIterator>
+OutputIterator encode_amf_ecma_array(const amf_ecma_array& value, OutputIterator out);
+
+template <typename OutputIterator>
+OutputIterator encode_amf_object_end(const amf_object_end& value, OutputIterator out);
+
+template <typename OutputIterator>
+OutputIterator encode_amf_strict_array(const amf_strict_array& value, OutputIterator out);
+
+template <typename OutputIterator>
+OutputIterator encode_amf_date(const amf_date& value, OutputIterator out);
+
+namespace impl {
+
+template <typename OutputIterator>
+OutputIterator encode_uint16_be(std::uint16_t value, OutputIterator out)
+{
+    *out++ = static_cast<std::uint8_t>(value >> 8);
+    *out++ = static_cast<std::uint8_t>(value);
+    return out;
+}
+
+template <typename OutputIterator>
+OutputIterator encode_uint32_be(std::uint32_t value, OutputIterator out)
+{
+    out = encode_uint16_be(static_cast<std::uint16_t>(value >> 16), out);
+    return encode_uint16_be(static_cast<std::uint16_t>(value), out);
+}
+
+template <typename OutputIterator>
+OutputIterator encode_double_be(double value, OutputIterator out)
+{
+    // IEEE-754
+    std::uint64_t bits = 0;
+    static_assert(sizeof(bits) == sizeof(value), "error");
+    std::memcpy(&bits, &value, sizeof(bits));
+    out = encode_uint32_be(static_cast<std::uint32_t>(bits >> 32), out);
+    return encode_uint32_be(static_cast<std::uint32_t>(bits), out);
+}
+
+// Property names, and string values after their marker.
+template <typename OutputIterator>
+OutputIterator encode_amf_string_without_marker(const std::string& value, OutputIterator out)
+{
+    if (value.size() > std::numeric_limits<std::uint16_t>::max()) {
+        throw encode_amf_error("Failed to encode, string too long.");
+    }
+    out = encode_uint16_be(static_cast<std::uint16_t>(value.size()), out);
+    for (auto c : value) {
+        *out++ = static_cast<std::uint8_t>(c);
+    }
+    return out;
+}
+
+// Empty property name followed by the object end marker, closes objects
+// and ECMA arrays.
+template <typename OutputIterator>
+OutputIterator encode_amf_properties_end(OutputIterator out)
+{
+    out = encode_uint16_be(0, out);
+    return encode_amf_object_end(amf_object_end(), out);
+}
+
+} // namespace impl
+
+template <typename OutputIterator>
+OutputIterator encode_amf(const amf_base& value, OutputIterator out)
+{
+    switch (value.get_type()) {
+    case amf_type::number:
+        return encode_amf_number(static_cast<const amf_number&>(value), out);
+    case amf_type::boolean:
+        return encode_amf_boolean(static_cast<const amf_boolean&>(value), out);
+    case amf_type::string:
+        return encode_amf_string(static_cast<const amf_string&>(value), out);
+    case amf_type::object:
+        return encode_amf_object(static_cast<const amf_object&>(value), out);
+    case amf_type::ecma_array:
+        return encode_amf_ecma_array(static_cast<const amf_ecma_array&>(value), out);
+    case amf_type::object_end:
+        return encode_amf_object_end(static_cast<const amf_object_end&>(value), out);
+    case amf_type::strict_array:
+        return encode_amf_strict_array(static_cast<const amf_strict_array&>(value), out);
+    case amf_type::date:
+        return encode_amf_date(static_cast<const amf_date&>(value), out);
+    default:
+        throw encode_amf_error("Failed to encode, meet unsupported value type.");
+    }
+}
+
+template <typename OutputIterator>
+OutputIterator encode_amf_number(const amf_number& value, OutputIterator out)
+{
+    *out++ = 0x00;
+    return impl::encode_double_be(value.get_value(), out);
+}
+
+template <typename OutputIterator>
+OutputIterator encode_amf_boolean(const amf_boolean& value, OutputIterator out)
+{
+    *out++ = 0x01;
+    *out++ = value.get_value() ? 0x01 : 0x00;
+    return out;
+}
+
+template <typename OutputIterator>
+OutputIterator encode_amf_string(const amf_string& value, OutputIterator out)
+{
+    *out++ = 0x02;
+    return impl::encode_amf_string_without_marker(value.get_value(), out);
+}
+
+template <typename OutputIterator>
+OutputIterator encode_amf_object(const amf_object& value, OutputIterator out)
+{
+    *out++ = 0x03;
+    // amf_object has no iterators, its properties are read through the
+    // array view.
+    auto properties = value.to_ecma_array();
+    for (const auto& property : *properties) {
+        out = impl::encode_amf_string_without_marker(property.first.get_value(), out);
+        out = encode_amf(*property.second, out);
+    }
+    return impl::encode_amf_properties_end(out);
+}
+
+template <typename OutputIterator>
+OutputIterator encode_amf_ecma_array(const amf_ecma_array& value, OutputIterator out)
+{
+    *out++ = 0x08;
+    // The count is only a hint to decoders, the array still ends with the
+    // object end marker.
+    out = impl::encode_uint32_be(static_cast<std::uint32_t>(std::distance(value.begin(), value.end())), out);
+    for (const auto& item : value) {
+        out = impl::encode_amf_string_without_marker(item.first.get_value(), out);
+        out = encode_amf(*item.second, out);
+    }
+    return impl::encode_amf_properties_end(out);
+}
+
+template <typename OutputIterator>
+OutputIterator encode_amf_object_end(const amf_object_end&, OutputIterator out)
+{
+    *out++ = 0x09;
+    return out;
+}
+
+template <typename OutputIterator>
+OutputIterator encode_amf_strict_array(const amf_strict_array& value, OutputIterator out)
+{
+    *out++ = 0x0a;
+    out = impl::encode_uint32_be(static_cast<std::uint32_t>(value.size()), out);
+    for (const auto& item : value) {
+        out = encode_amf(*item, out);
+    }
+    return out;
+}
+
+template <typename OutputIterator>
+OutputIterator encode_amf_date(const amf_date& value, OutputIterator out)
+{
+    *out++ = 0x0b;
+    out = impl::encode_double_be(value.get_value(), out);
+    // Time-zone (reserved S16)
+    return impl::encode_uint16_be(0, out);
+}
+
+} // namespace amf
+} // namespace dawn_player
+
+#endif
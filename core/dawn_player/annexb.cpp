@@ -0,0 +1,133 @@
+/*
+ *    annexb.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DAWN_PLAYER_ANNEXB_SSE2
+#include <emmintrin.h>
+// vceqzq_u8 and vmaxvq_u8 are AArch64 only, 32-bit ARM takes the scalar
+// path.
+#elif (defined(__ARM_NEON) && defined(__aarch64__)) || defined(_M_ARM64)
+#define DAWN_PLAYER_ANNEXB_NEON
+#include <arm_neon.h>
+#endif
+
+#include "annexb.hpp"
+
+namespace dawn_player {
+namespace sample {
+namespace impl {
+
+const std::uint8_t* find_start_code_scalar(const std::uint8_t* begin, const std::uint8_t* end)
+{
+    // A start code has a zero at +1 or a zero and a one at +2, so when the
+    // byte at +2 is neither, no start code begins at +0, +1 or +2.
+    auto p = begin;
+    while (end - p >= 3) {
+        if (p[2] > 1) {
+            p += 3;
+        }
+        else if (p[2] == 1 && p[1] == 0 && p[0] == 0) {
+            return p;
+        }
+        else {
+            ++p;
+        }
+    }
+    return end;
+}
+
+} // namespace impl
+
+const std::uint8_t* find_start_code(const std::uint8_t* begin, const std::uint8_t* end)
+{
+    auto p = begin;
+#if defined(DAWN_PLAYER_ANNEXB_SSE2)
+    // Positions i with data[i] == 0, data[i + 1] == 0 and data[i + 2] == 1,
+    // for 16 positions per step.
+    const auto zero = _mm_setzero_si128();
+    const auto one = _mm_set1_epi8(1);
+    while (end - p >= 18) {
+        auto v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        auto v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 1));
+        auto v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2));
+        auto match = _mm_and_si128(_mm_and_si128(_mm_cmpeq_epi8(v0, zero), _mm_cmpeq_epi8(v1, zero)), _mm_cmpeq_epi8(v2, one));
+        auto mask = static_cast<unsigned int>(_mm_movemask_epi8(match));
+        if (mask != 0) {
+            auto index = 0;
+            while ((mask & 1) == 0) {
+                mask >>= 1;
+                ++index;
+            }
+            return p + index;
+        }
+        p += 16;
+    }
+#elif defined(DAWN_PLAYER_ANNEXB_NEON)
+    const auto one = vdupq_n_u8(1);
+    while (end - p >= 18) {
+        auto v0 = vld1q_u8(p);
+        auto v1 = vld1q_u8(p + 1);
+        auto v2 = vld1q_u8(p + 2);
+        auto match = vandq_u8(vandq_u8(vceqzq_u8(v0), vceqzq_u8(v1)), vceqq_u8(v2, one));
+        if (vmaxvq_u8(match) != 0) {
+            // Rare, the block holds a start code.
+            return impl::find_start_code_scalar(p, p + 18);
+        }
+        p += 16;
+    }
+#endif
+    return impl::find_start_code_scalar(p, end);
+}
+
+void split_annexb(const std::uint8_t* data, std::size_t size, std::vector<std::pair<std::size_t, std::size_t>>& nalus)
+{
+    auto end = data + size;
+    auto start_code = find_start_code(data, end);
+    auto nalu = data;
+    if (start_code == data) {
+        nalu = start_code + 3;
+        start_code = find_start_code(nalu, end);
+    }
+    for (;;) {
+        auto nalu_end = start_code;
+        // The leading zero of a 4-byte start code, and trailing zero bytes,
+        // a NAL unit never ends with a zero byte.
+        while (nalu_end > nalu && nalu_end[-1] == 0) {
+            --nalu_end;
+        }
+        if (nalu_end > nalu) {
+            nalus.emplace_back(static_cast<std::size_t>(nalu - data), static_cast<std::size_t>(nalu_end - nalu));
+        }
+        if (start_code == end) {
+            break;
+        }
+        nalu = start_code + 3;
+        start_code = find_start_code(nalu, end);
+    }
+}
+
+void annexb_to_avcc(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& out)
+{
+    std::vector<std::pair<std::size_t, std::size_t>> nalus;
+    split_annexb(data, size, nalus);
+    std::size_t total_size = 0;
+    for (const auto& nalu : nalus) {
+        total_size += 4 + nalu.second;
+    }
+    out.reserve(out.size() + total_size);
+    for (const auto& nalu : nalus) {
+        auto length = static_cast<std::uint32_t>(nalu.second);
+        out.push_back(static_cast<std::uint8_t>(length >> 24));
+        out.push_back(static_cast<std::uint8_t>(length >> 16));
+        out.push_back(static_cast<std::uint8_t>(length >> 8));
+        out.push_back(static_cast<std::uint8_t>(length));
+        out.insert(out.end(), data + nalu.first, data + nalu.first + nalu.second);
+    }
+}
+
+} // namespace sample
+} // namespace dawn_player
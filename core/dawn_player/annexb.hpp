@@ -0,0 +1,35 @@
+/*
+ *    annexb.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_ANNEXB_HPP
+#define DAWN_PLAYER_ANNEXB_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dawn_player {
+namespace sample {
+
+// Returns the first 00 00 01 start code in [begin, end), or end. Scans 16
+// bytes at a time with SSE2 or NEON where available.
+const std::uint8_t* find_start_code(const std::uint8_t* begin, const std::uint8_t* end);
+
+// Appends (offset, size) of each NAL unit of an Annex-B buffer to nalus,
+// without start codes and the zero bytes of 4-byte start codes. Bytes
+// before the first start code are taken for a NAL unit too.
+void split_annexb(const std::uint8_t* data, std::size_t size, std::vector<std::pair<std::size_t, std::size_t>>& nalus);
+
+// Appends the NAL units of an Annex-B buffer to out as AVCC, each behind a
+// 4-byte big-endian length.
+void annexb_to_avcc(const std::uint8_t* data, std::size_t size, std::vector<std::uint8_t>& out);
+
+} // namespace sample
+} // namespace dawn_player
+
+#endif
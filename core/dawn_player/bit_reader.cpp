@@ -0,0 +1,99 @@
+/*
+ *    bit_reader.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include "bit_reader.hpp"
+
+namespace dawn_player {
+namespace parser {
+
+bit_reader::bit_reader(const std::uint8_t* data, std::size_t size)
+    : data(data)
+    , size(size)
+    , position(0)
+    , zero_count(0)
+    , current_byte(0)
+    , bits_left(0)
+{
+}
+
+std::uint32_t bit_reader::read_bits(std::uint32_t count)
+{
+    std::uint32_t value = 0;
+    while (count != 0) {
+        if (this->bits_left == 0) {
+            this->load_byte();
+        }
+        auto n = count < this->bits_left ? count : this->bits_left;
+        auto shift = this->bits_left - n;
+        auto bits = (this->current_byte >> shift) & ((1u << n) - 1);
+        // n may be 8 here, shift in two steps to stay defined for 32-bit reads.
+        value = ((value << (n - 1)) << 1) | bits;
+        this->bits_left -= n;
+        count -= n;
+    }
+    return value;
+}
+
+bool bit_reader::read_bit()
+{
+    return this->read_bits(1) != 0;
+}
+
+void bit_reader::skip_bits(std::size_t count)
+{
+    while (count >= 32) {
+        this->read_bits(32);
+        count -= 32;
+    }
+    this->read_bits(static_cast<std::uint32_t>(count));
+}
+
+std::uint32_t bit_reader::read_ue()
+{
+    std::uint32_t leading_zero_bits = 0;
+    while (!this->read_bit()) {
+        if (++leading_zero_bits > 31) {
+            throw bit_reader_error("Bad exp-Golomb code.");
+        }
+    }
+    if (leading_zero_bits == 0) {
+        return 0;
+    }
+    return static_cast<std::uint32_t>((std::uint64_t(1) << leading_zero_bits) - 1 + this->read_bits(leading_zero_bits));
+}
+
+std::int32_t bit_reader::read_se()
+{
+    auto code_num = this->read_ue();
+    // 1, 2, 3, 4 ... maps to 1, -1, 2, -2 ...
+    if (code_num & 1) {
+        return static_cast<std::int32_t>((code_num >> 1) + 1);
+    }
+    return -static_cast<std::int32_t>(code_num >> 1);
+}
+
+void bit_reader::load_byte()
+{
+    if (this->position >= this->size) {
+        throw bit_reader_error("Unexpected end of NAL unit.");
+    }
+    auto byte = this->data[this->position++];
+    if (this->zero_count >= 2 && byte == 0x03) {
+        // emulation_prevention_three_byte
+        this->zero_count = 0;
+        if (this->position >= this->size) {
+            throw bit_reader_error("Unexpected end of NAL unit.");
+        }
+        byte = this->data[this->position++];
+    }
+    this->zero_count = byte == 0x00 ? this->zero_count + 1 : 0;
+    this->current_byte = byte;
+    this->bits_left = 8;
+}
+
+} // namespace parser
+} // namespace dawn_player
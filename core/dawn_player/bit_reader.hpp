@@ -0,0 +1,58 @@
+/*
+ *    bit_reader.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_BIT_READER_HPP
+#define DAWN_PLAYER_BIT_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+
+namespace dawn_player {
+namespace parser {
+
+class bit_reader_error : public std::exception {
+    const char* _msg;
+public:
+    explicit bit_reader_error(const char* msg) : _msg(msg) {}
+    const char* what() const throw() {
+        return this->_msg;
+    }
+    ~bit_reader_error() throw() {
+    }
+};
+
+// Reads the RBSP of an H.264/HEVC NAL unit bit by bit, MSB first. Emulation
+// prevention bytes (the 0x03 in 0x000003) are dropped while reading, so the
+// NAL unit does not have to be unescaped into a copy first. Reading past the
+// end throws bit_reader_error.
+class bit_reader {
+    const std::uint8_t* data;
+    std::size_t size;
+    std::size_t position;
+    std::uint32_t zero_count;
+    std::uint32_t current_byte;
+    std::uint32_t bits_left;
+public:
+    bit_reader(const std::uint8_t* data, std::size_t size);
+    // u(n), n <= 32
+    std::uint32_t read_bits(std::uint32_t count);
+    // u(1)
+    bool read_bit();
+    void skip_bits(std::size_t count);
+    // ue(v)
+    std::uint32_t read_ue();
+    // se(v)
+    std::int32_t read_se();
+private:
+    void load_byte();
+};
+
+} // namespace parser
+} // namespace dawn_player
+
+#endif
@@ -0,0 +1,150 @@
+/*
+ *    cache_io.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#include "cache_io.hpp"
+
+namespace dawn_player {
+namespace io {
+
+block_cache_read_stream_proxy::block_cache_read_stream_proxy(const std::shared_ptr<read_stream_proxy>& inner,
+    std::uint64_t memory_budget, std::uint32_t block_size)
+    : inner(inner)
+    , block_size(std::max<std::uint32_t>(block_size, 4096))
+    , clock_hand(0)
+    , position(0)
+    , inner_position(0)
+{
+    // At least two blocks, so that the block being read is never the only
+    // candidate for eviction.
+    auto block_count = std::max<std::uint64_t>(memory_budget / this->block_size, 2);
+    this->blocks.resize(static_cast<std::size_t>(block_count));
+    this->block_slots.reserve(static_cast<std::size_t>(block_count));
+}
+
+block_cache_read_stream_proxy::~block_cache_read_stream_proxy()
+{
+}
+
+bool block_cache_read_stream_proxy::can_seek() const
+{
+    return this->inner->can_seek();
+}
+
+coroutine::task<std::uint32_t> block_cache_read_stream_proxy::read(std::uint8_t* buf, std::uint32_t size)
+{
+    if (size == 0) {
+        co_return 0;
+    }
+    auto index = this->position / this->block_size;
+    auto offset = static_cast<std::uint32_t>(this->position % this->block_size);
+    auto cached = this->find_block(index);
+    bool is_hit = cached != nullptr && (cached->filled > offset || cached->is_final);
+    if (is_hit) {
+        ++this->stats.hit_count;
+    }
+    else {
+        ++this->stats.miss_count;
+        if (cached == nullptr) {
+            cached = &this->allocate_block(index);
+        }
+        // Blocks are filled from their start, so that every cached byte of a
+        // block is contiguous.
+        auto fill_position = index * this->block_size + cached->filled;
+        if (this->inner_position != fill_position) {
+            if (!this->inner->can_seek()) {
+                throw std::runtime_error("position is not cached");
+            }
+            this->inner->seek(fill_position);
+            this->inner_position = fill_position;
+        }
+        while (cached->filled <= offset && !cached->is_final) {
+            auto result = co_await this->inner->read(cached->data.get() + cached->filled, this->block_size - cached->filled);
+            if (result == 0) {
+                cached->is_final = true;
+            }
+            cached->filled += result;
+            this->inner_position += result;
+            this->stats.miss_bytes += result;
+        }
+    }
+    cached->is_referenced = true;
+    if (cached->filled <= offset) {
+        co_return 0;
+    }
+    auto result = std::min(size, cached->filled - offset);
+    std::memcpy(buf, cached->data.get() + offset, result);
+    this->position += result;
+    if (is_hit) {
+        this->stats.hit_bytes += result;
+    }
+    co_return result;
+}
+
+void block_cache_read_stream_proxy::seek(std::uint64_t pos)
+{
+    if (!this->inner->can_seek() && pos != this->inner_position) {
+        auto cached = this->find_block(pos / this->block_size);
+        if (cached == nullptr || cached->filled <= pos % this->block_size) {
+            throw std::runtime_error("position is not cached");
+        }
+    }
+    this->position = pos;
+}
+
+void block_cache_read_stream_proxy::set_seek_points(const std::vector<std::uint64_t>& positions)
+{
+    this->inner->set_seek_points(positions);
+}
+
+block_cache_stats block_cache_read_stream_proxy::get_stats() const
+{
+    return this->stats;
+}
+
+block_cache_read_stream_proxy::block* block_cache_read_stream_proxy::find_block(std::uint64_t index)
+{
+    auto iter = this->block_slots.find(index);
+    if (iter == this->block_slots.end()) {
+        return nullptr;
+    }
+    return &this->blocks[iter->second];
+}
+
+block_cache_read_stream_proxy::block& block_cache_read_stream_proxy::allocate_block(std::uint64_t index)
+{
+    for (;;) {
+        auto slot = this->clock_hand;
+        auto& candidate = this->blocks[slot];
+        this->clock_hand = (this->clock_hand + 1) % this->blocks.size();
+        if (candidate.is_used) {
+            // Recently read blocks get a second chance.
+            if (candidate.is_referenced) {
+                candidate.is_referenced = false;
+                continue;
+            }
+            this->block_slots.erase(candidate.index);
+            ++this->stats.eviction_count;
+        }
+        if (candidate.data == nullptr) {
+            candidate.data.reset(new std::uint8_t[this->block_size]);
+        }
+        candidate.index = index;
+        candidate.filled = 0;
+        candidate.is_used = true;
+        candidate.is_final = false;
+        candidate.is_referenced = false;
+        this->block_slots.emplace(index, slot);
+        return candidate;
+    }
+}
+
+} // namespace io
+} // namespace dawn_player
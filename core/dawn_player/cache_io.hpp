@@ -0,0 +1,77 @@
+/*
+ *    cache_io.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_CACHE_IO_HPP
+#define DAWN_PLAYER_CACHE_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "io.hpp"
+
+namespace dawn_player {
+namespace io {
+
+struct block_cache_stats {
+    // Reads served from the cache and reads that had to go to the inner proxy.
+    std::uint64_t hit_count = 0;
+    std::uint64_t miss_count = 0;
+    std::uint64_t hit_bytes = 0;
+    std::uint64_t miss_bytes = 0;
+    std::uint64_t eviction_count = 0;
+};
+
+// Caches what is read from another proxy in blocks of block_size bytes,
+// aligned to multiples of block_size. When memory_budget is used up, blocks
+// are evicted with the CLOCK algorithm (an approximation of LRU). Seeking
+// back to a cached region, e.g. when scrubbing, is served from memory.
+//
+// If the inner proxy cannot seek (live streams), the cache still allows
+// seeking within the blocks it holds, up to the latest data read. can_seek()
+// reports the inner proxy's ability.
+class block_cache_read_stream_proxy : public read_stream_proxy {
+public:
+    explicit block_cache_read_stream_proxy(const std::shared_ptr<read_stream_proxy>& inner,
+        std::uint64_t memory_budget = 64 * 1024 * 1024, std::uint32_t block_size = 256 * 1024);
+    virtual ~block_cache_read_stream_proxy();
+    virtual bool can_seek() const;
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
+    // Throws if the inner proxy cannot seek and pos is neither cached nor
+    // the position of the latest data.
+    virtual void seek(std::uint64_t pos);
+    virtual void set_seek_points(const std::vector<std::uint64_t>& positions);
+    block_cache_stats get_stats() const;
+private:
+    struct block {
+        std::uint64_t index = 0;
+        std::unique_ptr<std::uint8_t[]> data;
+        std::uint32_t filled = 0;
+        bool is_used = false;
+        // The stream ends at filled.
+        bool is_final = false;
+        bool is_referenced = false;
+    };
+    block* find_block(std::uint64_t index);
+    block& allocate_block(std::uint64_t index);
+private:
+    std::shared_ptr<read_stream_proxy> inner;
+    std::uint32_t block_size;
+    std::vector<block> blocks;
+    std::unordered_map<std::uint64_t, std::size_t> block_slots;
+    std::size_t clock_hand;
+    std::uint64_t position;
+    std::uint64_t inner_position;
+    block_cache_stats stats;
+};
+
+} // namespace io
+} // namespace dawn_player
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ *    async_manual_reset_event.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_COROUTINE_ASYNC_MANUAL_RESET_EVENT_HPP
+#define DAWN_PLAYER_COROUTINE_ASYNC_MANUAL_RESET_EVENT_HPP
+
+#include <atomic>
+#include <coroutine>
+
+namespace dawn_player::coroutine {
+
+// An event that coroutines can co_await. While the event is set, co_await
+// completes immediately. Otherwise the awaiting coroutine is linked into an
+// intrusive list of waiters (the awaiter lives in its frame) and resumed
+// inline by the next call to set(), so waking any number of waiters does not
+// allocate.
+class async_manual_reset_event {
+public:
+    class awaiter {
+        friend class async_manual_reset_event;
+        const async_manual_reset_event& event;
+        awaiter* next = nullptr;
+        std::coroutine_handle<> coro;
+    public:
+        explicit awaiter(const async_manual_reset_event& event) noexcept
+            : event(event)
+        {}
+
+        bool await_ready() const noexcept
+        {
+            return this->event.is_set();
+        }
+
+        bool await_suspend(std::coroutine_handle<> coro) noexcept
+        {
+            this->coro = coro;
+            const void* set_state = &this->event;
+            void* old_state = this->event.state.load(std::memory_order_acquire);
+            do {
+                if (old_state == set_state) {
+                    // The event was set in the meantime, resume immediately.
+                    return false;
+                }
+                this->next = static_cast<awaiter*>(old_state);
+            } while (!this->event.state.compare_exchange_weak(
+                old_state, this, std::memory_order_release, std::memory_order_acquire));
+            return true;
+        }
+
+        void await_resume() const noexcept {}
+    };
+
+    explicit async_manual_reset_event(bool initially_set = false) noexcept
+        : state(initially_set ? static_cast<void*>(this) : nullptr)
+    {}
+
+    async_manual_reset_event(const async_manual_reset_event&) = delete;
+    async_manual_reset_event& operator=(const async_manual_reset_event&) = delete;
+
+    bool is_set() const noexcept
+    {
+        return this->state.load(std::memory_order_acquire) == this;
+    }
+
+    // Sets the event and resumes all waiting coroutines on the calling thread.
+    void set() noexcept
+    {
+        void* old_state = this->state.exchange(this, std::memory_order_acq_rel);
+        if (old_state == this) {
+            return;
+        }
+        // Waiters are pushed onto the list head, reverse it to resume them in
+        // the order they started waiting.
+        awaiter* waiter = nullptr;
+        for (auto node = static_cast<awaiter*>(old_state); node != nullptr;) {
+            auto next = node->next;
+            node->next = waiter;
+            waiter = node;
+            node = next;
+        }
+        while (waiter != nullptr) {
+            // The awaiter is destroyed once its coroutine resumes.
+            auto next = waiter->next;
+            waiter->coro.resume();
+            waiter = next;
+        }
+    }
+
+    void reset() noexcept
+    {
+        void* old_state = this;
+        this->state.compare_exchange_strong(old_state, nullptr, std::memory_order_relaxed);
+    }
+
+    awaiter operator co_await() const noexcept
+    {
+        return awaiter{ *this };
+    }
+
+private:
+    // this: set; nullptr: not set, no waiters; otherwise: head of the waiter list.
+    mutable std::atomic<void*> state;
+};
+
+} // namespace dawn_player::coroutine
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ *    detached_task.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_COROUTINE_DETACHED_TASK_HPP
+#define DAWN_PLAYER_COROUTINE_DETACHED_TASK_HPP
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+#include "frame_allocator.hpp"
+
+namespace dawn_player::coroutine {
+
+// Return type of fire-and-forget coroutines. The coroutine starts running
+// immediately and its frame is released when it finishes. Exceptions must be
+// handled inside the coroutine.
+struct detached_task {
+    struct promise_type {
+        static void* operator new(std::size_t size) { return impl::frame_cache::allocate(size); }
+
+        static void operator delete(void* ptr, std::size_t size) noexcept
+        {
+            impl::frame_cache::deallocate(ptr, size);
+        }
+
+        detached_task get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+} // namespace dawn_player::coroutine
+
+#endif
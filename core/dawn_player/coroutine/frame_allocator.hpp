@@ -0,0 +1,282 @@
+/*
+ *    frame_allocator.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_COROUTINE_FRAME_ALLOCATOR_HPP
+#define DAWN_PLAYER_COROUTINE_FRAME_ALLOCATOR_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace dawn_player::coroutine {
+namespace impl {
+
+// Thread-local free lists of coroutine frames. Size classes are eight steps
+// per power of two from 64 bytes to 128 KiB, so a frame wastes at most an
+// eighth of its block; the 64 KiB frame of flv_player::read_some_data()
+// takes a 72 KiB block. Larger frames come from operator new.
+//
+// Each block starts with a header naming the cache that allocated it. A
+// block released on another thread goes back to that cache through a
+// lock-free list, which the owner takes over when its own free list runs
+// out and reuses a block at a time, so producer/consumer patterns neither
+// grow the consumer's cache nor make the producer allocate.
+// A cache outlives its thread for as long as blocks it handed out are
+// alive, and a block released during thread exit, after the cache of the
+// thread is gone, is freed right away. The owner keeps its counts without
+// atomics, only blocks coming back from other threads are counted with one.
+class frame_cache {
+    struct alignas(std::max_align_t) block_header {
+        // Null for blocks not taken from a cache.
+        frame_cache* owner;
+        std::size_t class_index;
+    };
+
+    struct free_block {
+        free_block* next;
+    };
+
+    static constexpr std::size_t min_class_shift = 6;    // 64 bytes
+    static constexpr std::size_t max_class_shift = 17;   // 128 KiB
+    static constexpr std::size_t sub_class_shift = 3;    // 8 steps per power of two
+    static constexpr std::size_t sub_class_count = std::size_t(1) << sub_class_shift;
+    static constexpr std::size_t class_count = (max_class_shift - min_class_shift) * sub_class_count + 1;
+    // Upper bound on the bytes kept in one size class.
+    static constexpr std::size_t max_cached_bytes_per_class = 256 * 1024;
+
+    // Only touched by the owning thread, and by the last release.
+    free_block* free_lists[class_count] = {};
+    std::size_t free_counts[class_count] = {};
+    // Blocks taken over from returned_blocks, not sorted into classes yet.
+    free_block* returned_chain = nullptr;
+    // Blocks handed out and not released on the owning thread.
+    std::int64_t owned_block_count = 0;
+    // Blocks released on other threads, apart from those of the owner.
+    alignas(64) std::atomic<free_block*> returned_blocks{ nullptr };
+    // Minus the blocks released on other threads. When the thread exits it
+    // adds owned_block_count, which leaves the number of blocks still out,
+    // and whoever brings it to zero frees the cache.
+    std::atomic<std::int64_t> remote_balance{ 0 };
+    std::atomic<bool> is_thread_exited{ false };
+
+    // The cache of the calling thread. Plain pointers stay valid while the
+    // thread's other thread_local objects are destroyed.
+    static inline thread_local frame_cache* current = nullptr;
+    static inline thread_local bool is_current_exited = false;
+
+    // Creates the cache of a thread and releases it when the thread exits.
+    struct thread_cache_guard {
+        thread_cache_guard()
+        {
+            current = new frame_cache();
+        }
+        ~thread_cache_guard()
+        {
+            auto cache = current;
+            current = nullptr;
+            is_current_exited = true;
+            cache->release_thread();
+        }
+    };
+
+public:
+    frame_cache(const frame_cache&) = delete;
+    frame_cache& operator=(const frame_cache&) = delete;
+
+    // The cache of the calling thread, null once it has started to exit.
+    static frame_cache* local()
+    {
+        if (current == nullptr && !is_current_exited) {
+            static thread_local thread_cache_guard guard;
+        }
+        return current;
+    }
+
+    static void* allocate(std::size_t size)
+    {
+        auto index = size_class_index(sizeof(block_header) + size);
+        auto cache = index < class_count ? local() : nullptr;
+        if (cache == nullptr) {
+            auto header = static_cast<block_header*>(::operator new(sizeof(block_header) + size));
+            header->owner = nullptr;
+            header->class_index = class_count;
+            return header + 1;
+        }
+        return cache->allocate_block(index);
+    }
+
+    static void deallocate(void* ptr, std::size_t) noexcept
+    {
+        auto header = static_cast<block_header*>(ptr) - 1;
+        auto owner = header->owner;
+        if (owner == nullptr) {
+            ::operator delete(header);
+        }
+        else if (owner == current) {
+            owner->release_local_block(header);
+        }
+        else {
+            owner->release_remote_block(header);
+        }
+    }
+
+    // The size of the block that holds a frame of size bytes, its header
+    // included.
+    static std::size_t get_block_size(std::size_t size)
+    {
+        auto index = size_class_index(sizeof(block_header) + size);
+        return index < class_count ? class_size(index) : sizeof(block_header) + size;
+    }
+
+private:
+    frame_cache() = default;
+    ~frame_cache() = default;
+
+    void* allocate_block(std::size_t index)
+    {
+        auto block = this->free_lists[index];
+        if (block != nullptr) {
+            this->free_lists[index] = block->next;
+            --this->free_counts[index];
+        }
+        else {
+            block = this->take_returned_block(index);
+        }
+        auto header = block != nullptr
+            ? reinterpret_cast<block_header*>(block)
+            : static_cast<block_header*>(::operator new(class_size(index)));
+        ++this->owned_block_count;
+        header->owner = this;
+        header->class_index = index;
+        return header + 1;
+    }
+
+    // Keeps the block unless its size class is full.
+    void cache_block(block_header* header) noexcept
+    {
+        auto index = header->class_index;
+        if (this->free_counts[index] >= max_cached_bytes_per_class / class_size(index)) {
+            ::operator delete(header);
+            return;
+        }
+        auto block = reinterpret_cast<free_block*>(header);
+        block->next = this->free_lists[index];
+        this->free_lists[index] = block;
+        ++this->free_counts[index];
+    }
+
+    void release_local_block(block_header* header) noexcept
+    {
+        this->cache_block(header);
+        --this->owned_block_count;
+    }
+
+    void release_remote_block(block_header* header) noexcept
+    {
+        if (this->is_thread_exited.load(std::memory_order_acquire)) {
+            ::operator delete(header);
+        }
+        else {
+            auto block = reinterpret_cast<free_block*>(header);
+            block->next = this->returned_blocks.load(std::memory_order_relaxed);
+            while (!this->returned_blocks.compare_exchange_weak(block->next, block, std::memory_order_release, std::memory_order_relaxed)) {
+            }
+        }
+        if (this->remote_balance.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            this->destroy();
+        }
+    }
+
+    // A returned block of the size class, sorting the ones of other classes
+    // into their free lists on the way.
+    free_block* take_returned_block(std::size_t index) noexcept
+    {
+        for (;;) {
+            if (this->returned_chain == nullptr) {
+                this->returned_chain = this->returned_blocks.exchange(nullptr, std::memory_order_acquire);
+                if (this->returned_chain == nullptr) {
+                    return nullptr;
+                }
+            }
+            auto block = this->returned_chain;
+            this->returned_chain = block->next;
+            auto header = reinterpret_cast<block_header*>(block);
+            if (header->class_index == index) {
+                return block;
+            }
+            this->cache_block(header);
+        }
+    }
+
+    static void free_chain(free_block* block) noexcept
+    {
+        while (block != nullptr) {
+            auto next = block->next;
+            ::operator delete(block);
+            block = next;
+        }
+    }
+
+    void free_cached_blocks() noexcept
+    {
+        free_chain(this->returned_blocks.exchange(nullptr, std::memory_order_acquire));
+        free_chain(this->returned_chain);
+        this->returned_chain = nullptr;
+        for (std::size_t i = 0; i < class_count; ++i) {
+            free_chain(this->free_lists[i]);
+            this->free_lists[i] = nullptr;
+            this->free_counts[i] = 0;
+        }
+    }
+
+    void release_thread() noexcept
+    {
+        this->is_thread_exited.store(true, std::memory_order_release);
+        this->free_cached_blocks();
+        if (this->remote_balance.fetch_add(this->owned_block_count, std::memory_order_acq_rel) + this->owned_block_count == 0) {
+            this->destroy();
+        }
+    }
+
+    void destroy() noexcept
+    {
+        // Blocks returned after the thread exited.
+        this->free_cached_blocks();
+        delete this;
+    }
+
+    static constexpr std::size_t class_size(std::size_t index)
+    {
+        if (index == 0) {
+            return std::size_t(1) << min_class_shift;
+        }
+        auto shift = (index - 1) / sub_class_count + min_class_shift;
+        auto step = (index - 1) % sub_class_count + 1;
+        return (sub_class_count + step) << (shift - sub_class_shift);
+    }
+
+    static std::size_t size_class_index(std::size_t size)
+    {
+        if (size <= class_size(0)) {
+            return 0;
+        }
+        // size is in (2^shift, 2^(shift + 1)], step in [0, sub_class_count).
+        auto shift = static_cast<std::size_t>(std::bit_width(size - 1)) - 1;
+        if (shift >= max_class_shift) {
+            return class_count;
+        }
+        auto step = ((size - 1) >> (shift - sub_class_shift)) - sub_class_count;
+        return (shift - min_class_shift) * sub_class_count + step + 1;
+    }
+};
+
+} // namespace impl
+} // namespace dawn_player::coroutine
+
+#endif
@@ -1,108 +1,152 @@
-/*
- *    sync_wait.hpp:
- *
- *    Copyright (C) 2025 Light Lin <blog.poxiao.me> All Rights Reserved.
- *
- */
-
-#ifndef DAWN_PLAYER_COROUTINE_SYNC_WAIT_HPP
-#define DAWN_PLAYER_COROUTINE_SYNC_WAIT_HPP
-
-#include <coroutine>
-#include <future>
-#include <type_traits>
-
-#include "task.hpp"
-
-namespace dawn_player::coroutine::impl {
-struct as_coroutine;
-}
-
-// Enable the use of std::future<T> as a coroutine type
-// by using a std::promise<T> as the promise type.
-template<typename T, typename... Args>
-    requires(!std::is_void_v<T> && !std::is_reference_v<T>)
-struct std::coroutine_traits<std::future<T>, dawn_player::coroutine::impl::as_coroutine, Args...>
-{
-    struct promise_type : std::promise<T>
-    {
-        std::future<T> get_return_object() noexcept
-        {
-            return this->get_future();
-        }
-
-        std::suspend_never initial_suspend() const noexcept { return {}; }
-        std::suspend_never final_suspend() const noexcept { return {}; }
-
-        void return_value(const T& value)
-            noexcept(std::is_nothrow_copy_constructible_v<T>)
-        {
-            this->set_value(value);
-        }
-
-        void return_value(T&& value) noexcept(std::is_nothrow_move_constructible_v<T>)
-        {
-            this->set_value(std::move(value));
-        }
-
-        void unhandled_exception() noexcept
-        {
-            this->set_exception(std::current_exception());
-        }
-    };
-};
-
-// Same for std::future<void>.
-template<typename... Args>
-struct std::coroutine_traits<std::future<void>, dawn_player::coroutine::impl::as_coroutine, Args...>
-{
-    struct promise_type : std::promise<void>
-    {
-        std::future<void> get_return_object() noexcept
-        {
-            return this->get_future();
-        }
-
-        std::suspend_never initial_suspend() const noexcept { return {}; }
-        std::suspend_never final_suspend() const noexcept { return {}; }
-
-        void return_void() noexcept
-        {
-            this->set_value();
-        }
-
-        void unhandled_exception() noexcept
-        {
-            this->set_exception(std::current_exception());
-        }
-    };
-};
-
-namespace dawn_player::coroutine {
-namespace impl {
-
-struct as_coroutine {};
-
-template<typename T>
-std::future<T> task_to_future(as_coroutine, const task<T>& task)
-{
-	if constexpr (std::is_void_v<T>) {
-		co_await task;
-		co_return;
-	} else {
-		T result = co_await task;
-		co_return result;
-	}
-}
-
-} // namespace impl
-
-template<typename T>
-T sync_wait_task(const task<T>& task)
-{
-	return impl::task_to_future({}, task).get();
-}
-
-} // namespace dawn_player::coroutine
-
-#endif
+/*
+ *    sync_wait.hpp:
+ *
+ *    Copyright (C) 2025 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_COROUTINE_SYNC_WAIT_HPP
+#define DAWN_PLAYER_COROUTINE_SYNC_WAIT_HPP
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <type_traits>
+#include <utility>
+
+#include "task.hpp"
+
+namespace dawn_player::coroutine {
+namespace impl {
+
+// A coroutine that starts a task and wakes the blocked thread once the task
+// has completed. The result stays in the task's promise, so no shared state
+// has to be allocated. The flag the thread waits on lives in the frame,
+// which both sides hold a reference to: the frame goes away with the last
+// of the waiting thread returning and the completion having notified it,
+// so notify_one() never touches a flag that is gone.
+class sync_wait_driver {
+public:
+    struct promise_type {
+        std::atomic<bool> is_done{ false };
+        std::atomic<int> reference_count{ 1 };
+
+        static void* operator new(std::size_t size) { return frame_cache::allocate(size); }
+
+        static void operator delete(void* ptr, std::size_t size) noexcept
+        {
+            frame_cache::deallocate(ptr, size);
+        }
+
+        sync_wait_driver get_return_object() noexcept
+        {
+            return sync_wait_driver{ std::coroutine_handle<promise_type>::from_promise(*this) };
+        }
+
+        std::suspend_always initial_suspend() const noexcept { return {}; }
+
+        auto final_suspend() const noexcept
+        {
+            struct final_awaiter {
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<promise_type> coro) const noexcept
+                {
+                    auto& promise = coro.promise();
+                    promise.is_done.store(true, std::memory_order_release);
+                    promise.is_done.notify_one();
+                    release(coro);
+                }
+                void await_resume() const noexcept {}
+            };
+            return final_awaiter{};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() noexcept
+        {
+            // task::when_ready() never throws.
+            std::terminate();
+        }
+    };
+
+    explicit sync_wait_driver(std::coroutine_handle<promise_type> coro) noexcept
+        : coro(coro)
+    {}
+
+    sync_wait_driver(const sync_wait_driver&) = delete;
+    sync_wait_driver& operator=(const sync_wait_driver&) = delete;
+
+    ~sync_wait_driver()
+    {
+        release(this->coro);
+    }
+
+    void run_and_wait()
+    {
+        auto& promise = this->coro.promise();
+        // The reference of the completion.
+        promise.reference_count.fetch_add(1, std::memory_order_relaxed);
+        this->coro.resume();
+        promise.is_done.wait(false, std::memory_order_acquire);
+    }
+
+private:
+    static void release(std::coroutine_handle<promise_type> coro) noexcept
+    {
+        if (coro.promise().reference_count.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            coro.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> coro;
+};
+
+template<typename T>
+sync_wait_driver make_sync_wait_driver(const task<T>& task)
+{
+    co_await task.when_ready();
+}
+
+template<typename T>
+void wait_until_ready(const task<T>& task)
+{
+    if (!task.is_ready()) {
+        auto driver = make_sync_wait_driver(task);
+        driver.run_and_wait();
+    }
+}
+
+} // namespace impl
+
+// Blocks the calling thread until the task has completed and returns its
+// result. If the task is already completed, the result is returned inline.
+template<typename T>
+T sync_wait_task(const task<T>& task)
+{
+    impl::wait_until_ready(task);
+    if constexpr (std::is_void_v<T>) {
+        task.promise().result();
+    }
+    else {
+        return task.promise().result();
+    }
+}
+
+// Same as above, but moves the result out of a task that is no longer needed.
+template<typename T>
+T sync_wait_task(task<T>&& task)
+{
+    impl::wait_until_ready(task);
+    if constexpr (std::is_void_v<T>) {
+        task.promise().result();
+    }
+    else {
+        return std::move(task).promise().result();
+    }
+}
+
+} // namespace dawn_player::coroutine
+
+#endif
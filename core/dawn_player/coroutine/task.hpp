@@ -6,6 +6,8 @@
 #include <utility>
 #include <variant>
 
+#include "frame_allocator.hpp"
+
 /**
  * This file is modified based on the open-source project libcoro.
  * The original code can be found at:
@@ -50,6 +52,15 @@ namespace dawn_player::coroutine
             promise_base() noexcept = default;
             ~promise_base() = default;
 
+            // Coroutine frames are recycled through thread-local free lists, so the
+            // steady-state co_await chains do not hit the global allocator.
+            static auto operator new(std::size_t size) -> void* { return impl::frame_cache::allocate(size); }
+
+            static auto operator delete(void* ptr, std::size_t size) noexcept -> void
+            {
+                impl::frame_cache::deallocate(ptr, size);
+            }
+
             auto initial_suspend() noexcept { return std::suspend_always{}; }
 
             auto final_suspend() noexcept { return final_awaitable{}; }
@@ -218,7 +229,7 @@ namespace dawn_player::coroutine
 
             auto unhandled_exception() noexcept -> void { m_exception_ptr = std::current_exception(); }
 
-            auto result() -> void
+            auto result() const -> void
             {
                 if (m_exception_ptr)
                 {
@@ -332,6 +343,19 @@ namespace dawn_player::coroutine
             return awaitable{ m_coroutine };
         }
 
+        /**
+         * @return An awaitable that completes with the task but neither returns its result nor rethrows its exception.
+         */
+        auto when_ready() const noexcept
+        {
+            struct awaitable : public awaitable_base
+            {
+                auto await_resume() noexcept -> void {}
+            };
+
+            return awaitable{ m_coroutine };
+        }
+
         auto promise() & -> promise_type& { return m_coroutine.promise(); }
         auto promise() const& -> const promise_type& { return m_coroutine.promise(); }
         auto promise() && -> promise_type&& { return std::move(m_coroutine.promise()); }
@@ -13,22 +13,51 @@ namespace dawn_player {
 namespace impl
 {
 
-void task_thread_proc(const std::shared_ptr<default_task_service_context>& service_ctx)
+// Number of times the service thread polls an empty queue before it parks.
+const int task_thread_spin_count = 128;
+
+struct stop_task_node : public task_node {
+    default_task_service_context* service_ctx;
+    explicit stop_task_node(default_task_service_context* service_ctx)
+        : service_ctx(service_ctx)
+    {}
+    virtual void run()
+    {
+        this->service_ctx->is_stopped = true;
+        delete this;
+    }
+};
+
+void wait_for_task(default_task_service_context& service_ctx)
 {
-    while (true) {
-        std::function<void()> task;
-        {
-            std::unique_lock<std::mutex> lck(service_ctx->task_queue_mtx);
-            service_ctx->task_queue_cv.wait(lck, [&service_ctx]() {
-                return !service_ctx->task_queue.empty();
-            });
-            task = std::move(service_ctx->task_queue.front());
-            service_ctx->task_queue.pop();
+    // Yield before polling: pop() also finds nothing while a producer is in
+    // the middle of a push, and it cannot finish unless it gets to run.
+    for (int i = 0; i < task_thread_spin_count; ++i) {
+        std::this_thread::yield();
+        if (!service_ctx.task_queue.empty()) {
+            return;
         }
-        if (task == nullptr) {
-            break;
+    }
+    service_ctx.is_parked.store(true, std::memory_order_seq_cst);
+    if (!service_ctx.task_queue.empty()) {
+        service_ctx.is_parked.store(false, std::memory_order_relaxed);
+        return;
+    }
+    service_ctx.is_parked.wait(true, std::memory_order_seq_cst);
+}
+
+void task_thread_proc(const std::shared_ptr<default_task_service_context>& service_ctx)
+{
+    while (!service_ctx->is_stopped) {
+        auto node = service_ctx->task_queue.pop();
+        if (node == nullptr) {
+            wait_for_task(*service_ctx);
+            continue;
         }
-        task();
+        node->run();
+    }
+    while (service_ctx->producer_count.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
     }
 }
 
@@ -52,11 +81,27 @@ default_task_service::~default_task_service()
 
 void default_task_service::post_task(std::function<void()>&& task)
 {
-    {
-        std::unique_lock<std::mutex> lck(this->service_ctx->task_queue_mtx);
-        this->service_ctx->task_queue.push(std::move(task));
+    if (task == nullptr) {
+        this->post_task_node(new impl::stop_task_node(this->service_ctx.get()));
+    }
+    else {
+        this->post(std::move(task));
+    }
+}
+
+void default_task_service::post_task_node(impl::task_node* node)
+{
+    // Once the node is pushed the task may run and release this service,
+    // so do not touch any member after the push. The context itself stays
+    // alive until producer_count drops back.
+    auto ctx = this->service_ctx.get();
+    ctx->producer_count.fetch_add(1, std::memory_order_relaxed);
+    ctx->task_queue.push(node);
+    if (ctx->is_parked.load(std::memory_order_seq_cst)
+        && ctx->is_parked.exchange(false, std::memory_order_seq_cst)) {
+        ctx->is_parked.notify_one();
     }
-    this->service_ctx->task_queue_cv.notify_one();
+    ctx->producer_count.fetch_sub(1, std::memory_order_release);
 }
 
 std::thread::id default_task_service::get_thread_id()
@@ -8,11 +8,11 @@
 #ifndef DAWN_PLAYER_DEFAULT_TASK_SERVICE_HPP
 #define DAWN_PLAYER_DEFAULT_TASK_SERVICE_HPP
 
-#include <condition_variable>
+#include <atomic>
+#include <cstddef>
 #include <memory>
-#include <mutex>
-#include <queue>
 
+#include "mpsc_task_queue.hpp"
 #include "task_service.hpp"
 
 namespace dawn_player {
@@ -20,9 +20,15 @@ namespace impl
 {
 
 struct default_task_service_context {
-    std::queue<std::function<void()>> task_queue;
-    std::mutex task_queue_mtx;
-    std::condition_variable task_queue_cv;
+    mpsc_task_queue task_queue;
+    // Producers inside post_task_node(). A task may release the service as
+    // soon as it is pushed, so the service thread keeps the context alive
+    // until the producers still touching it are done.
+    std::atomic<std::size_t> producer_count{ 0 };
+    // Set by the service thread before it parks, cleared by the producer that wakes it up.
+    std::atomic<bool> is_parked{ false };
+    // Only accessed by the service thread.
+    bool is_stopped = false;
 };
 
 } // namespace impl
@@ -32,6 +38,7 @@ public:
     default_task_service();
     virtual ~default_task_service();
     virtual void post_task(std::function<void()>&& task);
+    virtual void post_task_node(impl::task_node* node);
     virtual std::thread::id get_thread_id();
 private:
     std::shared_ptr<impl::default_task_service_context> service_ctx;
@@ -0,0 +1,544 @@
+/*
+ *    disk_cache_io.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "disk_cache_io.hpp"
+
+namespace dawn_player {
+namespace io {
+namespace impl {
+
+// Index file layout, native byte order:
+//     magic[8], generation u64, content_length u64, extent_count u64,
+//     key_size u32, reserved u32, key, extent_count * (start u64, end u64)
+const char disk_cache_magic[8] = { 'D', 'P', 'C', 'A', 'C', 'H', 'E', '1' };
+const std::size_t disk_cache_header_size = 40;
+// Extents are published to the index once this many new bytes are cached.
+const std::uint64_t disk_cache_flush_size = 1024 * 1024;
+const std::uint64_t disk_cache_unknown_length = std::numeric_limits<std::uint64_t>::max();
+
+struct disk_cache_header {
+    std::uint64_t generation = 0;
+    std::uint64_t content_length = disk_cache_unknown_length;
+    std::uint64_t extent_count = 0;
+    std::uint32_t key_size = 0;
+};
+
+class file_lock {
+public:
+    file_lock(int fd, int operation)
+        : fd(fd)
+    {
+        while (::flock(fd, operation) != 0) {
+            if (errno != EINTR) {
+                throw std::runtime_error("failed to lock cache index");
+            }
+        }
+    }
+    file_lock(const file_lock&) = delete;
+    file_lock& operator=(const file_lock&) = delete;
+    ~file_lock()
+    {
+        ::flock(this->fd, LOCK_UN);
+    }
+private:
+    int fd;
+};
+
+std::uint64_t fnv1a_64(const std::string& str)
+{
+    std::uint64_t hash = 0xcbf29ce484222325ULL;
+    for (auto c : str) {
+        hash ^= static_cast<std::uint8_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+bool pread_all(int fd, void* buf, std::size_t size, std::uint64_t offset)
+{
+    auto data = static_cast<std::uint8_t*>(buf);
+    while (size != 0) {
+        auto result = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            return false;
+        }
+        data += result;
+        size -= static_cast<std::size_t>(result);
+        offset += static_cast<std::uint64_t>(result);
+    }
+    return true;
+}
+
+void pwrite_all(int fd, const void* buf, std::size_t size, std::uint64_t offset)
+{
+    auto data = static_cast<const std::uint8_t*>(buf);
+    while (size != 0) {
+        auto result = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("failed to write cache file");
+        }
+        data += result;
+        size -= static_cast<std::size_t>(result);
+        offset += static_cast<std::uint64_t>(result);
+    }
+}
+
+bool read_header(int fd, disk_cache_header& header)
+{
+    std::uint8_t buf[disk_cache_header_size];
+    if (!pread_all(fd, buf, sizeof(buf), 0) || std::memcmp(buf, disk_cache_magic, sizeof(disk_cache_magic)) != 0) {
+        return false;
+    }
+    std::memcpy(&header.generation, buf + 8, 8);
+    std::memcpy(&header.content_length, buf + 16, 8);
+    std::memcpy(&header.extent_count, buf + 24, 8);
+    std::memcpy(&header.key_size, buf + 32, 4);
+    return true;
+}
+
+bool read_extents(int fd, const disk_cache_header& header, std::map<std::uint64_t, std::uint64_t>& extents)
+{
+    std::vector<std::uint64_t> values(static_cast<std::size_t>(header.extent_count) * 2);
+    if (!values.empty() && !pread_all(fd, values.data(), values.size() * sizeof(std::uint64_t), disk_cache_header_size + header.key_size)) {
+        return false;
+    }
+    extents.clear();
+    for (std::size_t i = 0; i < values.size(); i += 2) {
+        extents.emplace_hint(extents.end(), values[i], values[i + 1]);
+    }
+    return true;
+}
+
+disk_cache_file_stamp make_file_stamp(const struct stat& st)
+{
+    disk_cache_file_stamp stamp;
+    stamp.device = static_cast<std::uint64_t>(st.st_dev);
+    stamp.inode = static_cast<std::uint64_t>(st.st_ino);
+    stamp.modification_time = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+    stamp.size = static_cast<std::uint64_t>(st.st_size);
+    return stamp;
+}
+
+// Whether path still names the file stamp was taken of, whatever was
+// written to it since.
+bool is_same_file(const std::string& path, const disk_cache_file_stamp& stamp)
+{
+    struct stat st;
+    return ::stat(path.c_str(), &st) == 0
+        && static_cast<std::uint64_t>(st.st_dev) == stamp.device && static_cast<std::uint64_t>(st.st_ino) == stamp.inode;
+}
+
+struct disk_cache_index {
+    disk_cache_header header;
+    std::string key;
+    std::map<std::uint64_t, std::uint64_t> extents;
+};
+
+// False if there is no index at path, or it is not one written in full.
+bool read_index(const std::string& path, disk_cache_index& index, disk_cache_file_stamp& stamp)
+{
+    auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    struct stat st;
+    bool is_valid = ::fstat(fd, &st) == 0 && read_header(fd, index.header);
+    if (is_valid) {
+        auto size = static_cast<std::uint64_t>(st.st_size);
+        is_valid = index.header.key_size <= size && index.header.extent_count <= size / 16
+            && size == disk_cache_header_size + index.header.key_size + index.header.extent_count * 16;
+    }
+    if (is_valid) {
+        index.key.resize(index.header.key_size);
+        is_valid = pread_all(fd, index.key.data(), index.key.size(), disk_cache_header_size)
+            && read_extents(fd, index.header, index.extents);
+        stamp = make_file_stamp(st);
+    }
+    ::close(fd);
+    return is_valid;
+}
+
+// Best effort, some file systems do not sync directories.
+void sync_parent_directory(const std::string& path)
+{
+    auto fd = ::open(path.substr(0, path.rfind('/') + 1).c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd != -1) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+// Writes a temporary file, syncs it and renames it over the index, so that
+// neither a crash nor a failed write leaves a torn index behind. Returns
+// the stamp of the new index file.
+disk_cache_file_stamp write_index(const std::string& path, const std::string& key, const disk_cache_header& header, const std::map<std::uint64_t, std::uint64_t>& extents)
+{
+    std::vector<std::uint8_t> buf(disk_cache_header_size + key.size() + extents.size() * 16);
+    std::memcpy(buf.data(), disk_cache_magic, sizeof(disk_cache_magic));
+    std::uint64_t extent_count = extents.size();
+    std::uint32_t key_size = static_cast<std::uint32_t>(key.size());
+    std::memcpy(buf.data() + 8, &header.generation, 8);
+    std::memcpy(buf.data() + 16, &header.content_length, 8);
+    std::memcpy(buf.data() + 24, &extent_count, 8);
+    std::memcpy(buf.data() + 32, &key_size, 4);
+    std::memcpy(buf.data() + disk_cache_header_size, key.data(), key.size());
+    auto p = buf.data() + disk_cache_header_size + key.size();
+    for (const auto& extent : extents) {
+        std::memcpy(p, &extent.first, 8);
+        std::memcpy(p + 8, &extent.second, 8);
+        p += 16;
+    }
+    auto temp_path = path + ".tmp";
+    auto fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        throw std::runtime_error("failed to write cache file");
+    }
+    struct stat st;
+    try {
+        pwrite_all(fd, buf.data(), buf.size(), 0);
+        if (::fsync(fd) != 0 || ::fstat(fd, &st) != 0) {
+            throw std::runtime_error("failed to write cache file");
+        }
+    }
+    catch (...) {
+        ::close(fd);
+        ::unlink(temp_path.c_str());
+        throw;
+    }
+    ::close(fd);
+    if (::rename(temp_path.c_str(), path.c_str()) != 0) {
+        ::unlink(temp_path.c_str());
+        throw std::runtime_error("failed to write cache file");
+    }
+    sync_parent_directory(path);
+    return make_file_stamp(st);
+}
+
+} // namespace impl
+
+std::string make_disk_cache_key(const std::string& url, const std::string& entity_tag, std::uint64_t content_length)
+{
+    return url + "\n" + entity_tag + "\n" + std::to_string(content_length);
+}
+
+disk_cache_read_stream_proxy::disk_cache_read_stream_proxy(const std::shared_ptr<read_stream_proxy>& inner, const std::string& cache_directory, const std::string& key)
+    : inner(inner)
+    , key(key)
+    , lock_fd(-1)
+    , data_fd(-1)
+    , is_detached(false)
+    , mapping(nullptr)
+    , mapping_size(0)
+    , pending_size(0)
+    , content_length(impl::disk_cache_unknown_length)
+    , position(0)
+    , inner_position(0)
+{
+    char name[17];
+    std::snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(impl::fnv1a_64(key)));
+    auto path = cache_directory + "/" + name;
+    this->index_path = path + ".index";
+    this->data_path = path + ".data";
+    // The index and data files are replaced, the lock file never is.
+    this->lock_fd = ::open((path + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (this->lock_fd == -1) {
+        throw std::runtime_error("failed to open cache entry");
+    }
+    try {
+        this->open_entry();
+    }
+    catch (...) {
+        if (this->data_fd != -1) {
+            ::close(this->data_fd);
+        }
+        ::close(this->lock_fd);
+        throw;
+    }
+}
+
+disk_cache_read_stream_proxy::~disk_cache_read_stream_proxy()
+{
+    try {
+        this->flush_index();
+    }
+    catch (...) {
+    }
+    if (this->mapping != nullptr) {
+        ::munmap(const_cast<std::uint8_t*>(this->mapping), static_cast<std::size_t>(this->mapping_size));
+    }
+    ::close(this->data_fd);
+    ::close(this->lock_fd);
+}
+
+bool disk_cache_read_stream_proxy::can_seek() const
+{
+    std::uint64_t end = 0;
+    return this->inner->can_seek()
+        || (this->content_length != impl::disk_cache_unknown_length && this->find_cached(0, end) && end >= this->content_length);
+}
+
+coroutine::task<std::uint32_t> disk_cache_read_stream_proxy::read(std::uint8_t* buf, std::uint32_t size)
+{
+    if (size == 0 || this->position >= this->content_length) {
+        co_return 0;
+    }
+    std::uint64_t end = 0;
+    // Another player may have fetched it in the meantime.
+    if (this->find_cached(this->position, end) || (this->load_index() && this->find_cached(this->position, end))) {
+        if (end > this->mapping_size) {
+            this->map_data(end);
+        }
+        auto result = static_cast<std::uint32_t>(std::min<std::uint64_t>(size, end - this->position));
+        std::memcpy(buf, this->mapping + this->position, result);
+        this->position += result;
+        co_return result;
+    }
+    if (this->position >= this->content_length) {
+        co_return 0;
+    }
+    if (this->inner_position != this->position) {
+        if (this->inner->can_seek()) {
+            this->inner->seek(this->position);
+            this->inner_position = this->position;
+        }
+        else if (this->position < this->inner_position) {
+            throw std::runtime_error("position is not cached");
+        }
+        else {
+            // Read forward to the position, caching what passes by.
+            std::vector<std::uint8_t> skipped(std::min<std::uint64_t>(this->position - this->inner_position, 64 * 1024));
+            while (this->inner_position < this->position) {
+                auto length = static_cast<std::uint32_t>(std::min<std::uint64_t>(skipped.size(), this->position - this->inner_position));
+                auto result = co_await this->inner->read(skipped.data(), length);
+                if (result == 0) {
+                    this->content_length = this->inner_position;
+                    co_return 0;
+                }
+                this->store(skipped.data(), this->inner_position, result);
+                this->inner_position += result;
+            }
+        }
+    }
+    // Stop where cached data starts again.
+    auto length = static_cast<std::uint32_t>(std::min<std::uint64_t>(size, this->next_cached_start(this->position) - this->position));
+    auto result = co_await this->inner->read(buf, length);
+    if (result == 0) {
+        this->content_length = this->position;
+        co_return 0;
+    }
+    this->store(buf, this->position, result);
+    this->inner_position += result;
+    this->position += result;
+    co_return result;
+}
+
+void disk_cache_read_stream_proxy::seek(std::uint64_t pos)
+{
+    this->position = pos;
+}
+
+void disk_cache_read_stream_proxy::set_seek_points(const std::vector<std::uint64_t>& positions)
+{
+    this->inner->set_seek_points(positions);
+}
+
+std::uint64_t disk_cache_read_stream_proxy::get_cached_size() const
+{
+    std::uint64_t result = 0;
+    for (const auto& extent : this->extents) {
+        result += extent.second - extent.first;
+    }
+    return result;
+}
+
+void disk_cache_read_stream_proxy::open_entry()
+{
+    impl::file_lock lock(this->lock_fd, LOCK_EX);
+    impl::disk_cache_index index;
+    if (impl::read_index(this->index_path, index, this->index_stamp) && index.key == this->key) {
+        this->data_fd = ::open(this->data_path.c_str(), O_RDWR | O_CLOEXEC);
+    }
+    if (this->data_fd == -1) {
+        // New entry, or a different key that hashed to the same name. Players
+        // of the old one may have its data file mapped, so it is replaced
+        // rather than truncated.
+        index = impl::disk_cache_index();
+        index.header.generation = 1;
+        auto temp_path = this->data_path + ".tmp";
+        this->data_fd = ::open(temp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (this->data_fd == -1 || ::rename(temp_path.c_str(), this->data_path.c_str()) != 0) {
+            throw std::runtime_error("failed to reset cache entry");
+        }
+        this->index_stamp = impl::write_index(this->index_path, this->key, index.header, index.extents);
+    }
+    struct stat st;
+    if (::fstat(this->data_fd, &st) != 0) {
+        throw std::runtime_error("failed to open cache entry");
+    }
+    this->data_stamp = impl::make_file_stamp(st);
+    this->extents = std::move(index.extents);
+    this->content_length = index.header.content_length;
+}
+
+bool disk_cache_read_stream_proxy::is_entry_owned(const std::string& stored_key) const
+{
+    return stored_key == this->key && impl::is_same_file(this->data_path, this->data_stamp);
+}
+
+void disk_cache_read_stream_proxy::detach_entry()
+{
+    // What is cached so far stays readable from the data file still open.
+    this->is_detached = true;
+    this->pending_extents.clear();
+    this->pending_size = 0;
+}
+
+bool disk_cache_read_stream_proxy::load_index()
+{
+    if (this->is_detached) {
+        return false;
+    }
+    // The index is only ever replaced, the same file holds the same index.
+    struct stat st;
+    if (::stat(this->index_path.c_str(), &st) == 0 && impl::make_file_stamp(st) == this->index_stamp) {
+        return false;
+    }
+    impl::file_lock lock(this->lock_fd, LOCK_SH);
+    impl::disk_cache_index index;
+    if (!impl::read_index(this->index_path, index, this->index_stamp) || !this->is_entry_owned(index.key)) {
+        this->detach_entry();
+        return false;
+    }
+    for (const auto& extent : this->pending_extents) {
+        this->add_extent(index.extents, extent.first, extent.second);
+    }
+    this->extents = std::move(index.extents);
+    this->content_length = std::min(this->content_length, index.header.content_length);
+    return true;
+}
+
+void disk_cache_read_stream_proxy::flush_index()
+{
+    if (this->is_detached) {
+        return;
+    }
+    impl::file_lock lock(this->lock_fd, LOCK_EX);
+    impl::disk_cache_index index;
+    if (!impl::read_index(this->index_path, index, this->index_stamp) || !this->is_entry_owned(index.key)) {
+        this->detach_entry();
+        return;
+    }
+    if (this->pending_extents.empty() && index.header.content_length <= this->content_length) {
+        return;
+    }
+    // The data must be on disk before an index that points at it.
+    if (!this->pending_extents.empty() && ::fdatasync(this->data_fd) != 0) {
+        throw std::runtime_error("failed to write cache file");
+    }
+    for (const auto& extent : this->pending_extents) {
+        this->add_extent(index.extents, extent.first, extent.second);
+    }
+    ++index.header.generation;
+    index.header.content_length = std::min(index.header.content_length, this->content_length);
+    this->index_stamp = impl::write_index(this->index_path, this->key, index.header, index.extents);
+    this->extents = std::move(index.extents);
+    this->pending_extents.clear();
+    this->pending_size = 0;
+    this->content_length = index.header.content_length;
+}
+
+void disk_cache_read_stream_proxy::add_extent(std::map<std::uint64_t, std::uint64_t>& target, std::uint64_t first, std::uint64_t last)
+{
+    // Merge with every extent that overlaps or touches [first, last).
+    auto iter = target.upper_bound(first);
+    if (iter != target.begin() && std::prev(iter)->second >= first) {
+        --iter;
+    }
+    while (iter != target.end() && iter->first <= last) {
+        first = std::min(first, iter->first);
+        last = std::max(last, iter->second);
+        iter = target.erase(iter);
+    }
+    target.emplace(first, last);
+}
+
+bool disk_cache_read_stream_proxy::find_cached(std::uint64_t pos, std::uint64_t& end) const
+{
+    auto iter = this->extents.upper_bound(pos);
+    if (iter == this->extents.begin()) {
+        return false;
+    }
+    --iter;
+    if (iter->second <= pos) {
+        return false;
+    }
+    end = iter->second;
+    return true;
+}
+
+std::uint64_t disk_cache_read_stream_proxy::next_cached_start(std::uint64_t pos) const
+{
+    auto iter = this->extents.upper_bound(pos);
+    return iter == this->extents.end() ? impl::disk_cache_unknown_length : iter->first;
+}
+
+void disk_cache_read_stream_proxy::map_data(std::uint64_t size)
+{
+    struct stat st;
+    if (::fstat(this->data_fd, &st) != 0 || static_cast<std::uint64_t>(st.st_size) < size) {
+        throw std::runtime_error("cache entry is truncated");
+    }
+    if (this->mapping != nullptr) {
+        ::munmap(const_cast<std::uint8_t*>(this->mapping), static_cast<std::size_t>(this->mapping_size));
+        this->mapping = nullptr;
+        this->mapping_size = 0;
+    }
+    auto mapping_size = static_cast<std::uint64_t>(st.st_size);
+    auto addr = ::mmap(nullptr, static_cast<std::size_t>(mapping_size), PROT_READ, MAP_SHARED, this->data_fd, 0);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("failed to map cache entry");
+    }
+    this->mapping = static_cast<const std::uint8_t*>(addr);
+    this->mapping_size = mapping_size;
+}
+
+void disk_cache_read_stream_proxy::store(const std::uint8_t* data, std::uint64_t pos, std::uint64_t size)
+{
+    // The data must be in the file before its extent is published.
+    impl::pwrite_all(this->data_fd, data, static_cast<std::size_t>(size), pos);
+    this->add_extent(this->extents, pos, pos + size);
+    if (this->is_detached) {
+        return;
+    }
+    this->add_extent(this->pending_extents, pos, pos + size);
+    this->pending_size += size;
+    if (this->pending_size >= impl::disk_cache_flush_size) {
+        this->flush_index();
+    }
+}
+
+} // namespace io
+} // namespace dawn_player
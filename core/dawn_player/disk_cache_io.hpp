@@ -0,0 +1,102 @@
+/*
+ *    disk_cache_io.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_DISK_CACHE_IO_HPP
+#define DAWN_PLAYER_DISK_CACHE_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "io.hpp"
+
+namespace dawn_player {
+namespace io {
+namespace impl {
+
+// Tells whether a file was modified or replaced since it was last looked at.
+struct disk_cache_file_stamp {
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    std::int64_t modification_time = 0;
+    std::uint64_t size = 0;
+    bool operator==(const disk_cache_file_stamp&) const = default;
+};
+
+} // namespace impl
+
+// A key that changes whenever the content behind url does.
+std::string make_disk_cache_key(const std::string& url, const std::string& entity_tag, std::uint64_t content_length);
+
+// Keeps what is read from another proxy (typically a remote file) in a
+// cache directory, so that replays and seeks into already fetched ranges
+// run at local disk speed. Each key has a sparse data file holding the
+// fetched bytes at their offsets and an index file with the map of cached
+// extents. Cached ranges are read from a shared mapping of the data file.
+//
+// Several players, in one process or many, may use the same entry at once:
+// data is written and synced before its extent is published, and the index
+// is merged under flock() of a lock file next to it. The index is replaced
+// as a whole by rename(), so a crash leaves either the old or the new one,
+// and it is only read again once the file it names has changed.
+//
+// An entry whose name is taken by another key gets new files, while players
+// still using the old ones keep reading them and stop publishing extents.
+class disk_cache_read_stream_proxy : public read_stream_proxy {
+public:
+    disk_cache_read_stream_proxy(const std::shared_ptr<read_stream_proxy>& inner, const std::string& cache_directory, const std::string& key);
+    virtual ~disk_cache_read_stream_proxy();
+    // Also true for a non-seekable inner proxy once the whole entry is cached.
+    virtual bool can_seek() const;
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
+    virtual void seek(std::uint64_t pos);
+    virtual void set_seek_points(const std::vector<std::uint64_t>& positions);
+    std::uint64_t get_cached_size() const;
+private:
+    void open_entry();
+    bool is_entry_owned(const std::string& stored_key) const;
+    void detach_entry();
+    bool load_index();
+    void flush_index();
+    void add_extent(std::map<std::uint64_t, std::uint64_t>& target, std::uint64_t first, std::uint64_t last);
+    bool find_cached(std::uint64_t pos, std::uint64_t& end) const;
+    std::uint64_t next_cached_start(std::uint64_t pos) const;
+    void map_data(std::uint64_t size);
+    void store(const std::uint8_t* data, std::uint64_t pos, std::uint64_t size);
+private:
+    std::shared_ptr<read_stream_proxy> inner;
+    std::string key;
+    std::string index_path;
+    std::string data_path;
+    int lock_fd;
+    int data_fd;
+    // Of the data file when it was opened.
+    impl::disk_cache_file_stamp data_stamp;
+    // Of the index file last read or written.
+    impl::disk_cache_file_stamp index_stamp;
+    // Another key took the entry over, or it was recreated under this one.
+    bool is_detached;
+    const std::uint8_t* mapping;
+    std::uint64_t mapping_size;
+    // Cached extents, start -> end.
+    std::map<std::uint64_t, std::uint64_t> extents;
+    // Extents written by this proxy but not yet in the index file.
+    std::map<std::uint64_t, std::uint64_t> pending_extents;
+    std::uint64_t pending_size;
+    // UINT64_MAX until known.
+    std::uint64_t content_length;
+    std::uint64_t position;
+    std::uint64_t inner_position;
+};
+
+} // namespace io
+} // namespace dawn_player
+
+#endif
@@ -13,7 +13,7 @@ open_error::open_error(const std::string& what_arg, open_error_code ec)
     : what_msg(what_arg), error_code(ec)
 {}
 
-const char* open_error::what() const
+const char* open_error::what() const noexcept
 {
     return this->what_msg.c_str();
 }
@@ -27,7 +27,7 @@ get_sample_error::get_sample_error(const std::string& what_arg, get_sample_error
     : what_msg(what_arg), error_code(ec)
 {}
 
-const char* get_sample_error::what() const {
+const char* get_sample_error::what() const noexcept {
     return this->what_msg.c_str();
 }
 
@@ -39,7 +39,7 @@ seek_error::seek_error(const std::string& what_arg, seek_error_code ec)
     : what_msg(what_arg), error_code(ec)
 {}
 
-const char* seek_error::what() const
+const char* seek_error::what() const noexcept
 {
     return this->what_msg.c_str();
 }
@@ -38,7 +38,7 @@ class open_error : public std::exception {
     open_error_code error_code;
 public:
     open_error(const std::string& what_arg, open_error_code ec);
-    virtual const char* what() const;
+    virtual const char* what() const noexcept;
     open_error_code code() const;
 };
 
@@ -47,7 +47,7 @@ class get_sample_error : public std::exception {
     get_sample_error_code error_code;
 public:
     get_sample_error(const std::string& what_arg, get_sample_error_code ec);
-    virtual const char* what() const;
+    virtual const char* what() const noexcept;
     get_sample_error_code code() const;
 };
 
@@ -56,7 +56,7 @@ class seek_error : public std::exception {
     seek_error_code error_code;
 public:
     seek_error(const std::string& what_arg, seek_error_code ec);
-    virtual const char* what() const;
+    virtual const char* what() const noexcept;
     seek_error_code code() const;
 };
 
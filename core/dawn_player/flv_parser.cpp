@@ -5,6 +5,7 @@
  *
  */
 
+#include <algorithm>
 #include <cassert>
 #include <tuple>
 #include <utility>
@@ -17,6 +18,7 @@ namespace parser {
 
 flv_parser::flv_parser()
     : length_size_minus_one(0)
+    , config_generation(0)
 {
 }
 
@@ -447,6 +449,10 @@ parse_result flv_parser::parse_flv_tags(const std::uint8_t* data, size_t size, s
                 //               Empty
 
                 if (avc_packet_type == 0) {
+                    if (tag_data_offset + tag_data_size < offset) {
+                        return parse_result::error;
+                    }
+                    this->update_config_generation(&data[offset], tag_data_offset + tag_data_size - offset);
                     // AVCDecoderConfigurationRecord ISO/IEC 14496-15 5.2.4
                     // configurationVersion unsigned int(8) 
                     auto configuration_version = data[offset++];
@@ -528,6 +534,9 @@ parse_result flv_parser::parse_flv_tags(const std::uint8_t* data, size_t size, s
                         sample.dts = static_cast<std::int64_t>(static_cast<std::uint32_t>(timestamp | (timestamp_extended << 24))) * 10000;
                         sample.timestamp = sample.dts + composition_time * 10000;
                         sample.is_key_frame = is_key_frame;
+                        sample.config_generation = this->config_generation;
+                        bool has_sps = false;
+                        bool has_pps = false;
                         while (tag_data_size > offset - tag_data_offset) {
                             if (tag_data_size - (offset - tag_data_offset) < this->length_size_minus_one) {
                                 return parse_result::error;
@@ -547,12 +556,17 @@ parse_result flv_parser::parse_flv_tags(const std::uint8_t* data, size_t size, s
                             if (nalu_length > tag_data_offset + tag_data_size - offset || nalu_length == 0) {
                                 return parse_result::error;
                             }
+                            // nal_unit_type u(5): 7 = SPS, 8 = PPS
+                            auto nalu_type = data[offset] & 0x1f;
+                            has_sps = has_sps || nalu_type == 7;
+                            has_pps = has_pps || nalu_type == 8;
                             sample.data.push_back(0x00);
                             sample.data.push_back(0x00);
                             sample.data.push_back(0x01);
                             std::copy(&data[offset], &data[offset + nalu_length], std::back_inserter(sample.data));
                             offset += nalu_length;
                         }
+                        sample.has_parameter_sets = has_sps && has_pps;
                         if (!this->on_video_sample(std::move(sample))) {
                             return parse_result::abort;
                         }
@@ -578,6 +592,7 @@ parse_result flv_parser::parse_flv_tags(const std::uint8_t* data, size_t size, s
                     if (tag_data_offset + tag_data_size < offset + 23) {
                         return parse_result::error;
                     }
+                    this->update_config_generation(&data[offset], tag_data_offset + tag_data_size - offset);
                     // HEVCDecoderConfigurationRecord ISO/IEC 14496-15
                     // configurationVersion unsigned int(8)
                     auto configuration_version = data[offset++];
@@ -690,6 +705,10 @@ parse_result flv_parser::parse_flv_tags(const std::uint8_t* data, size_t size, s
                         sample.dts = static_cast<std::int64_t>(static_cast<std::uint32_t>(timestamp | (timestamp_extended << 24))) * 10000;
                         sample.timestamp = sample.dts + composition_time * 10000;
                         sample.is_key_frame = is_key_frame;
+                        sample.config_generation = this->config_generation;
+                        bool has_vps = false;
+                        bool has_sps = false;
+                        bool has_pps = false;
                         while (tag_data_size > offset - tag_data_offset) {
                             if (tag_data_size - (offset - tag_data_offset) < this->length_size_minus_one) {
                                 return parse_result::error;
@@ -709,12 +728,18 @@ parse_result flv_parser::parse_flv_tags(const std::uint8_t* data, size_t size, s
                             if (nalu_length > tag_data_offset + tag_data_size - offset || nalu_length == 0) {
                                 return parse_result::error;
                             }
+                            // nal_unit_type u(6): 32 = VPS, 33 = SPS, 34 = PPS
+                            auto nalu_type = (data[offset] >> 1) & 0x3f;
+                            has_vps = has_vps || nalu_type == 32;
+                            has_sps = has_sps || nalu_type == 33;
+                            has_pps = has_pps || nalu_type == 34;
                             sample.data.push_back(0x00);
                             sample.data.push_back(0x00);
                             sample.data.push_back(0x01);
                             std::copy(&data[offset], &data[offset + nalu_length], std::back_inserter(sample.data));
                             offset += nalu_length;
                         }
+                        sample.has_parameter_sets = has_vps && has_sps && has_pps;
                         if (!this->on_video_sample(std::move(sample))) {
                             return parse_result::abort;
                         }
@@ -747,9 +772,34 @@ size_t flv_parser::first_tag_offset() const
     return 13;
 }
 
+std::uint32_t flv_parser::get_config_generation() const
+{
+    return this->config_generation;
+}
+
+std::uint32_t flv_parser::find_config_generation(const std::uint8_t* record, size_t size) const
+{
+    for (size_t i = 0; i < this->video_config_records.size(); ++i) {
+        const auto& known_record = this->video_config_records[i];
+        if (known_record.size() == size && std::equal(record, record + size, known_record.begin())) {
+            return static_cast<std::uint32_t>(i + 1);
+        }
+    }
+    return 0;
+}
+
+void flv_parser::set_config_generation(std::uint32_t generation)
+{
+    if (generation <= this->video_config_records.size()) {
+        this->config_generation = generation;
+    }
+}
+
 void flv_parser::reset()
 {
     this->length_size_minus_one = 0;
+    this->config_generation = 0;
+    this->video_config_records.clear();
 
     this->on_script_tag = nullptr;
     this->on_audio_specific_config = nullptr;
@@ -803,5 +853,15 @@ bool flv_parser::is_hevc_codec_id(std::uint8_t codec_id) const
     return codec_id == 12;
 }
 
+void flv_parser::update_config_generation(const std::uint8_t* record, size_t size)
+{
+    auto generation = this->find_config_generation(record, size);
+    if (generation == 0) {
+        this->video_config_records.emplace_back(record, record + size);
+        generation = static_cast<std::uint32_t>(this->video_config_records.size());
+    }
+    this->config_generation = generation;
+}
+
 } // namespace parser
 } // namespace dawn_player
@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include "amf_types.hpp"
 #include "samples.hpp"
@@ -44,6 +45,10 @@ struct audio_special_config {
 class flv_parser {
 private:
     std::uint32_t length_size_minus_one;
+    std::uint32_t config_generation;
+    // The distinct video decoder configuration records, generation n is the
+    // record at n - 1.
+    std::vector<std::vector<std::uint8_t>> video_config_records;
 public:
     flv_parser();
 
@@ -51,6 +56,16 @@ public:
     parse_result parse_flv_tags(const std::uint8_t* data, size_t size, size_t& bytes_consumed);
 
     size_t first_tag_offset() const;
+    // Generation of the latest video decoder configuration record. Distinct
+    // records are numbered from 1 in the order they are first parsed, a
+    // record parsed again, e.g. after a seek, gets its generation back.
+    std::uint32_t get_config_generation() const;
+    // Generation of the record, 0 if it has not been parsed yet.
+    std::uint32_t find_config_generation(const std::uint8_t* record, size_t size) const;
+    // Stamps the samples parsed from now on with a known generation until the
+    // next decoder configuration record, e.g. after seeking to a key frame
+    // behind that generation's sequence header.
+    void set_config_generation(std::uint32_t generation);
 
     void reset();
 public:
@@ -65,6 +80,7 @@ private:
     std::uint32_t to_uint24_be(const std::uint8_t* data);
     std::uint16_t to_uint16_be(const std::uint8_t* data);
     bool is_hevc_codec_id(std::uint8_t codec_id) const;
+    void update_config_generation(const std::uint8_t* record, size_t size);
 };
 
 } // namespace parser
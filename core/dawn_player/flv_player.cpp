@@ -5,6 +5,11 @@
  *
  */
 
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <iterator>
+
 #include "amf_decode.hpp"
 #include "error.hpp"
 #include "flv_player.hpp"
@@ -14,15 +19,22 @@ namespace dawn_player {
 flv_player::flv_player(const std::shared_ptr<task_service>& tsk_service, const std::shared_ptr<read_stream_proxy>& stream_proxy)
     : tsk_service(tsk_service)
     , stream_proxy(stream_proxy)
+    , is_view_mode(false)
+    , view_data(nullptr)
+    , view_size(0)
+    , stream_position(0)
     , is_video_cfg_read(false)
     , is_audio_cfg_read(false)
+    , is_sps_info_parsed(false)
+    , delivered_config_generation(0)
+    , is_closed(false)
     , is_end_of_stream(false)
     , is_error_ocurred(false)
     , is_sample_reading(false)
-    , is_closed(false)
     , first_sample_timestamp_has_value(false)
     , first_sample_timestamp(0)
     , can_seek(false)
+    , is_keyframe_index_live(false)
 {
 }
 
@@ -66,6 +78,9 @@ coroutine::task<audio_sample> flv_player::get_audio_sample()
     }
     auto sample = std::move(this->audio_sample_queue.front());
     this->audio_sample_queue.pop_front();
+    if (this->is_keyframe_index_live) {
+        sample.timestamp = this->adjust_sample_timestamp(sample.timestamp);
+    }
     co_return sample;
 }
 
@@ -95,9 +110,32 @@ coroutine::task<video_sample> flv_player::get_video_sample()
     }
     auto sample = std::move(this->video_sample_queue.front());
     this->video_sample_queue.pop_front();
+    if (this->is_keyframe_index_live) {
+        sample.dts = this->adjust_sample_timestamp(sample.dts);
+        sample.timestamp = this->adjust_sample_timestamp(sample.timestamp);
+    }
+    if (sample.config_generation != this->delivered_config_generation) {
+        auto is_format_changed = this->delivered_config_generation != 0;
+        this->delivered_config_generation = sample.config_generation;
+        this->select_video_config(sample.config_generation);
+        auto sets = this->video_packager.find_parameter_sets(sample.config_generation);
+        if (is_format_changed && sets != nullptr && this->video_format_changed_handler) {
+            this->video_format_changed_handler(*sets);
+        }
+    }
     co_return sample;
 }
 
+void flv_player::request_audio_sample(std::function<void(std::exception_ptr, audio_sample&&)>&& callback)
+{
+    flv_player::run_audio_sample_request(this->shared_from_this(), std::move(callback));
+}
+
+void flv_player::request_video_sample(std::function<void(std::exception_ptr, video_sample&&)>&& callback)
+{
+    flv_player::run_video_sample_request(this->shared_from_this(), std::move(callback));
+}
+
 coroutine::task<std::int64_t> flv_player::seek(std::int64_t seek_to_time)
 {
     co_await switch_to_task_service(this->tsk_service.get());
@@ -111,30 +149,66 @@ coroutine::task<std::int64_t> flv_player::seek(std::int64_t seek_to_time)
         co_await this->wait_for_read_more_sample_task_compelete();
         co_await switch_to_task_service(this->tsk_service.get());
     }
-    double seek_to_time_sec = static_cast<double>(seek_to_time) / 10000000;
-    auto iter = this->keyframes.lower_bound(seek_to_time_sec);
+    // Samples from a live index are rebased to the first one, its keyframe
+    // times are those of the stream.
+    std::int64_t time_offset = this->is_keyframe_index_live ? this->first_sample_timestamp : 0;
+    double seek_to_time_sec = static_cast<double>(seek_to_time + time_offset) / 10000000;
     std::uint64_t position = 0;
     double time = 0.00;
-    if (iter == this->keyframes.end()) {
-        position = keyframes.rbegin()->second;
-        time = keyframes.rbegin()->first;
-    }
-    else {
-        position = iter->second;
-        time = iter->first;
+    bool is_seeked = false;
+    // A live stream may drop the keyframe between taking the index and
+    // seeking to it. The seek is then retried with the keyframes the proxy
+    // still holds, which clamps it to the oldest one.
+    for (int attempt = 0; attempt < 3 && !is_seeked; ++attempt) {
+        if (this->is_keyframe_index_live) {
+            // The proxy keeps indexing a live stream and drops what it no
+            // longer holds. Seeking past the newest keyframe returns to the
+            // live edge.
+            std::vector<std::pair<double, std::uint64_t>> proxy_keyframes;
+            this->stream_proxy->get_keyframes(proxy_keyframes);
+            this->keyframes.clear();
+            this->keyframes.insert(proxy_keyframes.begin(), proxy_keyframes.end());
+            if (this->keyframes.empty()) {
+                if (attempt == 0) {
+                    co_return seek_to_time;
+                }
+                break;
+            }
+        }
+        auto iter = this->keyframes.lower_bound(seek_to_time_sec);
+        if (iter == this->keyframes.end()) {
+            position = keyframes.rbegin()->second;
+            time = keyframes.rbegin()->first;
+        }
+        else {
+            position = iter->second;
+            time = iter->first;
+        }
+        try {
+            this->stream_proxy->seek(position);
+            is_seeked = true;
+        }
+        catch (...) {
+            if (!this->is_keyframe_index_live) {
+                break;
+            }
+        }
     }
     this->read_buffer.clear();
+    this->view_data = nullptr;
+    this->view_size = 0;
     this->audio_sample_queue.clear();
     this->video_sample_queue.clear();
-    this->is_error_ocurred = false;
+    this->is_error_ocurred = !is_seeked;
     this->is_end_of_stream = false;
-    try {
-        this->stream_proxy->seek(position);
-    }
-    catch (...) {
-        this->is_error_ocurred = true;
+    if (is_seeked) {
+        this->stream_position = position;
+        auto config_iter = this->config_generation_positions.lower_bound(position);
+        if (config_iter != this->config_generation_positions.begin()) {
+            this->parser.set_config_generation(std::prev(config_iter)->second);
+        }
     }
-    co_return static_cast<std::int64_t>(time * 10000000);
+    co_return std::max<std::int64_t>(static_cast<std::int64_t>(time * 10000000) - time_offset, 0);
 }
 
 coroutine::task<void> flv_player::close()
@@ -143,6 +217,15 @@ coroutine::task<void> flv_player::close()
     this->is_closed = true;
 }
 
+coroutine::task<void> flv_player::set_recorder(const std::shared_ptr<flv_recorder>& recorder)
+{
+    co_await switch_to_task_service(this->tsk_service.get());
+    if (recorder != nullptr) {
+        recorder->start(this->audio_config_tag, this->video_config_tag, this->flv_meta_data);
+    }
+    this->recorder = recorder;
+}
+
 const std::vector<std::uint8_t>& flv_player::get_vps() const
 {
     return this->vps;
@@ -158,6 +241,46 @@ const std::vector<std::uint8_t>& flv_player::get_pps() const
     return this->pps;
 }
 
+bool flv_player::get_sps_info(sps_info& info) const
+{
+    if (!this->is_sps_info_parsed) {
+        return false;
+    }
+    info = this->video_sps_info;
+    return true;
+}
+
+std::vector<std::uint8_t> flv_player::package_video_sample(video_sample&& sample) const
+{
+    return this->video_packager.package(std::move(sample));
+}
+
+void flv_player::set_video_format_changed_handler(std::function<void(const parameter_sets&)>&& handler)
+{
+    this->video_format_changed_handler = std::move(handler);
+}
+
+std::vector<std::uint8_t> flv_player::get_video_config_record() const
+{
+    // Behind the tag header, FrameType/CodecID, PacketType and
+    // CompositionTime.
+    const std::size_t offset = 11 + 5;
+    if (this->video_config_tag.size() < offset) {
+        return std::vector<std::uint8_t>();
+    }
+    return std::vector<std::uint8_t>(this->video_config_tag.begin() + offset, this->video_config_tag.end());
+}
+
+std::vector<std::uint8_t> flv_player::get_audio_config_record() const
+{
+    // Behind the tag header, the sound flags and AACPacketType.
+    const std::size_t offset = 11 + 2;
+    if (this->audio_config_tag.size() < offset) {
+        return std::vector<std::uint8_t>();
+    }
+    return std::vector<std::uint8_t>(this->audio_config_tag.begin() + offset, this->audio_config_tag.end());
+}
+
 const std::shared_ptr<task_service> flv_player::get_task_service() const
 {
     return this->tsk_service;
@@ -172,6 +295,19 @@ coroutine::task<std::uint32_t> flv_player::read_some_data()
 {
     co_await switch_to_task_service(this->tsk_service.get());
     const size_t buf_size = 65536;
+    const std::uint8_t* data = nullptr;
+    std::uint64_t remaining = 0;
+    if (this->stream_proxy->get_view(data, remaining)) {
+        // Widen the window over the proxy's memory instead of copying. The
+        // window grows like read_buffer would, so that each parse step only
+        // queues as many samples as a read would have.
+        this->is_view_mode = true;
+        this->view_data = data;
+        auto window = std::min<std::uint64_t>(remaining, this->view_size + buf_size);
+        auto size = window > this->view_size ? static_cast<std::uint32_t>(window - this->view_size) : 0;
+        this->view_size = static_cast<std::size_t>(window);
+        co_return size;
+    }
     std::uint8_t buf[buf_size];
     auto size = co_await this->stream_proxy->read(buf, buf_size);
     co_await switch_to_task_service(tsk_service.get());
@@ -182,9 +318,70 @@ coroutine::task<std::uint32_t> flv_player::read_some_data()
     co_return size;
 }
 
+const std::uint8_t* flv_player::unparsed_data() const
+{
+    return this->is_view_mode ? this->view_data : this->read_buffer.data();
+}
+
+std::size_t flv_player::unparsed_size() const
+{
+    return this->is_view_mode ? this->view_size : this->read_buffer.size();
+}
+
+void flv_player::consume_data(std::size_t size)
+{
+    if (size == 0) {
+        return;
+    }
+    this->stream_position += size;
+    if (this->is_view_mode) {
+        this->stream_proxy->consume(size);
+        this->view_data += size;
+        this->view_size -= size;
+    }
+    else {
+        std::memmove(this->read_buffer.data(), this->read_buffer.data() + size, this->read_buffer.size() - size);
+        this->read_buffer.resize(this->read_buffer.size() - size);
+    }
+}
+
+void flv_player::tap_tags(const std::uint8_t* data, std::size_t size)
+{
+    const std::size_t tag_header_size = 11;
+    for (std::size_t offset = 0; offset + tag_header_size + 2 <= size;) {
+        auto tag = data + offset;
+        auto body_size = (static_cast<std::size_t>(tag[1]) << 16) | (static_cast<std::size_t>(tag[2]) << 8) | tag[3];
+        auto body = tag + tag_header_size;
+        auto tag_type = tag[0] & 0x1f;
+        // AVC/HEVC and AAC packet type 0 is the decoder configuration.
+        bool is_packet_type_zero = body_size >= 2 && body[1] == 0;
+        if (is_packet_type_zero && tag_type == 9 && ((body[0] & 0x0f) == 7 || (body[0] & 0x0f) == 12)) {
+            this->video_config_tag.assign(tag, body + body_size);
+            // The record follows FrameType/CodecID, PacketType and
+            // CompositionTime.
+            auto generation = body_size >= 5 ? this->parser.find_config_generation(body + 5, body_size - 5) : 0;
+            auto position = this->stream_position + offset;
+            auto next = this->config_generation_positions.lower_bound(position);
+            bool is_known = next != this->config_generation_positions.end() && next->first == position;
+            // Only the sequence headers that switch generation are kept.
+            bool is_switch = next == this->config_generation_positions.begin() || std::prev(next)->second != generation;
+            if (generation != 0 && !is_known && is_switch) {
+                this->config_generation_positions.emplace_hint(next, position, generation);
+            }
+        }
+        else if (is_packet_type_zero && tag_type == 8 && (body[0] >> 4) == 10) {
+            this->audio_config_tag.assign(tag, body + body_size);
+        }
+        offset += tag_header_size + body_size + 4;
+    }
+    if (this->recorder != nullptr) {
+        this->recorder->write_tags(data, size);
+    }
+}
+
 coroutine::task<void> flv_player::parse_header()
 {
-    while (this->read_buffer.size() < this->parser.first_tag_offset()) {
+    while (this->unparsed_size() < this->parser.first_tag_offset()) {
         std::uint32_t size = 0;
         try {
             size = co_await this->read_some_data();
@@ -198,12 +395,11 @@ coroutine::task<void> flv_player::parse_header()
         co_await switch_to_task_service(this->tsk_service.get());
     }
     size_t bytes_consumed = 0;
-    auto parse_res = this->parser.parse_flv_header(this->read_buffer.data(), this->read_buffer.size(), bytes_consumed);
+    auto parse_res = this->parser.parse_flv_header(this->unparsed_data(), this->unparsed_size(), bytes_consumed);
     if (parse_res != parse_result::ok) {
         throw open_error("Bad FLV header.", open_error_code::parse_error);
     }
-    std::memmove(this->read_buffer.data(), this->read_buffer.data() + this->parser.first_tag_offset(), this->read_buffer.size() - this->parser.first_tag_offset());
-    this->read_buffer.resize(this->read_buffer.size() - this->parser.first_tag_offset());
+    this->consume_data(this->parser.first_tag_offset());
 }
 
 coroutine::task<void> flv_player::parse_meta_data()
@@ -219,14 +415,15 @@ coroutine::task<void> flv_player::parse_meta_data()
         co_await switch_to_task_service(this->tsk_service.get());
         size_t bytes_consumed = 0;
         this->register_callback_functions(false);
-        auto parse_res = this->parser.parse_flv_tags(this->read_buffer.data(), this->read_buffer.size(), bytes_consumed);
+        auto parse_res = this->parser.parse_flv_tags(this->unparsed_data(), this->unparsed_size(), bytes_consumed);
         this->unregister_callback_functions();
         if (parse_res != parse_result::ok) {
             throw open_error("Bad FLV data.", open_error_code::parse_error);
         }
-        std::memmove(this->read_buffer.data(), this->read_buffer.data() + bytes_consumed, this->read_buffer.size() - bytes_consumed);
-        this->read_buffer.resize(this->read_buffer.size() - bytes_consumed);
-        if (this->flv_meta_data && this->is_audio_cfg_read && this->is_video_cfg_read) {
+        this->tap_tags(this->unparsed_data(), bytes_consumed);
+        this->consume_data(bytes_consumed);
+        // Without onMetaData the video info can still be taken from the SPS.
+        if (this->is_audio_cfg_read && this->is_video_cfg_read && (this->flv_meta_data || this->is_sps_info_parsed)) {
             break;
         }
         if (size == 0) {
@@ -272,6 +469,9 @@ std::map<std::string, std::string> flv_player::get_video_info()
     // keyframes
     std::shared_ptr<amf_object> keyframes;
 
+    if (!this->flv_meta_data) {
+        this->flv_meta_data = std::make_shared<amf_ecma_array>();
+    }
     auto iter = this->flv_meta_data->find("duration");
     if (iter != this->flv_meta_data->end() && std::get<1>(*iter)->get_type() == amf_type::number) {
         duration = std::dynamic_pointer_cast<amf_number, amf_base>(std::get<1>(*iter));
@@ -357,27 +557,89 @@ std::map<std::string, std::string> flv_player::get_video_info()
         info["Duration"] = std::to_string(duration->get_value() * 10000000);
     }
 
-    this->can_seek = this->stream_proxy->can_seek() && !this->keyframes.empty();
+    if (this->keyframes.empty()) {
+        std::vector<std::pair<double, std::uint64_t>> proxy_keyframes;
+        this->is_keyframe_index_live = this->stream_proxy->get_keyframes(proxy_keyframes);
+    }
+    this->can_seek = this->stream_proxy->can_seek() && (!this->keyframes.empty() || this->is_keyframe_index_live);
     if (this->can_seek) {
+        std::vector<std::uint64_t> seek_points;
+        seek_points.reserve(this->keyframes.size());
+        for (const auto& keyframe : this->keyframes) {
+            seek_points.push_back(keyframe.second);
+        }
+        this->stream_proxy->set_seek_points(seek_points);
         info["CanSeek"] = std::string("True");
     }
     else {
         info["CanSeek"] = std::string("False");
     }
     info["AudioCodecPrivateData"] = audio_codec_private_data;
-    if (!width || !height) {
-        throw open_error("Miss width or height", open_error_code::parse_error);
+    // Prefer what the SPS says over the metadata, which is written by the
+    // muxer and may be missing or stale.
+    if (this->is_sps_info_parsed) {
+        info["Height"] = std::to_string(this->video_sps_info.height);
+        info["Width"] = std::to_string(this->video_sps_info.width);
+        info["CodedHeight"] = std::to_string(this->video_sps_info.coded_height);
+        info["CodedWidth"] = std::to_string(this->video_sps_info.coded_width);
+        info["ProfileIdc"] = std::to_string(this->video_sps_info.profile_idc);
+        info["LevelIdc"] = std::to_string(this->video_sps_info.level_idc);
+        if (this->video_sps_info.max_num_reorder_frames >= 0) {
+            info["MaxNumReorderFrames"] = std::to_string(this->video_sps_info.max_num_reorder_frames);
+        }
+        if (this->video_sps_info.frame_rate > 0.0) {
+            info["FrameRate"] = std::to_string(this->video_sps_info.frame_rate);
+        }
+    }
+    else {
+        if (!width || !height) {
+            throw open_error("Miss width or height", open_error_code::parse_error);
+        }
+        info["Height"] = std::to_string(height->get_value());
+        info["Width"] = std::to_string(width->get_value());
+    }
+    if (info.find("FrameRate") == info.end() && frame_rate && frame_rate->get_value() > 0.0) {
+        info["FrameRate"] = std::to_string(frame_rate->get_value());
     }
-    info["Height"] = std::to_string(height->get_value());
-    info["Width"] = std::to_string(width->get_value());
     return info;
 }
 
+coroutine::detached_task flv_player::run_audio_sample_request(std::shared_ptr<flv_player> self, std::function<void(std::exception_ptr, audio_sample&&)> callback)
+{
+    audio_sample sample;
+    std::exception_ptr error;
+    try {
+        sample = co_await self->get_audio_sample();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+    co_await switch_to_task_service(self->tsk_service.get());
+    // Nothing is left to report a failure of the callback to, an exception
+    // escaping it terminates the process in unhandled_exception().
+    callback(error, std::move(sample));
+}
+
+coroutine::detached_task flv_player::run_video_sample_request(std::shared_ptr<flv_player> self, std::function<void(std::exception_ptr, video_sample&&)> callback)
+{
+    video_sample sample;
+    std::exception_ptr error;
+    try {
+        sample = co_await self->get_video_sample();
+    }
+    catch (...) {
+        error = std::current_exception();
+    }
+    co_await switch_to_task_service(self->tsk_service.get());
+    callback(error, std::move(sample));
+}
+
 coroutine::task<void> flv_player::read_more_sample()
 {
     co_await switch_to_task_service(this->tsk_service.get());
     assert(!this->is_sample_reading);
     this->is_sample_reading = true;
+    this->read_more_sample_complete_event.reset();
     bool err = false;
     std::uint32_t size = 0;
     try {
@@ -397,51 +659,25 @@ coroutine::task<void> flv_player::read_more_sample()
         else {
             size_t bytes_consumed = 0;
             this->register_callback_functions(true);
-            auto parse_res = this->parser.parse_flv_tags(this->read_buffer.data(), this->read_buffer.size(), bytes_consumed);
+            auto parse_res = this->parser.parse_flv_tags(this->unparsed_data(), this->unparsed_size(), bytes_consumed);
             this->unregister_callback_functions();
             if (parse_res != parse_result::ok) {
                 this->is_error_ocurred = true;
             }
             else {
-                std::memmove(this->read_buffer.data(), this->read_buffer.data() + bytes_consumed, this->read_buffer.size() - bytes_consumed);
-                this->read_buffer.resize(this->read_buffer.size() - bytes_consumed);
+                this->tap_tags(this->unparsed_data(), bytes_consumed);
+                this->consume_data(bytes_consumed);
             }
         }
     }
     this->is_sample_reading = false;
-    while (!this->read_more_sample_complete_callback_queue.empty()) {
-        auto callback = this->read_more_sample_complete_callback_queue.front();
-        this->read_more_sample_complete_callback_queue.pop();
-        callback();
-    }
+    this->read_more_sample_complete_event.set();
 }
 
 coroutine::task<void> flv_player::wait_for_read_more_sample_task_compelete()
 {
     co_await switch_to_task_service(this->tsk_service.get());
-    struct awaiter
-    {
-        awaiter(std::function<void(std::function<void()>)> async_wait_func)
-            : async_wait_func_(async_wait_func)
-        {}
-        bool await_ready() { return false; }
-        void await_suspend(std::coroutine_handle<> coro)
-        {
-            this->async_wait_func_([coro]() {
-                coro();
-            });
-        }
-        void await_resume() {}
-    private:
-        std::function<void(std::function<void()>)> async_wait_func_;
-    };
-    co_await awaiter([this](std::function<void()> callback) {
-        if (!this->is_sample_reading) {
-            callback();
-            return;
-        }
-        this->read_more_sample_complete_callback_queue.push(std::move(callback));
-    });
+    co_await this->read_more_sample_complete_event;
 }
 
 bool flv_player::on_script_tag(std::shared_ptr<amf_base> name, std::shared_ptr<amf_base> value)
@@ -466,20 +702,37 @@ bool flv_player::on_script_tag(std::shared_ptr<amf_base> name, std::shared_ptr<a
 
 bool flv_player::on_avc_decoder_configuration_record(const std::vector<std::uint8_t>& sps, const std::vector<std::uint8_t>& pps)
 {
+    auto generation = this->parser.get_config_generation();
+    if (this->video_packager.find_parameter_sets(generation) != nullptr) {
+        // The sequence header repeats a known configuration.
+        return true;
+    }
     this->video_codec_ = video_codec::h264;
-    this->sps = sps;
-    this->pps = pps;
-    this->is_video_cfg_read = true;
+    this->video_packager.set_parameter_sets(generation, std::vector<std::uint8_t>(), sps, pps);
+    this->parse_sps_info(generation);
+    if (!this->is_video_cfg_read) {
+        // Later configurations become current when their first sample is
+        // handed out.
+        this->select_video_config(generation);
+        this->is_video_cfg_read = true;
+    }
     return true;
 }
 
 bool flv_player::on_hevc_decoder_configuration_record(const std::vector<std::uint8_t>& vps, const std::vector<std::uint8_t>& sps, const std::vector<std::uint8_t>& pps)
 {
+    auto generation = this->parser.get_config_generation();
+    if (this->video_packager.find_parameter_sets(generation) != nullptr) {
+        // The sequence header repeats a known configuration.
+        return true;
+    }
     this->video_codec_ = video_codec::hevc;
-    this->vps = vps;
-    this->sps = sps;
-    this->pps = pps;
-    this->is_video_cfg_read = true;
+    this->video_packager.set_parameter_sets(generation, vps, sps, pps);
+    this->parse_sps_info(generation);
+    if (!this->is_video_cfg_read) {
+        this->select_video_config(generation);
+        this->is_video_cfg_read = true;
+    }
     return true;
 }
 
@@ -527,24 +780,24 @@ void flv_player::register_callback_functions(bool sample_only)
 {
     if (sample_only) {
         this->parser.on_script_tag = nullptr;
-        this->parser.on_avc_decoder_configuration_record = nullptr;
-        this->parser.on_hevc_decoder_configuration_record = nullptr;
         this->parser.on_audio_specific_config = nullptr;
     }
     else {
         this->parser.on_script_tag = [this](std::shared_ptr<amf_base> name, std::shared_ptr<amf_base> value) -> bool {
             return this->on_script_tag(name, value);
         };
-        this->parser.on_avc_decoder_configuration_record = [this](const std::vector<std::uint8_t>& sps, const std::vector<std::uint8_t>& pps) -> bool {
-            return this->on_avc_decoder_configuration_record(sps, pps);
-        };
-        this->parser.on_hevc_decoder_configuration_record = [this](const std::vector<std::uint8_t>& vps, const std::vector<std::uint8_t>& sps, const std::vector<std::uint8_t>& pps) -> bool {
-            return this->on_hevc_decoder_configuration_record(vps, sps, pps);
-        };
         this->parser.on_audio_specific_config = [this](const audio_special_config& asc) -> bool {
             return this->on_audio_specific_config(asc);
         };
     }
+    // Video decoder configuration records are tracked for the whole session,
+    // a stream may switch configuration mid-stream.
+    this->parser.on_avc_decoder_configuration_record = [this](const std::vector<std::uint8_t>& sps, const std::vector<std::uint8_t>& pps) -> bool {
+        return this->on_avc_decoder_configuration_record(sps, pps);
+    };
+    this->parser.on_hevc_decoder_configuration_record = [this](const std::vector<std::uint8_t>& vps, const std::vector<std::uint8_t>& sps, const std::vector<std::uint8_t>& pps) -> bool {
+        return this->on_hevc_decoder_configuration_record(vps, sps, pps);
+    };
     this->parser.on_audio_sample = [this](audio_sample&& sample) -> bool {
         return this->on_audio_sample(std::move(sample));
     };
@@ -557,11 +810,48 @@ void flv_player::unregister_callback_functions()
 {
     this->parser.on_script_tag = nullptr;
     this->parser.on_avc_decoder_configuration_record = nullptr;
+    this->parser.on_hevc_decoder_configuration_record = nullptr;
     this->parser.on_audio_specific_config = nullptr;
     this->parser.on_audio_sample = nullptr;
     this->parser.on_video_sample = nullptr;
 }
 
+void flv_player::parse_sps_info(std::uint32_t config_generation)
+{
+    auto sets = this->video_packager.find_parameter_sets(config_generation);
+    if (sets == nullptr) {
+        return;
+    }
+    // Only the first SPS is parsed, the bit reader stops at its end.
+    sps_info info;
+    bool is_parsed = false;
+    if (this->video_codec_ == video_codec::hevc) {
+        is_parsed = parse_hevc_sps(sets->sps.data(), sets->sps.size(), info);
+    }
+    else {
+        is_parsed = parse_h264_sps(sets->sps.data(), sets->sps.size(), info);
+    }
+    if (is_parsed) {
+        this->video_sps_infos[config_generation] = info;
+    }
+}
+
+void flv_player::select_video_config(std::uint32_t config_generation)
+{
+    auto sets = this->video_packager.find_parameter_sets(config_generation);
+    if (sets == nullptr) {
+        return;
+    }
+    this->vps = sets->vps;
+    this->sps = sets->sps;
+    this->pps = sets->pps;
+    auto iter = this->video_sps_infos.find(config_generation);
+    this->is_sps_info_parsed = iter != this->video_sps_infos.end();
+    if (this->is_sps_info_parsed) {
+        this->video_sps_info = iter->second;
+    }
+}
+
 std::string flv_player::uint8_to_hex_string(const std::uint8_t* data, size_t size, bool uppercase) const
 {
     std::string result;
@@ -586,7 +876,9 @@ std::string flv_player::uint8_to_hex_string(const std::uint8_t* data, size_t siz
 
 std::int64_t flv_player::adjust_sample_timestamp(std::int64_t timestamp)
 {
-    if (this->can_seek) {
+    // A live stream joined midway does not start at 0, whether or not a
+    // timeshift proxy makes it seekable.
+    if (this->can_seek && !this->is_keyframe_index_live) {
         return timestamp;
     }
     if (timestamp > this->first_sample_timestamp) {
@@ -9,18 +9,24 @@
 #define DAWN_PLAYER_FLV_PLAYER_HPP
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 #include <deque>
+#include <exception>
 #include <functional>
 #include <map>
 #include <memory>
-#include <queue>
 #include <vector>
 
 #include "amf_types.hpp"
+#include "coroutine/async_manual_reset_event.hpp"
+#include "coroutine/detached_task.hpp"
 #include "coroutine/task.hpp"
 #include "flv_parser.hpp"
+#include "flv_recorder.hpp"
 #include "io.hpp"
+#include "sample_packager.hpp"
+#include "sps_parser.hpp"
 #include "task_service.hpp"
 
 using namespace dawn_player::amf;
@@ -34,22 +40,51 @@ class flv_player : public std::enable_shared_from_this<flv_player> {
     std::shared_ptr<task_service> tsk_service;
     std::shared_ptr<read_stream_proxy> stream_proxy;
     std::vector<std::uint8_t> read_buffer;
+    // Set when the stream proxy exposes its data through get_view(), the
+    // unparsed bytes are then a window into the proxy's memory instead of
+    // read_buffer.
+    bool is_view_mode;
+    const std::uint8_t* view_data;
+    std::size_t view_size;
+    // Stream offset of the first unparsed byte.
+    std::uint64_t stream_position;
     flv_parser parser;
 
     std::shared_ptr<amf_ecma_array> flv_meta_data;
     bool is_video_cfg_read;
     bool is_audio_cfg_read;
     std::string audio_codec_private_data;
+    // The parameter sets of the config generation of the last video sample
+    // handed out, or of the first one before any sample is.
     std::vector<std::uint8_t> vps;
     std::vector<std::uint8_t> sps;
     std::vector<std::uint8_t> pps;
+    video_sample_packager video_packager;
+    // Parsed from the first SPS of the same decoder configuration record.
+    sps_info video_sps_info;
+    bool is_sps_info_parsed;
+    // The SPS info of each config generation whose SPS could be parsed.
+    std::map<std::uint32_t, sps_info> video_sps_infos;
+    // Config generation of the last video sample handed out.
+    std::uint32_t delivered_config_generation;
+    // Stream offsets of the video sequence headers that switch config
+    // generation. A seek resumes with the generation in effect at its key
+    // frame, as the sequence header in front of it is not read again.
+    std::map<std::uint64_t, std::uint32_t> config_generation_positions;
+    std::function<void(const parameter_sets&)> video_format_changed_handler;
     bool is_closed;
 
     std::deque<audio_sample> audio_sample_queue;
     std::deque<video_sample> video_sample_queue;
     std::map<double, std::uint64_t, std::greater<double>> keyframes;
+    // Raw tags of the latest decoder configurations, a recorder attached
+    // mid-stream starts with them.
+    std::vector<std::uint8_t> audio_config_tag;
+    std::vector<std::uint8_t> video_config_tag;
+    std::shared_ptr<flv_recorder> recorder;
 
-    std::queue<std::function<void()>> read_more_sample_complete_callback_queue;
+    // Set while no read_more_sample() is in progress.
+    coroutine::async_manual_reset_event read_more_sample_complete_event{ true };
 
     bool is_end_of_stream;
     bool is_error_ocurred;
@@ -58,6 +93,10 @@ class flv_player : public std::enable_shared_from_this<flv_player> {
     bool first_sample_timestamp_has_value;
     std::int64_t first_sample_timestamp;
     bool can_seek;
+    // keyframes is refreshed from the stream proxy before each seek. Sample
+    // times are rebased to first_sample_timestamp as for an unseekable
+    // stream, the keyframe times are not.
+    bool is_keyframe_index_live;
     video_codec video_codec_ = video_codec::unknown;
 
 public:
@@ -66,21 +105,59 @@ public:
     coroutine::task<std::map<std::string, std::string>> open();
     coroutine::task<audio_sample> get_audio_sample();
     coroutine::task<video_sample> get_video_sample();
+    // Callback based variants of get_audio_sample/get_video_sample for hosts
+    // that must not block. The callback is invoked on the task service thread
+    // with either a sample or the exception get_*_sample would have thrown.
+    // The callback must not throw, an exception escaping it terminates the
+    // process.
+    void request_audio_sample(std::function<void(std::exception_ptr, audio_sample&&)>&& callback);
+    void request_video_sample(std::function<void(std::exception_ptr, video_sample&&)>&& callback);
     coroutine::task<std::int64_t> seek(std::int64_t seek_to_time);
     coroutine::task<void> close();
+    // Copies the FLV tags read from now on to recorder, nullptr detaches the
+    // current one. Finalize the recorder once it is detached.
+    coroutine::task<void> set_recorder(const std::shared_ptr<flv_recorder>& recorder);
     const std::vector<std::uint8_t>& get_vps() const;
     const std::vector<std::uint8_t>& get_sps() const;
     const std::vector<std::uint8_t>& get_pps() const;
+    // Returns false if there is no SPS or it could not be parsed. Like
+    // get_vps(), get_sps() and get_pps() it follows the video samples handed
+    // out, not the latest decoder configuration parsed.
+    bool get_sps_info(sps_info& info) const;
+    // Returns the sample as one decoder-ready Annex-B buffer, key frames
+    // without in-band parameter sets are prefixed with the current ones. Call
+    // it on the task service thread, e.g. from a request_video_sample()
+    // callback.
+    std::vector<std::uint8_t> package_video_sample(video_sample&& sample) const;
+    // Sets the handler raised when the video decoder configuration changes
+    // mid-stream. It is invoked on the task service thread with the new
+    // parameter sets, right before the first video sample that uses them is
+    // handed out, so the consumer can reconfigure in place from that sample
+    // on instead of reopening the stream.
+    void set_video_format_changed_handler(std::function<void(const parameter_sets&)>&& handler);
+    // The latest decoder configuration records as carried in the stream,
+    // AVCDecoderConfigurationRecord or HEVCDecoderConfigurationRecord and
+    // the AAC AudioSpecificConfig, e.g. for flv_writer. Empty until read.
+    std::vector<std::uint8_t> get_video_config_record() const;
+    std::vector<std::uint8_t> get_audio_config_record() const;
     const std::shared_ptr<task_service> get_task_service() const;
     video_codec get_video_codec() const;
 
 private:
     coroutine::task<std::uint32_t> read_some_data();
+    const std::uint8_t* unparsed_data() const;
+    std::size_t unparsed_size() const;
+    void consume_data(std::size_t size);
+    // Called with the whole tags parsed from the unparsed data before they
+    // are consumed.
+    void tap_tags(const std::uint8_t* data, std::size_t size);
     coroutine::task<void> parse_header();
     coroutine::task<void> parse_meta_data();
     std::map<std::string, std::string> get_video_info();
 
 private:
+    static coroutine::detached_task run_audio_sample_request(std::shared_ptr<flv_player> self, std::function<void(std::exception_ptr, audio_sample&&)> callback);
+    static coroutine::detached_task run_video_sample_request(std::shared_ptr<flv_player> self, std::function<void(std::exception_ptr, video_sample&&)> callback);
     coroutine::task<void> read_more_sample();
     coroutine::task<void> wait_for_read_more_sample_task_compelete();
 
@@ -93,6 +170,10 @@ private:
     bool on_video_sample(video_sample&& sample);
     void register_callback_functions(bool sample_only);
     void unregister_callback_functions();
+    void parse_sps_info(std::uint32_t config_generation);
+    // Makes the parameter sets and SPS info of the generation the current
+    // ones.
+    void select_video_config(std::uint32_t config_generation);
     std::string uint8_to_hex_string(const std::uint8_t* data, size_t size, bool uppercase = true) const;
     std::int64_t adjust_sample_timestamp(std::int64_t);
 };
@@ -0,0 +1,492 @@
+/*
+ *    flv_recorder.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <stdexcept>
+
+#include "amf_encode.hpp"
+#include "flv_recorder.hpp"
+#include "output_support.hpp"
+
+namespace dawn_player {
+namespace impl {
+
+const std::uint64_t flv_header_size = 9;
+const std::uint64_t flv_tag_header_size = 11;
+const std::uint64_t flv_previous_tag_size_size = 4;
+// A batch is handed to the writer once it is this large or this old.
+const std::size_t recorder_batch_size = 1024 * 1024;
+const auto recorder_batch_interval = std::chrono::milliseconds(500);
+const auto recorder_index_interval = std::chrono::seconds(2);
+// Room for the values carried over from the stream's onMetaData, and per
+// keyframe for a time and a position entry.
+const std::uint64_t reserved_meta_data_size = 1024;
+const std::uint64_t keyframe_entry_size = 18;
+// Jumps in the source timestamps beyond these are taken for
+// discontinuities, e.g. a seek, and closed up.
+const std::int64_t max_timestamp_step_back = 1000;
+const std::int64_t max_timestamp_step = 10000;
+// Index file layout, native byte order:
+//     magic[8], data_size u64, keyframe_count u64,
+//     keyframe_count * (time f64, position u64)
+const char recorder_index_magic[8] = { 'D', 'P', 'R', 'E', 'C', 'I', 'X', '1' };
+
+void put_flv_header(std::vector<std::uint8_t>& out, std::uint8_t flags)
+{
+    const std::uint8_t signature[] = { 'F', 'L', 'V', 1 };
+    out.insert(out.end(), signature, signature + sizeof(signature));
+    put_uint8(out, flags);
+    put_uint32_be(out, static_cast<std::uint32_t>(flv_header_size));
+    put_uint32_be(out, 0);
+}
+
+void put_script_tag(std::vector<std::uint8_t>& out, const std::vector<std::uint8_t>& body)
+{
+    put_uint8(out, 18);
+    put_uint24_be(out, static_cast<std::uint32_t>(body.size()));
+    // Timestamp, extended timestamp and stream id.
+    out.insert(out.end(), 7, 0);
+    out.insert(out.end(), body.begin(), body.end());
+    put_uint32_be(out, static_cast<std::uint32_t>(body.size() + flv_tag_header_size));
+}
+
+void write_all(std::FILE* file, const void* data, std::size_t size)
+{
+    if (size != 0 && std::fwrite(data, 1, size, file) != size) {
+        throw std::runtime_error("failed to write recording");
+    }
+}
+
+bool is_derived_meta_data_name(const std::string& name)
+{
+    // Values that describe the source file rather than the recording.
+    static const char* const names[] = {
+        "duration", "filesize", "datasize", "videosize", "audiosize", "keyframes", "hasKeyframes",
+        "lasttimestamp", "lastkeyframetimestamp", "lastkeyframelocation", "metadatacreator", "metadatadate",
+    };
+    return std::any_of(std::begin(names), std::end(names), [&name](const char* n) { return name == n; });
+}
+
+} // namespace impl
+
+flv_recorder::flv_recorder(const std::string& path, std::size_t reserved_keyframe_count, std::uint64_t max_pending_size)
+    : path(path)
+    , file(nullptr)
+    , reserved_body_size(impl::reserved_meta_data_size + reserved_keyframe_count * impl::keyframe_entry_size)
+    , data_offset(0)
+    , max_pending_size(max_pending_size)
+    , next_position(0)
+    , timestamp_base(0)
+    , last_timestamp(0)
+    , is_started(false)
+    , is_waiting_for_keyframe(false)
+    , has_audio(false)
+    , has_video(false)
+    , pending_size(0)
+    , is_stopping(false)
+    , is_finalized(false)
+{
+    this->file = std::fopen(path.c_str(), "w+b");
+    if (this->file == nullptr) {
+        throw std::runtime_error("failed to create recording");
+    }
+    // The writes are batched already.
+    std::setvbuf(this->file, nullptr, _IONBF, 0);
+    // A valid file from the first byte on: header and an onMetaData tag
+    // whose array is still empty, padded to the reserved size.
+    std::vector<std::uint8_t> body;
+    amf::encode_amf_string(amf::amf_string("onMetaData"), std::back_inserter(body));
+    amf::encode_amf_ecma_array(amf::amf_ecma_array(), std::back_inserter(body));
+    body.resize(static_cast<std::size_t>(this->reserved_body_size), 0);
+    std::vector<std::uint8_t> head;
+    impl::put_flv_header(head, 0x05);
+    impl::put_script_tag(head, body);
+    try {
+        impl::write_all(this->file, head.data(), head.size());
+    }
+    catch (...) {
+        std::fclose(this->file);
+        throw;
+    }
+    this->data_offset = head.size();
+    this->next_position = this->data_offset;
+    this->writer = std::thread([this]() {
+        this->write_proc();
+    });
+}
+
+flv_recorder::~flv_recorder()
+{
+    try {
+        this->finalize();
+    }
+    catch (...) {
+    }
+}
+
+void flv_recorder::start(const std::vector<std::uint8_t>& audio_config_tag, const std::vector<std::uint8_t>& video_config_tag,
+    const std::shared_ptr<amf::amf_ecma_array>& meta_data)
+{
+    this->audio_config_tag = audio_config_tag;
+    this->video_config_tag = video_config_tag;
+    if (meta_data == nullptr) {
+        return;
+    }
+    for (const auto& item : *meta_data) {
+        if (!impl::is_derived_meta_data_name(item.first.get_value())) {
+            this->meta_values.emplace_back(item.first.get_value(), item.second);
+        }
+    }
+}
+
+void flv_recorder::write_tags(const std::uint8_t* data, std::size_t size)
+{
+    std::size_t offset = 0;
+    while (offset + impl::flv_tag_header_size <= size) {
+        auto tag = data + offset;
+        auto tag_type = tag[0] & 0x1f;
+        auto body_size = impl::read_uint24_be(tag + 1);
+        if (offset + impl::flv_tag_header_size + body_size + impl::flv_previous_tag_size_size > size) {
+            break;
+        }
+        offset += impl::flv_tag_header_size + body_size + impl::flv_previous_tag_size_size;
+        auto timestamp = static_cast<std::int64_t>(impl::read_uint24_be(tag + 4) | (static_cast<std::uint32_t>(tag[7]) << 24));
+        auto body = tag + impl::flv_tag_header_size;
+        bool is_config = false;
+        bool is_keyframe = false;
+        if (tag_type == 9 && body_size >= 2) {
+            auto codec_id = body[0] & 0x0f;
+            is_config = (codec_id == 7 || codec_id == 12) && body[1] == 0;
+            is_keyframe = (body[0] >> 4) == 1 && !is_config;
+        }
+        else if (tag_type == 8 && body_size >= 2) {
+            is_config = (body[0] >> 4) == 10 && body[1] == 0;
+        }
+        else {
+            // The recording gets its own onMetaData.
+            continue;
+        }
+        if (is_config) {
+            auto& config_tag = tag_type == 9 ? this->video_config_tag : this->audio_config_tag;
+            config_tag.assign(tag, body + body_size);
+            if (!this->is_started || this->is_waiting_for_keyframe) {
+                continue;
+            }
+        }
+        if (!this->is_started || this->is_waiting_for_keyframe) {
+            // Start at a keyframe, or at any audio frame of a stream without
+            // video, preceded by the decoder configurations.
+            if (!is_keyframe && (tag_type != 8 || !this->video_config_tag.empty())) {
+                continue;
+            }
+            if (!this->is_started) {
+                this->timestamp_base = timestamp;
+                this->is_started = true;
+            }
+            this->is_waiting_for_keyframe = false;
+            auto rebased_timestamp = this->rebase_timestamp(timestamp);
+            for (const auto config_tag : { &this->video_config_tag, &this->audio_config_tag }) {
+                if (!config_tag->empty()) {
+                    auto config_body_size = static_cast<std::uint32_t>(config_tag->size() - impl::flv_tag_header_size);
+                    this->write_tag(config_tag->data(), config_body_size, rebased_timestamp, false);
+                }
+            }
+        }
+        this->write_tag(tag, body_size, this->rebase_timestamp(timestamp), is_keyframe);
+    }
+    if (!this->batch.data.empty()
+        && (this->batch.data.size() >= impl::recorder_batch_size
+            || std::chrono::steady_clock::now() - this->batch_time >= impl::recorder_batch_interval)) {
+        this->submit_batch(false);
+    }
+}
+
+void flv_recorder::finalize()
+{
+    if (this->is_finalized) {
+        return;
+    }
+    this->is_finalized = true;
+    this->submit_batch(true);
+    {
+        std::unique_lock<std::mutex> lck(this->mtx);
+        this->is_stopping = true;
+    }
+    this->writer_cv.notify_one();
+    this->writer.join();
+    try {
+        if (this->error != nullptr) {
+            std::rethrow_exception(this->error);
+        }
+        this->write_meta_data();
+    }
+    catch (...) {
+        if (this->file != nullptr) {
+            std::fclose(this->file);
+            this->file = nullptr;
+        }
+        throw;
+    }
+    std::remove((this->path + ".index").c_str());
+}
+
+flv_recorder_stats flv_recorder::get_stats() const
+{
+    std::unique_lock<std::mutex> lck(this->mtx);
+    return this->stats;
+}
+
+std::int64_t flv_recorder::rebase_timestamp(std::int64_t timestamp)
+{
+    auto result = timestamp - this->timestamp_base;
+    if (result < this->last_timestamp - impl::max_timestamp_step_back || result > this->last_timestamp + impl::max_timestamp_step) {
+        this->timestamp_base = timestamp - this->last_timestamp;
+        result = this->last_timestamp;
+    }
+    this->last_timestamp = std::max(this->last_timestamp, result);
+    return std::max<std::int64_t>(result, 0);
+}
+
+void flv_recorder::write_tag(const std::uint8_t* tag, std::uint32_t body_size, std::int64_t timestamp, bool is_keyframe)
+{
+    auto& data = this->batch.data;
+    if (data.empty()) {
+        this->batch_time = std::chrono::steady_clock::now();
+        data.reserve(impl::recorder_batch_size);
+    }
+    if (is_keyframe) {
+        this->batch.keyframes.emplace_back(static_cast<double>(timestamp) / 1000, this->next_position);
+    }
+    auto tag_offset = data.size();
+    data.insert(data.end(), tag, tag + impl::flv_tag_header_size + body_size);
+    auto ts = static_cast<std::uint32_t>(timestamp);
+    data[tag_offset + 4] = static_cast<std::uint8_t>(ts >> 16);
+    data[tag_offset + 5] = static_cast<std::uint8_t>(ts >> 8);
+    data[tag_offset + 6] = static_cast<std::uint8_t>(ts);
+    data[tag_offset + 7] = static_cast<std::uint8_t>(ts >> 24);
+    // Written anew, some sources store it in a wrong byte order.
+    impl::put_uint32_be(data, body_size + static_cast<std::uint32_t>(impl::flv_tag_header_size));
+    this->next_position += data.size() - tag_offset;
+    if ((tag[0] & 0x1f) == 8) {
+        this->has_audio = true;
+    }
+    else {
+        this->has_video = true;
+    }
+}
+
+void flv_recorder::submit_batch(bool is_final)
+{
+    if (this->batch.data.empty()) {
+        return;
+    }
+    std::unique_lock<std::mutex> lck(this->mtx);
+    auto size = this->batch.data.size();
+    if (!is_final && (this->error != nullptr || this->pending_size + size > this->max_pending_size)) {
+        // The disk does not keep up. Drop the batch rather than hold up the
+        // player, and continue with the next keyframe.
+        this->stats.dropped_size += size;
+        this->next_position -= size;
+        this->batch.data.clear();
+        this->batch.keyframes.clear();
+        this->is_waiting_for_keyframe = true;
+        return;
+    }
+    this->pending_size += size;
+    this->pending_batches.push_back(std::move(this->batch));
+    this->batch = impl::flv_recorder_batch();
+    if (!this->free_buffers.empty()) {
+        this->batch.data = std::move(this->free_buffers.back());
+        this->free_buffers.pop_back();
+    }
+    lck.unlock();
+    this->writer_cv.notify_one();
+}
+
+void flv_recorder::write_proc()
+{
+    auto data_size = this->data_offset;
+    auto index_size = data_size;
+    auto index_time = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lck(this->mtx);
+    for (;;) {
+        this->writer_cv.wait_for(lck, impl::recorder_index_interval, [this]() {
+            return this->is_stopping || !this->pending_batches.empty();
+        });
+        if (!this->pending_batches.empty()) {
+            auto batch = std::move(this->pending_batches.front());
+            this->pending_batches.pop_front();
+            auto has_error = this->error != nullptr;
+            lck.unlock();
+            std::exception_ptr error;
+            if (!has_error) {
+                try {
+                    impl::write_all(this->file, batch.data.data(), batch.data.size());
+                    data_size += batch.data.size();
+                    this->keyframes.insert(this->keyframes.end(), batch.keyframes.begin(), batch.keyframes.end());
+                }
+                catch (...) {
+                    error = std::current_exception();
+                }
+            }
+            lck.lock();
+            this->pending_size -= batch.data.size();
+            if (error != nullptr) {
+                this->error = error;
+            }
+            else if (!has_error) {
+                this->stats.written_size += batch.data.size();
+                this->stats.keyframe_count = this->keyframes.size();
+            }
+            if (this->free_buffers.size() < 2) {
+                batch.data.clear();
+                this->free_buffers.push_back(std::move(batch.data));
+            }
+        }
+        else if (this->is_stopping) {
+            break;
+        }
+        auto now = std::chrono::steady_clock::now();
+        if (index_size != data_size && this->error == nullptr && now - index_time >= impl::recorder_index_interval) {
+            lck.unlock();
+            // Unbuffered, so the indexed data has reached the system.
+            this->write_index_file(data_size);
+            lck.lock();
+            index_size = data_size;
+            index_time = now;
+        }
+    }
+}
+
+void flv_recorder::write_index_file(std::uint64_t data_size)
+{
+    // Written aside and renamed over the old index, which is never seen half
+    // written.
+    auto index_path = this->path + ".index";
+    auto temp_path = index_path + ".tmp";
+    auto index_file = std::fopen(temp_path.c_str(), "wb");
+    if (index_file == nullptr) {
+        return;
+    }
+    std::uint64_t keyframe_count = this->keyframes.size();
+    bool is_written = std::fwrite(impl::recorder_index_magic, sizeof(impl::recorder_index_magic), 1, index_file) == 1
+        && std::fwrite(&data_size, sizeof(data_size), 1, index_file) == 1
+        && std::fwrite(&keyframe_count, sizeof(keyframe_count), 1, index_file) == 1;
+    for (const auto& keyframe : this->keyframes) {
+        is_written = is_written
+            && std::fwrite(&keyframe.first, sizeof(keyframe.first), 1, index_file) == 1
+            && std::fwrite(&keyframe.second, sizeof(keyframe.second), 1, index_file) == 1;
+    }
+    is_written = std::fclose(index_file) == 0 && is_written;
+    std::error_code ec;
+    if (is_written) {
+        std::filesystem::rename(temp_path, index_path, ec);
+    }
+    else {
+        std::filesystem::remove(temp_path, ec);
+    }
+}
+
+std::vector<std::uint8_t> flv_recorder::encode_meta_data(std::uint64_t position_shift, std::uint64_t file_size) const
+{
+    amf::amf_ecma_array meta_data;
+    for (const auto& value : this->meta_values) {
+        meta_data.push_back(std::make_pair(amf::amf_string(value.first), value.second));
+    }
+    auto times = std::make_shared<amf::amf_strict_array>();
+    auto file_positions = std::make_shared<amf::amf_strict_array>();
+    for (const auto& keyframe : this->keyframes) {
+        times->push_back(std::make_shared<amf::amf_number>(keyframe.first));
+        file_positions->push_back(std::make_shared<amf::amf_number>(static_cast<double>(keyframe.second + position_shift)));
+    }
+    auto keyframes = std::make_shared<amf::amf_object>();
+    keyframes->push_back(std::make_pair(amf::amf_string("times"), times));
+    keyframes->push_back(std::make_pair(amf::amf_string("filepositions"), file_positions));
+    meta_data.push_back(std::make_pair(amf::amf_string("duration"), std::make_shared<amf::amf_number>(static_cast<double>(this->last_timestamp) / 1000)));
+    meta_data.push_back(std::make_pair(amf::amf_string("filesize"), std::make_shared<amf::amf_number>(static_cast<double>(file_size))));
+    meta_data.push_back(std::make_pair(amf::amf_string("hasKeyframes"), std::make_shared<amf::amf_boolean>(!this->keyframes.empty())));
+    meta_data.push_back(std::make_pair(amf::amf_string("keyframes"), keyframes));
+    std::vector<std::uint8_t> body;
+    body.reserve(static_cast<std::size_t>(impl::reserved_meta_data_size + this->keyframes.size() * impl::keyframe_entry_size));
+    amf::encode_amf_string(amf::amf_string("onMetaData"), std::back_inserter(body));
+    amf::encode_amf_ecma_array(meta_data, std::back_inserter(body));
+    return body;
+}
+
+void flv_recorder::write_meta_data()
+{
+    std::uint8_t flags = (this->has_audio ? 0x04 : 0x00) | (this->has_video ? 0x01 : 0x00);
+    if (flags == 0) {
+        flags = 0x05;
+    }
+    auto data_size = this->stats.written_size;
+    auto body = this->encode_meta_data(0, this->data_offset + data_size);
+    if (body.size() <= this->reserved_body_size) {
+        // Fill in the reserved tag, the padding stays behind the array.
+        body.resize(static_cast<std::size_t>(this->reserved_body_size), 0);
+        if (std::fseek(this->file, 4, SEEK_SET) != 0) {
+            throw std::runtime_error("failed to write recording");
+        }
+        impl::write_all(this->file, &flags, 1);
+        if (std::fseek(this->file, static_cast<long>(impl::flv_header_size + impl::flv_previous_tag_size_size + impl::flv_tag_header_size), SEEK_SET) != 0) {
+            throw std::runtime_error("failed to write recording");
+        }
+        impl::write_all(this->file, body.data(), body.size());
+        auto result = std::fclose(this->file);
+        this->file = nullptr;
+        if (result != 0) {
+            throw std::runtime_error("failed to write recording");
+        }
+        return;
+    }
+    // The table outgrew the padding, write a copy with a larger tag in front.
+    auto shift = body.size() - this->reserved_body_size;
+    body = this->encode_meta_data(shift, this->data_offset + shift + data_size);
+    std::vector<std::uint8_t> head;
+    impl::put_flv_header(head, flags);
+    impl::put_script_tag(head, body);
+    auto temp_path = this->path + ".tmp";
+    auto temp_file = std::fopen(temp_path.c_str(), "wb");
+    if (temp_file == nullptr) {
+        throw std::runtime_error("failed to write recording");
+    }
+    try {
+        impl::write_all(temp_file, head.data(), head.size());
+        if (std::fseek(this->file, static_cast<long>(this->data_offset), SEEK_SET) != 0) {
+            throw std::runtime_error("failed to write recording");
+        }
+        std::vector<std::uint8_t> buffer(impl::recorder_batch_size);
+        for (;;) {
+            auto size = std::fread(buffer.data(), 1, buffer.size(), this->file);
+            if (size == 0) {
+                break;
+            }
+            impl::write_all(temp_file, buffer.data(), size);
+        }
+        if (std::ferror(this->file) || std::fclose(temp_file) != 0) {
+            temp_file = nullptr;
+            throw std::runtime_error("failed to write recording");
+        }
+        temp_file = nullptr;
+        std::fclose(this->file);
+        this->file = nullptr;
+        std::filesystem::rename(temp_path, this->path);
+    }
+    catch (...) {
+        if (temp_file != nullptr) {
+            std::fclose(temp_file);
+        }
+        std::error_code ec;
+        std::filesystem::remove(temp_path, ec);
+        throw;
+    }
+}
+
+} // namespace dawn_player
@@ -0,0 +1,126 @@
+/*
+ *    flv_recorder.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_FLV_RECORDER_HPP
+#define DAWN_PLAYER_FLV_RECORDER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "amf_types.hpp"
+
+namespace dawn_player {
+namespace impl {
+
+struct flv_recorder_batch {
+    std::vector<std::uint8_t> data;
+    // (time in seconds, file position) of the video keyframes in data.
+    std::vector<std::pair<double, std::uint64_t>> keyframes;
+};
+
+} // namespace impl
+
+struct flv_recorder_stats {
+    std::uint64_t written_size = 0;
+    std::uint64_t dropped_size = 0;
+    std::uint64_t keyframe_count = 0;
+};
+
+// Writes the FLV tags a player reads to a file, so a live stream can be
+// recorded while it plays without being downloaded twice. The tags are
+// copied into large batches on the player's thread and written by a
+// thread of the recorder's own, a batch that would exceed max_pending_size
+// of unwritten data is dropped instead of waiting for the disk, and the
+// recording resumes at the next keyframe.
+//
+// The file starts with an FLV header and an onMetaData tag padded for
+// reserved_keyframe_count keyframes, timestamps are rebased to start at 0.
+// While recording, path + ".index" is replaced every few seconds with the
+// keyframes of the data written so far, so that a recording cut short by a
+// crash can still be indexed. finalize() fills onMetaData with duration,
+// filesize and the keyframes table, rewriting the file only if the table
+// does not fit the padding, and removes the index file.
+class flv_recorder {
+public:
+    explicit flv_recorder(const std::string& path, std::size_t reserved_keyframe_count = 4096,
+        std::uint64_t max_pending_size = 64 * 1024 * 1024);
+    flv_recorder(const flv_recorder&) = delete;
+    flv_recorder& operator=(const flv_recorder&) = delete;
+    virtual ~flv_recorder();
+    // Called by the player on its task service thread. start() passes the
+    // raw tags (header and body) of the current decoder configurations, and
+    // the stream's metadata, whose values are carried over except those
+    // describing the source file.
+    void start(const std::vector<std::uint8_t>& audio_config_tag, const std::vector<std::uint8_t>& video_config_tag,
+        const std::shared_ptr<amf::amf_ecma_array>& meta_data);
+    // data holds whole tags, each followed by its previous tag size.
+    void write_tags(const std::uint8_t* data, std::size_t size);
+    // Call once the recorder is detached from the player. Throws
+    // std::runtime_error if the file could not be written.
+    void finalize();
+    flv_recorder_stats get_stats() const;
+private:
+    std::int64_t rebase_timestamp(std::int64_t timestamp);
+    void write_tag(const std::uint8_t* tag, std::uint32_t body_size, std::int64_t timestamp, bool is_keyframe);
+    void submit_batch(bool is_final);
+    void write_proc();
+    void write_index_file(std::uint64_t data_size);
+    std::vector<std::uint8_t> encode_meta_data(std::uint64_t position_shift, std::uint64_t file_size) const;
+    void write_meta_data();
+private:
+    std::string path;
+    std::FILE* file;
+    std::uint64_t reserved_body_size;
+    // Where the recorded tags start, right after the padded onMetaData tag.
+    std::uint64_t data_offset;
+    std::uint64_t max_pending_size;
+    // Name and value pairs copied from the stream's onMetaData.
+    std::vector<std::pair<std::string, std::shared_ptr<amf::amf_base>>> meta_values;
+
+    // Player thread state.
+    std::vector<std::uint8_t> audio_config_tag;
+    std::vector<std::uint8_t> video_config_tag;
+    impl::flv_recorder_batch batch;
+    std::chrono::steady_clock::time_point batch_time;
+    std::uint64_t next_position;
+    std::int64_t timestamp_base;
+    std::int64_t last_timestamp;
+    bool is_started;
+    bool is_waiting_for_keyframe;
+    bool has_audio;
+    bool has_video;
+
+    // Shared with the writer thread.
+    mutable std::mutex mtx;
+    std::condition_variable writer_cv;
+    std::deque<impl::flv_recorder_batch> pending_batches;
+    std::vector<std::vector<std::uint8_t>> free_buffers;
+    std::uint64_t pending_size;
+    flv_recorder_stats stats;
+    std::exception_ptr error;
+    bool is_stopping;
+
+    // Writer thread state, handed back to finalize() after join.
+    std::vector<std::pair<double, std::uint64_t>> keyframes;
+    std::thread writer;
+    bool is_finalized;
+};
+
+} // namespace dawn_player
+
+#endif
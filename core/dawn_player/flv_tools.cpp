@@ -0,0 +1,657 @@
+/*
+ *    flv_tools.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "amf_decode.hpp"
+#include "amf_encode.hpp"
+#include "flv_tools.hpp"
+#include "output_support.hpp"
+
+namespace dawn_player {
+namespace impl {
+
+const std::uint64_t flv_header_size = 9;
+const std::uint64_t flv_tag_header_size = 11;
+const std::uint64_t flv_previous_tag_size_size = 4;
+const std::size_t copy_buffer_size = 1024 * 1024;
+// Tag payloads from this size on are copied by copy_file_range() when
+// retimed, smaller ones through the buffer holding the patched headers.
+const std::uint64_t copy_range_min_size = 64 * 1024;
+
+// A read-only mapping of a whole file.
+class mapped_file {
+public:
+    explicit mapped_file(const std::string& path)
+        : fd(-1)
+        , data(nullptr)
+        , size(0)
+    {
+        this->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (this->fd == -1) {
+            throw std::runtime_error("failed to open file");
+        }
+        struct stat st;
+        if (::fstat(this->fd, &st) != 0) {
+            ::close(this->fd);
+            throw std::runtime_error("failed to stat file");
+        }
+        this->mode = st.st_mode;
+        this->size = static_cast<std::uint64_t>(st.st_size);
+        if (this->size != 0) {
+            auto addr = ::mmap(nullptr, static_cast<std::size_t>(this->size), PROT_READ, MAP_SHARED, this->fd, 0);
+            if (addr == MAP_FAILED) {
+                ::close(this->fd);
+                throw std::runtime_error("failed to map file");
+            }
+            ::madvise(addr, static_cast<std::size_t>(this->size), MADV_SEQUENTIAL);
+            this->data = static_cast<const std::uint8_t*>(addr);
+        }
+    }
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    ~mapped_file()
+    {
+        if (this->data != nullptr) {
+            ::munmap(const_cast<std::uint8_t*>(this->data), static_cast<std::size_t>(this->size));
+        }
+        ::close(this->fd);
+    }
+public:
+    int fd;
+    const std::uint8_t* data;
+    std::uint64_t size;
+    mode_t mode;
+};
+
+// Closes the descriptor and removes the file unless released.
+class temp_file {
+public:
+    temp_file(const std::string& path, mode_t mode)
+        : path(path)
+    {
+        this->fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, mode & 07777);
+        if (this->fd == -1) {
+            throw std::runtime_error("failed to create file");
+        }
+    }
+    temp_file(const temp_file&) = delete;
+    temp_file& operator=(const temp_file&) = delete;
+    ~temp_file()
+    {
+        if (this->fd != -1) {
+            ::close(this->fd);
+            ::unlink(this->path.c_str());
+        }
+    }
+    void rename_to(const std::string& target)
+    {
+        auto result = ::fsync(this->fd);
+        result = ::close(this->fd) == 0 && result == 0 ? 0 : -1;
+        this->fd = -1;
+        if (result != 0 || ::rename(this->path.c_str(), target.c_str()) != 0) {
+            ::unlink(this->path.c_str());
+            throw std::runtime_error("failed to write file");
+        }
+    }
+public:
+    std::string path;
+    int fd;
+};
+
+// Timestamp and TimestampExtended of the tag header at tag.
+std::int64_t read_tag_timestamp(const std::uint8_t* tag)
+{
+    return static_cast<std::int64_t>(read_uint24_be(tag + 4) | (static_cast<std::uint32_t>(tag[7]) << 24));
+}
+
+std::uint64_t get_tag_size(const std::uint8_t* tag)
+{
+    return flv_tag_header_size + read_uint24_be(tag + 1) + flv_previous_tag_size_size;
+}
+
+// Whether the audio or video tag at tag carries a decoder configuration:
+// an AAC AudioSpecificConfig or an AVC/HEVC sequence header.
+bool is_config_tag(const std::uint8_t* tag)
+{
+    auto tag_type = tag[0] & 0x1f;
+    auto body_size = read_uint24_be(tag + 1);
+    auto body = tag + flv_tag_header_size;
+    if (body_size < 2 || body[1] != 0) {
+        return false;
+    }
+    if (tag_type == 8) {
+        return (body[0] >> 4) == 10;
+    }
+    return tag_type == 9 && ((body[0] & 0x0f) == 7 || (body[0] & 0x0f) == 12);
+}
+
+void write_file_at(int fd, const std::uint8_t* data, std::size_t size, std::uint64_t offset)
+{
+    while (size != 0) {
+        auto result = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            throw std::runtime_error("failed to write file");
+        }
+        data += result;
+        size -= static_cast<std::size_t>(result);
+        offset += static_cast<std::uint64_t>(result);
+    }
+}
+
+// Copies size bytes between two files inside the kernel, through a buffer
+// where copy_file_range() is not supported for the pair.
+void copy_file_data(int in_fd, std::uint64_t in_offset, int out_fd, std::uint64_t out_offset, std::uint64_t size)
+{
+    while (size != 0) {
+        auto in_off = static_cast<off_t>(in_offset);
+        auto out_off = static_cast<off_t>(out_offset);
+        auto result = ::copy_file_range(in_fd, &in_off, out_fd, &out_off, static_cast<std::size_t>(std::min<std::uint64_t>(size, 1ULL << 30)), 0);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result < 0 && (errno == EXDEV || errno == ENOSYS || errno == EOPNOTSUPP || errno == EINVAL)) {
+            break;
+        }
+        if (result <= 0) {
+            throw std::runtime_error("failed to copy file data");
+        }
+        in_offset += static_cast<std::uint64_t>(result);
+        out_offset += static_cast<std::uint64_t>(result);
+        size -= static_cast<std::uint64_t>(result);
+    }
+    std::vector<std::uint8_t> buffer;
+    while (size != 0) {
+        buffer.resize(copy_buffer_size);
+        auto length = static_cast<std::size_t>(std::min<std::uint64_t>(size, buffer.size()));
+        auto result = ::pread(in_fd, buffer.data(), length, static_cast<off_t>(in_offset));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            throw std::runtime_error("failed to copy file data");
+        }
+        write_file_at(out_fd, buffer.data(), static_cast<std::size_t>(result), out_offset);
+        in_offset += static_cast<std::uint64_t>(result);
+        out_offset += static_cast<std::uint64_t>(result);
+        size -= static_cast<std::uint64_t>(result);
+    }
+}
+
+std::shared_ptr<amf::amf_ecma_array> decode_meta_data(const std::uint8_t* body, std::size_t size)
+{
+    try {
+        auto name = amf::decode_amf(body, body + size);
+        if (name.first->get_type() != amf::amf_type::string
+            || std::static_pointer_cast<amf::amf_string>(name.first)->get_value() != "onMetaData") {
+            return nullptr;
+        }
+        auto value = amf::decode_amf(name.second, body + size).first;
+        if (value->get_type() == amf::amf_type::ecma_array) {
+            return std::static_pointer_cast<amf::amf_ecma_array>(value);
+        }
+        if (value->get_type() == amf::amf_type::object) {
+            return std::static_pointer_cast<amf::amf_object>(value)->to_ecma_array();
+        }
+    }
+    catch (const amf::decode_amf_error&) {
+    }
+    return nullptr;
+}
+
+bool is_stale_meta_data_name(const std::string& name)
+{
+    // Values that describe the file as it was before, not as it is written.
+    static const char* const names[] = {
+        "duration", "filesize", "datasize", "videosize", "audiosize", "keyframes", "hasKeyframes",
+        "lasttimestamp", "lastkeyframetimestamp", "lastkeyframelocation",
+    };
+    return std::any_of(std::begin(names), std::end(names), [&name](const char* n) { return name == n; });
+}
+
+// The body of an onMetaData tag for the described file, with its keyframe
+// positions moved by position_shift.
+std::vector<std::uint8_t> encode_meta_data(const flv_file_info& info, std::int64_t position_shift, std::uint64_t file_size)
+{
+    amf::amf_ecma_array meta_data;
+    if (info.meta_data != nullptr) {
+        for (const auto& item : *info.meta_data) {
+            if (!is_stale_meta_data_name(item.first.get_value())) {
+                meta_data.push_back(item);
+            }
+        }
+    }
+    auto times = std::make_shared<amf::amf_strict_array>();
+    auto file_positions = std::make_shared<amf::amf_strict_array>();
+    for (const auto& keyframe : info.keyframes) {
+        times->push_back(std::make_shared<amf::amf_number>(keyframe.first));
+        file_positions->push_back(std::make_shared<amf::amf_number>(static_cast<double>(static_cast<std::int64_t>(keyframe.second) + position_shift)));
+    }
+    auto keyframes = std::make_shared<amf::amf_object>();
+    keyframes->push_back(std::make_pair(amf::amf_string("times"), times));
+    keyframes->push_back(std::make_pair(amf::amf_string("filepositions"), file_positions));
+    meta_data.push_back(std::make_pair(amf::amf_string("duration"), std::make_shared<amf::amf_number>(static_cast<double>(info.last_timestamp) / 1000)));
+    meta_data.push_back(std::make_pair(amf::amf_string("filesize"), std::make_shared<amf::amf_number>(static_cast<double>(file_size))));
+    meta_data.push_back(std::make_pair(amf::amf_string("hasKeyframes"), std::make_shared<amf::amf_boolean>(!info.keyframes.empty())));
+    meta_data.push_back(std::make_pair(amf::amf_string("keyframes"), keyframes));
+    std::vector<std::uint8_t> body;
+    amf::encode_amf_string(amf::amf_string("onMetaData"), std::back_inserter(body));
+    amf::encode_amf_ecma_array(meta_data, std::back_inserter(body));
+    return body;
+}
+
+// FLV header, PreviousTagSize0 and a script tag holding body.
+std::vector<std::uint8_t> make_file_head(std::uint8_t flags, const std::vector<std::uint8_t>& body)
+{
+    if (body.size() > 0xffffff) {
+        throw std::runtime_error("onMetaData too large");
+    }
+    std::vector<std::uint8_t> head = { 'F', 'L', 'V', 1, flags, 0, 0, 0, static_cast<std::uint8_t>(flv_header_size), 0, 0, 0, 0 };
+    head.reserve(head.size() + flv_tag_header_size + body.size() + flv_previous_tag_size_size);
+    head.push_back(18);
+    put_uint24_be(head, static_cast<std::uint32_t>(body.size()));
+    // Timestamp, TimestampExtended and StreamID.
+    head.insert(head.end(), 7, 0);
+    head.insert(head.end(), body.begin(), body.end());
+    put_uint32_be(head, static_cast<std::uint32_t>(body.size() + flv_tag_header_size));
+    return head;
+}
+
+void scan_flv_tags(const std::uint8_t* data, std::uint64_t size, flv_file_info& info)
+{
+    if (size < flv_header_size + flv_previous_tag_size_size || data[0] != 'F' || data[1] != 'L' || data[2] != 'V') {
+        throw std::runtime_error("not an FLV file");
+    }
+    info.flags = data[4];
+    info.data_offset = std::max<std::uint64_t>(read_uint32_be(data + 5), flv_header_size) + flv_previous_tag_size_size;
+    info.meta_data_end = info.data_offset;
+    info.file_size = size;
+    auto offset = info.data_offset;
+    info.end_offset = std::min(offset, size);
+    while (offset + flv_tag_header_size <= size) {
+        auto tag = data + offset;
+        auto tag_type = tag[0] & 0x1f;
+        auto body_size = read_uint24_be(tag + 1);
+        auto tag_end = offset + get_tag_size(tag);
+        // StreamID is always 0.
+        if (tag[8] != 0 || tag[9] != 0 || tag[10] != 0) {
+            throw std::runtime_error("bad FLV tag");
+        }
+        if (tag_end > size) {
+            // The file is cut short in this tag, unless the header is not
+            // one of a tag the writers put at the end.
+            if (tag_type != 8 && tag_type != 9 && tag_type != 18) {
+                throw std::runtime_error("bad FLV tag");
+            }
+            break;
+        }
+        auto timestamp = read_tag_timestamp(tag);
+        auto body = tag + flv_tag_header_size;
+        if (tag_type == 18) {
+            if (offset == info.data_offset) {
+                info.meta_data = decode_meta_data(body, body_size);
+                if (info.meta_data != nullptr) {
+                    info.meta_data_body_size = body_size;
+                    info.meta_data_end = tag_end;
+                }
+            }
+        }
+        else if (tag_type == 8 || tag_type == 9) {
+            auto is_config = is_config_tag(tag);
+            if (!is_config) {
+                info.last_timestamp = std::max(info.last_timestamp, timestamp);
+            }
+            if (tag_type == 8) {
+                info.has_audio = true;
+                if (is_config) {
+                    info.audio_config_offsets.push_back(offset);
+                }
+            }
+            else {
+                info.has_video = true;
+                if (is_config) {
+                    info.video_config_offsets.push_back(offset);
+                }
+                else if (body_size >= 1 && (body[0] >> 4) == 1) {
+                    info.keyframes.emplace_back(static_cast<double>(timestamp) / 1000, offset);
+                }
+            }
+        }
+        // Other tag types are skipped by their DataSize.
+        offset = tag_end;
+        info.end_offset = tag_end;
+    }
+}
+
+// Sets Timestamp and TimestampExtended of the tag header at tag.
+void set_tag_timestamp(std::uint8_t* tag, std::int64_t timestamp)
+{
+    auto ts = static_cast<std::uint32_t>(std::max<std::int64_t>(timestamp, 0));
+    tag[4] = static_cast<std::uint8_t>(ts >> 16);
+    tag[5] = static_cast<std::uint8_t>(ts >> 8);
+    tag[6] = static_cast<std::uint8_t>(ts);
+    tag[7] = static_cast<std::uint8_t>(ts >> 24);
+}
+
+// Copies the tags in [begin, end) of file to out_fd at out_offset with
+// their timestamps moved by shift. The headers are patched in a buffer
+// that is written along with the small tags around them, so a run of
+// small tags costs one write. Larger payloads go through copy_file_data(),
+// which leaves the kernel free to share their extents.
+void copy_retimed_tags(const mapped_file& file, std::uint64_t begin, std::uint64_t end, int out_fd, std::uint64_t out_offset, std::int64_t shift)
+{
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve(copy_buffer_size);
+    auto flush_buffer = [&]() {
+        write_file_at(out_fd, buffer.data(), buffer.size(), out_offset);
+        out_offset += buffer.size();
+        buffer.clear();
+    };
+    for (auto offset = begin; offset < end;) {
+        auto tag = file.data + offset;
+        auto tag_size = get_tag_size(tag);
+        auto header = buffer.size();
+        buffer.insert(buffer.end(), tag, tag + flv_tag_header_size);
+        set_tag_timestamp(buffer.data() + header, read_tag_timestamp(tag) + shift);
+        auto rest = tag_size - flv_tag_header_size;
+        if (rest >= copy_range_min_size) {
+            flush_buffer();
+            copy_file_data(file.fd, offset + flv_tag_header_size, out_fd, out_offset, rest);
+            out_offset += rest;
+        }
+        else {
+            buffer.insert(buffer.end(), tag + flv_tag_header_size, tag + tag_size);
+            if (buffer.size() >= copy_buffer_size) {
+                flush_buffer();
+            }
+        }
+        offset += tag_size;
+    }
+    flush_buffer();
+}
+
+// Writes the tags in [begin, end) of a scanned file to a new file at
+// output_path, begin being a keyframe. The decoder configurations in effect
+// at begin go first, and the timestamps start over from that keyframe's.
+// The tags are copied as one range and only their timestamps are patched.
+void write_flv_range(const mapped_file& file, const flv_file_info& info, std::uint64_t begin, std::uint64_t end, const std::string& output_path)
+{
+    std::vector<std::uint64_t> config_offsets;
+    for (const auto* offsets : { &info.video_config_offsets, &info.audio_config_offsets }) {
+        auto iter = std::lower_bound(offsets->begin(), offsets->end(), begin);
+        if (iter != offsets->begin()) {
+            config_offsets.push_back(*--iter);
+        }
+    }
+    std::uint64_t config_size = 0;
+    for (auto offset : config_offsets) {
+        config_size += get_tag_size(file.data + offset);
+    }
+    auto base_timestamp = read_tag_timestamp(file.data + begin);
+    flv_file_info range_info;
+    range_info.meta_data = info.meta_data;
+    for (auto offset = begin; offset < end; offset += get_tag_size(file.data + offset)) {
+        auto tag_type = file.data[offset] & 0x1f;
+        if (tag_type == 8 || tag_type == 9) {
+            range_info.last_timestamp = std::max(range_info.last_timestamp, read_tag_timestamp(file.data + offset) - base_timestamp);
+        }
+    }
+    auto first = std::lower_bound(info.keyframes.begin(), info.keyframes.end(), begin,
+        [](const std::pair<double, std::uint64_t>& keyframe, std::uint64_t offset) { return keyframe.second < offset; });
+    for (auto iter = first; iter != info.keyframes.end() && iter->second < end; ++iter) {
+        range_info.keyframes.emplace_back(iter->first - static_cast<double>(base_timestamp) / 1000, iter->second);
+    }
+    // Numbers have a fixed size, so the tag size does not depend on the
+    // values.
+    auto body = encode_meta_data(range_info, 0, 0);
+    auto data_offset = flv_header_size + flv_previous_tag_size_size + flv_tag_header_size + body.size() + flv_previous_tag_size_size + config_size;
+    auto shift = static_cast<std::int64_t>(data_offset) - static_cast<std::int64_t>(begin);
+    body = encode_meta_data(range_info, shift, data_offset + (end - begin));
+    auto head = make_file_head(info.flags & 0x05, body);
+    temp_file output(output_path + ".tmp", file.mode);
+    write_file_at(output.fd, head.data(), head.size(), 0);
+    std::uint64_t position = head.size();
+    for (auto offset : config_offsets) {
+        // Stamped 0.
+        auto size = get_tag_size(file.data + offset);
+        copy_retimed_tags(file, offset, offset + size, output.fd, position, -read_tag_timestamp(file.data + offset));
+        position += size;
+    }
+    if (base_timestamp != 0) {
+        // Audio slightly ahead of the keyframe is clamped to 0.
+        copy_retimed_tags(file, begin, end, output.fd, position, -base_timestamp);
+    }
+    else {
+        copy_file_data(file.fd, begin, output.fd, position, end - begin);
+    }
+    output.rename_to(output_path);
+}
+
+// Where the audio/video timestamps of a file start and end, and how long
+// its last frame lasts as far as the step before it tells.
+struct flv_timeline {
+    bool is_empty = true;
+    std::int64_t first_timestamp = 0;
+    std::int64_t last_timestamp = 0;
+    std::int64_t last_frame_duration = 0;
+};
+
+flv_timeline get_timeline(const mapped_file& file, const flv_file_info& info)
+{
+    flv_timeline timeline;
+    std::int64_t last_frame_timestamp = -1;
+    auto frame_tag_type = info.has_video ? 9 : 8;
+    for (auto offset = info.meta_data_end; offset < info.end_offset; offset += get_tag_size(file.data + offset)) {
+        auto tag_type = file.data[offset] & 0x1f;
+        // Writers commonly stamp the decoder configurations 0, ahead of
+        // frames that start later.
+        if ((tag_type != 8 && tag_type != 9) || is_config_tag(file.data + offset)) {
+            continue;
+        }
+        auto timestamp = read_tag_timestamp(file.data + offset);
+        if (timeline.is_empty) {
+            timeline.first_timestamp = timestamp;
+            timeline.is_empty = false;
+        }
+        timeline.last_timestamp = std::max(timeline.last_timestamp, timestamp);
+        if (tag_type == frame_tag_type) {
+            if (last_frame_timestamp >= 0 && timestamp > last_frame_timestamp) {
+                timeline.last_frame_duration = timestamp - last_frame_timestamp;
+            }
+            last_frame_timestamp = timestamp;
+        }
+    }
+    return timeline;
+}
+
+// Whether the decoder configuration in effect at the end of one file,
+// given by the offsets of its configuration tags, is the one the next file
+// starts with.
+bool is_same_config(const mapped_file& file, const std::vector<std::uint64_t>& offsets,
+    const mapped_file& next_file, const std::vector<std::uint64_t>& next_offsets)
+{
+    if (offsets.empty() || next_offsets.empty()) {
+        return offsets.empty() && next_offsets.empty();
+    }
+    auto tag = file.data + offsets.back();
+    auto next_tag = next_file.data + next_offsets.front();
+    auto size = read_uint24_be(tag + 1);
+    return size == read_uint24_be(next_tag + 1)
+        && std::equal(tag + flv_tag_header_size, tag + flv_tag_header_size + size, next_tag + flv_tag_header_size);
+}
+
+} // namespace impl
+
+flv_file_info scan_flv_file(const std::string& path)
+{
+    impl::mapped_file file(path);
+    flv_file_info info;
+    impl::scan_flv_tags(file.data, file.size, info);
+    return info;
+}
+
+void inject_flv_meta_data(const std::string& path, std::uint64_t padding)
+{
+    impl::mapped_file file(path);
+    flv_file_info info;
+    impl::scan_flv_tags(file.data, file.size, info);
+    std::uint8_t flags = (info.has_audio ? 0x04 : 0x00) | (info.has_video ? 0x01 : 0x00);
+    auto body = impl::encode_meta_data(info, 0, info.end_offset);
+    if (info.meta_data != nullptr && body.size() <= info.meta_data_body_size) {
+        // Fits the existing tag, the padding stays behind the array.
+        body.resize(static_cast<std::size_t>(info.meta_data_body_size), 0);
+        auto fd = ::open(path.c_str(), O_WRONLY | O_CLOEXEC);
+        if (fd == -1) {
+            throw std::runtime_error("failed to open file");
+        }
+        try {
+            impl::write_file_at(fd, &flags, 1, 4);
+            impl::write_file_at(fd, body.data(), body.size(), info.data_offset + impl::flv_tag_header_size);
+            if (info.end_offset < info.file_size && ::ftruncate(fd, static_cast<off_t>(info.end_offset)) != 0) {
+                throw std::runtime_error("failed to write file");
+            }
+        }
+        catch (...) {
+            ::close(fd);
+            throw;
+        }
+        ::close(fd);
+        return;
+    }
+    // The tags behind onMetaData move by shift.
+    auto head_size = impl::flv_header_size + impl::flv_previous_tag_size_size + impl::flv_tag_header_size
+        + body.size() + padding + impl::flv_previous_tag_size_size;
+    auto shift = static_cast<std::int64_t>(head_size) - static_cast<std::int64_t>(info.meta_data_end);
+    auto data_size = info.end_offset - info.meta_data_end;
+    body = impl::encode_meta_data(info, shift, head_size + data_size);
+    body.resize(static_cast<std::size_t>(body.size() + padding), 0);
+    auto head = impl::make_file_head(flags, body);
+    impl::temp_file output(path + ".tmp", file.mode);
+    impl::write_file_at(output.fd, head.data(), head.size(), 0);
+    impl::copy_file_data(file.fd, info.meta_data_end, output.fd, head.size(), data_size);
+    output.rename_to(path);
+}
+
+void export_flv_clip(const std::string& path, const std::string& output_path, double start_time, double end_time)
+{
+    impl::mapped_file file(path);
+    flv_file_info info;
+    impl::scan_flv_tags(file.data, file.size, info);
+    if (info.keyframes.empty() || !(start_time < end_time)) {
+        throw std::runtime_error("bad operation");
+    }
+    auto compare = [](const std::pair<double, std::uint64_t>& keyframe, double time) { return keyframe.first < time; };
+    // From the last keyframe at or before start_time up to the first one at
+    // or after end_time.
+    auto first = std::upper_bound(info.keyframes.begin(), info.keyframes.end(), start_time,
+        [](double time, const std::pair<double, std::uint64_t>& keyframe) { return time < keyframe.first; });
+    if (first != info.keyframes.begin()) {
+        --first;
+    }
+    auto last = std::lower_bound(first + 1, info.keyframes.end(), end_time, compare);
+    auto end = last != info.keyframes.end() ? last->second : info.end_offset;
+    impl::write_flv_range(file, info, first->second, end, output_path);
+}
+
+std::vector<std::string> export_flv_segments(const std::string& path, const std::string& output_prefix, double segment_duration)
+{
+    impl::mapped_file file(path);
+    flv_file_info info;
+    impl::scan_flv_tags(file.data, file.size, info);
+    if (info.keyframes.empty() || !(segment_duration > 0)) {
+        throw std::runtime_error("bad operation");
+    }
+    std::vector<std::string> output_paths;
+    for (std::size_t first = 0, last = 0; first < info.keyframes.size(); first = last) {
+        last = first + 1;
+        while (last < info.keyframes.size() && info.keyframes[last].first - info.keyframes[first].first < segment_duration) {
+            ++last;
+        }
+        auto end = last < info.keyframes.size() ? info.keyframes[last].second : info.end_offset;
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), "%04zu.flv", output_paths.size());
+        output_paths.push_back(output_prefix + suffix);
+        impl::write_flv_range(file, info, info.keyframes[first].second, end, output_paths.back());
+    }
+    return output_paths;
+}
+
+void concat_flv_files(const std::vector<std::string>& paths, const std::string& output_path)
+{
+    if (paths.empty()) {
+        throw std::runtime_error("bad operation");
+    }
+    std::vector<std::unique_ptr<impl::mapped_file>> files;
+    std::vector<flv_file_info> infos(paths.size());
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        files.push_back(std::make_unique<impl::mapped_file>(paths[i]));
+        impl::scan_flv_tags(files[i]->data, files[i]->size, infos[i]);
+        if (i != 0 && (infos[i].has_audio != infos[0].has_audio || infos[i].has_video != infos[0].has_video
+            || !impl::is_same_config(*files[i - 1], infos[i - 1].video_config_offsets, *files[i], infos[i].video_config_offsets)
+            || !impl::is_same_config(*files[i - 1], infos[i - 1].audio_config_offsets, *files[i], infos[i].audio_config_offsets))) {
+            throw std::runtime_error("incompatible decoder configuration");
+        }
+    }
+    // Each file's timestamps are moved to follow the last frame of the file
+    // before it. The tags behind each file's onMetaData are copied as they
+    // are, so only the first file's onMetaData survives.
+    std::vector<std::int64_t> timestamp_shifts;
+    std::vector<std::uint64_t> data_offsets;
+    std::uint64_t data_size = 0;
+    flv_file_info merged_info;
+    merged_info.meta_data = infos[0].meta_data;
+    std::int64_t timeline_end = 0;
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        auto timeline = impl::get_timeline(*files[i], infos[i]);
+        auto shift = timeline_end - timeline.first_timestamp;
+        if (!timeline.is_empty) {
+            merged_info.last_timestamp = timeline.last_timestamp + shift;
+            timeline_end = merged_info.last_timestamp + timeline.last_frame_duration;
+        }
+        timestamp_shifts.push_back(timeline.is_empty ? 0 : shift);
+        data_offsets.push_back(data_size);
+        for (const auto& keyframe : infos[i].keyframes) {
+            merged_info.keyframes.emplace_back(keyframe.first + static_cast<double>(shift) / 1000, data_size + (keyframe.second - infos[i].meta_data_end));
+        }
+        data_size += infos[i].end_offset - infos[i].meta_data_end;
+    }
+    // Numbers have a fixed size, so the tag size does not depend on the
+    // values.
+    auto body = impl::encode_meta_data(merged_info, 0, 0);
+    auto head_size = impl::flv_header_size + impl::flv_previous_tag_size_size + impl::flv_tag_header_size
+        + body.size() + impl::flv_previous_tag_size_size;
+    body = impl::encode_meta_data(merged_info, static_cast<std::int64_t>(head_size), head_size + data_size);
+    auto head = impl::make_file_head(infos[0].flags & 0x05, body);
+    impl::temp_file output(output_path + ".tmp", files[0]->mode);
+    impl::write_file_at(output.fd, head.data(), head.size(), 0);
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        const auto& file = *files[i];
+        const auto& info = infos[i];
+        auto position = head_size + data_offsets[i];
+        if (timestamp_shifts[i] != 0) {
+            impl::copy_retimed_tags(file, info.meta_data_end, info.end_offset, output.fd, position, timestamp_shifts[i]);
+        }
+        else {
+            impl::copy_file_data(file.fd, info.meta_data_end, output.fd, position, info.end_offset - info.meta_data_end);
+        }
+    }
+    output.rename_to(output_path);
+}
+
+} // namespace dawn_player
@@ -0,0 +1,94 @@
+/*
+ *    flv_tools.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_FLV_TOOLS_HPP
+#define DAWN_PLAYER_FLV_TOOLS_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "amf_types.hpp"
+
+namespace dawn_player {
+
+// What one pass over the tag headers of an FLV file finds.
+struct flv_file_info {
+    // TypeFlags of the FLV header.
+    std::uint8_t flags = 0;
+    // Offset of the first tag, behind the header and PreviousTagSize0.
+    std::uint64_t data_offset = 0;
+    // The onMetaData tag if it is the first tag, its body size and where
+    // the tag after it starts. Without one, meta_data is nullptr and
+    // meta_data_end equals data_offset.
+    std::shared_ptr<amf::amf_ecma_array> meta_data;
+    std::uint64_t meta_data_body_size = 0;
+    std::uint64_t meta_data_end = 0;
+    // (time in seconds, tag offset) of the video keyframes.
+    std::vector<std::pair<double, std::uint64_t>> keyframes;
+    // Tag offsets of the AVC/HEVC sequence headers and the AAC
+    // AudioSpecificConfigs.
+    std::vector<std::uint64_t> video_config_offsets;
+    std::vector<std::uint64_t> audio_config_offsets;
+    // Greatest audio/video timestamp in milliseconds.
+    std::int64_t last_timestamp = 0;
+    // End of the last complete tag. A file cut short, e.g. by a crash while
+    // recording, has bytes of one partial tag behind it.
+    std::uint64_t end_offset = 0;
+    std::uint64_t file_size = 0;
+    bool has_audio = false;
+    bool has_video = false;
+};
+
+// Scans the tags of an FLV file once, the tag bodies are not read beyond
+// their first bytes. Tags other than audio, video and script data are
+// skipped. Throws std::runtime_error if the file cannot be read or is not
+// an FLV file, or if a tag header is broken anywhere but in a partial tag
+// at the end, so that the tools below never cut off data behind it.
+flv_file_info scan_flv_file(const std::string& path);
+
+// Makes an FLV file seekable for flv_player by writing onMetaData with
+// duration, filesize and the keyframes table, keeping the other values of
+// an existing onMetaData. If the existing tag (or its padding) is large
+// enough, only its body is overwritten. Otherwise the file is written anew
+// next to it and renamed over it, with the new tag padded by padding bytes
+// for later updates and the tags behind it copied with copy_file_range(),
+// which moves no data through user space and shares the extents on file
+// systems that support it. A partial tag at the end is cut off either way.
+void inject_flv_meta_data(const std::string& path, std::uint64_t padding = 16 * 1024);
+
+// Writes the part of an FLV file from the last keyframe at or before
+// start_time up to the first keyframe at or after end_time (seconds) to a
+// new file. The new file gets its own onMetaData and the decoder
+// configurations in effect at the first keyframe, and its timestamps start
+// at 0. The tags are moved with copy_file_range() and only their
+// timestamps are rewritten. Throws std::runtime_error if the file has no
+// keyframes or cannot be read or written.
+void export_flv_clip(const std::string& path, const std::string& output_path, double start_time, double end_time);
+
+// Splits an FLV file at keyframes into segments of at least
+// segment_duration seconds each, the last one excepted, written like
+// export_flv_clip() does to output_prefix followed by 0000.flv, 0001.flv
+// and so on. Tags before the first keyframe are left out. Returns the
+// paths written.
+std::vector<std::string> export_flv_segments(const std::string& path, const std::string& output_prefix, double segment_duration);
+
+// Joins FLV files, e.g. the segments of a recording, into one file at
+// output_path. The timestamps of each file are moved to continue where the
+// file before it ends, one frame after its last one, and the keyframes
+// tables are merged into the onMetaData written first; the other values of
+// onMetaData come from the first file. The tags are copied as they are
+// with copy_file_range(). Throws std::runtime_error if a file does not
+// carry the same streams, or does not start with the decoder configuration
+// the file before it ends with.
+void concat_flv_files(const std::vector<std::string>& paths, const std::string& output_path);
+
+} // namespace dawn_player
+
+#endif
@@ -0,0 +1,210 @@
+/*
+ *    flv_writer.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+#include <sys/uio.h>
+
+#include "amf_encode.hpp"
+#include "annexb.hpp"
+#include "flv_writer.hpp"
+#include "output_support.hpp"
+
+namespace dawn_player {
+namespace impl {
+
+const std::size_t flv_writer_tag_header_size = 11;
+// Queued tags are written once they hold this much or need this many
+// iovecs.
+const std::size_t flv_writer_flush_size = 1024 * 1024;
+const std::size_t flv_writer_flush_iovec_count = 512;
+
+std::uint8_t to_flv_video_codec_id(video_codec codec)
+{
+    switch (codec) {
+    case video_codec::h264:
+        return 7;
+    case video_codec::hevc:
+        return 12;
+    default:
+        throw std::runtime_error("bad operation");
+    }
+}
+
+} // namespace impl
+
+flv_writer::flv_writer(int fd)
+    : fd(fd)
+    , pending_size(0)
+    , pending_iovec_count(0)
+    , flushed_size(0)
+    , position(0)
+    , video_codec_id(7)
+{
+}
+
+flv_writer::~flv_writer()
+{
+    try {
+        this->flush();
+    }
+    catch (...) {
+    }
+}
+
+void flv_writer::write_header(bool has_audio, bool has_video)
+{
+    this->pending_tags.emplace_back();
+    auto& header = this->pending_tags.back();
+    header.is_tag = false;
+    // Signature, version, flags, data offset and the first previous tag
+    // size.
+    const std::uint8_t head[] = { 'F', 'L', 'V', 1, 0, 0, 0, 0, 9, 0, 0, 0, 0 };
+    std::copy(std::begin(head), std::end(head), header.head.begin());
+    header.head[4] = (has_audio ? 0x04 : 0x00) | (has_video ? 0x01 : 0x00);
+    header.head_size = sizeof(head);
+    this->position += header.head_size;
+    this->pending_size += header.head_size;
+    ++this->pending_iovec_count;
+}
+
+void flv_writer::write_script_data(const std::string& name, const amf::amf_base& value)
+{
+    auto& tag = this->add_tag(18, 0);
+    amf::encode_amf_string(amf::amf_string(name), std::back_inserter(tag.data));
+    amf::encode_amf(value, std::back_inserter(tag.data));
+    this->finish_tag(tag, tag.data.size());
+}
+
+void flv_writer::write_audio_config(const std::vector<std::uint8_t>& audio_specific_config, std::int64_t timestamp)
+{
+    auto& tag = this->add_tag(8, timestamp / 10000);
+    // AAC, 44 kHz, 16 bit, stereo as the specification requires for AAC,
+    // and AACPacketType 0.
+    tag.head[tag.head_size++] = 0xaf;
+    tag.head[tag.head_size++] = 0x00;
+    tag.data = audio_specific_config;
+    this->finish_tag(tag, tag.data.size());
+}
+
+void flv_writer::write_video_config(video_codec codec, const std::vector<std::uint8_t>& record, std::int64_t timestamp)
+{
+    this->video_codec_id = impl::to_flv_video_codec_id(codec);
+    auto& tag = this->add_tag(9, timestamp / 10000);
+    // Key frame, PacketType 0 and composition time 0.
+    tag.head[tag.head_size++] = 0x10 | this->video_codec_id;
+    tag.head[tag.head_size++] = 0x00;
+    impl::store_uint24_be(&tag.head[tag.head_size], 0);
+    tag.head_size += 3;
+    tag.data = record;
+    this->finish_tag(tag, tag.data.size());
+}
+
+void flv_writer::write_audio_sample(sample::audio_sample&& sample)
+{
+    auto& tag = this->add_tag(8, sample.timestamp / 10000);
+    tag.head[tag.head_size++] = 0xaf;
+    tag.head[tag.head_size++] = 0x01;
+    tag.data = std::move(sample.data);
+    this->finish_tag(tag, tag.data.size());
+}
+
+void flv_writer::write_video_sample(sample::video_sample&& sample)
+{
+    auto& tag = this->add_tag(9, sample.dts / 10000);
+    tag.head[tag.head_size++] = (sample.is_key_frame ? 0x10 : 0x20) | this->video_codec_id;
+    tag.head[tag.head_size++] = 0x01;
+    // CompositionTime SI24
+    auto composition_time = static_cast<std::int32_t>((sample.timestamp - sample.dts) / 10000);
+    impl::store_uint24_be(&tag.head[tag.head_size], static_cast<std::uint32_t>(composition_time) & 0xffffff);
+    tag.head_size += 3;
+    tag.data = std::move(sample.data);
+    sample::split_annexb(tag.data.data(), tag.data.size(), tag.nalus);
+    std::size_t data_size = 0;
+    tag.nalu_lengths.resize(tag.nalus.size());
+    for (std::size_t i = 0; i < tag.nalus.size(); ++i) {
+        impl::store_uint32_be(tag.nalu_lengths[i].data(), static_cast<std::uint32_t>(tag.nalus[i].second));
+        data_size += 4 + tag.nalus[i].second;
+    }
+    this->finish_tag(tag, data_size);
+}
+
+void flv_writer::flush()
+{
+    if (this->pending_tags.empty()) {
+        return;
+    }
+    std::vector<iovec> iovecs;
+    iovecs.reserve(this->pending_iovec_count);
+    auto add = [&iovecs](const void* data, std::size_t size) {
+        if (size != 0) {
+            iovecs.push_back(iovec{ const_cast<void*>(data), size });
+        }
+    };
+    for (auto& tag : this->pending_tags) {
+        add(tag.head.data(), tag.head_size);
+        if (tag.nalus.empty()) {
+            add(tag.data.data(), tag.data.size());
+        }
+        for (std::size_t i = 0; i < tag.nalus.size(); ++i) {
+            add(tag.nalu_lengths[i].data(), 4);
+            add(tag.data.data() + tag.nalus[i].first, tag.nalus[i].second);
+        }
+        if (tag.is_tag) {
+            add(tag.previous_tag_size.data(), 4);
+        }
+    }
+    auto data = iovecs.data();
+    auto count = iovecs.size();
+    impl::skip_iovecs(data, count, this->flushed_size);
+    impl::write_iovecs(this->fd, data, count, this->flushed_size);
+    this->pending_tags.clear();
+    this->pending_size = 0;
+    this->pending_iovec_count = 0;
+    this->flushed_size = 0;
+}
+
+std::uint64_t flv_writer::get_position() const
+{
+    return this->position;
+}
+
+impl::flv_writer_tag& flv_writer::add_tag(std::uint8_t tag_type, std::int64_t timestamp)
+{
+    this->pending_tags.emplace_back();
+    auto& tag = this->pending_tags.back();
+    auto ts = static_cast<std::uint32_t>(std::max<std::int64_t>(timestamp, 0));
+    tag.head[0] = tag_type;
+    // DataSize is filled in by finish_tag().
+    impl::store_uint24_be(&tag.head[4], ts & 0xffffff);
+    tag.head[7] = static_cast<std::uint8_t>(ts >> 24);
+    // StreamID
+    impl::store_uint24_be(&tag.head[8], 0);
+    tag.head_size = impl::flv_writer_tag_header_size;
+    return tag;
+}
+
+void flv_writer::finish_tag(impl::flv_writer_tag& tag, std::size_t data_size)
+{
+    auto body_size = static_cast<std::uint32_t>(tag.head_size - impl::flv_writer_tag_header_size + data_size);
+    if (body_size > 0xffffff) {
+        this->pending_tags.pop_back();
+        throw std::runtime_error("tag too large");
+    }
+    impl::store_uint24_be(&tag.head[1], body_size);
+    impl::store_uint32_be(tag.previous_tag_size.data(), body_size + static_cast<std::uint32_t>(impl::flv_writer_tag_header_size));
+    this->position += impl::flv_writer_tag_header_size + body_size + 4;
+    this->pending_size += impl::flv_writer_tag_header_size + body_size + 4;
+    this->pending_iovec_count += 2 + (tag.nalus.empty() ? 1 : tag.nalus.size() * 2);
+    if (this->pending_size >= impl::flv_writer_flush_size || this->pending_iovec_count >= impl::flv_writer_flush_iovec_count) {
+        this->flush();
+    }
+}
+
+} // namespace dawn_player
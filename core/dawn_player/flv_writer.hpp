@@ -0,0 +1,90 @@
+/*
+ *    flv_writer.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_FLV_WRITER_HPP
+#define DAWN_PLAYER_FLV_WRITER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "amf_types.hpp"
+#include "flv_parser.hpp"
+#include "samples.hpp"
+
+namespace dawn_player {
+namespace impl {
+
+struct flv_writer_tag {
+    // Tag header and the audio/video data header, or the file header.
+    std::array<std::uint8_t, 16> head;
+    std::size_t head_size = 0;
+    // The payload, owned by the tag until it is written.
+    std::vector<std::uint8_t> data;
+    // (offset, size) of the NAL units in data that are written behind a
+    // 4-byte length each, empty to write data as is.
+    std::vector<std::pair<std::size_t, std::size_t>> nalus;
+    std::vector<std::array<std::uint8_t, 4>> nalu_lengths;
+    std::array<std::uint8_t, 4> previous_tag_size;
+    // False for the file header, which has no previous tag size behind it.
+    bool is_tag = true;
+};
+
+} // namespace impl
+
+// Writes an FLV stream to a file descriptor, which stays owned by the
+// caller. Tags are queued with their payloads moved in and written with
+// writev() once enough are queued or on flush(), so the payloads are never
+// copied. Video samples are taken as the player delivers them, Annex-B,
+// and written as AVCC with 4-byte lengths in front of the NAL units in
+// place of the start codes.
+//
+// Write the header first, then the onMetaData script data and the decoder
+// configurations, before the samples. Throws std::runtime_error if the
+// file cannot be written; the tags stay queued, and a later flush()
+// continues from the first byte that did not make it.
+class flv_writer {
+public:
+    explicit flv_writer(int fd);
+    flv_writer(const flv_writer&) = delete;
+    flv_writer& operator=(const flv_writer&) = delete;
+    // Flushes, errors are lost, call flush() to see them.
+    virtual ~flv_writer();
+    void write_header(bool has_audio, bool has_video);
+    void write_script_data(const std::string& name, const amf::amf_base& value);
+    // An AAC AudioSpecificConfig. Timestamps are in 100 ns units, like
+    // those of the samples.
+    void write_audio_config(const std::vector<std::uint8_t>& audio_specific_config, std::int64_t timestamp = 0);
+    // An AVCDecoderConfigurationRecord or HEVCDecoderConfigurationRecord,
+    // which also selects the codec of the video samples that follow.
+    void write_video_config(video_codec codec, const std::vector<std::uint8_t>& record, std::int64_t timestamp = 0);
+    void write_audio_sample(sample::audio_sample&& sample);
+    void write_video_sample(sample::video_sample&& sample);
+    void flush();
+    // Where the next tag starts, written or still queued.
+    std::uint64_t get_position() const;
+private:
+    impl::flv_writer_tag& add_tag(std::uint8_t tag_type, std::int64_t timestamp);
+    void finish_tag(impl::flv_writer_tag& tag, std::size_t data_size);
+private:
+    int fd;
+    std::deque<impl::flv_writer_tag> pending_tags;
+    std::size_t pending_size;
+    std::size_t pending_iovec_count;
+    // Bytes of the pending tags a flush() that failed part way got written.
+    std::size_t flushed_size;
+    std::uint64_t position;
+    std::uint8_t video_codec_id;
+};
+
+} // namespace dawn_player
+
+#endif
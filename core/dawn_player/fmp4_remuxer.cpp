@@ -0,0 +1,604 @@
+/*
+ *    fmp4_remuxer.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+
+#include <sys/uio.h>
+
+#include "annexb.hpp"
+#include "fmp4_remuxer.hpp"
+#include "output_support.hpp"
+#include "sps_parser.hpp"
+
+namespace dawn_player {
+namespace impl {
+
+// Of the movie and the video track, that of FLV timestamps.
+const std::uint32_t fmp4_timescale = 1000;
+// Fragment length in seconds for audio without video, whose keyframes cut
+// the fragments otherwise.
+const std::int64_t fmp4_audio_fragment_duration = 1;
+// Sample durations assumed until there are two samples to tell.
+const std::uint32_t fmp4_default_video_duration = 40;
+const std::uint32_t fmp4_aac_frame_length = 1024;
+// sample_flags of ISO/IEC 14496-12 8.8.3.1: sample_depends_on 2 for sync
+// samples, sample_depends_on 1 and sample_is_non_sync_sample otherwise.
+const std::uint32_t fmp4_sync_sample_flags = 0x02000000;
+const std::uint32_t fmp4_non_sync_sample_flags = 0x01010000;
+
+// A timestamp in 100 ns units in units of timescale.
+std::int64_t to_timescale(std::int64_t timestamp, std::uint32_t timescale)
+{
+    return timestamp * timescale / 10000000;
+}
+
+void write_zeros(std::vector<std::uint8_t>& out, std::size_t count)
+{
+    out.insert(out.end(), count, 0);
+}
+
+// Starts a box whose size is filled in by end_box(), returns its offset.
+std::size_t begin_box(std::vector<std::uint8_t>& out, const char* type)
+{
+    auto offset = out.size();
+    put_uint32_be(out, 0);
+    out.insert(out.end(), type, type + 4);
+    return offset;
+}
+
+std::size_t begin_full_box(std::vector<std::uint8_t>& out, const char* type, std::uint8_t version, std::uint32_t flags)
+{
+    auto offset = begin_box(out, type);
+    put_uint8(out, version);
+    put_uint24_be(out, flags);
+    return offset;
+}
+
+void end_box(std::vector<std::uint8_t>& out, std::size_t offset)
+{
+    store_uint32_be(out.data() + offset, static_cast<std::uint32_t>(out.size() - offset));
+}
+
+// The unity matrix of mvhd and tkhd.
+void write_matrix(std::vector<std::uint8_t>& out)
+{
+    const std::uint32_t matrix[] = { 0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000 };
+    for (auto value : matrix) {
+        put_uint32_be(out, value);
+    }
+}
+
+// An ES descriptor header of ISO/IEC 14496-1 with its size in as few
+// 7-bit groups as it takes.
+void write_descriptor_header(std::vector<std::uint8_t>& out, std::uint8_t tag, std::uint32_t size)
+{
+    put_uint8(out, tag);
+    int shift = 21;
+    while (shift > 0 && (size >> shift) == 0) {
+        shift -= 7;
+    }
+    for (; shift > 0; shift -= 7) {
+        put_uint8(out, static_cast<std::uint8_t>(0x80 | ((size >> shift) & 0x7f)));
+    }
+    put_uint8(out, static_cast<std::uint8_t>(size & 0x7f));
+}
+
+// Returns the first SPS of an AVCDecoderConfigurationRecord or
+// HEVCDecoderConfigurationRecord, (nullptr, 0) if there is none.
+std::pair<const std::uint8_t*, std::size_t> find_sps(video_codec codec, const std::vector<std::uint8_t>& record)
+{
+    const std::pair<const std::uint8_t*, std::size_t> none(nullptr, 0);
+    if (codec == video_codec::h264) {
+        // numOfSequenceParameterSets is at byte 5, the first
+        // sequenceParameterSetLength behind it.
+        if (record.size() < 8 || (record[5] & 0x1f) == 0) {
+            return none;
+        }
+        std::size_t size = (static_cast<std::size_t>(record[6]) << 8) | record[7];
+        return record.size() < 8 + size ? none : std::make_pair(record.data() + 8, size);
+    }
+    // numOfArrays is at byte 22, each array has NAL_unit_type, numNalus and
+    // the NAL units behind a 16-bit length each.
+    if (record.size() < 23) {
+        return none;
+    }
+    std::size_t offset = 23;
+    for (std::uint32_t i = 0; i < record[22] && offset + 3 <= record.size(); ++i) {
+        auto nalu_type = record[offset] & 0x3f;
+        std::uint32_t count = (static_cast<std::uint32_t>(record[offset + 1]) << 8) | record[offset + 2];
+        offset += 3;
+        for (std::uint32_t j = 0; j < count && offset + 2 <= record.size(); ++j) {
+            std::size_t size = (static_cast<std::size_t>(record[offset]) << 8) | record[offset + 1];
+            offset += 2;
+            if (offset + size > record.size()) {
+                return none;
+            }
+            if (nalu_type == 33) {
+                return std::make_pair(record.data() + offset, size);
+            }
+            offset += size;
+        }
+    }
+    return none;
+}
+
+// samplingFrequencyIndex and channelConfiguration of an AAC
+// AudioSpecificConfig, ISO/IEC 14496-3 1.6.2.1.
+void parse_audio_specific_config(const std::vector<std::uint8_t>& config, std::uint32_t& sample_rate, std::uint32_t& channels)
+{
+    const std::uint32_t sample_rates[] = { 96000, 88200, 64000, 48000, 44100, 32000, 24000, 22050, 16000, 12000, 11025, 8000, 7350 };
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < 8; ++i) {
+        bits = (bits << 8) | (i < config.size() ? config[i] : 0);
+    }
+    int position = 0;
+    auto read_bits = [&bits, &position](int count) {
+        auto value = static_cast<std::uint32_t>((bits >> (64 - position - count)) & ((1u << count) - 1));
+        position += count;
+        return value;
+    };
+    sample_rate = 44100;
+    channels = 2;
+    if (config.size() < 2) {
+        return;
+    }
+    // audioObjectType, escaped for types from 32 on.
+    if (read_bits(5) == 31) {
+        read_bits(6);
+    }
+    auto frequency_index = read_bits(4);
+    if (frequency_index == 15) {
+        sample_rate = read_bits(24);
+    }
+    else if (frequency_index < std::size(sample_rates)) {
+        sample_rate = sample_rates[frequency_index];
+    }
+    auto channel_configuration = read_bits(4);
+    if (channel_configuration != 0) {
+        channels = channel_configuration == 7 ? 8 : channel_configuration;
+    }
+}
+
+// The picture size from the first SPS of a decoder configuration record,
+// 0 x 0 if it cannot be parsed.
+void get_video_size(video_codec codec, const std::vector<std::uint8_t>& record, std::uint32_t& width, std::uint32_t& height)
+{
+    parser::sps_info info;
+    auto sps = find_sps(codec, record);
+    bool is_parsed = false;
+    if (sps.first != nullptr) {
+        is_parsed = codec == video_codec::h264 ? parser::parse_h264_sps(sps.first, sps.second, info) : parser::parse_hevc_sps(sps.first, sps.second, info);
+    }
+    width = is_parsed ? info.width : 0;
+    height = is_parsed ? info.height : 0;
+}
+
+void write_video_sample_entry(std::vector<std::uint8_t>& out, video_codec codec, const std::vector<std::uint8_t>& record, std::uint32_t width, std::uint32_t height)
+{
+    // Not avc1 or hvc1, which rule out parameter sets in the samples.
+    auto entry = begin_box(out, codec == video_codec::h264 ? "avc3" : "hev1");
+    // reserved, data_reference_index
+    write_zeros(out, 6);
+    put_uint16_be(out, 1);
+    // pre_defined, reserved, pre_defined[3]
+    write_zeros(out, 16);
+    put_uint16_be(out, static_cast<std::uint16_t>(width));
+    put_uint16_be(out, static_cast<std::uint16_t>(height));
+    // horizresolution, vertresolution 72 dpi, reserved, frame_count
+    put_uint32_be(out, 0x00480000);
+    put_uint32_be(out, 0x00480000);
+    put_uint32_be(out, 0);
+    put_uint16_be(out, 1);
+    // compressorname
+    write_zeros(out, 32);
+    // depth, pre_defined = -1
+    put_uint16_be(out, 0x0018);
+    put_uint16_be(out, 0xffff);
+    auto config = begin_box(out, codec == video_codec::h264 ? "avcC" : "hvcC");
+    out.insert(out.end(), record.begin(), record.end());
+    end_box(out, config);
+    end_box(out, entry);
+}
+
+void write_audio_sample_entry(std::vector<std::uint8_t>& out, const std::vector<std::uint8_t>& audio_specific_config, std::uint32_t sample_rate, std::uint32_t channels)
+{
+    auto entry = begin_box(out, "mp4a");
+    // reserved, data_reference_index
+    write_zeros(out, 6);
+    put_uint16_be(out, 1);
+    // reserved[2], channelcount, samplesize, pre_defined, reserved
+    write_zeros(out, 8);
+    put_uint16_be(out, static_cast<std::uint16_t>(channels));
+    put_uint16_be(out, 16);
+    write_zeros(out, 4);
+    put_uint32_be(out, sample_rate <= 0xffff ? sample_rate << 16 : 0);
+    auto esds = begin_full_box(out, "esds", 0, 0);
+    auto config_size = static_cast<std::uint32_t>(audio_specific_config.size());
+    // ES_Descriptor: ES_ID and flags, DecoderConfigDescriptor and
+    // SLConfigDescriptor, each descriptor header counted at 2 bytes as
+    // the sizes stay below 128.
+    write_descriptor_header(out, 0x03, 3 + (2 + 13 + 2 + config_size) + (2 + 1));
+    put_uint16_be(out, 0);
+    put_uint8(out, 0);
+    // DecoderConfigDescriptor: objectTypeIndication 0x40 (MPEG-4 Audio),
+    // streamType 5 (audio) with upStream 0 and reserved 1, bufferSizeDB,
+    // maxBitrate and avgBitrate unknown, and the DecoderSpecificInfo.
+    write_descriptor_header(out, 0x04, 13 + 2 + config_size);
+    put_uint8(out, 0x40);
+    put_uint8(out, 0x15);
+    put_uint24_be(out, 0);
+    put_uint32_be(out, 0);
+    put_uint32_be(out, 0);
+    write_descriptor_header(out, 0x05, config_size);
+    out.insert(out.end(), audio_specific_config.begin(), audio_specific_config.end());
+    // SLConfigDescriptor: predefined 2 (reserved for MP4 files).
+    write_descriptor_header(out, 0x06, 1);
+    put_uint8(out, 0x02);
+    end_box(out, esds);
+    end_box(out, entry);
+}
+
+void write_track(std::vector<std::uint8_t>& out, const fmp4_track& track, bool is_video, std::uint32_t width, std::uint32_t height,
+    const std::vector<std::uint8_t>& sample_entry)
+{
+    auto trak = begin_box(out, "trak");
+    // Flags: track_enabled, track_in_movie.
+    auto tkhd = begin_full_box(out, "tkhd", 0, 0x000003);
+    // creation_time, modification_time, track_ID, reserved, duration
+    put_uint32_be(out, 0);
+    put_uint32_be(out, 0);
+    put_uint32_be(out, track.track_id);
+    put_uint32_be(out, 0);
+    put_uint32_be(out, 0);
+    // reserved[2], layer, alternate_group, volume, reserved
+    write_zeros(out, 12);
+    put_uint16_be(out, is_video ? 0 : 0x0100);
+    put_uint16_be(out, 0);
+    write_matrix(out);
+    put_uint32_be(out, width << 16);
+    put_uint32_be(out, height << 16);
+    end_box(out, tkhd);
+    auto mdia = begin_box(out, "mdia");
+    auto mdhd = begin_full_box(out, "mdhd", 0, 0);
+    // creation_time, modification_time, timescale, duration, language
+    // "und", pre_defined
+    put_uint32_be(out, 0);
+    put_uint32_be(out, 0);
+    put_uint32_be(out, track.timescale);
+    put_uint32_be(out, 0);
+    put_uint16_be(out, 0x55c4);
+    put_uint16_be(out, 0);
+    end_box(out, mdhd);
+    auto hdlr = begin_full_box(out, "hdlr", 0, 0);
+    // pre_defined, handler_type, reserved[3], name
+    put_uint32_be(out, 0);
+    const char* handler_type = is_video ? "vide" : "soun";
+    out.insert(out.end(), handler_type, handler_type + 4);
+    write_zeros(out, 12);
+    const char* name = is_video ? "VideoHandler" : "SoundHandler";
+    out.insert(out.end(), name, name + 13);
+    end_box(out, hdlr);
+    auto minf = begin_box(out, "minf");
+    if (is_video) {
+        // graphicsmode, opcolor
+        auto vmhd = begin_full_box(out, "vmhd", 0, 0x000001);
+        write_zeros(out, 8);
+        end_box(out, vmhd);
+    }
+    else {
+        // balance, reserved
+        auto smhd = begin_full_box(out, "smhd", 0, 0);
+        write_zeros(out, 4);
+        end_box(out, smhd);
+    }
+    auto dinf = begin_box(out, "dinf");
+    auto dref = begin_full_box(out, "dref", 0, 0);
+    put_uint32_be(out, 1);
+    // The media data is in the same file.
+    end_box(out, begin_full_box(out, "url ", 0, 0x000001));
+    end_box(out, dref);
+    end_box(out, dinf);
+    // Empty sample tables, the samples are in the fragments.
+    auto stbl = begin_box(out, "stbl");
+    auto stsd = begin_full_box(out, "stsd", 0, 0);
+    put_uint32_be(out, 1);
+    out.insert(out.end(), sample_entry.begin(), sample_entry.end());
+    end_box(out, stsd);
+    auto stts = begin_full_box(out, "stts", 0, 0);
+    put_uint32_be(out, 0);
+    end_box(out, stts);
+    auto stsc = begin_full_box(out, "stsc", 0, 0);
+    put_uint32_be(out, 0);
+    end_box(out, stsc);
+    // sample_size, sample_count
+    auto stsz = begin_full_box(out, "stsz", 0, 0);
+    put_uint32_be(out, 0);
+    put_uint32_be(out, 0);
+    end_box(out, stsz);
+    auto stco = begin_full_box(out, "stco", 0, 0);
+    put_uint32_be(out, 0);
+    end_box(out, stco);
+    end_box(out, stbl);
+    end_box(out, minf);
+    end_box(out, mdia);
+    end_box(out, trak);
+}
+
+void write_trex(std::vector<std::uint8_t>& out, std::uint32_t track_id)
+{
+    // track_ID, default_sample_description_index and no other defaults,
+    // every trun carries them.
+    auto trex = begin_full_box(out, "trex", 0, 0);
+    put_uint32_be(out, track_id);
+    put_uint32_be(out, 1);
+    put_uint32_be(out, 0);
+    put_uint32_be(out, 0);
+    put_uint32_be(out, 0);
+    end_box(out, trex);
+}
+
+// Writes the traf of the first count samples of a track, durations taken
+// from the samples behind them or else end_dts. Returns the offset of the
+// trun data_offset for the caller to fill in.
+std::size_t write_traf(std::vector<std::uint8_t>& out, fmp4_track& track, std::size_t count, std::int64_t end_dts, bool has_composition_offsets)
+{
+    auto traf = begin_box(out, "traf");
+    // Flags: default-base-is-moof.
+    auto tfhd = begin_full_box(out, "tfhd", 0, 0x020000);
+    put_uint32_be(out, track.track_id);
+    end_box(out, tfhd);
+    auto tfdt = begin_full_box(out, "tfdt", 1, 0);
+    put_uint64_be(out, static_cast<std::uint64_t>(std::max<std::int64_t>(track.samples.front().dts, 0)));
+    end_box(out, tfdt);
+    // Flags: data-offset-present, sample-duration-present,
+    // sample-size-present, sample-flags-present and, for video,
+    // sample-composition-time-offsets-present, signed in version 1.
+    auto trun = begin_full_box(out, "trun", 1, has_composition_offsets ? 0x000f01 : 0x000701);
+    put_uint32_be(out, static_cast<std::uint32_t>(count));
+    auto data_offset = out.size();
+    put_uint32_be(out, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        const auto& sample = track.samples[i];
+        auto next_dts = i + 1 < track.samples.size() ? track.samples[i + 1].dts : end_dts;
+        if (next_dts > sample.dts) {
+            track.last_duration = static_cast<std::uint32_t>(next_dts - sample.dts);
+        }
+        put_uint32_be(out, track.last_duration);
+        put_uint32_be(out, sample.size);
+        put_uint32_be(out, sample.is_key_frame ? fmp4_sync_sample_flags : fmp4_non_sync_sample_flags);
+        if (has_composition_offsets) {
+            put_uint32_be(out, static_cast<std::uint32_t>(sample.composition_offset));
+        }
+    }
+    end_box(out, trun);
+    end_box(out, traf);
+    return data_offset;
+}
+
+} // namespace impl
+
+fmp4_remuxer::fmp4_remuxer(int fd)
+    : fd(fd)
+    , sequence_number(0)
+{
+}
+
+fmp4_remuxer::~fmp4_remuxer()
+{
+    try {
+        this->flush();
+    }
+    catch (...) {
+    }
+}
+
+void fmp4_remuxer::write_init_segment(video_codec codec, const std::vector<std::uint8_t>& video_config_record, const std::vector<std::uint8_t>& audio_specific_config)
+{
+    bool has_video = !video_config_record.empty();
+    bool has_audio = !audio_specific_config.empty();
+    if ((!has_video && !has_audio) || (has_video && codec != video_codec::h264 && codec != video_codec::hevc)) {
+        throw std::runtime_error("bad operation");
+    }
+    std::vector<std::uint8_t> out;
+    auto ftyp = impl::begin_box(out, "ftyp");
+    const char brands[] = "iso5" "iso5" "iso6" "mp41";
+    out.insert(out.end(), brands, brands + 4);
+    impl::put_uint32_be(out, 512);
+    out.insert(out.end(), brands + 4, brands + 16);
+    impl::end_box(out, ftyp);
+    auto moov = impl::begin_box(out, "moov");
+    auto mvhd = impl::begin_full_box(out, "mvhd", 0, 0);
+    // creation_time, modification_time, timescale, duration, rate 1.0,
+    // volume 1.0, reserved
+    impl::put_uint32_be(out, 0);
+    impl::put_uint32_be(out, 0);
+    impl::put_uint32_be(out, impl::fmp4_timescale);
+    impl::put_uint32_be(out, 0);
+    impl::put_uint32_be(out, 0x00010000);
+    impl::put_uint16_be(out, 0x0100);
+    impl::write_zeros(out, 10);
+    impl::write_matrix(out);
+    // pre_defined[6], next_track_ID
+    impl::write_zeros(out, 24);
+    impl::put_uint32_be(out, 3);
+    impl::end_box(out, mvhd);
+    this->video_track = impl::fmp4_track();
+    this->audio_track = impl::fmp4_track();
+    std::vector<std::uint8_t> sample_entry;
+    if (has_video) {
+        this->video_track.track_id = 1;
+        this->video_track.timescale = impl::fmp4_timescale;
+        this->video_track.last_duration = impl::fmp4_default_video_duration;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        impl::get_video_size(codec, video_config_record, width, height);
+        impl::write_video_sample_entry(sample_entry, codec, video_config_record, width, height);
+        impl::write_track(out, this->video_track, true, width, height, sample_entry);
+    }
+    if (has_audio) {
+        std::uint32_t sample_rate = 44100;
+        std::uint32_t channels = 2;
+        impl::parse_audio_specific_config(audio_specific_config, sample_rate, channels);
+        this->audio_track.track_id = 2;
+        this->audio_track.timescale = std::max<std::uint32_t>(sample_rate, 1);
+        this->audio_track.last_duration = impl::fmp4_aac_frame_length;
+        sample_entry.clear();
+        impl::write_audio_sample_entry(sample_entry, audio_specific_config, sample_rate, channels);
+        impl::write_track(out, this->audio_track, false, 0, 0, sample_entry);
+    }
+    auto mvex = impl::begin_box(out, "mvex");
+    for (const auto* track : { &this->video_track, &this->audio_track }) {
+        if (track->track_id != 0) {
+            impl::write_trex(out, track->track_id);
+        }
+    }
+    impl::end_box(out, mvex);
+    impl::end_box(out, moov);
+    iovec iov = { out.data(), out.size() };
+    std::size_t written = 0;
+    impl::write_iovecs(this->fd, &iov, 1, written);
+}
+
+void fmp4_remuxer::write_audio_sample(sample::audio_sample&& sample)
+{
+    if (this->audio_track.track_id == 0) {
+        throw std::runtime_error("bad operation");
+    }
+    auto& track = this->audio_track;
+    auto dts = impl::to_timescale(sample.timestamp, track.timescale);
+    // Within a millisecond of the end of the last frame, FLV rounding.
+    if (track.next_dts >= 0 && std::abs(dts - track.next_dts) <= track.timescale / 1000 + 1) {
+        dts = track.next_dts;
+    }
+    track.next_dts = dts + impl::fmp4_aac_frame_length;
+    if (this->video_track.track_id == 0 && !track.samples.empty()
+        && dts - track.samples.front().dts >= impl::fmp4_audio_fragment_duration * track.timescale) {
+        this->write_fragment(0, true);
+    }
+    track.samples.emplace_back();
+    auto& s = track.samples.back();
+    s.dts = dts;
+    s.data = std::move(sample.data);
+    s.size = static_cast<std::uint32_t>(s.data.size());
+}
+
+void fmp4_remuxer::write_video_sample(sample::video_sample&& sample)
+{
+    if (this->video_track.track_id == 0) {
+        throw std::runtime_error("bad operation");
+    }
+    auto dts = impl::to_timescale(sample.dts, this->video_track.timescale);
+    if (sample.is_key_frame && !this->video_track.samples.empty()) {
+        this->write_fragment(sample.dts, false);
+    }
+    this->video_track.samples.emplace_back();
+    auto& s = this->video_track.samples.back();
+    s.dts = dts;
+    s.composition_offset = static_cast<std::int32_t>(impl::to_timescale(sample.timestamp, this->video_track.timescale) - dts);
+    s.is_key_frame = sample.is_key_frame;
+    s.data = std::move(sample.data);
+    sample::split_annexb(s.data.data(), s.data.size(), s.nalus);
+    s.nalu_lengths.resize(s.nalus.size());
+    std::size_t size = 0;
+    for (std::size_t i = 0; i < s.nalus.size(); ++i) {
+        impl::store_uint32_be(s.nalu_lengths[i].data(), static_cast<std::uint32_t>(s.nalus[i].second));
+        size += 4 + s.nalus[i].second;
+    }
+    s.size = static_cast<std::uint32_t>(size);
+}
+
+void fmp4_remuxer::flush()
+{
+    this->write_fragment(0, true);
+}
+
+void fmp4_remuxer::write_fragment(std::int64_t end_timestamp, bool is_end)
+{
+    auto& video_samples = this->video_track.samples;
+    auto& audio_samples = this->audio_track.samples;
+    auto video_count = video_samples.size();
+    auto video_end_dts = impl::to_timescale(end_timestamp, this->video_track.timescale);
+    auto audio_end_dts = impl::to_timescale(end_timestamp, this->audio_track.timescale);
+    std::size_t audio_count = 0;
+    while (audio_count < audio_samples.size() && (is_end || audio_samples[audio_count].dts < audio_end_dts)) {
+        ++audio_count;
+    }
+    if (video_count == 0 && audio_count == 0) {
+        return;
+    }
+    std::vector<std::uint8_t> head;
+    auto moof = impl::begin_box(head, "moof");
+    auto mfhd = impl::begin_full_box(head, "mfhd", 0, 0);
+    impl::put_uint32_be(head, ++this->sequence_number);
+    impl::end_box(head, mfhd);
+    // The samples of both tracks follow each other in one mdat. The
+    // duration of a track's last sample is that of the one before it,
+    // unless the keyframe that starts the next fragment tells.
+    std::vector<std::pair<std::size_t, std::uint64_t>> data_offsets;
+    std::uint64_t data_size = 0;
+    if (video_count != 0) {
+        data_offsets.emplace_back(impl::write_traf(head, this->video_track, video_count, is_end ? video_samples.back().dts : video_end_dts, true), data_size);
+        for (std::size_t i = 0; i < video_count; ++i) {
+            data_size += video_samples[i].size;
+        }
+    }
+    if (audio_count != 0) {
+        data_offsets.emplace_back(impl::write_traf(head, this->audio_track, audio_count, audio_samples[audio_count - 1].dts, false), data_size);
+        for (std::size_t i = 0; i < audio_count; ++i) {
+            data_size += audio_samples[i].size;
+        }
+    }
+    impl::end_box(head, moof);
+    if (data_size + 8 > UINT32_MAX) {
+        throw std::runtime_error("fragment too large");
+    }
+    // The data offsets count from the start of moof to the samples in mdat.
+    for (const auto& data_offset : data_offsets) {
+        impl::store_uint32_be(head.data() + data_offset.first, static_cast<std::uint32_t>(head.size() + 8 + data_offset.second));
+    }
+    impl::put_uint32_be(head, static_cast<std::uint32_t>(data_size + 8));
+    head.insert(head.end(), { 'm', 'd', 'a', 't' });
+    std::vector<iovec> iovecs;
+    auto add = [&iovecs](const void* data, std::size_t size) {
+        if (size != 0) {
+            iovecs.push_back(iovec{ const_cast<void*>(data), size });
+        }
+    };
+    add(head.data(), head.size());
+    for (std::size_t i = 0; i < video_count; ++i) {
+        auto& sample = video_samples[i];
+        for (std::size_t j = 0; j < sample.nalus.size(); ++j) {
+            add(sample.nalu_lengths[j].data(), 4);
+            add(sample.data.data() + sample.nalus[j].first, sample.nalus[j].second);
+        }
+    }
+    for (std::size_t i = 0; i < audio_count; ++i) {
+        add(audio_samples[i].data.data(), audio_samples[i].data.size());
+    }
+    auto drop_samples = [&]() {
+        video_samples.erase(video_samples.begin(), video_samples.begin() + static_cast<std::ptrdiff_t>(video_count));
+        audio_samples.erase(audio_samples.begin(), audio_samples.begin() + static_cast<std::ptrdiff_t>(audio_count));
+    };
+    std::size_t written = 0;
+    try {
+        impl::write_iovecs(this->fd, iovecs.data(), iovecs.size(), written);
+    }
+    catch (...) {
+        // Written in part, the samples would be repeated by writing the
+        // fragment again.
+        if (written != 0) {
+            drop_samples();
+        }
+        throw;
+    }
+    drop_samples();
+}
+
+} // namespace dawn_player
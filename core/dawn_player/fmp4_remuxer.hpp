@@ -0,0 +1,98 @@
+/*
+ *    fmp4_remuxer.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_FMP4_REMUXER_HPP
+#define DAWN_PLAYER_FMP4_REMUXER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "flv_parser.hpp"
+#include "samples.hpp"
+
+namespace dawn_player {
+namespace impl {
+
+struct fmp4_sample {
+    // Decode time and composition offset in units of the track timescale.
+    std::int64_t dts = 0;
+    std::int32_t composition_offset = 0;
+    bool is_key_frame = true;
+    // The payload, owned by the sample until it is written.
+    std::vector<std::uint8_t> data;
+    // (offset, size) of the NAL units in data that are written behind a
+    // 4-byte length each, empty to write data as is.
+    std::vector<std::pair<std::size_t, std::size_t>> nalus;
+    std::vector<std::array<std::uint8_t, 4>> nalu_lengths;
+    std::uint32_t size = 0;
+};
+
+struct fmp4_track {
+    std::uint32_t track_id = 0;
+    // Units per second.
+    std::uint32_t timescale = 0;
+    std::deque<fmp4_sample> samples;
+    // Used for the last sample of a fragment when no later one is queued.
+    std::uint32_t last_duration = 0;
+    // Audio only, where a frame that follows the last one without a gap
+    // starts, -1 before the first frame.
+    std::int64_t next_dts = -1;
+};
+
+} // namespace impl
+
+// Remuxes the samples of an flv_player into fragmented MP4, as Media
+// Source Extensions take it, to a file descriptor that stays owned by the
+// caller. write_init_segment() writes ftyp and moov; every sample after it
+// goes to a moof/mdat fragment, a new one starting at each video keyframe,
+// or every second for audio only. Video samples are taken as the player
+// delivers them, Annex-B, and written with 4-byte lengths in front of the
+// NAL units in place of the start codes. The moof is built in memory and
+// written with writev() along with the payloads, which are never copied.
+//
+// The video track is avc3 or hev1, so the decoder takes the parameter sets
+// a key frame carries in-band over those of the init segment. Samples from
+// flv_player::package_video_sample() carry them, and a stream can switch
+// to another configuration mid-stream that way.
+//
+// Video has a timescale of 1000, that of FLV timestamps, and audio the AAC
+// sample rate. Audio frames whose timestamps follow each other within the
+// millisecond rounding of FLV are laid end to end, 1024 samples apart.
+// Throws std::runtime_error if the file cannot be written. The samples of a
+// fragment that was written in part are dropped rather than repeated.
+class fmp4_remuxer {
+public:
+    explicit fmp4_remuxer(int fd);
+    fmp4_remuxer(const fmp4_remuxer&) = delete;
+    fmp4_remuxer& operator=(const fmp4_remuxer&) = delete;
+    virtual ~fmp4_remuxer();
+    // Takes the records of flv_player::get_video_config_record() and
+    // get_audio_config_record(), an empty one leaves its track out.
+    void write_init_segment(video_codec codec, const std::vector<std::uint8_t>& video_config_record, const std::vector<std::uint8_t>& audio_specific_config);
+    void write_audio_sample(sample::audio_sample&& sample);
+    void write_video_sample(sample::video_sample&& sample);
+    // Writes the queued samples as a fragment, e.g. at the end of the
+    // stream.
+    void flush();
+private:
+    // Writes a fragment of the queued video samples and the audio samples
+    // that precede end_timestamp, in 100 ns units, or of all of them.
+    void write_fragment(std::int64_t end_timestamp, bool is_end);
+private:
+    int fd;
+    impl::fmp4_track video_track;
+    impl::fmp4_track audio_track;
+    std::uint32_t sequence_number;
+};
+
+} // namespace dawn_player
+
+#endif
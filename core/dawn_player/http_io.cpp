@@ -0,0 +1,1083 @@
+/*
+ *    http_io.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "http_io.hpp"
+
+namespace dawn_player {
+namespace io {
+namespace impl {
+
+// Large enough for the window to stay open on high bandwidth-delay links,
+// the kernel clamps it to net.core.rmem_max.
+const int socket_receive_buffer_size = 4 * 1024 * 1024;
+// Holds response heads, chunk framing and whatever readv() spills past the
+// current chunk.
+const std::size_t connection_buffer_size = 64 * 1024;
+const int socket_timeout_seconds = 30;
+const int max_redirect_count = 5;
+// Forward seeks shorter than this skip bytes of the current response
+// instead of opening a new one.
+const std::uint64_t max_skip_size = 256 * 1024;
+const std::uint64_t speculative_range_size = 512 * 1024;
+const std::uint64_t unknown_position = std::numeric_limits<std::uint64_t>::max();
+
+bool iequals(const std::string& lhs, const std::string& rhs)
+{
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < lhs.size(); ++i) {
+        if (std::tolower(static_cast<unsigned char>(lhs[i])) != std::tolower(static_cast<unsigned char>(rhs[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool icontains_token(const std::string& value, const std::string& token)
+{
+    std::size_t pos = 0;
+    while (pos <= value.size()) {
+        auto end = value.find(',', pos);
+        if (end == std::string::npos) {
+            end = value.size();
+        }
+        auto first = value.find_first_not_of(" \t", pos);
+        auto last = value.find_last_not_of(" \t", end == 0 ? 0 : end - 1);
+        if (first != std::string::npos && first < end && last != std::string::npos && last >= first) {
+            if (iequals(value.substr(first, last - first + 1), token)) {
+                return true;
+            }
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+std::string trim(const std::string& str)
+{
+    auto first = str.find_first_not_of(" \t");
+    if (first == std::string::npos) {
+        return std::string();
+    }
+    auto last = str.find_last_not_of(" \t");
+    return str.substr(first, last - first + 1);
+}
+
+void set_socket_options(int fd)
+{
+    int flag = 1;
+    // Requests are written in one piece, never hold them back for an ACK.
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+    // Must be set before connect() so that the window scale is negotiated.
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &socket_receive_buffer_size, sizeof(socket_receive_buffer_size));
+    timeval timeout = {};
+    timeout.tv_sec = socket_timeout_seconds;
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+[[noreturn]] void throw_socket_error()
+{
+    if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        throw std::runtime_error("HTTP connection timed out");
+    }
+    throw std::runtime_error("failed to receive from HTTP connection");
+}
+
+// Points url at the target of a redirect response, returns false if the
+// response is not a redirect.
+bool follow_redirect(const http_response& response, http_url& url)
+{
+    auto location = response.find_header("Location");
+    bool is_redirect = response.status_code == 301 || response.status_code == 302
+        || response.status_code == 303 || response.status_code == 307 || response.status_code == 308;
+    if (!is_redirect || location == nullptr) {
+        return false;
+    }
+    if (location->compare(0, 2, "//") == 0) {
+        if (!http_url::parse("http:" + *location, url)) {
+            throw std::runtime_error("unsupported HTTP redirect");
+        }
+    }
+    else if (!location->empty() && (*location)[0] == '/') {
+        url.target = *location;
+    }
+    else if (!http_url::parse(*location, url)) {
+        throw std::runtime_error("unsupported HTTP redirect");
+    }
+    return true;
+}
+
+} // namespace impl
+
+bool http_url::parse(const std::string& url, http_url& result)
+{
+    const std::string scheme = "http://";
+    if (url.size() < scheme.size() || !impl::iequals(url.substr(0, scheme.size()), scheme)) {
+        return false;
+    }
+    auto authority_end = url.find_first_of("/?#", scheme.size());
+    if (authority_end == std::string::npos) {
+        authority_end = url.size();
+    }
+    auto authority = url.substr(scheme.size(), authority_end - scheme.size());
+    auto at = authority.rfind('@');
+    if (at != std::string::npos) {
+        authority.erase(0, at + 1);
+    }
+    std::string host;
+    std::string port;
+    if (!authority.empty() && authority[0] == '[') {
+        auto bracket = authority.find(']');
+        if (bracket == std::string::npos) {
+            return false;
+        }
+        host = authority.substr(1, bracket - 1);
+        if (bracket + 1 < authority.size()) {
+            if (authority[bracket + 1] != ':') {
+                return false;
+            }
+            port = authority.substr(bracket + 2);
+        }
+    }
+    else {
+        auto colon = authority.find(':');
+        host = authority.substr(0, colon);
+        if (colon != std::string::npos) {
+            port = authority.substr(colon + 1);
+        }
+    }
+    if (host.empty()) {
+        return false;
+    }
+    std::uint16_t port_number = 80;
+    if (!port.empty()) {
+        if (port.size() > 5 || port.find_first_not_of("0123456789") != std::string::npos) {
+            return false;
+        }
+        auto value = std::atoi(port.c_str());
+        if (value <= 0 || value > 65535) {
+            return false;
+        }
+        port_number = static_cast<std::uint16_t>(value);
+    }
+    auto target_end = url.find('#', authority_end);
+    auto target = url.substr(authority_end, target_end == std::string::npos ? std::string::npos : target_end - authority_end);
+    if (target.empty() || target[0] != '/') {
+        target = "/" + target;
+    }
+    result.host = std::move(host);
+    result.port = port_number;
+    result.target = std::move(target);
+    return true;
+}
+
+const std::string* http_response::find_header(const std::string& name) const
+{
+    for (const auto& header : this->headers) {
+        if (impl::iequals(header.first, name)) {
+            return &header.second;
+        }
+    }
+    return nullptr;
+}
+
+http_resource_info probe_http_resource(const std::string& url, const std::vector<std::string>& extra_headers)
+{
+    http_url target;
+    if (!http_url::parse(url, target)) {
+        throw std::runtime_error("bad HTTP URL");
+    }
+    auto headers = extra_headers;
+    headers.push_back("Range: bytes=0-0");
+    http_connection connection;
+    http_response response;
+    for (int i = 0; ; ++i) {
+        connection.request(target, headers, response);
+        if (!impl::follow_redirect(response, target)) {
+            break;
+        }
+        if (i == impl::max_redirect_count) {
+            throw std::runtime_error("too many HTTP redirects");
+        }
+        if (!connection.is_reusable()) {
+            connection.close();
+        }
+    }
+    http_resource_info info;
+    if (auto entity_tag = response.find_header("ETag")) {
+        info.entity_tag = *entity_tag;
+    }
+    if (response.status_code == 206) {
+        auto content_range = response.find_header("Content-Range");
+        if (content_range != nullptr) {
+            auto slash = content_range->find('/');
+            if (slash != std::string::npos && slash + 1 < content_range->size() && (*content_range)[slash + 1] != '*') {
+                info.content_length = std::strtoull(content_range->c_str() + slash + 1, nullptr, 10);
+            }
+        }
+    }
+    else if (response.status_code == 200) {
+        if (auto content_length = response.find_header("Content-Length")) {
+            info.content_length = std::strtoull(content_length->c_str(), nullptr, 10);
+        }
+    }
+    else {
+        throw std::runtime_error("unexpected HTTP status");
+    }
+    return info;
+}
+
+void http_connection_canceller::cancel()
+{
+    std::unique_lock<std::mutex> lck(this->mtx);
+    this->is_cancelled = true;
+    for (auto fd : this->fds) {
+        ::shutdown(fd, SHUT_RDWR);
+    }
+}
+
+bool http_connection_canceller::add_socket(int fd)
+{
+    std::unique_lock<std::mutex> lck(this->mtx);
+    if (this->is_cancelled) {
+        return false;
+    }
+    this->fds.push_back(fd);
+    return true;
+}
+
+void http_connection_canceller::close_socket(int fd)
+{
+    // Closed under the lock, so that cancel() never shuts down a socket
+    // that reuses the number.
+    std::unique_lock<std::mutex> lck(this->mtx);
+    this->fds.erase(std::remove(this->fds.begin(), this->fds.end(), fd), this->fds.end());
+    ::close(fd);
+}
+
+http_connection::http_connection(const std::shared_ptr<http_connection_canceller>& canceller)
+    : canceller(canceller)
+    , fd(-1)
+    , connected_port(0)
+    , rx_buffer(impl::connection_buffer_size)
+    , rx_begin(0)
+    , rx_end(0)
+    , mode(body_mode::none)
+    , body_remaining(0)
+    , is_body_complete(true)
+    , is_keep_alive(false)
+    , is_connect_pending(false)
+{
+}
+
+http_connection::~http_connection()
+{
+    this->close();
+}
+
+void http_connection::connect(const std::string& host, std::uint16_t port)
+{
+    this->open_socket(host, port, true);
+}
+
+void http_connection::start_connect(const std::string& host, std::uint16_t port)
+{
+    this->open_socket(host, port, false);
+}
+
+bool http_connection::is_connected() const
+{
+    return this->fd != -1;
+}
+
+bool http_connection::is_connecting()
+{
+    if (!this->is_connect_pending) {
+        return false;
+    }
+    pollfd pfd = {};
+    pfd.fd = this->fd;
+    pfd.events = POLLOUT;
+    if (::poll(&pfd, 1, 0) == 0) {
+        return true;
+    }
+    this->finish_connect();
+    return false;
+}
+
+void http_connection::close()
+{
+    if (this->fd != -1) {
+        this->close_socket(this->fd);
+        this->fd = -1;
+    }
+    this->rx_begin = 0;
+    this->rx_end = 0;
+    this->mode = body_mode::none;
+    this->body_remaining = 0;
+    this->is_body_complete = true;
+    this->is_keep_alive = false;
+    this->is_connect_pending = false;
+}
+
+void http_connection::request(const http_url& url, const std::vector<std::string>& extra_headers, http_response& response)
+{
+    bool is_reused = this->is_reusable() && this->connected_host == url.host && this->connected_port == url.port;
+    if (!is_reused) {
+        this->connect(url.host, url.port);
+    }
+    try {
+        this->send_request(url, extra_headers);
+        this->read_response(response);
+    }
+    catch (const std::runtime_error&) {
+        if (!is_reused) {
+            this->close();
+            throw;
+        }
+        // The server may have closed the idle connection, retry once on a
+        // fresh one.
+        this->connect(url.host, url.port);
+        this->send_request(url, extra_headers);
+        this->read_response(response);
+    }
+}
+
+void http_connection::send_request(const http_url& url, const std::vector<std::string>& extra_headers)
+{
+    std::string request = "GET " + url.target + " HTTP/1.1\r\nHost: ";
+    if (url.host.find(':') != std::string::npos) {
+        request.append("[").append(url.host).append("]");
+    }
+    else {
+        request += url.host;
+    }
+    if (url.port != 80) {
+        request.append(":").append(std::to_string(url.port));
+    }
+    request += "\r\nUser-Agent: DawnPlayer\r\nAccept: */*\r\nConnection: keep-alive\r\n";
+    for (const auto& header : extra_headers) {
+        request += header;
+        request += "\r\n";
+    }
+    request += "\r\n";
+    this->send_all(request);
+}
+
+std::size_t http_connection::read_body(std::uint8_t* buf, std::size_t size)
+{
+    if (size == 0 || this->is_body_complete) {
+        return 0;
+    }
+    if (this->mode == body_mode::content_length) {
+        auto length = static_cast<std::size_t>(std::min<std::uint64_t>(size, this->body_remaining));
+        auto result = this->take_buffered(buf, length);
+        if (result == 0) {
+            result = this->receive(buf, length, false);
+            if (result == 0) {
+                this->close();
+                throw std::runtime_error("HTTP connection closed before the end of the body");
+            }
+        }
+        this->body_remaining -= result;
+        this->is_body_complete = this->body_remaining == 0;
+        return result;
+    }
+    if (this->mode == body_mode::chunked) {
+        if (this->body_remaining == 0) {
+            auto line = this->read_line();
+            if (line.empty()) {
+                // The CRLF that terminates the previous chunk's data.
+                line = this->read_line();
+            }
+            char* end = nullptr;
+            auto chunk_size = std::strtoull(line.c_str(), &end, 16);
+            if (end == line.c_str() || (*end != '\0' && *end != ';' && *end != ' ' && *end != '\t')) {
+                this->close();
+                throw std::runtime_error("bad HTTP chunk size");
+            }
+            if (chunk_size == 0) {
+                // Skip trailer fields.
+                while (!this->read_line().empty()) {
+                }
+                this->is_body_complete = true;
+                return 0;
+            }
+            this->body_remaining = chunk_size;
+        }
+        auto length = static_cast<std::size_t>(std::min<std::uint64_t>(size, this->body_remaining));
+        auto result = this->take_buffered(buf, length);
+        if (result == 0) {
+            result = this->receive(buf, length, true);
+            if (result == 0) {
+                this->close();
+                throw std::runtime_error("HTTP connection closed before the end of the body");
+            }
+        }
+        this->body_remaining -= result;
+        return result;
+    }
+    auto result = this->take_buffered(buf, size);
+    if (result == 0) {
+        result = this->receive(buf, size, false);
+        if (result == 0) {
+            this->is_body_complete = true;
+        }
+    }
+    return result;
+}
+
+bool http_connection::is_reusable() const
+{
+    return this->fd != -1 && this->is_body_complete && this->is_keep_alive;
+}
+
+void http_connection::open_socket(const std::string& host, std::uint16_t port, bool is_blocking)
+{
+    this->close();
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* addresses = nullptr;
+    auto service = std::to_string(port);
+    if (::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses) != 0) {
+        throw std::runtime_error("failed to resolve HTTP host");
+    }
+    for (auto address = addresses; address != nullptr; address = address->ai_next) {
+        auto fd = ::socket(address->ai_family, address->ai_socktype | SOCK_CLOEXEC | (is_blocking ? 0 : SOCK_NONBLOCK), address->ai_protocol);
+        if (fd == -1) {
+            continue;
+        }
+        if (this->canceller != nullptr && !this->canceller->add_socket(fd)) {
+            ::close(fd);
+            ::freeaddrinfo(addresses);
+            throw std::runtime_error("HTTP connection cancelled");
+        }
+        impl::set_socket_options(fd);
+        int result = 0;
+        do {
+            result = ::connect(fd, address->ai_addr, address->ai_addrlen);
+        } while (result != 0 && errno == EINTR);
+        if (result == 0 || (!is_blocking && errno == EINPROGRESS)) {
+            this->fd = fd;
+            this->is_connect_pending = !is_blocking;
+            break;
+        }
+        this->close_socket(fd);
+    }
+    ::freeaddrinfo(addresses);
+    if (this->fd == -1) {
+        throw std::runtime_error("failed to connect to HTTP host");
+    }
+    this->connected_host = host;
+    this->connected_port = port;
+}
+
+void http_connection::close_socket(int fd)
+{
+    if (this->canceller != nullptr) {
+        this->canceller->close_socket(fd);
+    }
+    else {
+        ::close(fd);
+    }
+}
+
+void http_connection::finish_connect()
+{
+    this->is_connect_pending = false;
+    pollfd pfd = {};
+    pfd.fd = this->fd;
+    pfd.events = POLLOUT;
+    int result = 0;
+    do {
+        result = ::poll(&pfd, 1, impl::socket_timeout_seconds * 1000);
+    } while (result < 0 && errno == EINTR);
+    int error = 0;
+    socklen_t error_size = sizeof(error);
+    if (result <= 0 || ::getsockopt(this->fd, SOL_SOCKET, SO_ERROR, &error, &error_size) != 0 || error != 0) {
+        this->close();
+        throw std::runtime_error("failed to connect to HTTP host");
+    }
+    ::fcntl(this->fd, F_SETFL, ::fcntl(this->fd, F_GETFL) & ~O_NONBLOCK);
+}
+
+void http_connection::send_all(const std::string& data)
+{
+    if (this->is_connect_pending) {
+        this->finish_connect();
+    }
+    std::size_t sent = 0;
+    while (sent < data.size()) {
+        auto result = ::send(this->fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("failed to send HTTP request");
+        }
+        sent += static_cast<std::size_t>(result);
+    }
+}
+
+std::size_t http_connection::receive(std::uint8_t* buf, std::size_t size, bool allow_spill)
+{
+    // Only called with an empty connection buffer.
+    this->rx_begin = 0;
+    this->rx_end = 0;
+    for (;;) {
+        ssize_t result = 0;
+        if (allow_spill) {
+            // The body goes straight into the caller's buffer, the bytes that
+            // follow the current chunk land in ours.
+            iovec iov[2];
+            iov[0].iov_base = buf;
+            iov[0].iov_len = size;
+            iov[1].iov_base = this->rx_buffer.data();
+            iov[1].iov_len = this->rx_buffer.size();
+            result = ::readv(this->fd, iov, 2);
+        }
+        else {
+            result = ::recv(this->fd, buf, size, 0);
+        }
+        if (result >= 0) {
+            auto received = static_cast<std::size_t>(result);
+            if (received > size) {
+                this->rx_end = received - size;
+                received = size;
+            }
+            return received;
+        }
+        if (errno != EINTR) {
+            this->close();
+            impl::throw_socket_error();
+        }
+    }
+}
+
+void http_connection::fill_buffer()
+{
+    if (this->rx_begin != 0) {
+        std::memmove(this->rx_buffer.data(), this->rx_buffer.data() + this->rx_begin, this->rx_end - this->rx_begin);
+        this->rx_end -= this->rx_begin;
+        this->rx_begin = 0;
+    }
+    if (this->rx_end == this->rx_buffer.size()) {
+        throw std::runtime_error("HTTP line too long");
+    }
+    for (;;) {
+        auto result = ::recv(this->fd, this->rx_buffer.data() + this->rx_end, this->rx_buffer.size() - this->rx_end, 0);
+        if (result > 0) {
+            this->rx_end += static_cast<std::size_t>(result);
+            return;
+        }
+        if (result == 0) {
+            throw std::runtime_error("HTTP connection closed");
+        }
+        if (errno != EINTR) {
+            impl::throw_socket_error();
+        }
+    }
+}
+
+std::string http_connection::read_line()
+{
+    for (;;) {
+        auto begin = this->rx_buffer.data() + this->rx_begin;
+        auto end = this->rx_buffer.data() + this->rx_end;
+        auto lf = static_cast<std::uint8_t*>(std::memchr(begin, '\n', end - begin));
+        if (lf != nullptr) {
+            auto line_end = (lf != begin && *(lf - 1) == '\r') ? lf - 1 : lf;
+            std::string line(reinterpret_cast<const char*>(begin), line_end - begin);
+            this->rx_begin += static_cast<std::size_t>(lf + 1 - begin);
+            return line;
+        }
+        this->fill_buffer();
+    }
+}
+
+void http_connection::read_response(http_response& response)
+{
+    this->is_body_complete = false;
+    std::string status_line;
+    for (;;) {
+        status_line = this->read_line();
+        if (status_line.compare(0, 5, "HTTP/") != 0 || status_line.size() < 12) {
+            throw std::runtime_error("bad HTTP status line");
+        }
+        response.status_code = std::atoi(status_line.c_str() + 9);
+        response.headers.clear();
+        for (;;) {
+            auto line = this->read_line();
+            if (line.empty()) {
+                break;
+            }
+            auto colon = line.find(':');
+            if (colon == std::string::npos) {
+                throw std::runtime_error("bad HTTP header");
+            }
+            response.headers.emplace_back(line.substr(0, colon), impl::trim(line.substr(colon + 1)));
+        }
+        // Skip interim responses such as 100 Continue.
+        if (response.status_code < 100 || response.status_code >= 200 || response.status_code == 101) {
+            break;
+        }
+    }
+
+    this->is_keep_alive = status_line.compare(0, 8, "HTTP/1.0") != 0;
+    if (auto connection = response.find_header("Connection")) {
+        if (impl::icontains_token(*connection, "close")) {
+            this->is_keep_alive = false;
+        }
+        else if (impl::icontains_token(*connection, "keep-alive")) {
+            this->is_keep_alive = true;
+        }
+    }
+    this->body_remaining = 0;
+    auto transfer_encoding = response.find_header("Transfer-Encoding");
+    auto content_length = response.find_header("Content-Length");
+    if (response.status_code == 204 || response.status_code == 304) {
+        this->mode = body_mode::none;
+    }
+    else if (transfer_encoding != nullptr && impl::icontains_token(*transfer_encoding, "chunked")) {
+        this->mode = body_mode::chunked;
+    }
+    else if (content_length != nullptr) {
+        this->mode = body_mode::content_length;
+        this->body_remaining = std::strtoull(content_length->c_str(), nullptr, 10);
+    }
+    else {
+        this->mode = body_mode::until_close;
+        this->is_keep_alive = false;
+    }
+    this->is_body_complete = this->mode == body_mode::none
+        || (this->mode == body_mode::content_length && this->body_remaining == 0);
+}
+
+std::size_t http_connection::take_buffered(std::uint8_t* buf, std::size_t size)
+{
+    auto result = std::min(size, this->rx_end - this->rx_begin);
+    if (result != 0) {
+        std::memcpy(buf, this->rx_buffer.data() + this->rx_begin, result);
+        this->rx_begin += result;
+    }
+    return result;
+}
+
+http_read_stream_proxy::http_read_stream_proxy(const std::string& url, const std::vector<std::string>& extra_headers)
+    : extra_headers(extra_headers)
+    , canceller(std::make_shared<http_connection_canceller>())
+    , connection(canceller)
+    , is_opened(false)
+{
+    if (!http_url::parse(url, this->url)) {
+        throw std::runtime_error("bad HTTP URL");
+    }
+}
+
+http_read_stream_proxy::~http_read_stream_proxy()
+{
+}
+
+bool http_read_stream_proxy::can_seek() const
+{
+    return false;
+}
+
+coroutine::task<std::uint32_t> http_read_stream_proxy::read(std::uint8_t* buf, std::uint32_t size)
+{
+    if (!this->is_opened) {
+        this->open();
+    }
+    co_return static_cast<std::uint32_t>(this->connection.read_body(buf, size));
+}
+
+void http_read_stream_proxy::seek(std::uint64_t)
+{
+    throw std::runtime_error("bad operation");
+}
+
+void http_read_stream_proxy::cancel()
+{
+    this->canceller->cancel();
+}
+
+void http_read_stream_proxy::open()
+{
+    http_response response;
+    for (int i = 0; ; ++i) {
+        this->connection.request(this->url, this->extra_headers, response);
+        if (!impl::follow_redirect(response, this->url)) {
+            break;
+        }
+        if (i == impl::max_redirect_count) {
+            throw std::runtime_error("too many HTTP redirects");
+        }
+        // Redirect bodies are not worth draining.
+        if (!this->connection.is_reusable()) {
+            this->connection.close();
+        }
+    }
+    if (response.status_code < 200 || response.status_code >= 300) {
+        throw std::runtime_error("unexpected HTTP status");
+    }
+    this->is_opened = true;
+}
+
+http_range_read_stream_proxy::http_range_read_stream_proxy(const std::string& url, const std::vector<std::string>& extra_headers, bool is_speculative)
+    : extra_headers(extra_headers)
+    , is_speculative(is_speculative)
+    , canceller(std::make_shared<http_connection_canceller>())
+    , speculative_position(impl::unknown_position)
+    , is_streaming(false)
+    , is_followup_pending(false)
+    , is_range_supported(false)
+    , stream_position(0)
+    , position(0)
+    , range_end(impl::unknown_position)
+    , content_length(impl::unknown_position)
+{
+    if (!http_url::parse(url, this->url)) {
+        throw std::runtime_error("bad HTTP URL");
+    }
+}
+
+http_range_read_stream_proxy::~http_range_read_stream_proxy()
+{
+}
+
+bool http_range_read_stream_proxy::can_seek() const
+{
+    return this->is_range_supported;
+}
+
+coroutine::task<std::uint32_t> http_range_read_stream_proxy::read(std::uint8_t* buf, std::uint32_t size)
+{
+    if (size == 0 || this->position >= this->content_length) {
+        co_return 0;
+    }
+    if (this->is_streaming && this->stream_position != this->position) {
+        if (this->position > this->stream_position && this->position - this->stream_position <= impl::max_skip_size) {
+            while (this->is_streaming && this->stream_position < this->position) {
+                auto length = static_cast<std::size_t>(std::min<std::uint64_t>(size, this->position - this->stream_position));
+                if (this->read_stream(buf, length) == 0) {
+                    break;
+                }
+            }
+        }
+        if (this->stream_position != this->position) {
+            this->active.reset();
+            this->is_streaming = false;
+        }
+    }
+    std::size_t result = 0;
+    // The second attempt resumes a response that broke off or ended early.
+    for (int i = 0; i < 2; ++i) {
+        if (!this->is_streaming) {
+            this->start_streaming();
+            if (!this->is_streaming) {
+                break;
+            }
+        }
+        try {
+            result = this->read_stream(buf, size);
+        }
+        catch (const std::runtime_error&) {
+            if (i != 0) {
+                throw;
+            }
+            this->active.reset();
+            this->is_streaming = false;
+            continue;
+        }
+        if (result != 0 || this->content_length == impl::unknown_position || this->stream_position >= this->content_length) {
+            break;
+        }
+    }
+    this->position += result;
+    if (this->speculative != nullptr && this->speculative_position == impl::unknown_position) {
+        this->send_speculative_request();
+    }
+    co_return static_cast<std::uint32_t>(result);
+}
+
+void http_range_read_stream_proxy::seek(std::uint64_t pos)
+{
+    this->position = pos;
+    this->range_end = impl::unknown_position;
+}
+
+void http_range_read_stream_proxy::seek_range(std::uint64_t pos, std::uint64_t size)
+{
+    this->position = pos;
+    this->range_end = size < impl::unknown_position - pos ? pos + size : impl::unknown_position;
+}
+
+void http_range_read_stream_proxy::set_seek_points(const std::vector<std::uint64_t>& positions)
+{
+    this->seek_points = positions;
+    std::sort(this->seek_points.begin(), this->seek_points.end());
+}
+
+void http_range_read_stream_proxy::cancel()
+{
+    this->canceller->cancel();
+}
+
+void http_range_read_stream_proxy::start_streaming()
+{
+    this->is_streaming = false;
+    this->is_followup_pending = false;
+    if (this->adopt_speculative()) {
+        return;
+    }
+    auto last = this->range_end != impl::unknown_position && this->range_end > this->position
+        ? this->range_end - 1 : impl::unknown_position;
+    http_response response;
+    for (int i = 0; ; ++i) {
+        std::unique_ptr<http_connection> connection;
+        if (this->active != nullptr && this->active->is_reusable()) {
+            connection = std::move(this->active);
+        }
+        else if (this->spare != nullptr) {
+            connection = std::move(this->spare);
+        }
+        else {
+            connection = std::make_unique<http_connection>(this->canceller);
+        }
+        this->active.reset();
+        bool is_reused = connection->is_connected();
+        if (!is_reused) {
+            connection->connect(this->url.host, this->url.port);
+        }
+        try {
+            this->send_range_request(*connection, this->position, last);
+        }
+        catch (const std::runtime_error&) {
+            if (!is_reused) {
+                throw;
+            }
+            connection->connect(this->url.host, this->url.port);
+            this->send_range_request(*connection, this->position, last);
+            is_reused = false;
+        }
+        this->active = std::move(connection);
+        // The handshakes for later seeks overlap with this round trip.
+        this->open_warm_connections();
+        try {
+            this->active->read_response(response);
+        }
+        catch (const std::runtime_error&) {
+            if (!is_reused) {
+                throw;
+            }
+            // An idle connection the server has closed in the meantime.
+            this->active->connect(this->url.host, this->url.port);
+            this->send_range_request(*this->active, this->position, last);
+            this->active->read_response(response);
+        }
+        if (!impl::follow_redirect(response, this->url)) {
+            break;
+        }
+        if (i == impl::max_redirect_count) {
+            throw std::runtime_error("too many HTTP redirects");
+        }
+        // Warm connections may point at the old host.
+        this->active.reset();
+        this->spare.reset();
+        this->speculative.reset();
+        this->speculative_position = impl::unknown_position;
+    }
+    this->is_streaming = this->check_range_response(response, this->position);
+    this->stream_position = this->position;
+    this->send_speculative_request();
+}
+
+bool http_range_read_stream_proxy::adopt_speculative()
+{
+    if (this->speculative == nullptr || this->speculative_position != this->position) {
+        return false;
+    }
+    this->active = std::move(this->speculative);
+    this->speculative_position = impl::unknown_position;
+    http_response response;
+    try {
+        this->active->read_response(response);
+        if (!this->check_range_response(response, this->position)) {
+            this->active.reset();
+            return false;
+        }
+    }
+    catch (const std::runtime_error&) {
+        this->active.reset();
+        return false;
+    }
+    this->is_streaming = true;
+    this->stream_position = this->position;
+    // Ask for the rest right away, the response follows the speculative range
+    // on the same connection.
+    auto followup_position = this->position + impl::speculative_range_size;
+    if (followup_position < this->content_length) {
+        try {
+            this->send_range_request(*this->active, followup_position, impl::unknown_position);
+            this->is_followup_pending = true;
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+    this->open_warm_connections();
+    return true;
+}
+
+void http_range_read_stream_proxy::send_range_request(http_connection& connection, std::uint64_t first, std::uint64_t last)
+{
+    auto headers = this->extra_headers;
+    auto range = "Range: bytes=" + std::to_string(first) + "-";
+    if (last != impl::unknown_position) {
+        range += std::to_string(last);
+    }
+    headers.push_back(std::move(range));
+    connection.send_request(this->url, headers);
+}
+
+void http_range_read_stream_proxy::open_warm_connections()
+{
+    if (this->spare == nullptr) {
+        auto connection = std::make_unique<http_connection>(this->canceller);
+        try {
+            connection->start_connect(this->url.host, this->url.port);
+            this->spare = std::move(connection);
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+    if (!this->is_speculative || this->seek_points.empty()) {
+        return;
+    }
+    // A speculative range behind the position is unlikely to be wanted.
+    if (this->speculative != nullptr && this->speculative_position != impl::unknown_position
+        && this->speculative_position < this->position) {
+        this->speculative.reset();
+        this->speculative_position = impl::unknown_position;
+    }
+    if (this->speculative == nullptr) {
+        auto connection = std::make_unique<http_connection>(this->canceller);
+        try {
+            connection->start_connect(this->url.host, this->url.port);
+            this->speculative = std::move(connection);
+        }
+        catch (const std::runtime_error&) {
+        }
+    }
+}
+
+void http_range_read_stream_proxy::send_speculative_request()
+{
+    if (this->speculative == nullptr || this->speculative_position != impl::unknown_position) {
+        return;
+    }
+    // Bet on the first seek point past the skip distance, i.e. the next
+    // keyframe a "skip forward" lands on.
+    auto iter = std::upper_bound(this->seek_points.begin(), this->seek_points.end(), this->position + impl::max_skip_size);
+    if (iter == this->seek_points.end() || *iter >= this->content_length) {
+        return;
+    }
+    try {
+        if (this->speculative->is_connecting()) {
+            return;
+        }
+        this->send_range_request(*this->speculative, *iter, *iter + impl::speculative_range_size - 1);
+        this->speculative_position = *iter;
+    }
+    catch (const std::runtime_error&) {
+        this->speculative.reset();
+    }
+}
+
+bool http_range_read_stream_proxy::check_range_response(const http_response& response, std::uint64_t first)
+{
+    if (response.status_code == 206) {
+        // Content-Range: bytes first-last/length
+        auto content_range = response.find_header("Content-Range");
+        if (content_range == nullptr || content_range->compare(0, 6, "bytes ") != 0) {
+            throw std::runtime_error("bad HTTP Content-Range");
+        }
+        char* end = nullptr;
+        auto range_first = std::strtoull(content_range->c_str() + 6, &end, 10);
+        auto slash = content_range->find('/');
+        if (range_first != first || slash == std::string::npos) {
+            throw std::runtime_error("bad HTTP Content-Range");
+        }
+        if ((*content_range)[slash + 1] != '*') {
+            this->content_length = std::strtoull(content_range->c_str() + slash + 1, nullptr, 10);
+        }
+        this->is_range_supported = true;
+        return true;
+    }
+    if (response.status_code == 200 && first == 0) {
+        // The whole resource, but no seeking.
+        if (auto content_length = response.find_header("Content-Length")) {
+            this->content_length = std::strtoull(content_length->c_str(), nullptr, 10);
+        }
+        return true;
+    }
+    if (response.status_code == 416) {
+        // Past the end of the resource.
+        this->content_length = std::min(this->content_length, first);
+        return false;
+    }
+    if (response.status_code == 200) {
+        throw std::runtime_error("HTTP server does not support range requests");
+    }
+    throw std::runtime_error("unexpected HTTP status");
+}
+
+std::size_t http_range_read_stream_proxy::read_stream(std::uint8_t* buf, std::size_t size)
+{
+    for (;;) {
+        auto result = this->active->read_body(buf, size);
+        if (result != 0) {
+            this->stream_position += result;
+            return result;
+        }
+        if (!this->is_followup_pending) {
+            this->is_streaming = false;
+            return 0;
+        }
+        // The speculative range is done, continue with the pipelined request.
+        this->is_followup_pending = false;
+        http_response response;
+        this->active->read_response(response);
+        if (!this->check_range_response(response, this->stream_position)) {
+            this->is_streaming = false;
+            return 0;
+        }
+    }
+}
+
+} // namespace io
+} // namespace dawn_player
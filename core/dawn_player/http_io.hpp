@@ -0,0 +1,212 @@
+/*
+ *    http_io.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_HTTP_IO_HPP
+#define DAWN_PLAYER_HTTP_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "io.hpp"
+
+namespace dawn_player {
+namespace io {
+
+struct http_url {
+    std::string host;
+    std::uint16_t port = 80;
+    // Path and query, "/" if empty.
+    std::string target;
+    // Only plain http:// URLs are supported.
+    static bool parse(const std::string& url, http_url& result);
+};
+
+struct http_response {
+    int status_code = 0;
+    std::vector<std::pair<std::string, std::string>> headers;
+    // Case-insensitive lookup, returns nullptr if the header is missing.
+    const std::string* find_header(const std::string& name) const;
+};
+
+struct http_resource_info {
+    // Empty if the server sent no ETag.
+    std::string entity_tag;
+    // UINT64_MAX if the server did not tell.
+    std::uint64_t content_length = UINT64_MAX;
+};
+
+// Asks the server for the ETag and length of url with a one byte range
+// request, e.g. to build a cache key. Redirects are followed.
+http_resource_info probe_http_resource(const std::string& url, const std::vector<std::string>& extra_headers = std::vector<std::string>());
+
+// Shuts down the sockets of the connections sharing it from another thread,
+// so that a request or receive blocked on one of them fails soon.
+// Connections that open a socket after cancel() fail right away.
+class http_connection_canceller {
+public:
+    void cancel();
+private:
+    friend class http_connection;
+    // False once cancelled, the caller then closes fd itself.
+    bool add_socket(int fd);
+    void close_socket(int fd);
+private:
+    std::mutex mtx;
+    std::vector<int> fds;
+    bool is_cancelled = false;
+};
+
+// A blocking HTTP/1.1 client connection over a TCP socket. Responses are
+// read with Content-Length, chunked transfer coding or until the server
+// closes the connection. Body bytes are received with readv() straight into
+// the caller's buffer, only bytes beyond the current chunk spill into the
+// connection's own buffer. The connection can be reused for the next request
+// when the server keeps it alive.
+class http_connection {
+public:
+    explicit http_connection(const std::shared_ptr<http_connection_canceller>& canceller = nullptr);
+    http_connection(const http_connection&) = delete;
+    http_connection& operator=(const http_connection&) = delete;
+    ~http_connection();
+
+    void connect(const std::string& host, std::uint16_t port);
+    // Starts connecting without waiting for the handshake, the first
+    // send_request() finishes it.
+    void start_connect(const std::string& host, std::uint16_t port);
+    bool is_connected() const;
+    // True while the handshake started by start_connect() is in progress,
+    // does not block.
+    bool is_connecting();
+    void close();
+    // Sends a GET request and reads the response head. extra_headers are
+    // complete header lines without the trailing CRLF. A reused connection
+    // that the server has closed in the meantime is reopened once.
+    void request(const http_url& url, const std::vector<std::string>& extra_headers, http_response& response);
+    // The two halves of request(), for callers that want to do other work
+    // while the response is on its way. A request may be sent before the
+    // body of the previous response was read (pipelining), its response is
+    // read once that body is complete.
+    void send_request(const http_url& url, const std::vector<std::string>& extra_headers);
+    void read_response(http_response& response);
+    // Reads up to size bytes of the response body, returns 0 at its end.
+    std::size_t read_body(std::uint8_t* buf, std::size_t size);
+    // True once the whole body was read and the server keeps the connection
+    // alive, the next request may then be sent on it.
+    bool is_reusable() const;
+private:
+    enum class body_mode {
+        none,
+        content_length,
+        chunked,
+        until_close,
+    };
+    void open_socket(const std::string& host, std::uint16_t port, bool is_blocking);
+    void close_socket(int fd);
+    void finish_connect();
+    void send_all(const std::string& data);
+    std::size_t receive(std::uint8_t* buf, std::size_t size, bool allow_spill);
+    void fill_buffer();
+    std::string read_line();
+    std::size_t take_buffered(std::uint8_t* buf, std::size_t size);
+private:
+    std::shared_ptr<http_connection_canceller> canceller;
+    int fd;
+    std::string connected_host;
+    std::uint16_t connected_port;
+    std::vector<std::uint8_t> rx_buffer;
+    std::size_t rx_begin;
+    std::size_t rx_end;
+    body_mode mode;
+    std::uint64_t body_remaining;
+    bool is_body_complete;
+    bool is_keep_alive;
+    bool is_connect_pending;
+};
+
+// Streams a remote FLV (e.g. HTTP-FLV live) over HTTP/1.1. Redirects to
+// other http:// URLs are followed. read() blocks the calling thread until
+// data arrives, so the player should run on a task service with its own
+// thread.
+class http_read_stream_proxy : public read_stream_proxy {
+public:
+    explicit http_read_stream_proxy(const std::string& url, const std::vector<std::string>& extra_headers = std::vector<std::string>());
+    virtual ~http_read_stream_proxy();
+    virtual bool can_seek() const;
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
+    virtual void seek(std::uint64_t pos);
+    virtual void cancel();
+private:
+    void open();
+private:
+    http_url url;
+    std::vector<std::string> extra_headers;
+    std::shared_ptr<http_connection_canceller> canceller;
+    http_connection connection;
+    bool is_opened;
+};
+
+// Reads a remote FLV (VOD) with HTTP Range requests, so that it can seek.
+// A seek costs one round trip: the new range request goes out on a spare
+// connection that was opened while an earlier response was on its way.
+// Short forward seeks are served by skipping bytes of the current response.
+// With is_speculative set, a small range at the next seek point ahead (see
+// set_seek_points()) is requested in advance, seeking there costs no round
+// trip at all. Like http_read_stream_proxy, read() blocks the calling thread.
+class http_range_read_stream_proxy : public read_stream_proxy {
+public:
+    explicit http_range_read_stream_proxy(const std::string& url, const std::vector<std::string>& extra_headers = std::vector<std::string>(), bool is_speculative = false);
+    virtual ~http_range_read_stream_proxy();
+    // False until the server has answered a range request with 206.
+    virtual bool can_seek() const;
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
+    virtual void seek(std::uint64_t pos);
+    // Requests end at pos + size instead of the end of the resource, the
+    // connection can then be reused for the next range right away.
+    virtual void seek_range(std::uint64_t pos, std::uint64_t size);
+    virtual void set_seek_points(const std::vector<std::uint64_t>& positions);
+    virtual void cancel();
+private:
+    void start_streaming();
+    bool adopt_speculative();
+    void send_range_request(http_connection& connection, std::uint64_t first, std::uint64_t last);
+    void open_warm_connections();
+    void send_speculative_request();
+    bool check_range_response(const http_response& response, std::uint64_t first);
+    std::size_t read_stream(std::uint8_t* buf, std::size_t size);
+private:
+    http_url url;
+    std::vector<std::string> extra_headers;
+    bool is_speculative;
+    std::vector<std::uint64_t> seek_points;
+    std::shared_ptr<http_connection_canceller> canceller;
+    std::unique_ptr<http_connection> active;
+    // Connected and idle, takes the next range request.
+    std::unique_ptr<http_connection> spare;
+    // Has a range request at speculative_position in flight.
+    std::unique_ptr<http_connection> speculative;
+    std::uint64_t speculative_position;
+    bool is_streaming;
+    bool is_followup_pending;
+    bool is_range_supported;
+    // Position of the next byte of the active response.
+    std::uint64_t stream_position;
+    std::uint64_t position;
+    // End of the range given to seek_range(), UINT64_MAX if none.
+    std::uint64_t range_end;
+    // UINT64_MAX until the server tells.
+    std::uint64_t content_length;
+};
+
+} // namespace io
+} // namespace dawn_player
+
+#endif
@@ -9,13 +9,11 @@
 #define DAWN_PLAYER_IO_HPP
 
 #include <cstdint>
-
-#include <winrt/Windows.Storage.Streams.h>
+#include <utility>
+#include <vector>
 
 #include "coroutine/task.hpp"
 
-using namespace winrt::Windows::Storage::Streams;
-
 namespace dawn_player {
 namespace io {
 
@@ -24,28 +22,30 @@ struct read_stream_proxy {
     virtual bool can_seek() const = 0;
     virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size) = 0;
     virtual void seek(std::uint64_t pos) = 0;
-};
-
-class ramdon_access_read_stream_proxy : public read_stream_proxy {
-public:
-    ramdon_access_read_stream_proxy(IRandomAccessStream stream);
-    virtual ~ramdon_access_read_stream_proxy();
-    virtual bool can_seek() const;
-    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
-    virtual void seek(std::uint64_t pos);
-private:
-    IRandomAccessStream target;
-};
-
-class input_read_stream_proxy : public read_stream_proxy {
-public:
-    input_read_stream_proxy(IInputStream stream);
-    virtual ~input_read_stream_proxy();
-    virtual bool can_seek() const;
-    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
-    virtual void seek(std::uint64_t pos);
-private:
-    IInputStream target;
+    // Like seek(), but at most size bytes will be read before the next seek.
+    // Proxies that fetch ahead may use it to fetch no further.
+    virtual void seek_range(std::uint64_t pos, std::uint64_t /* size */) { this->seek(pos); }
+    // Proxies whose data is already in memory may expose it instead of
+    // copying it out in read(). On success data points at the byte at the
+    // current position and size is the number of bytes from there to the end
+    // of the stream, the view stays valid until the proxy is destroyed. The
+    // caller moves the position forward with consume(). Returns false if the
+    // proxy has no such view, the caller then uses read().
+    virtual bool get_view(const std::uint8_t*& /* data */, std::uint64_t& /* size */) { return false; }
+    virtual void consume(std::uint64_t /* size */) {}
+    // Called with the byte positions of the keyframes once the player knows
+    // them, i.e. the positions seek() will be called with. Proxies for which
+    // seeking is expensive may use them to prepare.
+    virtual void set_seek_points(const std::vector<std::uint64_t>& /* positions */) {}
+    // Proxies that index the stream themselves, e.g. over a live stream
+    // without onMetaData keyframes, fill keyframes with (time in seconds,
+    // byte position) pairs of the keyframes seek() can currently go to.
+    // Returns false if the proxy keeps no such index.
+    virtual bool get_keyframes(std::vector<std::pair<double, std::uint64_t>>& /* keyframes */) { return false; }
+    // May be called from another thread to make a read() blocked in the proxy
+    // fail or return soon, e.g. by shutting its connections down. The proxy
+    // is not read from again afterwards.
+    virtual void cancel() {}
 };
 
 } // namespace io
@@ -0,0 +1,84 @@
+/*
+ *    mpsc_task_queue.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_MPSC_TASK_QUEUE_HPP
+#define DAWN_PLAYER_MPSC_TASK_QUEUE_HPP
+
+#include <atomic>
+
+#include "task_service.hpp"
+
+namespace dawn_player {
+namespace impl {
+
+// Intrusive lock-free multi-producer single-consumer queue of task nodes
+// (Dmitry Vyukov's algorithm). push() may be called from any thread, pop()
+// and empty() only from the consumer thread.
+class mpsc_task_queue {
+    // Written by the producers, tail by the consumer, kept apart so that
+    // they do not share a cache line.
+    alignas(64) std::atomic<task_node*> head;
+    alignas(64) task_node* tail;
+    task_node stub;
+public:
+    mpsc_task_queue()
+        : head(&stub)
+        , tail(&stub)
+    {
+    }
+
+    mpsc_task_queue(const mpsc_task_queue&) = delete;
+    mpsc_task_queue& operator=(const mpsc_task_queue&) = delete;
+
+    void push(task_node* node)
+    {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        auto prev = this->head.exchange(node, std::memory_order_seq_cst);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // Returns nullptr if the queue is empty or a producer is in the middle
+    // of a push. In the latter case empty() returns false.
+    task_node* pop()
+    {
+        auto tail = this->tail;
+        auto next = tail->next.load(std::memory_order_acquire);
+        if (tail == &this->stub) {
+            if (next == nullptr) {
+                return nullptr;
+            }
+            this->tail = next;
+            tail = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next != nullptr) {
+            this->tail = next;
+            return tail;
+        }
+        if (tail != this->head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        this->push(&this->stub);
+        next = tail->next.load(std::memory_order_acquire);
+        if (next != nullptr) {
+            this->tail = next;
+            return tail;
+        }
+        return nullptr;
+    }
+
+    bool empty() const
+    {
+        return this->tail == &this->stub
+            && this->head.load(std::memory_order_seq_cst) == &this->stub;
+    }
+};
+
+} // namespace impl
+} // namespace dawn_player
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ *    output_support.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <stdexcept>
+
+#include <sys/uio.h>
+
+#include "output_support.hpp"
+
+namespace dawn_player {
+namespace impl {
+
+#ifdef IOV_MAX
+const std::size_t max_iovec_count = IOV_MAX;
+#else
+const std::size_t max_iovec_count = 1024;
+#endif
+
+void skip_iovecs(iovec*& iovecs, std::size_t& count, std::size_t size)
+{
+    while (count != 0 && size >= iovecs->iov_len) {
+        size -= iovecs->iov_len;
+        ++iovecs;
+        --count;
+    }
+    if (count != 0) {
+        iovecs->iov_base = static_cast<std::uint8_t*>(iovecs->iov_base) + size;
+        iovecs->iov_len -= size;
+    }
+}
+
+void write_iovecs(int fd, iovec* iovecs, std::size_t count, std::size_t& written)
+{
+    while (count != 0) {
+        auto result = ::writev(fd, iovecs, static_cast<int>(std::min(count, max_iovec_count)));
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error("failed to write file");
+        }
+        written += static_cast<std::size_t>(result);
+        skip_iovecs(iovecs, count, static_cast<std::size_t>(result));
+    }
+}
+
+} // namespace impl
+} // namespace dawn_player
@@ -0,0 +1,90 @@
+/*
+ *    output_support.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_OUTPUT_SUPPORT_HPP
+#define DAWN_PLAYER_OUTPUT_SUPPORT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct iovec;
+
+namespace dawn_player {
+namespace impl {
+
+// Big-endian integers, as FLV and MP4 store them, appended to out.
+
+inline void put_uint8(std::vector<std::uint8_t>& out, std::uint8_t value)
+{
+    out.push_back(value);
+}
+
+inline void put_uint16_be(std::vector<std::uint8_t>& out, std::uint16_t value)
+{
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+inline void put_uint24_be(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    out.push_back(static_cast<std::uint8_t>(value >> 16));
+    put_uint16_be(out, static_cast<std::uint16_t>(value));
+}
+
+inline void put_uint32_be(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    put_uint16_be(out, static_cast<std::uint16_t>(value >> 16));
+    put_uint16_be(out, static_cast<std::uint16_t>(value));
+}
+
+inline void put_uint64_be(std::vector<std::uint8_t>& out, std::uint64_t value)
+{
+    put_uint32_be(out, static_cast<std::uint32_t>(value >> 32));
+    put_uint32_be(out, static_cast<std::uint32_t>(value));
+}
+
+// The same stored at data, and read back from there.
+
+inline void store_uint24_be(std::uint8_t* data, std::uint32_t value)
+{
+    data[0] = static_cast<std::uint8_t>(value >> 16);
+    data[1] = static_cast<std::uint8_t>(value >> 8);
+    data[2] = static_cast<std::uint8_t>(value);
+}
+
+inline void store_uint32_be(std::uint8_t* data, std::uint32_t value)
+{
+    data[0] = static_cast<std::uint8_t>(value >> 24);
+    store_uint24_be(data + 1, value);
+}
+
+inline std::uint32_t read_uint24_be(const std::uint8_t* data)
+{
+    return (static_cast<std::uint32_t>(data[0]) << 16) | (static_cast<std::uint32_t>(data[1]) << 8) | data[2];
+}
+
+inline std::uint32_t read_uint32_be(const std::uint8_t* data)
+{
+    return (static_cast<std::uint32_t>(data[0]) << 24) | read_uint24_be(data + 1);
+}
+
+// Defined on POSIX systems only.
+
+// Moves iovecs past size bytes, leaving the rest of a partly covered iovec
+// in front.
+void skip_iovecs(iovec*& iovecs, std::size_t& count, std::size_t size);
+
+// Writes iovecs to fd in full with as many writev() calls as it takes, and
+// adds the bytes written to written as it goes, so that a caller catching
+// the std::runtime_error thrown on failure knows how far it got.
+void write_iovecs(int fd, iovec* iovecs, std::size_t count, std::size_t& written);
+
+} // namespace impl
+} // namespace dawn_player
+
+#endif
@@ -0,0 +1,355 @@
+/*
+ *    parallel_io.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include "coroutine/sync_wait.hpp"
+#include "parallel_io.hpp"
+
+namespace dawn_player {
+namespace io {
+namespace impl {
+
+const std::uint64_t initial_range_size = 256 * 1024;
+const std::uint64_t min_range_size = 64 * 1024;
+const std::uint64_t max_range_size = 8 * 1024 * 1024;
+const int max_attempt_count = 3;
+// Weight of the newest measurement in the running averages.
+const double measurement_weight = 0.25;
+
+void release_front_segment(parallel_read_context& ctx)
+{
+    auto segment = std::move(ctx.segments.front());
+    ctx.segments.pop_front();
+    ctx.buffered_size -= segment->size;
+    if (!segment->is_complete) {
+        segment->is_cancelled = true;
+    }
+    else if (ctx.free_buffers.size() < ctx.worker_count) {
+        // The worker is done with it, keep the pages for the next range.
+        ctx.free_buffers.push_back(std::move(segment->data));
+    }
+}
+
+std::shared_ptr<parallel_read_segment> take_segment(parallel_read_context& ctx, std::size_t worker_index)
+{
+    if (ctx.seekability != parallel_seekability::seekable && worker_index != 0) {
+        return nullptr;
+    }
+    // A range whose fetch failed goes to the next free worker first.
+    for (const auto& segment : ctx.segments) {
+        if (!segment->is_assigned) {
+            segment->is_assigned = true;
+            return segment;
+        }
+    }
+    if (ctx.next_offset >= ctx.end_offset) {
+        return nullptr;
+    }
+    if (!ctx.segments.empty() && ctx.buffered_size + ctx.range_size > ctx.max_buffered_size) {
+        return nullptr;
+    }
+    auto segment = std::make_shared<parallel_read_segment>();
+    segment->start = ctx.next_offset;
+    segment->size = std::min(ctx.range_size, ctx.end_offset - ctx.next_offset);
+    segment->is_assigned = true;
+    ctx.next_offset += segment->size;
+    ctx.buffered_size += segment->size;
+    ctx.segments.push_back(segment);
+    return segment;
+}
+
+void update_range_size(parallel_read_context& ctx, double first_byte_seconds, double transfer_seconds, std::uint64_t size)
+{
+    auto weight = ctx.first_byte_seconds == 0.0 ? 1.0 : measurement_weight;
+    ctx.first_byte_seconds += (first_byte_seconds - ctx.first_byte_seconds) * weight;
+    // Transfers that short say nothing about the throughput.
+    if (transfer_seconds > 0.001) {
+        weight = ctx.bytes_per_second == 0.0 ? 1.0 : measurement_weight;
+        ctx.bytes_per_second += (static_cast<double>(size) / transfer_seconds - ctx.bytes_per_second) * weight;
+    }
+    if (ctx.bytes_per_second == 0.0) {
+        return;
+    }
+    // Transferring a range should take about four round trips, so that the
+    // request costs a connection at most a fifth of its time.
+    auto target = static_cast<std::uint64_t>(ctx.bytes_per_second * ctx.first_byte_seconds * 4);
+    auto limit = std::max(min_range_size, std::min(max_range_size, ctx.max_buffered_size / (ctx.worker_count * 2)));
+    target = std::clamp(target, min_range_size, limit);
+    ctx.range_size = target / min_range_size * min_range_size;
+}
+
+void worker_proc(const std::shared_ptr<parallel_read_context>& ctx, std::size_t worker_index)
+{
+    std::shared_ptr<read_stream_proxy> proxy;
+    std::uint64_t proxy_position = 0;
+    std::unique_lock<std::mutex> lck(ctx->mtx);
+    for (;;) {
+        std::shared_ptr<parallel_read_segment> segment;
+        ctx->worker_cv.wait(lck, [&]() {
+            return ctx->is_stopped || (segment = take_segment(*ctx, worker_index)) != nullptr;
+        });
+        if (ctx->is_stopped) {
+            ctx->proxies[worker_index].reset();
+            break;
+        }
+        ++segment->attempt_count;
+        // A failed attempt is resumed where it stopped.
+        auto offset = segment->filled;
+        auto initial_offset = offset;
+        auto start = segment->start;
+        auto size = segment->size;
+        auto seekability = ctx->seekability;
+        if (segment->data.empty() && !ctx->free_buffers.empty()) {
+            segment->data = std::move(ctx->free_buffers.back());
+            ctx->free_buffers.pop_back();
+        }
+        lck.unlock();
+
+        // The reader does not touch the data before filled is published.
+        segment->data.resize(static_cast<std::size_t>(size));
+        auto request_time = std::chrono::steady_clock::now();
+        double first_byte_seconds = -1.0;
+        bool is_end = false;
+        std::exception_ptr error;
+        try {
+            if (proxy == nullptr) {
+                proxy = ctx->open_proxy();
+                proxy_position = 0;
+                lck.lock();
+                ctx->proxies[worker_index] = proxy;
+                if (ctx->is_stopped) {
+                    // Opened after the destructor cancelled the others.
+                    proxy->cancel();
+                }
+                lck.unlock();
+            }
+            if (seekability != parallel_seekability::sequential) {
+                proxy->seek_range(start + offset, size - offset);
+            }
+            else if (proxy_position != start + offset) {
+                throw std::runtime_error("bad operation");
+            }
+            while (offset < size) {
+                auto length = static_cast<std::uint32_t>(std::min<std::uint64_t>(size - offset, std::numeric_limits<std::uint32_t>::max()));
+                auto result = coroutine::sync_wait_task(proxy->read(segment->data.data() + offset, length));
+                if (first_byte_seconds < 0.0) {
+                    first_byte_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - request_time).count();
+                }
+                if (result == 0) {
+                    is_end = true;
+                    break;
+                }
+                offset += result;
+                proxy_position = start + offset;
+                lck.lock();
+                bool is_resolved = false;
+                if (ctx->seekability == parallel_seekability::unknown) {
+                    // The proxy has answered, e.g. with 206 or 200, so it
+                    // knows by now. The reader gets no byte before this is
+                    // settled, so can_seek() is right from the file header
+                    // on, and the other workers may start right away.
+                    ctx->seekability = proxy->can_seek() ? parallel_seekability::seekable : parallel_seekability::sequential;
+                    is_resolved = true;
+                }
+                segment->filled = offset;
+                bool is_cancelled = segment->is_cancelled || ctx->is_stopped;
+                lck.unlock();
+                ctx->data_event.set();
+                if (is_resolved) {
+                    ctx->worker_cv.notify_all();
+                }
+                if (is_cancelled) {
+                    break;
+                }
+            }
+        }
+        catch (...) {
+            error = std::current_exception();
+            proxy.reset();
+        }
+        auto total_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - request_time).count();
+
+        lck.lock();
+        // Still unknown if the stream is empty.
+        if (ctx->seekability == parallel_seekability::unknown && error == nullptr) {
+            ctx->seekability = proxy->can_seek() ? parallel_seekability::seekable : parallel_seekability::sequential;
+        }
+        if (error != nullptr) {
+            if (segment->attempt_count < max_attempt_count && !segment->is_cancelled
+                && ctx->seekability != parallel_seekability::sequential) {
+                segment->is_assigned = false;
+                ctx->worker_cv.notify_all();
+                continue;
+            }
+            segment->error = error;
+        }
+        else if (is_end) {
+            // The stream ends inside this range, drop the ranges past it.
+            ctx->end_offset = std::min(ctx->end_offset, start + offset);
+            ctx->next_offset = std::min(ctx->next_offset, ctx->end_offset);
+            while (!ctx->segments.empty() && ctx->segments.back()->start >= ctx->end_offset) {
+                ctx->segments.back()->is_cancelled = true;
+                ctx->buffered_size -= ctx->segments.back()->size;
+                ctx->segments.pop_back();
+            }
+        }
+        else if (offset == size && !segment->is_cancelled) {
+            update_range_size(*ctx, first_byte_seconds, total_seconds - first_byte_seconds, size - initial_offset);
+        }
+        segment->is_complete = true;
+        // A reader resumed by the event runs on this thread and takes the
+        // lock itself.
+        lck.unlock();
+        ctx->data_event.set();
+        ctx->worker_cv.notify_all();
+        lck.lock();
+    }
+}
+
+} // namespace impl
+
+parallel_read_stream_proxy::parallel_read_stream_proxy(std::function<std::shared_ptr<read_stream_proxy>()>&& open_proxy,
+    std::size_t connection_count, std::uint64_t max_buffered_size)
+    : ctx(std::make_shared<impl::parallel_read_context>())
+    , position(0)
+{
+    this->ctx->open_proxy = std::move(open_proxy);
+    this->ctx->end_offset = std::numeric_limits<std::uint64_t>::max();
+    this->ctx->worker_count = std::max<std::size_t>(connection_count, 1);
+    this->ctx->max_buffered_size = std::max(max_buffered_size, impl::initial_range_size * this->ctx->worker_count);
+    this->ctx->range_size = impl::initial_range_size;
+    this->ctx->proxies.resize(this->ctx->worker_count);
+    for (std::size_t i = 0; i < this->ctx->worker_count; ++i) {
+        auto ctx = this->ctx;
+        this->workers.emplace_back([ctx, i]() {
+            impl::worker_proc(ctx, i);
+        });
+    }
+}
+
+parallel_read_stream_proxy::~parallel_read_stream_proxy()
+{
+    std::vector<std::shared_ptr<read_stream_proxy>> proxies;
+    {
+        std::unique_lock<std::mutex> lck(this->ctx->mtx);
+        this->ctx->is_stopped = true;
+        while (!this->ctx->segments.empty()) {
+            impl::release_front_segment(*this->ctx);
+        }
+        proxies = this->ctx->proxies;
+    }
+    // Shut the connections down, a worker blocked in a read then fails
+    // right away instead of waiting for the server.
+    for (const auto& proxy : proxies) {
+        if (proxy != nullptr) {
+            proxy->cancel();
+        }
+    }
+    this->ctx->worker_cv.notify_all();
+    for (auto& worker : this->workers) {
+        // A reader resumed on a worker may drop the last reference to the
+        // proxy there, that worker then leaves on its own.
+        if (worker.get_id() == std::this_thread::get_id()) {
+            worker.detach();
+        }
+        else {
+            worker.join();
+        }
+    }
+}
+
+bool parallel_read_stream_proxy::can_seek() const
+{
+    std::unique_lock<std::mutex> lck(this->ctx->mtx);
+    return this->ctx->seekability == impl::parallel_seekability::seekable;
+}
+
+coroutine::task<std::uint32_t> parallel_read_stream_proxy::read(std::uint8_t* buf, std::uint32_t size)
+{
+    auto& ctx = *this->ctx;
+    std::unique_lock<std::mutex> lck(ctx.mtx);
+    for (;;) {
+        this->reposition();
+        if (size == 0 || this->position >= ctx.end_offset) {
+            co_return 0;
+        }
+        if (!ctx.segments.empty()) {
+            break;
+        }
+        // No worker has picked up the range at the position yet. Reset under
+        // the lock, the workers set the event once they have released it.
+        ctx.data_event.reset();
+        lck.unlock();
+        co_await ctx.data_event;
+        lck.lock();
+    }
+    auto segment = ctx.segments.front();
+    auto offset = this->position - segment->start;
+    while (segment->filled <= offset && !segment->is_complete && !segment->is_cancelled) {
+        ctx.data_event.reset();
+        lck.unlock();
+        co_await ctx.data_event;
+        lck.lock();
+    }
+    if (segment->filled <= offset) {
+        if (segment->error != nullptr) {
+            std::rethrow_exception(segment->error);
+        }
+        // The stream ended before the position.
+        co_return 0;
+    }
+    auto length = static_cast<std::uint32_t>(std::min<std::uint64_t>(size, segment->filled - offset));
+    lck.unlock();
+    std::memcpy(buf, segment->data.data() + offset, length);
+    lck.lock();
+    this->position += length;
+    if (this->position == segment->start + segment->size && !ctx.segments.empty() && ctx.segments.front() == segment) {
+        impl::release_front_segment(ctx);
+        ctx.worker_cv.notify_all();
+    }
+    co_return length;
+}
+
+void parallel_read_stream_proxy::seek(std::uint64_t pos)
+{
+    std::unique_lock<std::mutex> lck(this->ctx->mtx);
+    this->position = pos;
+    this->reposition();
+}
+
+// Must be called with the context mutex held.
+void parallel_read_stream_proxy::reposition()
+{
+    auto& ctx = *this->ctx;
+    bool is_released = false;
+    while (!ctx.segments.empty() && ctx.segments.front()->start + ctx.segments.front()->size <= this->position) {
+        impl::release_front_segment(ctx);
+        is_released = true;
+    }
+    if (ctx.segments.empty() || ctx.segments.front()->start > this->position) {
+        // Outside of the fetched window, start over at the position.
+        while (!ctx.segments.empty()) {
+            impl::release_front_segment(ctx);
+        }
+        if (ctx.next_offset != this->position) {
+            ctx.next_offset = this->position;
+            is_released = true;
+        }
+    }
+    if (is_released) {
+        ctx.worker_cv.notify_all();
+    }
+}
+
+} // namespace io
+} // namespace dawn_player
@@ -0,0 +1,112 @@
+/*
+ *    parallel_io.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_PARALLEL_IO_HPP
+#define DAWN_PLAYER_PARALLEL_IO_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "coroutine/async_manual_reset_event.hpp"
+#include "io.hpp"
+
+namespace dawn_player {
+namespace io {
+namespace impl {
+
+struct parallel_read_segment {
+    std::uint64_t start = 0;
+    std::uint64_t size = 0;
+    // Written by the fetching worker beyond filled, read by the reader below
+    // filled.
+    std::vector<std::uint8_t> data;
+    // The members below are guarded by the context mutex.
+    std::uint64_t filled = 0;
+    bool is_assigned = false;
+    bool is_complete = false;
+    bool is_cancelled = false;
+    int attempt_count = 0;
+    std::exception_ptr error;
+};
+
+enum class parallel_seekability {
+    unknown,
+    seekable,
+    sequential,
+};
+
+struct parallel_read_context {
+    std::function<std::shared_ptr<read_stream_proxy>()> open_proxy;
+    std::mutex mtx;
+    std::condition_variable worker_cv;
+    // Set by the workers after they have filled or completed a range, reset
+    // by a read() that waits for one.
+    coroutine::async_manual_reset_event data_event;
+    // The proxy of each worker, cancelled on destruction.
+    std::vector<std::shared_ptr<read_stream_proxy>> proxies;
+    // Consecutive ranges starting at or before the reader's position.
+    std::deque<std::shared_ptr<parallel_read_segment>> segments;
+    std::vector<std::vector<std::uint8_t>> free_buffers;
+    std::uint64_t next_offset = 0;
+    // UINT64_MAX until a worker hits the end of the stream.
+    std::uint64_t end_offset = 0;
+    std::uint64_t buffered_size = 0;
+    std::uint64_t max_buffered_size = 0;
+    std::uint64_t range_size = 0;
+    std::size_t worker_count = 0;
+    // Running averages over completed ranges, 0 until measured.
+    double first_byte_seconds = 0.0;
+    double bytes_per_second = 0.0;
+    parallel_seekability seekability = parallel_seekability::unknown;
+    bool is_stopped = false;
+};
+
+} // namespace impl
+
+// Decorates seekable proxies so that the bytes ahead of the reader are
+// fetched in ranges over several connections at once, which fills links
+// where a single TCP stream is limited by the round trip time. Each worker
+// thread owns one proxy created by open_proxy and fetches the next free
+// range with seek_range()/read(), the reader gets the ranges back in order.
+// Ranges are sized from the measured time to first byte and throughput, so
+// that a request's round trip stays small against its transfer time.
+//
+// Until the first bytes are in, only one proxy is used. can_seek() then
+// reports whether that proxy can seek, before read() returns any byte. If it
+// cannot, that proxy keeps reading sequentially on its own.
+//
+// A read() that waits for a range suspends and resumes on the worker thread
+// that filled it. The destructor cancels the proxies of the workers, which
+// shuts their connections down, and joins the worker threads.
+class parallel_read_stream_proxy : public read_stream_proxy {
+public:
+    explicit parallel_read_stream_proxy(std::function<std::shared_ptr<read_stream_proxy>()>&& open_proxy,
+        std::size_t connection_count = 4, std::uint64_t max_buffered_size = 32 * 1024 * 1024);
+    virtual ~parallel_read_stream_proxy();
+    virtual bool can_seek() const;
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
+    virtual void seek(std::uint64_t pos);
+private:
+    void reposition();
+private:
+    std::shared_ptr<impl::parallel_read_context> ctx;
+    std::uint64_t position;
+    std::vector<std::thread> workers;
+};
+
+} // namespace io
+} // namespace dawn_player
+
+#endif
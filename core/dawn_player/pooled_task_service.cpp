@@ -0,0 +1,106 @@
+/*
+ *    pooled_task_service.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "pooled_task_service.hpp"
+
+namespace dawn_player {
+namespace impl
+{
+
+// Upper bound on the tasks a strand runs before yielding its worker thread,
+// so that one busy player cannot starve the others.
+const std::size_t max_tasks_per_strand_turn = 64;
+
+void pooled_strand_context::schedule()
+{
+    {
+        std::unique_lock<std::mutex> lck(this->pool_ctx->ready_queue_mtx);
+        this->pool_ctx->ready_queue.push(this->shared_from_this());
+    }
+    this->pool_ctx->ready_queue_cv.notify_one();
+}
+
+void pool_thread_proc(const std::shared_ptr<task_service_pool_context>& pool_ctx)
+{
+    while (true) {
+        std::shared_ptr<strand_context> strand_ctx;
+        {
+            std::unique_lock<std::mutex> lck(pool_ctx->ready_queue_mtx);
+            pool_ctx->ready_queue_cv.wait(lck, [&pool_ctx]() {
+                return !pool_ctx->ready_queue.empty() || pool_ctx->is_stopped;
+            });
+            if (pool_ctx->ready_queue.empty()) {
+                break;
+            }
+            strand_ctx = std::move(pool_ctx->ready_queue.front());
+            pool_ctx->ready_queue.pop();
+        }
+        run_strand(*strand_ctx, max_tasks_per_strand_turn);
+    }
+}
+
+} // namespace impl
+
+task_service_pool::task_service_pool(std::size_t thread_count)
+    : pool_ctx(std::make_shared<impl::task_service_pool_context>())
+    , thread_count(std::max<std::size_t>(thread_count, 1))
+{
+    for (std::size_t i = 0; i < this->thread_count; ++i) {
+        auto ctx = this->pool_ctx;
+        std::thread([ctx]() {
+            impl::pool_thread_proc(ctx);
+        }).detach();
+    }
+}
+
+task_service_pool::~task_service_pool()
+{
+    {
+        std::unique_lock<std::mutex> lck(this->pool_ctx->ready_queue_mtx);
+        this->pool_ctx->is_stopped = true;
+    }
+    this->pool_ctx->ready_queue_cv.notify_all();
+}
+
+std::shared_ptr<task_service> task_service_pool::create_task_service()
+{
+    return std::make_shared<pooled_task_service>(this->pool_ctx);
+}
+
+std::size_t task_service_pool::get_thread_count() const
+{
+    return this->thread_count;
+}
+
+pooled_task_service::pooled_task_service(const std::shared_ptr<impl::task_service_pool_context>& pool_ctx)
+    : strand_ctx(std::make_shared<impl::pooled_strand_context>())
+{
+    this->strand_ctx->pool_ctx = pool_ctx;
+}
+
+pooled_task_service::~pooled_task_service()
+{
+    // Tasks that are still queued keep the strand alive until they have run.
+}
+
+void pooled_task_service::post_task(std::function<void()>&& task)
+{
+    impl::post_to_strand(*this->strand_ctx, std::move(task));
+}
+
+std::thread::id pooled_task_service::get_thread_id()
+{
+    if (impl::is_running_strand(*this->strand_ctx)) {
+        return std::this_thread::get_id();
+    }
+    return std::thread::id();
+}
+
+} // namespace dawn_player
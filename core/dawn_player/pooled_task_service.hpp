@@ -0,0 +1,70 @@
+/*
+ *    pooled_task_service.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_POOLED_TASK_SERVICE_HPP
+#define DAWN_PLAYER_POOLED_TASK_SERVICE_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <queue>
+
+#include "strand.hpp"
+#include "task_service.hpp"
+
+namespace dawn_player {
+namespace impl
+{
+
+struct task_service_pool_context {
+    std::queue<std::shared_ptr<strand_context>> ready_queue;
+    std::mutex ready_queue_mtx;
+    std::condition_variable ready_queue_cv;
+    bool is_stopped = false;
+};
+
+// A strand queued on the ready queue of the pool.
+struct pooled_strand_context : public strand_context {
+    std::shared_ptr<task_service_pool_context> pool_ctx;
+    virtual void schedule();
+};
+
+} // namespace impl
+
+// A fixed set of worker threads shared by many task services.
+class task_service_pool {
+public:
+    explicit task_service_pool(std::size_t thread_count = std::thread::hardware_concurrency());
+    ~task_service_pool();
+    task_service_pool(const task_service_pool&) = delete;
+    task_service_pool& operator=(const task_service_pool&) = delete;
+    std::shared_ptr<task_service> create_task_service();
+    std::size_t get_thread_count() const;
+private:
+    std::shared_ptr<impl::task_service_pool_context> pool_ctx;
+    std::size_t thread_count;
+};
+
+// A task_service backed by a strand of a task_service_pool. Tasks posted to
+// the same pooled_task_service run one at a time and in FIFO order, but not
+// necessarily on the same worker thread. get_thread_id() returns the id of
+// the calling thread while it is running this strand, and a default
+// constructed std::thread::id otherwise.
+class pooled_task_service : public task_service {
+public:
+    explicit pooled_task_service(const std::shared_ptr<impl::task_service_pool_context>& pool_ctx);
+    virtual ~pooled_task_service();
+    virtual void post_task(std::function<void()>&& task);
+    virtual std::thread::id get_thread_id();
+private:
+    std::shared_ptr<impl::pooled_strand_context> strand_ctx;
+};
+
+} // namespace dawn_player
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ *    posix_io.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "posix_io.hpp"
+
+namespace dawn_player {
+namespace io {
+
+file_read_stream_proxy::file_read_stream_proxy(const std::string& path)
+    : fd(-1)
+    , position(0)
+{
+    this->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (this->fd == -1) {
+        throw std::runtime_error("failed to open file");
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(this->fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+}
+
+file_read_stream_proxy::~file_read_stream_proxy()
+{
+    ::close(this->fd);
+}
+
+bool file_read_stream_proxy::can_seek() const
+{
+    return true;
+}
+
+coroutine::task<std::uint32_t> file_read_stream_proxy::read(std::uint8_t* buf, std::uint32_t size)
+{
+    for (;;) {
+        auto result = ::pread(this->fd, buf, size, static_cast<off_t>(this->position));
+        if (result >= 0) {
+            this->position += static_cast<std::uint64_t>(result);
+            co_return static_cast<std::uint32_t>(result);
+        }
+        if (errno != EINTR) {
+            throw std::runtime_error("failed to read file");
+        }
+    }
+}
+
+void file_read_stream_proxy::seek(std::uint64_t pos)
+{
+    this->position = pos;
+}
+
+mmap_read_stream_proxy::mmap_read_stream_proxy(const std::string& path)
+    : mapping(nullptr)
+    , mapping_size(0)
+    , position(0)
+{
+    auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        throw std::runtime_error("failed to open file");
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("failed to stat file");
+    }
+    this->mapping_size = static_cast<std::uint64_t>(st.st_size);
+    if (this->mapping_size != 0) {
+        auto addr = ::mmap(nullptr, static_cast<std::size_t>(this->mapping_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("failed to map file");
+        }
+        // Tags are parsed front to back, let the kernel read ahead aggressively.
+        ::madvise(addr, static_cast<std::size_t>(this->mapping_size), MADV_SEQUENTIAL);
+        this->mapping = static_cast<const std::uint8_t*>(addr);
+    }
+    // The mapping keeps the file referenced.
+    ::close(fd);
+}
+
+mmap_read_stream_proxy::~mmap_read_stream_proxy()
+{
+    if (this->mapping != nullptr) {
+        ::munmap(const_cast<std::uint8_t*>(this->mapping), static_cast<std::size_t>(this->mapping_size));
+    }
+}
+
+bool mmap_read_stream_proxy::can_seek() const
+{
+    return true;
+}
+
+coroutine::task<std::uint32_t> mmap_read_stream_proxy::read(std::uint8_t* buf, std::uint32_t size)
+{
+    std::uint32_t result = 0;
+    if (this->position < this->mapping_size) {
+        auto remaining = this->mapping_size - this->position;
+        result = remaining < size ? static_cast<std::uint32_t>(remaining) : size;
+        std::memcpy(buf, this->mapping + this->position, result);
+        this->position += result;
+    }
+    co_return result;
+}
+
+void mmap_read_stream_proxy::seek(std::uint64_t pos)
+{
+    this->position = pos;
+}
+
+bool mmap_read_stream_proxy::get_view(const std::uint8_t*& data, std::uint64_t& size)
+{
+    if (this->position >= this->mapping_size) {
+        data = nullptr;
+        size = 0;
+    }
+    else {
+        data = this->mapping + this->position;
+        size = this->mapping_size - this->position;
+    }
+    return true;
+}
+
+void mmap_read_stream_proxy::consume(std::uint64_t size)
+{
+    this->position += size;
+}
+
+} // namespace io
+} // namespace dawn_player
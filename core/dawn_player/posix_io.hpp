@@ -0,0 +1,58 @@
+/*
+ *    posix_io.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_POSIX_IO_HPP
+#define DAWN_PLAYER_POSIX_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "io.hpp"
+
+namespace dawn_player {
+namespace io {
+
+// Reads a local file with pread(), the position is kept in the proxy.
+class file_read_stream_proxy : public read_stream_proxy {
+public:
+    explicit file_read_stream_proxy(const std::string& path);
+    file_read_stream_proxy(const file_read_stream_proxy&) = delete;
+    file_read_stream_proxy& operator=(const file_read_stream_proxy&) = delete;
+    virtual ~file_read_stream_proxy();
+    virtual bool can_seek() const;
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
+    virtual void seek(std::uint64_t pos);
+private:
+    int fd;
+    std::uint64_t position;
+};
+
+// Maps a local file into memory and hands out views of the mapping, so the
+// player parses tags in place without read syscalls or copies into its read
+// buffer. read() is still supported and copies out of the mapping.
+class mmap_read_stream_proxy : public read_stream_proxy {
+public:
+    explicit mmap_read_stream_proxy(const std::string& path);
+    mmap_read_stream_proxy(const mmap_read_stream_proxy&) = delete;
+    mmap_read_stream_proxy& operator=(const mmap_read_stream_proxy&) = delete;
+    virtual ~mmap_read_stream_proxy();
+    virtual bool can_seek() const;
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
+    virtual void seek(std::uint64_t pos);
+    virtual bool get_view(const std::uint8_t*& data, std::uint64_t& size);
+    virtual void consume(std::uint64_t size);
+private:
+    const std::uint8_t* mapping;
+    std::uint64_t mapping_size;
+    std::uint64_t position;
+};
+
+} // namespace io
+} // namespace dawn_player
+
+#endif
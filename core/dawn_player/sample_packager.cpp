@@ -0,0 +1,89 @@
+/*
+ *    sample_packager.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+
+#include "sample_packager.hpp"
+
+namespace dawn_player {
+namespace sample {
+
+video_sample_packager::video_sample_packager()
+{
+}
+
+void video_sample_packager::set_parameter_sets(std::uint32_t config_generation, const std::vector<std::uint8_t>& vps, const std::vector<std::uint8_t>& sps, const std::vector<std::uint8_t>& pps)
+{
+    auto iter = std::find_if(this->parameter_sets_list.begin(), this->parameter_sets_list.end(), [config_generation](const parameter_sets& sets) {
+        return sets.config_generation == config_generation;
+    });
+    if (iter == this->parameter_sets_list.end()) {
+        iter = this->parameter_sets_list.emplace(iter);
+    }
+    auto& sets = *iter;
+    sets.config_generation = config_generation;
+    sets.vps = vps;
+    sets.sps = sps;
+    sets.pps = pps;
+    sets.prefix.clear();
+    sets.prefix.reserve(vps.size() + sps.size() + pps.size() + 9);
+    video_sample_packager::append_nalu(sets.prefix, vps);
+    video_sample_packager::append_nalu(sets.prefix, sps);
+    video_sample_packager::append_nalu(sets.prefix, pps);
+}
+
+const parameter_sets* video_sample_packager::find_parameter_sets(std::uint32_t config_generation) const
+{
+    for (auto iter = this->parameter_sets_list.rbegin(); iter != this->parameter_sets_list.rend(); ++iter) {
+        if (iter->config_generation == config_generation) {
+            return &*iter;
+        }
+    }
+    return nullptr;
+}
+
+std::uint32_t video_sample_packager::get_config_generation() const
+{
+    if (this->parameter_sets_list.empty()) {
+        return 0;
+    }
+    return this->parameter_sets_list.back().config_generation;
+}
+
+std::vector<std::uint8_t> video_sample_packager::package(video_sample&& sample) const
+{
+    if (!sample.is_key_frame || sample.has_parameter_sets || this->parameter_sets_list.empty()) {
+        return std::move(sample.data);
+    }
+    auto sets = this->find_parameter_sets(sample.config_generation);
+    if (sets == nullptr) {
+        sets = &this->parameter_sets_list.back();
+    }
+    if (sets->prefix.empty()) {
+        return std::move(sample.data);
+    }
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve(sets->prefix.size() + sample.data.size());
+    buffer.insert(buffer.end(), sets->prefix.begin(), sets->prefix.end());
+    buffer.insert(buffer.end(), sample.data.begin(), sample.data.end());
+    sample.data.clear();
+    return buffer;
+}
+
+void video_sample_packager::append_nalu(std::vector<std::uint8_t>& buffer, const std::vector<std::uint8_t>& nalu)
+{
+    if (nalu.empty()) {
+        return;
+    }
+    buffer.push_back(0x00);
+    buffer.push_back(0x00);
+    buffer.push_back(0x01);
+    buffer.insert(buffer.end(), nalu.begin(), nalu.end());
+}
+
+} // namespace sample
+} // namespace dawn_player
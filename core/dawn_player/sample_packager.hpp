@@ -0,0 +1,59 @@
+/*
+ *    sample_packager.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_SAMPLE_PACKAGER_HPP
+#define DAWN_PLAYER_SAMPLE_PACKAGER_HPP
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "samples.hpp"
+
+namespace dawn_player {
+namespace sample {
+
+// The parameter sets of one video decoder configuration.
+struct parameter_sets {
+    std::uint32_t config_generation;
+    std::vector<std::uint8_t> vps;
+    std::vector<std::uint8_t> sps;
+    std::vector<std::uint8_t> pps;
+    // vps, sps and pps as start-coded Annex-B NALUs.
+    std::vector<std::uint8_t> prefix;
+};
+
+// Turns video samples into decoder-ready Annex-B buffers. Key frames are
+// prefixed with the parameter sets (VPS/SPS/PPS), which are start-coded once
+// when they change instead of once per key frame. Key frames that already
+// carry their parameter sets in-band are passed through unchanged.
+//
+// A stream may switch decoder configuration mid-stream, while samples of the
+// previous configuration are still queued, and a seek may go back to an
+// earlier configuration. The packager therefore keeps the parameter sets of
+// every config generation and prefixes each key frame with those of its own.
+class video_sample_packager {
+public:
+    video_sample_packager();
+    void set_parameter_sets(std::uint32_t config_generation, const std::vector<std::uint8_t>& vps, const std::vector<std::uint8_t>& sps, const std::vector<std::uint8_t>& pps);
+    // Returns the parameter sets of the given config generation, or nullptr
+    // if they are unknown or already released.
+    const parameter_sets* find_parameter_sets(std::uint32_t config_generation) const;
+    // The newest config generation, 0 before any parameter sets are set.
+    std::uint32_t get_config_generation() const;
+    // Returns one contiguous buffer holding the sample. The sample data is
+    // moved out of the sample, so non-key frames are not copied at all.
+    std::vector<std::uint8_t> package(video_sample&& sample) const;
+private:
+    static void append_nalu(std::vector<std::uint8_t>& buffer, const std::vector<std::uint8_t>& nalu);
+    std::deque<parameter_sets> parameter_sets_list;
+};
+
+} // namespace sample
+} // namespace dawn_player
+
+#endif
@@ -42,21 +42,25 @@ audio_sample& audio_sample::operator=(audio_sample&& other)
 }
 
 video_sample::video_sample()
-    : dts(0), timestamp(0), is_key_frame(false)
+    : dts(0), timestamp(0), is_key_frame(false), has_parameter_sets(false), config_generation(0)
 {
 }
 
 video_sample::video_sample(const video_sample& other)
     : dts(other.dts), timestamp(other.timestamp), data(other.data), is_key_frame(other.is_key_frame)
+    , has_parameter_sets(other.has_parameter_sets), config_generation(other.config_generation)
 {
 }
 
 video_sample::video_sample(video_sample&& other)
     : dts(other.dts), timestamp(other.timestamp), data(std::move(other.data)), is_key_frame(other.is_key_frame)
+    , has_parameter_sets(other.has_parameter_sets), config_generation(other.config_generation)
 {
     other.dts = 0;
     other.timestamp = 0;
     other.is_key_frame = false;
+    other.has_parameter_sets = false;
+    other.config_generation = 0;
 }
 
 video_sample& video_sample::operator=(const video_sample& other)
@@ -65,6 +69,8 @@ video_sample& video_sample::operator=(const video_sample& other)
     this->timestamp = other.timestamp;
     this->data = other.data;
     this->is_key_frame = other.is_key_frame;
+    this->has_parameter_sets = other.has_parameter_sets;
+    this->config_generation = other.config_generation;
     return *this;
 }
 
@@ -74,9 +80,13 @@ video_sample& video_sample::operator=(video_sample&& other)
     this->timestamp = other.timestamp;
     this->data = std::move(other.data);
     this->is_key_frame = other.is_key_frame;
+    this->has_parameter_sets = other.has_parameter_sets;
+    this->config_generation = other.config_generation;
     other.dts = 0;
     other.timestamp = 0;
     other.is_key_frame = false;
+    other.has_parameter_sets = false;
+    other.config_generation = 0;
     return *this;
 }
 
@@ -29,6 +29,12 @@ struct video_sample {
     std::int64_t timestamp;
     std::vector<unsigned char> data;
     bool is_key_frame;
+    // The sample carries its own parameter set NALUs (SPS/PPS, and VPS for
+    // HEVC), so they need not be prepended from the decoder configuration.
+    bool has_parameter_sets;
+    // Version of the decoder configuration the sample belongs to, see
+    // flv_parser::get_config_generation().
+    std::uint32_t config_generation;
     video_sample();
     video_sample(const video_sample& other);
     video_sample(video_sample&& other);
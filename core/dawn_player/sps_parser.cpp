@@ -0,0 +1,596 @@
+/*
+ *    sps_parser.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include "bit_reader.hpp"
+#include "sps_parser.hpp"
+
+namespace dawn_player {
+namespace parser {
+namespace impl
+{
+
+void skip_h264_scaling_list(bit_reader& reader, std::uint32_t size_of_scaling_list)
+{
+    // ITU-T H.264 7.3.2.1.1.1
+    std::int32_t last_scale = 8;
+    std::int32_t next_scale = 8;
+    for (std::uint32_t j = 0; j < size_of_scaling_list; ++j) {
+        if (next_scale != 0) {
+            auto delta_scale = reader.read_se();
+            next_scale = (last_scale + delta_scale + 256) % 256;
+        }
+        last_scale = next_scale == 0 ? last_scale : next_scale;
+    }
+}
+
+void skip_h264_hrd_parameters(bit_reader& reader)
+{
+    // ITU-T H.264 E.1.2
+    auto cpb_cnt_minus1 = reader.read_ue();
+    if (cpb_cnt_minus1 > 31) {
+        throw bit_reader_error("Bad cpb_cnt_minus1.");
+    }
+    // bit_rate_scale u(4), cpb_size_scale u(4)
+    reader.skip_bits(8);
+    for (std::uint32_t i = 0; i <= cpb_cnt_minus1; ++i) {
+        // bit_rate_value_minus1 ue(v), cpb_size_value_minus1 ue(v), cbr_flag u(1)
+        reader.read_ue();
+        reader.read_ue();
+        reader.skip_bits(1);
+    }
+    // initial_cpb_removal_delay_length_minus1, cpb_removal_delay_length_minus1,
+    // dpb_output_delay_length_minus1, time_offset_length u(5) each
+    reader.skip_bits(20);
+}
+
+void read_aspect_ratio_info(bit_reader& reader, sps_info& info)
+{
+    // Table E-1
+    static const std::uint32_t sample_aspect_ratios[17][2] = {
+        { 0, 0 }, { 1, 1 }, { 12, 11 }, { 10, 11 }, { 16, 11 }, { 40, 33 }, { 24, 11 }, { 20, 11 }, { 32, 11 },
+        { 80, 33 }, { 18, 11 }, { 15, 11 }, { 64, 33 }, { 160, 99 }, { 4, 3 }, { 3, 2 }, { 2, 1 },
+    };
+    // aspect_ratio_idc u(8)
+    auto aspect_ratio_idc = reader.read_bits(8);
+    if (aspect_ratio_idc == 255) {
+        // Extended_SAR
+        info.sar_width = reader.read_bits(16);
+        info.sar_height = reader.read_bits(16);
+    }
+    else if (aspect_ratio_idc > 0 && aspect_ratio_idc < 17) {
+        info.sar_width = sample_aspect_ratios[aspect_ratio_idc][0];
+        info.sar_height = sample_aspect_ratios[aspect_ratio_idc][1];
+    }
+    if (info.sar_width == 0 || info.sar_height == 0) {
+        info.sar_width = 1;
+        info.sar_height = 1;
+    }
+}
+
+void skip_video_signal_type(bit_reader& reader)
+{
+    // video_format u(3), video_full_range_flag u(1)
+    reader.skip_bits(4);
+    // colour_description_present_flag u(1)
+    if (reader.read_bit()) {
+        // colour_primaries, transfer_characteristics, matrix_coefficients u(8) each
+        reader.skip_bits(24);
+    }
+}
+
+void parse_h264_vui_parameters(bit_reader& reader, sps_info& info)
+{
+    // ITU-T H.264 E.1.1
+    // aspect_ratio_info_present_flag u(1)
+    if (reader.read_bit()) {
+        read_aspect_ratio_info(reader, info);
+    }
+    // overscan_info_present_flag u(1)
+    if (reader.read_bit()) {
+        // overscan_appropriate_flag u(1)
+        reader.skip_bits(1);
+    }
+    // video_signal_type_present_flag u(1)
+    if (reader.read_bit()) {
+        skip_video_signal_type(reader);
+    }
+    // chroma_loc_info_present_flag u(1)
+    if (reader.read_bit()) {
+        // chroma_sample_loc_type_top_field, chroma_sample_loc_type_bottom_field ue(v)
+        reader.read_ue();
+        reader.read_ue();
+    }
+    // timing_info_present_flag u(1)
+    if (reader.read_bit()) {
+        auto num_units_in_tick = reader.read_bits(32);
+        auto time_scale = reader.read_bits(32);
+        // fixed_frame_rate_flag u(1)
+        reader.skip_bits(1);
+        if (num_units_in_tick != 0 && time_scale != 0) {
+            // One frame lasts two ticks (a tick is a field period).
+            info.frame_rate = static_cast<double>(time_scale) / (2.0 * num_units_in_tick);
+        }
+    }
+    // nal_hrd_parameters_present_flag u(1)
+    auto nal_hrd_parameters_present_flag = reader.read_bit();
+    if (nal_hrd_parameters_present_flag) {
+        skip_h264_hrd_parameters(reader);
+    }
+    // vcl_hrd_parameters_present_flag u(1)
+    auto vcl_hrd_parameters_present_flag = reader.read_bit();
+    if (vcl_hrd_parameters_present_flag) {
+        skip_h264_hrd_parameters(reader);
+    }
+    if (nal_hrd_parameters_present_flag || vcl_hrd_parameters_present_flag) {
+        // low_delay_hrd_flag u(1)
+        reader.skip_bits(1);
+    }
+    // pic_struct_present_flag u(1)
+    reader.skip_bits(1);
+    // bitstream_restriction_flag u(1)
+    if (reader.read_bit()) {
+        // motion_vectors_over_pic_boundaries_flag u(1)
+        reader.skip_bits(1);
+        // max_bytes_per_pic_denom, max_bits_per_mb_denom,
+        // log2_max_mv_length_horizontal, log2_max_mv_length_vertical ue(v)
+        reader.read_ue();
+        reader.read_ue();
+        reader.read_ue();
+        reader.read_ue();
+        // max_num_reorder_frames ue(v)
+        info.max_num_reorder_frames = static_cast<std::int32_t>(reader.read_ue());
+        // max_dec_frame_buffering ue(v)
+        reader.read_ue();
+    }
+}
+
+void skip_hevc_profile_tier_level(bit_reader& reader, std::uint32_t max_sub_layers_minus1, sps_info& info)
+{
+    // ITU-T H.265 7.3.3
+    // general_profile_space u(2), general_tier_flag u(1)
+    reader.skip_bits(3);
+    info.profile_idc = reader.read_bits(5);
+    // general_profile_compatibility_flag[32], general_progressive_source_flag,
+    // general_interlaced_source_flag, general_non_packed_constraint_flag,
+    // general_frame_only_constraint_flag, 43 bits of constraint flags and
+    // general_inbld_flag / reserved bit
+    reader.skip_bits(32 + 4 + 43 + 1);
+    info.level_idc = reader.read_bits(8);
+    bool sub_layer_profile_present_flags[8] = {};
+    bool sub_layer_level_present_flags[8] = {};
+    for (std::uint32_t i = 0; i < max_sub_layers_minus1; ++i) {
+        sub_layer_profile_present_flags[i] = reader.read_bit();
+        sub_layer_level_present_flags[i] = reader.read_bit();
+    }
+    if (max_sub_layers_minus1 > 0) {
+        // reserved_zero_2bits
+        reader.skip_bits(2 * (8 - max_sub_layers_minus1));
+    }
+    for (std::uint32_t i = 0; i < max_sub_layers_minus1; ++i) {
+        if (sub_layer_profile_present_flags[i]) {
+            reader.skip_bits(88);
+        }
+        if (sub_layer_level_present_flags[i]) {
+            reader.skip_bits(8);
+        }
+    }
+}
+
+void skip_hevc_scaling_list_data(bit_reader& reader)
+{
+    // ITU-T H.265 7.3.4
+    for (std::uint32_t size_id = 0; size_id < 4; ++size_id) {
+        for (std::uint32_t matrix_id = 0; matrix_id < 6; matrix_id += (size_id == 3) ? 3 : 1) {
+            // scaling_list_pred_mode_flag u(1)
+            if (!reader.read_bit()) {
+                // scaling_list_pred_matrix_id_delta ue(v)
+                reader.read_ue();
+            }
+            else {
+                std::uint32_t coef_num = 1u << (4 + (size_id << 1));
+                if (coef_num > 64) {
+                    coef_num = 64;
+                }
+                if (size_id > 1) {
+                    // scaling_list_dc_coef_minus8 se(v)
+                    reader.read_se();
+                }
+                for (std::uint32_t i = 0; i < coef_num; ++i) {
+                    // scaling_list_delta_coef se(v)
+                    reader.read_se();
+                }
+            }
+        }
+    }
+}
+
+void skip_hevc_short_term_ref_pic_sets(bit_reader& reader, std::uint32_t num_short_term_ref_pic_sets)
+{
+    // ITU-T H.265 7.3.7
+    std::uint32_t num_delta_pocs[64] = {};
+    for (std::uint32_t idx = 0; idx < num_short_term_ref_pic_sets; ++idx) {
+        bool inter_ref_pic_set_prediction_flag = false;
+        if (idx != 0) {
+            inter_ref_pic_set_prediction_flag = reader.read_bit();
+        }
+        if (inter_ref_pic_set_prediction_flag) {
+            // delta_idx_minus1 is only present in slice headers, the reference
+            // set is the previous one. delta_rps_sign u(1), abs_delta_rps_minus1 ue(v)
+            reader.skip_bits(1);
+            reader.read_ue();
+            std::uint32_t count = 0;
+            for (std::uint32_t j = 0; j <= num_delta_pocs[idx - 1]; ++j) {
+                // used_by_curr_pic_flag u(1)
+                bool used_by_curr_pic_flag = reader.read_bit();
+                // use_delta_flag u(1), inferred to be 1 when not present
+                bool use_delta_flag = true;
+                if (!used_by_curr_pic_flag) {
+                    use_delta_flag = reader.read_bit();
+                }
+                if (used_by_curr_pic_flag || use_delta_flag) {
+                    ++count;
+                }
+            }
+            num_delta_pocs[idx] = count;
+        }
+        else {
+            auto num_negative_pics = reader.read_ue();
+            auto num_positive_pics = reader.read_ue();
+            if (num_negative_pics > 16 || num_positive_pics > 16) {
+                throw bit_reader_error("Bad short-term reference picture set.");
+            }
+            for (std::uint32_t i = 0; i < num_negative_pics + num_positive_pics; ++i) {
+                // delta_poc_s0/s1_minus1 ue(v), used_by_curr_pic_s0/s1_flag u(1)
+                reader.read_ue();
+                reader.skip_bits(1);
+            }
+            num_delta_pocs[idx] = num_negative_pics + num_positive_pics;
+        }
+    }
+}
+
+void parse_hevc_vui_parameters(bit_reader& reader, sps_info& info)
+{
+    // ITU-T H.265 E.2.1, parsed up to the timing info.
+    // aspect_ratio_info_present_flag u(1)
+    if (reader.read_bit()) {
+        read_aspect_ratio_info(reader, info);
+    }
+    // overscan_info_present_flag u(1)
+    if (reader.read_bit()) {
+        // overscan_appropriate_flag u(1)
+        reader.skip_bits(1);
+    }
+    // video_signal_type_present_flag u(1)
+    if (reader.read_bit()) {
+        skip_video_signal_type(reader);
+    }
+    // chroma_loc_info_present_flag u(1)
+    if (reader.read_bit()) {
+        reader.read_ue();
+        reader.read_ue();
+    }
+    // neutral_chroma_indication_flag, field_seq_flag, frame_field_info_present_flag u(1)
+    reader.skip_bits(3);
+    // default_display_window_flag u(1)
+    if (reader.read_bit()) {
+        // def_disp_win_left/right/top/bottom_offset ue(v)
+        reader.read_ue();
+        reader.read_ue();
+        reader.read_ue();
+        reader.read_ue();
+    }
+    // vui_timing_info_present_flag u(1)
+    if (reader.read_bit()) {
+        auto num_units_in_tick = reader.read_bits(32);
+        auto time_scale = reader.read_bits(32);
+        if (num_units_in_tick != 0 && time_scale != 0) {
+            info.frame_rate = static_cast<double>(time_scale) / num_units_in_tick;
+        }
+    }
+}
+
+} // namespace impl
+
+sps_info::sps_info()
+    : profile_idc(0)
+    , level_idc(0)
+    , coded_width(0)
+    , coded_height(0)
+    , width(0)
+    , height(0)
+    , sar_width(1)
+    , sar_height(1)
+    , frame_rate(0.0)
+    , max_num_reorder_frames(-1)
+{
+}
+
+bool parse_h264_sps(const std::uint8_t* data, std::size_t size, sps_info& info)
+{
+    // ITU-T H.264 7.3.2.1.1
+    if (size < 4 || (data[0] & 0x1f) != 7) {
+        return false;
+    }
+    sps_info result;
+    try {
+        bit_reader reader(data + 1, size - 1);
+        result.profile_idc = reader.read_bits(8);
+        // constraint_set0_flag ... constraint_set5_flag u(1), reserved_zero_2bits u(2)
+        auto constraint_flags = reader.read_bits(8);
+        bool constraint_set3_flag = (constraint_flags & 0x10) != 0;
+        result.level_idc = reader.read_bits(8);
+        // seq_parameter_set_id ue(v)
+        reader.read_ue();
+        std::uint32_t chroma_format_idc = 1;
+        bool separate_colour_plane_flag = false;
+        switch (result.profile_idc) {
+        case 100: case 110: case 122: case 244: case 44: case 83:
+        case 86: case 118: case 128: case 138: case 139: case 134: case 135:
+            chroma_format_idc = reader.read_ue();
+            if (chroma_format_idc > 3) {
+                return false;
+            }
+            if (chroma_format_idc == 3) {
+                separate_colour_plane_flag = reader.read_bit();
+            }
+            // bit_depth_luma_minus8, bit_depth_chroma_minus8 ue(v)
+            reader.read_ue();
+            reader.read_ue();
+            // qpprime_y_zero_transform_bypass_flag u(1)
+            reader.skip_bits(1);
+            // seq_scaling_matrix_present_flag u(1)
+            if (reader.read_bit()) {
+                auto count = chroma_format_idc != 3 ? 8 : 12;
+                for (int i = 0; i < count; ++i) {
+                    // seq_scaling_list_present_flag[i] u(1)
+                    if (reader.read_bit()) {
+                        impl::skip_h264_scaling_list(reader, i < 6 ? 16 : 64);
+                    }
+                }
+            }
+            break;
+        default:
+            break;
+        }
+        // log2_max_frame_num_minus4 ue(v)
+        reader.read_ue();
+        auto pic_order_cnt_type = reader.read_ue();
+        if (pic_order_cnt_type == 0) {
+            // log2_max_pic_order_cnt_lsb_minus4 ue(v)
+            reader.read_ue();
+        }
+        else if (pic_order_cnt_type == 1) {
+            // delta_pic_order_always_zero_flag u(1)
+            reader.skip_bits(1);
+            // offset_for_non_ref_pic, offset_for_top_to_bottom_field se(v)
+            reader.read_se();
+            reader.read_se();
+            auto num_ref_frames_in_pic_order_cnt_cycle = reader.read_ue();
+            if (num_ref_frames_in_pic_order_cnt_cycle > 255) {
+                return false;
+            }
+            for (std::uint32_t i = 0; i < num_ref_frames_in_pic_order_cnt_cycle; ++i) {
+                // offset_for_ref_frame[i] se(v)
+                reader.read_se();
+            }
+        }
+        else if (pic_order_cnt_type != 2) {
+            return false;
+        }
+        // max_num_ref_frames ue(v)
+        reader.read_ue();
+        // gaps_in_frame_num_value_allowed_flag u(1)
+        reader.skip_bits(1);
+        auto pic_width_in_mbs_minus1 = reader.read_ue();
+        auto pic_height_in_map_units_minus1 = reader.read_ue();
+        auto frame_mbs_only_flag = reader.read_bit() ? 1u : 0u;
+        if (!frame_mbs_only_flag) {
+            // mb_adaptive_frame_field_flag u(1)
+            reader.skip_bits(1);
+        }
+        // direct_8x8_inference_flag u(1)
+        reader.skip_bits(1);
+        std::uint32_t frame_crop_left_offset = 0;
+        std::uint32_t frame_crop_right_offset = 0;
+        std::uint32_t frame_crop_top_offset = 0;
+        std::uint32_t frame_crop_bottom_offset = 0;
+        // frame_cropping_flag u(1)
+        if (reader.read_bit()) {
+            frame_crop_left_offset = reader.read_ue();
+            frame_crop_right_offset = reader.read_ue();
+            frame_crop_top_offset = reader.read_ue();
+            frame_crop_bottom_offset = reader.read_ue();
+        }
+        if (pic_width_in_mbs_minus1 > 1024 || pic_height_in_map_units_minus1 > 1024) {
+            return false;
+        }
+        result.coded_width = (pic_width_in_mbs_minus1 + 1) * 16;
+        result.coded_height = (2 - frame_mbs_only_flag) * (pic_height_in_map_units_minus1 + 1) * 16;
+        // 7.4.2.1.1 frame_cropping_flag semantics
+        auto chroma_array_type = separate_colour_plane_flag ? 0 : chroma_format_idc;
+        std::uint32_t crop_unit_x = 1;
+        std::uint32_t crop_unit_y = 2 - frame_mbs_only_flag;
+        if (chroma_array_type != 0) {
+            auto sub_width_c = chroma_format_idc == 3 ? 1u : 2u;
+            auto sub_height_c = chroma_format_idc == 1 ? 2u : 1u;
+            crop_unit_x = sub_width_c;
+            crop_unit_y = sub_height_c * (2 - frame_mbs_only_flag);
+        }
+        auto crop_x = crop_unit_x * (static_cast<std::uint64_t>(frame_crop_left_offset) + frame_crop_right_offset);
+        auto crop_y = crop_unit_y * (static_cast<std::uint64_t>(frame_crop_top_offset) + frame_crop_bottom_offset);
+        if (crop_x >= result.coded_width || crop_y >= result.coded_height) {
+            return false;
+        }
+        result.width = result.coded_width - static_cast<std::uint32_t>(crop_x);
+        result.height = result.coded_height - static_cast<std::uint32_t>(crop_y);
+        // A.2.1, A.2.8 ... A.2.11: Baseline and the intra profiles have no
+        // reordering. Otherwise this is only known from the VUI.
+        if (result.profile_idc == 66) {
+            result.max_num_reorder_frames = 0;
+        }
+        else if (constraint_set3_flag) {
+            switch (result.profile_idc) {
+            case 44: case 86: case 100: case 110: case 122: case 244:
+                result.max_num_reorder_frames = 0;
+                break;
+            default:
+                break;
+            }
+        }
+        // vui_parameters_present_flag u(1)
+        if (reader.read_bit()) {
+            try {
+                impl::parse_h264_vui_parameters(reader, result);
+            }
+            catch (const bit_reader_error&) {
+                // Some encoders write truncated VUI, keep what was read.
+            }
+        }
+    }
+    catch (const bit_reader_error&) {
+        return false;
+    }
+    info = result;
+    return true;
+}
+
+bool parse_hevc_sps(const std::uint8_t* data, std::size_t size, sps_info& info)
+{
+    // ITU-T H.265 7.3.2.2.1
+    if (size < 3 || ((data[0] >> 1) & 0x3f) != 33) {
+        return false;
+    }
+    sps_info result;
+    try {
+        bit_reader reader(data + 2, size - 2);
+        // sps_video_parameter_set_id u(4)
+        reader.skip_bits(4);
+        auto sps_max_sub_layers_minus1 = reader.read_bits(3);
+        if (sps_max_sub_layers_minus1 > 6) {
+            return false;
+        }
+        // sps_temporal_id_nesting_flag u(1)
+        reader.skip_bits(1);
+        impl::skip_hevc_profile_tier_level(reader, sps_max_sub_layers_minus1, result);
+        // sps_seq_parameter_set_id ue(v)
+        reader.read_ue();
+        auto chroma_format_idc = reader.read_ue();
+        if (chroma_format_idc > 3) {
+            return false;
+        }
+        bool separate_colour_plane_flag = false;
+        if (chroma_format_idc == 3) {
+            separate_colour_plane_flag = reader.read_bit();
+        }
+        result.coded_width = reader.read_ue();
+        result.coded_height = reader.read_ue();
+        if (result.coded_width == 0 || result.coded_height == 0 || result.coded_width > 16888 || result.coded_height > 16888) {
+            return false;
+        }
+        std::uint64_t crop_x = 0;
+        std::uint64_t crop_y = 0;
+        // conformance_window_flag u(1)
+        if (reader.read_bit()) {
+            auto conf_win_left_offset = reader.read_ue();
+            auto conf_win_right_offset = reader.read_ue();
+            auto conf_win_top_offset = reader.read_ue();
+            auto conf_win_bottom_offset = reader.read_ue();
+            // Table 6-1, ChromaArrayType 0 uses 1x1 units.
+            auto chroma_array_type = separate_colour_plane_flag ? 0 : chroma_format_idc;
+            std::uint32_t sub_width_c = (chroma_array_type == 1 || chroma_array_type == 2) ? 2 : 1;
+            std::uint32_t sub_height_c = chroma_array_type == 1 ? 2 : 1;
+            crop_x = sub_width_c * (static_cast<std::uint64_t>(conf_win_left_offset) + conf_win_right_offset);
+            crop_y = sub_height_c * (static_cast<std::uint64_t>(conf_win_top_offset) + conf_win_bottom_offset);
+        }
+        if (crop_x >= result.coded_width || crop_y >= result.coded_height) {
+            return false;
+        }
+        result.width = result.coded_width - static_cast<std::uint32_t>(crop_x);
+        result.height = result.coded_height - static_cast<std::uint32_t>(crop_y);
+        // bit_depth_luma_minus8, bit_depth_chroma_minus8 ue(v)
+        reader.read_ue();
+        reader.read_ue();
+        auto log2_max_pic_order_cnt_lsb_minus4 = reader.read_ue();
+        if (log2_max_pic_order_cnt_lsb_minus4 > 12) {
+            return false;
+        }
+        // sps_sub_layer_ordering_info_present_flag u(1)
+        auto sub_layer_ordering_info_present_flag = reader.read_bit();
+        for (auto i = sub_layer_ordering_info_present_flag ? 0 : sps_max_sub_layers_minus1; i <= sps_max_sub_layers_minus1; ++i) {
+            // sps_max_dec_pic_buffering_minus1 ue(v)
+            reader.read_ue();
+            // The value of the highest sub-layer is the one that applies to
+            // the whole stream.
+            result.max_num_reorder_frames = static_cast<std::int32_t>(reader.read_ue());
+            // sps_max_latency_increase_plus1 ue(v)
+            reader.read_ue();
+        }
+        try {
+            // log2_min_luma_coding_block_size_minus3, log2_diff_max_min_luma_coding_block_size,
+            // log2_min_luma_transform_block_size_minus2, log2_diff_max_min_luma_transform_block_size,
+            // max_transform_hierarchy_depth_inter, max_transform_hierarchy_depth_intra ue(v)
+            for (int i = 0; i < 6; ++i) {
+                reader.read_ue();
+            }
+            // scaling_list_enabled_flag u(1)
+            if (reader.read_bit()) {
+                // sps_scaling_list_data_present_flag u(1)
+                if (reader.read_bit()) {
+                    impl::skip_hevc_scaling_list_data(reader);
+                }
+            }
+            // amp_enabled_flag, sample_adaptive_offset_enabled_flag u(1)
+            reader.skip_bits(2);
+            // pcm_enabled_flag u(1)
+            if (reader.read_bit()) {
+                // pcm_sample_bit_depth_luma_minus1, pcm_sample_bit_depth_chroma_minus1 u(4)
+                reader.skip_bits(8);
+                // log2_min_pcm_luma_coding_block_size_minus3,
+                // log2_diff_max_min_pcm_luma_coding_block_size ue(v)
+                reader.read_ue();
+                reader.read_ue();
+                // pcm_loop_filter_disabled_flag u(1)
+                reader.skip_bits(1);
+            }
+            auto num_short_term_ref_pic_sets = reader.read_ue();
+            if (num_short_term_ref_pic_sets > 64) {
+                throw bit_reader_error("Bad num_short_term_ref_pic_sets.");
+            }
+            impl::skip_hevc_short_term_ref_pic_sets(reader, num_short_term_ref_pic_sets);
+            // long_term_ref_pics_present_flag u(1)
+            if (reader.read_bit()) {
+                auto num_long_term_ref_pics_sps = reader.read_ue();
+                if (num_long_term_ref_pics_sps > 32) {
+                    throw bit_reader_error("Bad num_long_term_ref_pics_sps.");
+                }
+                for (std::uint32_t i = 0; i < num_long_term_ref_pics_sps; ++i) {
+                    // lt_ref_pic_poc_lsb_sps u(v), used_by_curr_pic_lt_sps_flag u(1)
+                    reader.skip_bits(log2_max_pic_order_cnt_lsb_minus4 + 4 + 1);
+                }
+            }
+            // sps_temporal_mvp_enabled_flag, strong_intra_smoothing_enabled_flag u(1)
+            reader.skip_bits(2);
+            // vui_parameters_present_flag u(1)
+            if (reader.read_bit()) {
+                impl::parse_hevc_vui_parameters(reader, result);
+            }
+        }
+        catch (const bit_reader_error&) {
+            // Everything after the ordering info is only needed for the
+            // aspect ratio and frame rate, keep what was read.
+        }
+    }
+    catch (const bit_reader_error&) {
+        return false;
+    }
+    info = result;
+    return true;
+}
+
+} // namespace parser
+} // namespace dawn_player
@@ -0,0 +1,52 @@
+/*
+ *    sps_parser.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_SPS_PARSER_HPP
+#define DAWN_PLAYER_SPS_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dawn_player {
+namespace parser {
+
+// What a sequence parameter set says about the video.
+struct sps_info {
+    // profile_idc / general_profile_idc
+    std::uint32_t profile_idc;
+    // level_idc / general_level_idc
+    std::uint32_t level_idc;
+    // Size of the decoded pictures.
+    std::uint32_t coded_width;
+    std::uint32_t coded_height;
+    // Size after applying the cropping / conformance window.
+    std::uint32_t width;
+    std::uint32_t height;
+    // Sample aspect ratio, 1:1 when not signalled.
+    std::uint32_t sar_width;
+    std::uint32_t sar_height;
+    // Frames per second from the VUI timing info, 0 when not signalled.
+    double frame_rate;
+    // Maximum number of frames that precede any frame in decoding order and
+    // follow it in output order, -1 when unknown. 0 means no B-frame style
+    // reordering, so the decoder may output frames as soon as they are
+    // decoded.
+    std::int32_t max_num_reorder_frames;
+    sps_info();
+};
+
+// Both functions take a single SPS NAL unit, including its NAL unit header
+// and still escaped with emulation prevention bytes, as stored in the
+// decoder configuration records. They return false if the SPS is malformed
+// or uses syntax they do not support.
+bool parse_h264_sps(const std::uint8_t* data, std::size_t size, sps_info& info);
+bool parse_hevc_sps(const std::uint8_t* data, std::size_t size, sps_info& info);
+
+} // namespace parser
+} // namespace dawn_player
+
+#endif
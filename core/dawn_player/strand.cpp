@@ -0,0 +1,86 @@
+/*
+ *    strand.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include "strand.hpp"
+
+namespace dawn_player {
+namespace impl
+{
+
+thread_local strand_context* current_strand = nullptr;
+
+void post_to_strand(strand_context& strand_ctx, std::function<void()>&& task)
+{
+    bool need_schedule = false;
+    {
+        std::unique_lock<std::mutex> lck(strand_ctx.task_queue_mtx);
+        strand_ctx.task_queue.push(std::move(task));
+        if (!strand_ctx.is_scheduled) {
+            strand_ctx.is_scheduled = true;
+            need_schedule = true;
+        }
+    }
+    if (need_schedule) {
+        strand_ctx.schedule();
+    }
+}
+
+void run_strand(strand_context& strand_ctx, std::size_t max_task_count)
+{
+    // Ends the turn however the loop below is left, so that a task that
+    // throws neither keeps the thread marked as running the strand nor the
+    // strand marked as queued with nobody to run it.
+    struct strand_turn {
+        strand_context& strand_ctx;
+        strand_context* previous_strand;
+        bool is_released = false;
+        explicit strand_turn(strand_context& strand_ctx)
+            : strand_ctx(strand_ctx)
+            , previous_strand(current_strand)
+        {
+            current_strand = &strand_ctx;
+        }
+        ~strand_turn()
+        {
+            current_strand = this->previous_strand;
+            if (this->is_released) {
+                return;
+            }
+            {
+                std::unique_lock<std::mutex> lck(this->strand_ctx.task_queue_mtx);
+                if (this->strand_ctx.task_queue.empty()) {
+                    this->strand_ctx.is_scheduled = false;
+                    return;
+                }
+            }
+            // Still has pending tasks, go to the back of the queue.
+            this->strand_ctx.schedule();
+        }
+    } turn(strand_ctx);
+    for (std::size_t i = 0; i < max_task_count; ++i) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lck(strand_ctx.task_queue_mtx);
+            if (strand_ctx.task_queue.empty()) {
+                strand_ctx.is_scheduled = false;
+                turn.is_released = true;
+                return;
+            }
+            task = std::move(strand_ctx.task_queue.front());
+            strand_ctx.task_queue.pop();
+        }
+        task();
+    }
+}
+
+bool is_running_strand(const strand_context& strand_ctx)
+{
+    return current_strand == &strand_ctx;
+}
+
+} // namespace impl
+} // namespace dawn_player
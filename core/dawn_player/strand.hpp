@@ -0,0 +1,48 @@
+/*
+ *    strand.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_STRAND_HPP
+#define DAWN_PLAYER_STRAND_HPP
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+
+namespace dawn_player {
+namespace impl
+{
+
+// A strand serializes the tasks of one task_service on threads shared with
+// other strands. It is queued on its threads at most once at a time, so its
+// tasks never run concurrently. The context derived for each kind of
+// thread set says how the strand is queued there.
+struct strand_context : public std::enable_shared_from_this<strand_context> {
+    std::queue<std::function<void()>> task_queue;
+    std::mutex task_queue_mtx;
+    bool is_scheduled = false;
+    virtual ~strand_context() {}
+    // Queues the strand, a thread that takes it calls run_strand().
+    virtual void schedule() = 0;
+};
+
+// Queues task on the strand, and the strand unless it is queued already.
+void post_to_strand(strand_context& strand_ctx, std::function<void()>&& task);
+
+// Runs up to max_task_count tasks of the strand on the calling thread, then
+// queues the strand again if tasks are left. An exception thrown by a task
+// propagates, the strand is released as if the turn had ended there.
+void run_strand(strand_context& strand_ctx, std::size_t max_task_count);
+
+// Whether the calling thread is running a task of the strand.
+bool is_running_strand(const strand_context& strand_ctx);
+
+} // namespace impl
+} // namespace dawn_player
+
+#endif
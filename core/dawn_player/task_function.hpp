@@ -0,0 +1,164 @@
+/*
+ *    task_function.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_TASK_FUNCTION_HPP
+#define DAWN_PLAYER_TASK_FUNCTION_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace dawn_player {
+namespace impl {
+
+// A move-only void() callable. Callables of up to inline_size bytes that
+// can be moved without throwing are kept in place, so wrapping a lambda
+// with a few captures (or a std::function) allocates nothing. Larger ones
+// are moved to the heap.
+class task_function {
+public:
+    // Room for a std::function or five pointers, and small enough that a
+    // task node holding one fits in 64 bytes.
+    static constexpr std::size_t inline_size = 40;
+
+    task_function() noexcept
+        : ops(nullptr)
+    {
+    }
+
+    template <typename Function, typename = std::enable_if_t<!std::is_same_v<std::decay_t<Function>, task_function>>>
+    task_function(Function&& function)
+        : ops(nullptr)
+    {
+        this->emplace(std::forward<Function>(function));
+    }
+
+    task_function(task_function&& other) noexcept
+        : ops(other.ops)
+    {
+        if (this->ops != nullptr) {
+            this->ops->move(other.storage, this->storage);
+            other.ops = nullptr;
+        }
+    }
+
+    task_function& operator=(task_function&& other) noexcept
+    {
+        if (this != &other) {
+            this->reset();
+            if (other.ops != nullptr) {
+                other.ops->move(other.storage, this->storage);
+                this->ops = other.ops;
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    task_function(const task_function&) = delete;
+    task_function& operator=(const task_function&) = delete;
+
+    ~task_function()
+    {
+        this->reset();
+    }
+
+    explicit operator bool() const noexcept
+    {
+        return this->ops != nullptr;
+    }
+
+    void operator()()
+    {
+        this->ops->invoke(this->storage);
+    }
+
+    // Replaces the callable, constructing the new one in place.
+    template <typename Function>
+    void emplace(Function&& function)
+    {
+        using stored_type = std::decay_t<Function>;
+        this->reset();
+        if constexpr (is_inline<stored_type>()) {
+            ::new (static_cast<void*>(this->storage)) stored_type(std::forward<Function>(function));
+            this->ops = &inline_operations<stored_type>::ops;
+        }
+        else {
+            *reinterpret_cast<stored_type**>(this->storage) = new stored_type(std::forward<Function>(function));
+            this->ops = &heap_operations<stored_type>::ops;
+        }
+    }
+
+    // Destroys the callable, and with it what it captured.
+    void reset() noexcept
+    {
+        if (this->ops != nullptr) {
+            this->ops->destroy(this->storage);
+            this->ops = nullptr;
+        }
+    }
+
+private:
+    struct operations {
+        void (*invoke)(void* storage);
+        // Moves the callable to uninitialized storage and destroys the
+        // source.
+        void (*move)(void* from, void* to) noexcept;
+        void (*destroy)(void* storage) noexcept;
+    };
+
+    template <typename Stored>
+    static constexpr bool is_inline()
+    {
+        return sizeof(Stored) <= inline_size && alignof(Stored) <= alignof(std::max_align_t)
+            && std::is_nothrow_move_constructible_v<Stored>;
+    }
+
+    template <typename Stored>
+    struct inline_operations {
+        static void invoke(void* storage)
+        {
+            (*static_cast<Stored*>(storage))();
+        }
+        static void move(void* from, void* to) noexcept
+        {
+            ::new (to) Stored(std::move(*static_cast<Stored*>(from)));
+            static_cast<Stored*>(from)->~Stored();
+        }
+        static void destroy(void* storage) noexcept
+        {
+            static_cast<Stored*>(storage)->~Stored();
+        }
+        static constexpr operations ops = { &invoke, &move, &destroy };
+    };
+
+    template <typename Stored>
+    struct heap_operations {
+        static void invoke(void* storage)
+        {
+            (**static_cast<Stored**>(storage))();
+        }
+        static void move(void* from, void* to) noexcept
+        {
+            *static_cast<Stored**>(to) = *static_cast<Stored**>(from);
+        }
+        static void destroy(void* storage) noexcept
+        {
+            delete *static_cast<Stored**>(storage);
+        }
+        static constexpr operations ops = { &invoke, &move, &destroy };
+    };
+
+    alignas(std::max_align_t) unsigned char storage[inline_size];
+    const operations* ops;
+};
+
+} // namespace impl
+} // namespace dawn_player
+
+#endif
@@ -11,8 +11,22 @@
 
 namespace dawn_player {
 
+void task_service::post_task_node(impl::task_node* node)
+{
+    this->post_task([node]() {
+        node->run();
+    });
+}
+
 namespace impl {
 
+void function_task_node::run()
+{
+    // Freed after the task, or if it throws.
+    std::unique_ptr<function_task_node> self(this);
+    this->task();
+}
+
 switch_task_service_awaitor::switch_task_service_awaitor(task_service* service)
     : tsk_service(service)
 {}
@@ -28,9 +42,15 @@ void switch_task_service_awaitor::await_resume()
 
 void switch_task_service_awaitor::await_suspend(std::coroutine_handle<> coro)
 {
-    this->tsk_service->post_task([coro]() {
-        coro.resume();
-    });
+    // The awaitor lives in the coroutine frame until the coroutine is
+    // resumed, so it can be queued as an intrusive node.
+    this->coro = coro;
+    this->tsk_service->post_task_node(this);
+}
+
+void switch_task_service_awaitor::run()
+{
+    this->coro.resume();
 }
 
 } // namespace impl
@@ -8,26 +8,67 @@
 #ifndef DAWN_PLAYER_TASK_SERVICE_HPP
 #define DAWN_PLAYER_TASK_SERVICE_HPP
 
+#include <atomic>
 #include <coroutine>
 #include <functional>
 #include <thread>
+#include <utility>
+
+#include "coroutine/frame_allocator.hpp"
+#include "task_function.hpp"
 
 namespace dawn_player {
 
+namespace impl {
+    // An intrusive task that can be queued without allocating. The owner of
+    // the node keeps it alive until run() has been called.
+    struct task_node {
+        std::atomic<task_node*> next{ nullptr };
+        virtual ~task_node() {}
+        virtual void run() {}
+    };
+
+    // Carries a posted function, stored in the node itself when it is small.
+    // Nodes are freed on the service thread, so they come from the frame
+    // cache, which hands them back to the thread that posted them.
+    struct function_task_node : public task_node {
+        task_function task;
+        template <typename Function>
+        explicit function_task_node(Function&& task)
+            : task(std::forward<Function>(task))
+        {}
+        virtual void run();
+        static void* operator new(std::size_t size) { return coroutine::impl::frame_cache::allocate(size); }
+        static void operator delete(void* ptr, std::size_t size) { coroutine::impl::frame_cache::deallocate(ptr, size); }
+    };
+}
+
 struct task_service {
     virtual void post_task(std::function<void()>&& task) = 0;
+    virtual void post_task_node(impl::task_node* node);
     virtual std::thread::id get_thread_id() = 0;
     virtual ~task_service() {}
+    // Posts any callable, move-only ones included, without wrapping it in a
+    // std::function first. Small callables are stored in the task node
+    // itself, so a post makes at most one allocation.
+    template <typename Function>
+    void post(Function&& task)
+    {
+        this->post_task_node(new impl::function_task_node(std::forward<Function>(task)));
+    }
 };
 
 namespace impl {
-    class switch_task_service_awaitor {
+    class switch_task_service_awaitor : private task_node {
         task_service* tsk_service;
+        std::coroutine_handle<> coro;
     public:
         switch_task_service_awaitor(task_service* service);
         bool await_ready();
         void await_resume();
         void await_suspend(std::coroutine_handle<> coro);
+    private:
+        virtual void run();
     };
 }
 
@@ -0,0 +1,295 @@
+/*
+ *    timeshift_io.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "coroutine/sync_wait.hpp"
+#include "timeshift_io.hpp"
+
+namespace dawn_player {
+namespace io {
+namespace impl {
+
+const std::uint32_t timeshift_ingest_size = 64 * 1024;
+const std::uint64_t flv_tag_header_size = 11;
+const std::uint64_t flv_previous_tag_size_size = 4;
+
+timeshift_context::~timeshift_context()
+{
+    if (this->ring != nullptr) {
+        ::munmap(this->ring, static_cast<std::size_t>(this->capacity));
+    }
+}
+
+std::uint8_t ring_byte(const timeshift_context& ctx, std::uint64_t pos)
+{
+    return ctx.ring[pos % ctx.capacity];
+}
+
+void copy_from_ring(const timeshift_context& ctx, std::uint8_t* buf, std::uint64_t pos, std::uint64_t size)
+{
+    while (size != 0) {
+        auto offset = pos % ctx.capacity;
+        auto length = std::min(size, ctx.capacity - offset);
+        std::memcpy(buf, ctx.ring + offset, static_cast<std::size_t>(length));
+        buf += length;
+        pos += length;
+        size -= length;
+    }
+}
+
+void copy_to_ring(timeshift_context& ctx, const std::uint8_t* data, std::uint64_t pos, std::uint64_t size)
+{
+    while (size != 0) {
+        auto offset = pos % ctx.capacity;
+        auto length = std::min(size, ctx.capacity - offset);
+        std::memcpy(ctx.ring + offset, data, static_cast<std::size_t>(length));
+        data += length;
+        pos += length;
+        size -= length;
+    }
+}
+
+// Whether a whole tag with a sane header starts at pos: a known tag type, a
+// zero stream id and a previous tag size that matches the data size.
+bool is_valid_tag(const timeshift_context& ctx, std::uint64_t pos, std::uint64_t data_size)
+{
+    auto tag_type = ring_byte(ctx, pos) & 0x1f;
+    if (tag_type != 8 && tag_type != 9 && tag_type != 18) {
+        return false;
+    }
+    for (std::uint64_t i = 8; i < flv_tag_header_size; ++i) {
+        if (ring_byte(ctx, pos + i) != 0) {
+            return false;
+        }
+    }
+    auto end = pos + flv_tag_header_size + data_size;
+    std::uint64_t previous_tag_size = 0;
+    for (std::uint64_t i = 0; i < flv_previous_tag_size_size; ++i) {
+        previous_tag_size = (previous_tag_size << 8) | ring_byte(ctx, end + i);
+    }
+    return previous_tag_size == flv_tag_header_size + data_size;
+}
+
+// Walks the tags that are complete in [scan_position, head) and records the
+// video keyframes. Codec configuration tags are skipped, the player gets
+// them from the start of the stream. After a corrupt tag header the walk
+// goes on byte by byte until a valid tag starts.
+void scan_tags(timeshift_context& ctx)
+{
+    if (ctx.scan_position == 0) {
+        // FLV header: signature[3], version, flags, data offset u32, then
+        // the first previous tag size.
+        if (ctx.head < 9) {
+            return;
+        }
+        std::uint64_t data_offset = 0;
+        for (std::uint64_t i = 5; i < 9; ++i) {
+            data_offset = (data_offset << 8) | ring_byte(ctx, i);
+        }
+        ctx.scan_position = std::max<std::uint64_t>(data_offset, 9) + flv_previous_tag_size_size;
+    }
+    // Dropped out of the ring while resyncing.
+    ctx.scan_position = std::max(ctx.scan_position, ctx.tail);
+    while (ctx.scan_position + flv_tag_header_size + flv_previous_tag_size_size <= ctx.head) {
+        auto pos = ctx.scan_position;
+        auto tag_type = ring_byte(ctx, pos) & 0x1f;
+        std::uint64_t data_size = 0;
+        for (std::uint64_t i = 1; i < 4; ++i) {
+            data_size = (data_size << 8) | ring_byte(ctx, pos + i);
+        }
+        auto tag_size = flv_tag_header_size + data_size + flv_previous_tag_size_size;
+        if (tag_size > ctx.capacity) {
+            ++ctx.scan_position;
+            continue;
+        }
+        if (pos + tag_size > ctx.head) {
+            break;
+        }
+        if (!is_valid_tag(ctx, pos, data_size)) {
+            ++ctx.scan_position;
+            continue;
+        }
+        std::uint32_t timestamp = 0;
+        for (std::uint64_t i = 4; i < 7; ++i) {
+            timestamp = (timestamp << 8) | ring_byte(ctx, pos + i);
+        }
+        timestamp |= static_cast<std::uint32_t>(ring_byte(ctx, pos + 7)) << 24;
+        if (tag_type == 9 && data_size >= 2) {
+            auto flags = ring_byte(ctx, pos + flv_tag_header_size);
+            auto codec_id = flags & 0x0f;
+            auto packet_type = ring_byte(ctx, pos + flv_tag_header_size + 1);
+            bool is_configuration = (codec_id == 7 || codec_id == 12) && packet_type == 0;
+            if ((flags >> 4) == 1 && !is_configuration && pos >= ctx.tail) {
+                ctx.keyframes.emplace_back(timestamp / 1000.0, pos);
+            }
+        }
+        ctx.scan_position = pos + tag_size;
+    }
+}
+
+void ingest_proc(const std::shared_ptr<timeshift_context>& ctx)
+{
+    std::vector<std::uint8_t> buffer(timeshift_ingest_size);
+    for (;;) {
+        std::uint32_t result = 0;
+        std::exception_ptr error;
+        try {
+            result = coroutine::sync_wait_task(ctx->inner->read(buffer.data(), timeshift_ingest_size));
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        {
+            std::unique_lock<std::mutex> lck(ctx->mtx);
+            if (ctx->is_stopped) {
+                break;
+            }
+            if (error != nullptr || result == 0) {
+                ctx->error = error;
+                ctx->is_end = true;
+                lck.unlock();
+                ctx->data_event.set();
+                break;
+            }
+            // Readers copy under the lock, so the oldest bytes can be
+            // overwritten in place.
+            copy_to_ring(*ctx, buffer.data(), ctx->head, result);
+            ctx->head += result;
+            if (ctx->head - ctx->tail > ctx->capacity) {
+                ctx->tail = ctx->head - ctx->capacity;
+            }
+            while (!ctx->keyframes.empty() && ctx->keyframes.front().second < ctx->tail) {
+                ctx->keyframes.pop_front();
+            }
+            scan_tags(*ctx);
+        }
+        ctx->data_event.set();
+    }
+    // The inner proxy may hold connections, release it on this thread.
+    ctx->inner.reset();
+}
+
+} // namespace impl
+
+timeshift_read_stream_proxy::timeshift_read_stream_proxy(const std::shared_ptr<read_stream_proxy>& inner, const std::string& directory,
+    std::uint64_t capacity)
+    : ctx(std::make_shared<impl::timeshift_context>())
+    , position(0)
+{
+    if (inner == nullptr || capacity == 0) {
+        throw std::runtime_error("bad operation");
+    }
+    auto path = directory + "/dawn_player_timeshift_XXXXXX";
+    auto fd = ::mkstemp(&path[0]);
+    if (fd < 0) {
+        throw std::runtime_error("failed to create timeshift file");
+    }
+    // Nothing else needs the file, its pages go when the mapping does.
+    ::unlink(path.c_str());
+    void* addr = MAP_FAILED;
+    if (::ftruncate(fd, static_cast<off_t>(capacity)) == 0) {
+        addr = ::mmap(nullptr, static_cast<std::size_t>(capacity), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw std::runtime_error("failed to map timeshift file");
+    }
+    this->ctx->ring = static_cast<std::uint8_t*>(addr);
+    this->ctx->capacity = capacity;
+    this->ctx->inner = inner;
+    auto ctx = this->ctx;
+    this->ingest_thread = std::thread([ctx]() {
+        impl::ingest_proc(ctx);
+    });
+}
+
+timeshift_read_stream_proxy::~timeshift_read_stream_proxy()
+{
+    {
+        std::unique_lock<std::mutex> lck(this->ctx->mtx);
+        this->ctx->is_stopped = true;
+    }
+    // A reader resumed by the ingest thread may drop the last reference to
+    // the proxy there, the thread then leaves on its own.
+    if (this->ingest_thread.get_id() == std::this_thread::get_id()) {
+        this->ingest_thread.detach();
+    }
+    else {
+        this->ingest_thread.join();
+    }
+}
+
+bool timeshift_read_stream_proxy::can_seek() const
+{
+    return true;
+}
+
+coroutine::task<std::uint32_t> timeshift_read_stream_proxy::read(std::uint8_t* buf, std::uint32_t size)
+{
+    auto& ctx = *this->ctx;
+    std::unique_lock<std::mutex> lck(ctx.mtx);
+    while (ctx.head <= this->position && !ctx.is_end) {
+        // Reset under the lock, the ingest thread sets the event after it
+        // has released the lock with more data in.
+        ctx.data_event.reset();
+        lck.unlock();
+        co_await ctx.data_event;
+        lck.lock();
+    }
+    if (this->position < ctx.tail) {
+        throw std::runtime_error("timeshift position is no longer buffered");
+    }
+    if (ctx.head <= this->position) {
+        if (ctx.error != nullptr) {
+            std::rethrow_exception(ctx.error);
+        }
+        co_return 0;
+    }
+    auto length = static_cast<std::uint32_t>(std::min<std::uint64_t>(size, ctx.head - this->position));
+    impl::copy_from_ring(ctx, buf, this->position, length);
+    lck.unlock();
+    this->position += length;
+    co_return length;
+}
+
+void timeshift_read_stream_proxy::seek(std::uint64_t pos)
+{
+    std::unique_lock<std::mutex> lck(this->ctx->mtx);
+    if (pos < this->ctx->tail || pos > this->ctx->head) {
+        throw std::runtime_error("bad operation");
+    }
+    this->position = pos;
+}
+
+bool timeshift_read_stream_proxy::get_keyframes(std::vector<std::pair<double, std::uint64_t>>& keyframes)
+{
+    std::unique_lock<std::mutex> lck(this->ctx->mtx);
+    keyframes.assign(this->ctx->keyframes.begin(), this->ctx->keyframes.end());
+    return true;
+}
+
+std::uint64_t timeshift_read_stream_proxy::get_oldest_position() const
+{
+    std::unique_lock<std::mutex> lck(this->ctx->mtx);
+    return this->ctx->tail;
+}
+
+std::uint64_t timeshift_read_stream_proxy::get_live_position() const
+{
+    std::unique_lock<std::mutex> lck(this->ctx->mtx);
+    return this->ctx->head;
+}
+
+} // namespace io
+} // namespace dawn_player
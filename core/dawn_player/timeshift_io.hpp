@@ -0,0 +1,88 @@
+/*
+ *    timeshift_io.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_TIMESHIFT_IO_HPP
+#define DAWN_PLAYER_TIMESHIFT_IO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "coroutine/async_manual_reset_event.hpp"
+#include "io.hpp"
+
+namespace dawn_player {
+namespace io {
+namespace impl {
+
+struct timeshift_context {
+    std::shared_ptr<read_stream_proxy> inner;
+    // Shared mapping of an unlinked file, stream position p is at
+    // p % capacity while p is in [tail, head).
+    std::uint8_t* ring = nullptr;
+    std::uint64_t capacity = 0;
+    std::mutex mtx;
+    // Set by the ingest thread after it has appended data or reached the end,
+    // reset by a read() that waits at the live edge.
+    coroutine::async_manual_reset_event data_event;
+    std::uint64_t tail = 0;
+    std::uint64_t head = 0;
+    // Start of the next FLV tag header to index, 0 until the file header is in.
+    std::uint64_t scan_position = 0;
+    // (time in seconds, tag position) of the video keyframes in the ring, oldest first.
+    std::deque<std::pair<double, std::uint64_t>> keyframes;
+    std::exception_ptr error;
+    bool is_end = false;
+    bool is_stopped = false;
+
+    ~timeshift_context();
+};
+
+} // namespace impl
+
+// Timeshift (DVR) over a live FLV stream. A thread keeps appending what the
+// inner proxy delivers to a ring of capacity bytes in a memory mapped,
+// unlinked file under directory, and indexes the video keyframes as they
+// arrive. The reader may seek to any position still in the ring, so the
+// player can go back up to capacity bytes of the broadcast and return to
+// the live edge without fetching anything from the origin again. A read()
+// at the live edge suspends until more data has arrived, and resumes on the
+// ingest thread.
+//
+// The inner proxy is read from the moment of construction on, whether or
+// not the reader keeps up. A reader that falls out of the ring gets an
+// error from read() until it seeks back into the ring. The destructor waits
+// for the read of the inner proxy in progress to return.
+class timeshift_read_stream_proxy : public read_stream_proxy {
+public:
+    timeshift_read_stream_proxy(const std::shared_ptr<read_stream_proxy>& inner, const std::string& directory,
+        std::uint64_t capacity = 512 * 1024 * 1024);
+    virtual ~timeshift_read_stream_proxy();
+    virtual bool can_seek() const;
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
+    virtual void seek(std::uint64_t pos);
+    virtual bool get_keyframes(std::vector<std::pair<double, std::uint64_t>>& keyframes);
+    // Stream positions [oldest, live) are in the ring.
+    std::uint64_t get_oldest_position() const;
+    std::uint64_t get_live_position() const;
+private:
+    std::shared_ptr<impl::timeshift_context> ctx;
+    std::uint64_t position;
+    std::thread ingest_thread;
+};
+
+} // namespace io
+} // namespace dawn_player
+
+#endif
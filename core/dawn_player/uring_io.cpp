@@ -0,0 +1,418 @@
+/*
+ *    uring_io.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "posix_io.hpp"
+#include "uring_io.hpp"
+
+namespace dawn_player {
+namespace io {
+namespace impl
+{
+
+// user_data of the NOP that stops the completion thread.
+constexpr std::uint64_t stop_user_data = std::numeric_limits<std::uint64_t>::max();
+
+int io_uring_setup(unsigned entries, io_uring_params* params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int ring_fd, unsigned opcode, const void* arg, unsigned nr_args)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, ring_fd, opcode, arg, nr_args));
+}
+
+} // namespace impl
+
+std::shared_ptr<read_stream_proxy> uring_read_stream_proxy::create(const std::shared_ptr<task_service>& service, const std::string& path, std::uint32_t queue_depth, std::uint32_t block_size)
+{
+    try {
+        return std::make_shared<uring_read_stream_proxy>(service, path, queue_depth, block_size);
+    }
+    catch (const uring_unavailable_error&) {
+        return std::make_shared<file_read_stream_proxy>(path);
+    }
+}
+
+uring_read_stream_proxy::uring_read_stream_proxy(const std::shared_ptr<task_service>& service, const std::string& path, std::uint32_t queue_depth, std::uint32_t block_size)
+    : tsk_service(service)
+    , fd(-1)
+    , file_size(0)
+    , position(0)
+    , next_read_offset(0)
+    , block_size(std::max<std::uint32_t>(block_size, 4096))
+    , buffers(nullptr)
+    , is_buffers_registered(false)
+    , head_slot(0)
+    , submitted_slot_count(0)
+    , inflight_count(0)
+    , ring_fd(-1)
+    , sq_ring(MAP_FAILED)
+    , sq_ring_size(0)
+    , cq_ring(MAP_FAILED)
+    , cq_ring_size(0)
+    , sqes(nullptr)
+    , sqes_size(0)
+    , sq_tail(nullptr)
+    , sq_mask(nullptr)
+    , sq_array(nullptr)
+    , cq_head(nullptr)
+    , cq_tail(nullptr)
+    , cq_mask(nullptr)
+    , cqes(nullptr)
+{
+    queue_depth = std::clamp<std::uint32_t>(queue_depth, 1, 64);
+    // Block sizes and buffers are page aligned, as registered buffers are
+    // pinned by the page. The file is not opened with O_DIRECT, so reads
+    // still copy from the page cache.
+    this->block_size = (this->block_size + 4095) & ~std::uint32_t(4095);
+    this->fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (this->fd == -1) {
+        throw std::runtime_error("failed to open file");
+    }
+    struct stat st;
+    if (::fstat(this->fd, &st) != 0) {
+        ::close(this->fd);
+        throw std::runtime_error("failed to stat file");
+    }
+    this->file_size = static_cast<std::uint64_t>(st.st_size);
+    void* memory = nullptr;
+    if (::posix_memalign(&memory, 4096, static_cast<std::size_t>(queue_depth) * this->block_size) != 0) {
+        ::close(this->fd);
+        throw std::bad_alloc();
+    }
+    this->buffers = static_cast<std::uint8_t*>(memory);
+    for (std::uint32_t i = 0; i < queue_depth; ++i) {
+        auto slot = std::make_shared<impl::uring_read_slot>();
+        slot->buffer = this->buffers + static_cast<std::size_t>(i) * this->block_size;
+        this->slots.emplace_back(std::move(slot));
+    }
+    try {
+        // One more entry for the NOP that stops the completion thread.
+        this->setup_ring(queue_depth + 1);
+    }
+    catch (...) {
+        this->destroy_ring();
+        std::free(this->buffers);
+        ::close(this->fd);
+        throw;
+    }
+    std::vector<iovec> iovecs(queue_depth);
+    for (std::uint32_t i = 0; i < queue_depth; ++i) {
+        iovecs[i].iov_base = this->slots[i]->buffer;
+        iovecs[i].iov_len = this->block_size;
+    }
+    // Registering pins the buffers, it may fail under a low RLIMIT_MEMLOCK.
+    // Plain reads are used then.
+    this->is_buffers_registered = impl::io_uring_register(this->ring_fd, IORING_REGISTER_BUFFERS, iovecs.data(), queue_depth) == 0;
+    this->completion_thread = std::thread([this]() {
+        this->completion_thread_proc();
+    });
+}
+
+uring_read_stream_proxy::~uring_read_stream_proxy()
+{
+    this->wait_for_inflight_reads();
+    auto sqe = this->next_sqe();
+    sqe->opcode = IORING_OP_NOP;
+    sqe->user_data = impl::stop_user_data;
+    try {
+        this->submit(1);
+    }
+    catch (const std::runtime_error&) {
+        // The ring is unusable, the completion thread's wait fails as well
+        // and it returns.
+    }
+    this->completion_thread.join();
+    if (this->is_buffers_registered) {
+        impl::io_uring_register(this->ring_fd, IORING_UNREGISTER_BUFFERS, nullptr, 0);
+    }
+    this->destroy_ring();
+    std::free(this->buffers);
+    ::close(this->fd);
+}
+
+bool uring_read_stream_proxy::can_seek() const
+{
+    return true;
+}
+
+coroutine::task<std::uint32_t> uring_read_stream_proxy::read(std::uint8_t* buf, std::uint32_t size)
+{
+    co_await this->wait_for_idle_slots();
+    this->submit_read_ahead();
+    auto& slot = *this->slots[this->head_slot];
+    if (!slot.is_submitted) {
+        // End of file.
+        co_return 0;
+    }
+    co_await slot.completed;
+    auto slot_result = slot.result.load(std::memory_order_relaxed);
+    if (slot_result < 0) {
+        throw std::runtime_error("failed to read file");
+    }
+    auto available = static_cast<std::uint32_t>(slot_result) - slot.consumed;
+    auto result = std::min(size, available);
+    std::memcpy(buf, slot.buffer + slot.consumed, result);
+    slot.consumed += result;
+    this->position += result;
+    if (slot.consumed == static_cast<std::uint32_t>(slot_result)) {
+        auto is_short_read = slot_result < static_cast<std::int32_t>(slot.length);
+        slot.is_submitted = false;
+        slot.completed.reset();
+        this->head_slot = (this->head_slot + 1) % static_cast<std::uint32_t>(this->slots.size());
+        --this->submitted_slot_count;
+        if (is_short_read) {
+            // The blocks queued behind this one start at the wrong offset,
+            // the next read() queues new ones once they have landed.
+            this->restart_at(this->position);
+        }
+        else {
+            this->submit_read_ahead();
+        }
+    }
+    co_return result;
+}
+
+void uring_read_stream_proxy::seek(std::uint64_t pos)
+{
+    if (pos == this->position) {
+        return;
+    }
+    this->restart_at(pos);
+}
+
+void uring_read_stream_proxy::setup_ring(std::uint32_t entries)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    this->ring_fd = impl::io_uring_setup(entries, &params);
+    if (this->ring_fd < 0) {
+        // ENOSYS on old kernels, EPERM when disabled by sysctl or seccomp.
+        throw uring_unavailable_error("io_uring is not available");
+    }
+    this->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    this->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        this->sq_ring_size = std::max(this->sq_ring_size, this->cq_ring_size);
+        this->cq_ring_size = 0;
+    }
+    this->sq_ring = ::mmap(nullptr, this->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd, IORING_OFF_SQ_RING);
+    if (this->sq_ring == MAP_FAILED) {
+        throw uring_unavailable_error("failed to map io_uring");
+    }
+    if (this->cq_ring_size != 0) {
+        this->cq_ring = ::mmap(nullptr, this->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd, IORING_OFF_CQ_RING);
+        if (this->cq_ring == MAP_FAILED) {
+            throw uring_unavailable_error("failed to map io_uring");
+        }
+    }
+    auto sqes_memory = ::mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ring_fd, IORING_OFF_SQES);
+    if (sqes_memory == MAP_FAILED) {
+        throw uring_unavailable_error("failed to map io_uring");
+    }
+    this->sqes = static_cast<io_uring_sqe*>(sqes_memory);
+    this->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+    auto sq = static_cast<std::uint8_t*>(this->sq_ring);
+    auto cq = this->cq_ring_size != 0 ? static_cast<std::uint8_t*>(this->cq_ring) : sq;
+    this->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+    this->sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+    this->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+    this->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+    this->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+    this->cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+    this->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+}
+
+void uring_read_stream_proxy::destroy_ring()
+{
+    if (this->sqes != nullptr) {
+        ::munmap(this->sqes, this->sqes_size);
+    }
+    if (this->cq_ring != MAP_FAILED) {
+        ::munmap(this->cq_ring, this->cq_ring_size);
+    }
+    if (this->sq_ring != MAP_FAILED) {
+        ::munmap(this->sq_ring, this->sq_ring_size);
+    }
+    if (this->ring_fd >= 0) {
+        ::close(this->ring_fd);
+    }
+}
+
+coroutine::task<void> uring_read_stream_proxy::wait_for_idle_slots()
+{
+    for (auto& slot : this->slots) {
+        if (!slot->is_submitted) {
+            co_await slot->landed;
+        }
+    }
+}
+
+void uring_read_stream_proxy::submit_read_ahead()
+{
+    auto slot_count = static_cast<std::uint32_t>(this->slots.size());
+    std::uint32_t count = 0;
+    while (this->submitted_slot_count < slot_count && this->next_read_offset < this->file_size) {
+        // Slot i reads into registered buffer i.
+        auto index = (this->head_slot + this->submitted_slot_count) % slot_count;
+        auto& slot = *this->slots[index];
+        slot.offset = this->next_read_offset;
+        slot.length = static_cast<std::uint32_t>(std::min<std::uint64_t>(this->block_size, this->file_size - this->next_read_offset));
+        slot.result.store(0, std::memory_order_relaxed);
+        slot.consumed = 0;
+        slot.is_submitted = true;
+        slot.landed.reset();
+        ++slot.submission;
+        slot.is_in_flight.store(true, std::memory_order_release);
+        auto sqe = this->next_sqe();
+        if (this->is_buffers_registered) {
+            sqe->opcode = IORING_OP_READ_FIXED;
+            sqe->buf_index = static_cast<std::uint16_t>(index);
+        }
+        else {
+            sqe->opcode = IORING_OP_READ;
+        }
+        sqe->fd = this->fd;
+        sqe->off = slot.offset;
+        sqe->addr = reinterpret_cast<std::uint64_t>(slot.buffer);
+        sqe->len = slot.length;
+        sqe->user_data = (static_cast<std::uint64_t>(slot.submission) << 32) | index;
+        this->next_read_offset += slot.length;
+        ++this->submitted_slot_count;
+        ++count;
+    }
+    if (count != 0) {
+        this->inflight_count.fetch_add(count);
+        this->submit(count);
+    }
+}
+
+io_uring_sqe* uring_read_stream_proxy::next_sqe()
+{
+    // Only the thread calling read() and seek() touches the submission queue.
+    auto tail = std::atomic_ref<unsigned>(*this->sq_tail).load(std::memory_order_relaxed);
+    auto index = tail & *this->sq_mask;
+    auto sqe = &this->sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    this->sq_array[index] = index;
+    std::atomic_ref<unsigned>(*this->sq_tail).store(tail + 1, std::memory_order_release);
+    return sqe;
+}
+
+void uring_read_stream_proxy::submit(std::uint32_t count)
+{
+    while (count != 0) {
+        auto result = impl::io_uring_enter(this->ring_fd, count, 0, 0);
+        if (result < 0) {
+            if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+                continue;
+            }
+            throw std::runtime_error("failed to submit to io_uring");
+        }
+        count -= static_cast<std::uint32_t>(result);
+    }
+}
+
+void uring_read_stream_proxy::wait_for_inflight_reads()
+{
+    for (;;) {
+        auto count = this->inflight_count.load();
+        if (count == 0) {
+            break;
+        }
+        this->inflight_count.wait(count);
+    }
+}
+
+void uring_read_stream_proxy::restart_at(std::uint64_t pos)
+{
+    // Reads still in flight keep their buffers until they land, see
+    // wait_for_idle_slots().
+    for (auto& slot : this->slots) {
+        slot->is_submitted = false;
+        // Drops the completions still posted for the reads drained.
+        ++slot->submission;
+        slot->completed.reset();
+    }
+    this->head_slot = 0;
+    this->submitted_slot_count = 0;
+    this->next_read_offset = pos;
+    this->position = pos;
+}
+
+void uring_read_stream_proxy::completion_thread_proc()
+{
+    for (;;) {
+        auto head = std::atomic_ref<unsigned>(*this->cq_head).load(std::memory_order_relaxed);
+        auto tail = std::atomic_ref<unsigned>(*this->cq_tail).load(std::memory_order_acquire);
+        if (head == tail) {
+            auto result = impl::io_uring_enter(this->ring_fd, 0, 1, IORING_ENTER_GETEVENTS);
+            if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                // The ring is unusable, fail everything still in flight.
+                for (std::uint32_t i = 0; i < this->slots.size(); ++i) {
+                    auto& slot = *this->slots[i];
+                    if (slot.is_in_flight.exchange(false)) {
+                        slot.result.store(-EIO, std::memory_order_relaxed);
+                        this->inflight_count.fetch_sub(1);
+                        this->post_completion(i, slot.submission);
+                    }
+                }
+                this->inflight_count.notify_all();
+                return;
+            }
+            continue;
+        }
+        auto cqe = this->cqes[head & *this->cq_mask];
+        std::atomic_ref<unsigned>(*this->cq_head).store(head + 1, std::memory_order_release);
+        if (cqe.user_data == impl::stop_user_data) {
+            return;
+        }
+        auto index = static_cast<std::uint32_t>(cqe.user_data);
+        auto& slot = *this->slots[index];
+        slot.result.store(cqe.res, std::memory_order_relaxed);
+        slot.is_in_flight.exchange(false);
+        // The destructor waits on the count before it frees the buffers.
+        this->inflight_count.fetch_sub(1);
+        this->inflight_count.notify_all();
+        this->post_completion(index, static_cast<std::uint32_t>(cqe.user_data >> 32));
+    }
+}
+
+void uring_read_stream_proxy::post_completion(std::uint32_t index, std::uint32_t submission)
+{
+    // The reader resumes on its own task service. A completion overtaken by
+    // restart_at() only frees the buffer.
+    this->tsk_service->post_task([slot = this->slots[index], submission]() {
+        if (slot->submission == submission) {
+            slot->completed.set();
+        }
+        slot->landed.set();
+    });
+}
+
+} // namespace io
+} // namespace dawn_player
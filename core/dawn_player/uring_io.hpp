@@ -0,0 +1,137 @@
+/*
+ *    uring_io.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_URING_IO_HPP
+#define DAWN_PLAYER_URING_IO_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "coroutine/async_manual_reset_event.hpp"
+#include "io.hpp"
+#include "task_service.hpp"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace dawn_player {
+namespace io {
+
+class uring_unavailable_error : public std::runtime_error {
+public:
+    explicit uring_unavailable_error(const char* msg) : std::runtime_error(msg) {}
+};
+
+namespace impl
+{
+
+// One read-ahead block, owned by the proxy while idle and by the kernel while
+// its read is in flight.
+struct uring_read_slot {
+    std::uint8_t* buffer = nullptr;
+    std::uint64_t offset = 0;
+    std::uint32_t length = 0;
+    // Written by the completion thread.
+    std::atomic<std::int32_t> result{ 0 };
+    // Set while the kernel owns the slot, cleared by the completion thread.
+    std::atomic<bool> is_in_flight{ false };
+    std::uint32_t consumed = 0;
+    bool is_submitted = false;
+    // Counts the reads of the slot, it goes to the high half of user_data.
+    // A completion posted for an earlier read is ignored.
+    std::uint32_t submission = 0;
+    // Set on the reader's task service once result is valid.
+    coroutine::async_manual_reset_event completed;
+    // Set on the reader's task service once the kernel is done with the
+    // buffer, also for reads dropped by a seek. The slot is not submitted
+    // again before.
+    coroutine::async_manual_reset_event landed{ true };
+};
+
+} // namespace impl
+
+// Reads a local file through an io_uring. Up to queue_depth sequential reads
+// of block_size bytes are kept in flight ahead of the read position, into
+// buffers registered with the ring when the kernel allows it. A completion
+// thread reaps the ring and posts each completion to the task service given,
+// that of the player, where the read() waiting for the block resumes. The
+// caller never blocks: seek() drops the reads in flight, and the read()
+// after it waits for them to land before it reuses their buffers. The
+// completion thread never runs the reader.
+//
+// The file size is taken when the proxy is created, use it for complete
+// files. Call read() and seek() on the task service thread, as flv_player
+// does.
+class uring_read_stream_proxy : public read_stream_proxy {
+public:
+    // Creates an io_uring proxy, or a file_read_stream_proxy when the kernel
+    // has no io_uring support or it is disabled.
+    static std::shared_ptr<read_stream_proxy> create(const std::shared_ptr<task_service>& service, const std::string& path, std::uint32_t queue_depth = 4, std::uint32_t block_size = 256 * 1024);
+
+    // Throws uring_unavailable_error if the ring cannot be set up.
+    uring_read_stream_proxy(const std::shared_ptr<task_service>& service, const std::string& path, std::uint32_t queue_depth, std::uint32_t block_size);
+    uring_read_stream_proxy(const uring_read_stream_proxy&) = delete;
+    uring_read_stream_proxy& operator=(const uring_read_stream_proxy&) = delete;
+    virtual ~uring_read_stream_proxy();
+    virtual bool can_seek() const;
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size);
+    virtual void seek(std::uint64_t pos);
+private:
+    void setup_ring(std::uint32_t entries);
+    void destroy_ring();
+    // Waits until the buffers of the slots that are not submitted are free.
+    coroutine::task<void> wait_for_idle_slots();
+    void submit_read_ahead();
+    void submit(std::uint32_t count);
+    io_uring_sqe* next_sqe();
+    void wait_for_inflight_reads();
+    void restart_at(std::uint64_t pos);
+    void completion_thread_proc();
+    void post_completion(std::uint32_t index, std::uint32_t submission);
+private:
+    std::shared_ptr<task_service> tsk_service;
+    int fd;
+    std::uint64_t file_size;
+    std::uint64_t position;
+    std::uint64_t next_read_offset;
+    std::uint32_t block_size;
+    std::uint8_t* buffers;
+    bool is_buffers_registered;
+    // Shared with the completions posted to tsk_service, which may run after
+    // the proxy is gone.
+    std::vector<std::shared_ptr<impl::uring_read_slot>> slots;
+    std::uint32_t head_slot;
+    std::uint32_t submitted_slot_count;
+    std::atomic<std::uint32_t> inflight_count;
+
+    int ring_fd;
+    void* sq_ring;
+    std::size_t sq_ring_size;
+    void* cq_ring;
+    std::size_t cq_ring_size;
+    io_uring_sqe* sqes;
+    std::size_t sqes_size;
+    unsigned* sq_tail;
+    unsigned* sq_mask;
+    unsigned* sq_array;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned* cq_mask;
+    io_uring_cqe* cqes;
+    std::thread completion_thread;
+};
+
+} // namespace io
+} // namespace dawn_player
+
+#endif
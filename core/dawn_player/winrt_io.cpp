@@ -1,17 +1,18 @@
 /*
- *    io.cpp:
+ *    winrt_io.cpp:
  *
  *    Copyright (C) 2015-2025 Light Lin <blog.poxiao.me> All Rights Reserved.
  *
  */
 
+#include <cstring>
 #include <stdexcept>
 
 #include <ppltasks.h>
 #include <robuffer.h>
 #include <winrt/Windows.Foundation.h>
 
-#include "io.hpp"
+#include "winrt_io.hpp"
 
 using namespace concurrency;
 using namespace winrt::Windows::Foundation;
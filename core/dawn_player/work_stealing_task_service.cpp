@@ -0,0 +1,198 @@
+/*
+ *    work_stealing_task_service.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <thread>
+
+#include "work_stealing_task_service.hpp"
+
+namespace dawn_player {
+namespace impl
+{
+
+// Upper bound on the tasks a strand runs before it goes back to the deques,
+// so that one busy player cannot hold on to a worker.
+const std::size_t max_tasks_per_work_stealing_strand_turn = 64;
+
+thread_local work_stealing_task_service_context* current_service_ctx = nullptr;
+thread_local std::size_t current_worker_index = 0;
+
+void push_task(work_stealing_task_service_context& service_ctx, std::function<void()>&& task)
+{
+    // Count the task before it becomes visible, so that a worker taking it
+    // never sees the counter underflow.
+    service_ctx.pending_task_count.fetch_add(1);
+    std::size_t index = 0;
+    if (current_service_ctx == &service_ctx) {
+        index = current_worker_index;
+    }
+    else {
+        index = service_ctx.next_worker_index.fetch_add(1, std::memory_order_relaxed) % service_ctx.workers.size();
+    }
+    {
+        auto& worker = *service_ctx.workers[index];
+        std::unique_lock<std::mutex> lck(worker.task_deque_mtx);
+        worker.task_deque.push_back(std::move(task));
+    }
+    if (service_ctx.sleeping_worker_count.load() != 0) {
+        {
+            std::unique_lock<std::mutex> lck(service_ctx.sleep_mtx);
+        }
+        service_ctx.sleep_cv.notify_one();
+    }
+}
+
+void work_stealing_strand_context::schedule()
+{
+    push_task(*this->service_ctx, [strand_ctx = this->shared_from_this()]() {
+        run_strand(*strand_ctx, max_tasks_per_work_stealing_strand_turn);
+    });
+}
+
+bool pop_local_task(work_stealing_worker& worker, std::function<void()>& task)
+{
+    std::unique_lock<std::mutex> lck(worker.task_deque_mtx);
+    if (worker.task_deque.empty()) {
+        return false;
+    }
+    task = std::move(worker.task_deque.back());
+    worker.task_deque.pop_back();
+    return true;
+}
+
+bool steal_task(work_stealing_worker& victim, std::function<void()>& task)
+{
+    std::unique_lock<std::mutex> lck(victim.task_deque_mtx, std::try_to_lock);
+    if (!lck.owns_lock() || victim.task_deque.empty()) {
+        return false;
+    }
+    task = std::move(victim.task_deque.front());
+    victim.task_deque.pop_front();
+    return true;
+}
+
+bool find_task(work_stealing_task_service_context& service_ctx, std::size_t worker_index, std::function<void()>& task)
+{
+    if (service_ctx.pending_task_count.load() == 0) {
+        return false;
+    }
+    if (pop_local_task(*service_ctx.workers[worker_index], task)) {
+        return true;
+    }
+    auto worker_count = service_ctx.workers.size();
+    for (std::size_t i = 1; i < worker_count; ++i) {
+        if (steal_task(*service_ctx.workers[(worker_index + i) % worker_count], task)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void worker_thread_proc(const std::shared_ptr<work_stealing_task_service_context>& service_ctx, std::size_t worker_index)
+{
+    current_service_ctx = service_ctx.get();
+    current_worker_index = worker_index;
+    while (true) {
+        std::function<void()> task;
+        if (find_task(*service_ctx, worker_index, task)) {
+            service_ctx->pending_task_count.fetch_sub(1);
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lck(service_ctx->sleep_mtx);
+        if (service_ctx->pending_task_count.load() != 0) {
+            // A task is queued but its deque was busy, try again.
+            lck.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        if (service_ctx->is_stopped) {
+            break;
+        }
+        service_ctx->sleeping_worker_count.fetch_add(1);
+        service_ctx->sleep_cv.wait(lck, [&service_ctx]() {
+            return service_ctx->pending_task_count.load() != 0 || service_ctx->is_stopped;
+        });
+        service_ctx->sleeping_worker_count.fetch_sub(1);
+    }
+    current_service_ctx = nullptr;
+}
+
+} // namespace impl
+
+work_stealing_task_service::work_stealing_task_service(std::size_t thread_count)
+    : service_ctx(std::make_shared<impl::work_stealing_task_service_context>())
+{
+    thread_count = std::max<std::size_t>(thread_count, 1);
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        this->service_ctx->workers.emplace_back(std::make_unique<impl::work_stealing_worker>());
+    }
+    for (std::size_t i = 0; i < thread_count; ++i) {
+        auto ctx = this->service_ctx;
+        std::thread([ctx, i]() {
+            impl::worker_thread_proc(ctx, i);
+        }).detach();
+    }
+}
+
+work_stealing_task_service::~work_stealing_task_service()
+{
+    {
+        std::unique_lock<std::mutex> lck(this->service_ctx->sleep_mtx);
+        this->service_ctx->is_stopped = true;
+    }
+    this->service_ctx->sleep_cv.notify_all();
+}
+
+void work_stealing_task_service::post_task(std::function<void()>&& task)
+{
+    impl::push_task(*this->service_ctx, std::move(task));
+}
+
+std::thread::id work_stealing_task_service::get_thread_id()
+{
+    if (impl::current_service_ctx == this->service_ctx.get()) {
+        return std::this_thread::get_id();
+    }
+    return std::thread::id();
+}
+
+std::size_t work_stealing_task_service::get_thread_count() const
+{
+    return this->service_ctx->workers.size();
+}
+
+std::shared_ptr<task_service> work_stealing_task_service::create_strand()
+{
+    return std::make_shared<work_stealing_strand>(this->service_ctx);
+}
+
+work_stealing_strand::work_stealing_strand(const std::shared_ptr<impl::work_stealing_task_service_context>& service_ctx)
+    : strand_ctx(std::make_shared<impl::work_stealing_strand_context>())
+{
+    this->strand_ctx->service_ctx = service_ctx;
+}
+
+work_stealing_strand::~work_stealing_strand()
+{
+    // Tasks that are still queued keep the strand alive until they have run.
+}
+
+void work_stealing_strand::post_task(std::function<void()>&& task)
+{
+    impl::post_to_strand(*this->strand_ctx, std::move(task));
+}
+
+std::thread::id work_stealing_strand::get_thread_id()
+{
+    if (impl::is_running_strand(*this->strand_ctx)) {
+        return std::this_thread::get_id();
+    }
+    return std::thread::id();
+}
+
+} // namespace dawn_player
@@ -0,0 +1,93 @@
+/*
+ *    work_stealing_task_service.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_WORK_STEALING_TASK_SERVICE_HPP
+#define DAWN_PLAYER_WORK_STEALING_TASK_SERVICE_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <vector>
+
+#include "strand.hpp"
+#include "task_service.hpp"
+
+namespace dawn_player {
+namespace impl
+{
+
+struct work_stealing_worker {
+    std::deque<std::function<void()>> task_deque;
+    std::mutex task_deque_mtx;
+};
+
+struct work_stealing_task_service_context {
+    std::vector<std::unique_ptr<work_stealing_worker>> workers;
+    std::atomic<std::size_t> pending_task_count{ 0 };
+    std::atomic<std::size_t> next_worker_index{ 0 };
+    std::atomic<std::size_t> sleeping_worker_count{ 0 };
+    std::mutex sleep_mtx;
+    std::condition_variable sleep_cv;
+    bool is_stopped = false;
+};
+
+// A strand queued on the worker deques as a task that runs it.
+struct work_stealing_strand_context : public strand_context {
+    std::shared_ptr<work_stealing_task_service_context> service_ctx;
+    virtual void schedule();
+};
+
+} // namespace impl
+
+// Runs tasks on several worker threads. Each worker owns a deque: tasks
+// posted from a worker go to the back of its own deque and are taken LIFO,
+// idle workers steal from the front of the other deques.
+//
+// Tasks may run in parallel, so post_task() is meant for work that does not
+// share state, e.g. AMF decoding, indexing or bitstream conversion of
+// independent chunks. That breaks the one-task-at-a-time contract of a
+// task_service, which this class therefore is not: a flv_player or
+// switch_to_task_service() takes a strand from create_strand().
+class work_stealing_task_service {
+public:
+    explicit work_stealing_task_service(std::size_t thread_count = std::thread::hardware_concurrency());
+    ~work_stealing_task_service();
+    work_stealing_task_service(const work_stealing_task_service&) = delete;
+    work_stealing_task_service& operator=(const work_stealing_task_service&) = delete;
+    void post_task(std::function<void()>&& task);
+    // The id of the calling thread if it is one of the workers, a default
+    // constructed std::thread::id otherwise.
+    std::thread::id get_thread_id();
+    std::size_t get_thread_count() const;
+    std::shared_ptr<task_service> create_strand();
+private:
+    std::shared_ptr<impl::work_stealing_task_service_context> service_ctx;
+};
+
+// A task_service backed by a strand of a work_stealing_task_service, like
+// pooled_task_service is of a task_service_pool. Tasks posted to the same
+// strand run one at a time and in FIFO order, on whichever worker takes the
+// strand. get_thread_id() returns the id of the calling thread while it is
+// running this strand, and a default constructed std::thread::id otherwise,
+// so switch_to_task_service() hops onto the strand from any other worker.
+class work_stealing_strand : public task_service {
+public:
+    explicit work_stealing_strand(const std::shared_ptr<impl::work_stealing_task_service_context>& service_ctx);
+    virtual ~work_stealing_strand();
+    virtual void post_task(std::function<void()>&& task);
+    virtual std::thread::id get_thread_id();
+private:
+    std::shared_ptr<impl::work_stealing_strand_context> strand_ctx;
+};
+
+} // namespace dawn_player
+
+#endif
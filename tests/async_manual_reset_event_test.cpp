@@ -0,0 +1,99 @@
+/*
+ *    async_manual_reset_event_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "coroutine/async_manual_reset_event.hpp"
+#include "coroutine/detached_task.hpp"
+#include "coroutine/sync_wait.hpp"
+#include "coroutine/task.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::coroutine;
+using namespace dawn_player::test;
+
+namespace {
+
+// Appends id to resumed once the event is set.
+detached_task wait_event(const async_manual_reset_event& event, std::vector<int>& resumed, int id)
+{
+    co_await event;
+    resumed.push_back(id);
+}
+
+task<std::thread::id> wait_event_thread(const async_manual_reset_event& event)
+{
+    co_await event;
+    co_return std::this_thread::get_id();
+}
+
+} // namespace
+
+TEST_CASE(await_completes_when_set)
+{
+    async_manual_reset_event event(true);
+    CHECK(event.is_set());
+    std::vector<int> resumed;
+    wait_event(event, resumed, 1);
+    CHECK(resumed == std::vector<int>({ 1 }));
+    async_manual_reset_event later;
+    CHECK(!later.is_set());
+    later.set();
+    wait_event(later, resumed, 2);
+    CHECK(resumed == std::vector<int>({ 1, 2 }));
+}
+
+TEST_CASE(set_resumes_all_waiters_in_order)
+{
+    async_manual_reset_event event;
+    std::vector<int> resumed;
+    for (int i = 0; i < 5; ++i) {
+        wait_event(event, resumed, i);
+    }
+    CHECK(resumed.empty());
+    event.set();
+    CHECK(resumed == std::vector<int>({ 0, 1, 2, 3, 4 }));
+    // Setting again resumes nothing twice.
+    event.set();
+    CHECK_EQUAL(std::size_t(5), resumed.size());
+}
+
+TEST_CASE(await_after_reset_waits_for_set)
+{
+    async_manual_reset_event event(true);
+    event.reset();
+    CHECK(!event.is_set());
+    std::vector<int> resumed;
+    wait_event(event, resumed, 1);
+    CHECK(resumed.empty());
+    // Resetting an unset event keeps the waiter.
+    event.reset();
+    event.set();
+    CHECK(resumed == std::vector<int>({ 1 }));
+    event.reset();
+    wait_event(event, resumed, 2);
+    CHECK(resumed == std::vector<int>({ 1 }));
+    event.set();
+    CHECK(resumed == std::vector<int>({ 1, 2 }));
+}
+
+TEST_CASE(set_resumes_on_setting_thread)
+{
+    async_manual_reset_event event;
+    std::thread::id setter_id;
+    std::thread setter([&]() {
+        setter_id = std::this_thread::get_id();
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        event.set();
+    });
+    auto resumed_id = sync_wait_task(wait_event_thread(event));
+    setter.join();
+    CHECK(resumed_id == setter_id);
+}
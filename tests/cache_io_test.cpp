@@ -0,0 +1,175 @@
+/*
+ *    cache_io_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+#include "cache_io.hpp"
+#include "coroutine/sync_wait.hpp"
+#include "posix_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+// Passes reads through to a file and counts what the cache asks of it.
+// Without seeking, it behaves like live input.
+class counting_read_stream_proxy : public io::read_stream_proxy {
+public:
+    counting_read_stream_proxy(const std::string& path, bool is_seekable)
+        : inner(std::make_shared<io::file_read_stream_proxy>(path))
+        , is_seekable(is_seekable)
+        , seek_count(0)
+        , read_bytes(0)
+    {}
+    virtual bool can_seek() const
+    {
+        return this->is_seekable;
+    }
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size)
+    {
+        auto result = co_await this->inner->read(buf, size);
+        this->read_bytes += result;
+        co_return result;
+    }
+    virtual void seek(std::uint64_t pos)
+    {
+        if (!this->is_seekable) {
+            throw std::runtime_error("bad operation");
+        }
+        ++this->seek_count;
+        this->inner->seek(pos);
+    }
+    std::size_t get_seek_count() const
+    {
+        return this->seek_count;
+    }
+    std::uint64_t get_read_bytes() const
+    {
+        return this->read_bytes;
+    }
+private:
+    std::shared_ptr<io::file_read_stream_proxy> inner;
+    bool is_seekable;
+    std::size_t seek_count;
+    std::uint64_t read_bytes;
+};
+
+std::vector<std::uint8_t> read_some(io::read_stream_proxy& proxy, std::uint32_t size)
+{
+    std::vector<std::uint8_t> data(size);
+    std::uint32_t offset = 0;
+    while (offset < size) {
+        auto result = coroutine::sync_wait_task(proxy.read(data.data() + offset, size - offset));
+        if (result == 0) {
+            break;
+        }
+        offset += result;
+    }
+    data.resize(offset);
+    return data;
+}
+
+std::vector<std::uint8_t> slice(const std::vector<std::uint8_t>& data, std::uint64_t first, std::uint64_t size)
+{
+    first = std::min<std::uint64_t>(first, data.size());
+    return std::vector<std::uint8_t>(data.begin() + first, data.begin() + std::min<std::uint64_t>(first + size, data.size()));
+}
+
+} // namespace
+
+TEST_CASE(matches_file_through_random_seeks)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto inner = std::make_shared<counting_read_stream_proxy>(dir.get_file_path("a.flv"), true);
+    io::block_cache_read_stream_proxy proxy(inner, 256 * 1024, 64 * 1024);
+    std::mt19937 engine(7);
+    std::uniform_int_distribution<std::uint64_t> position_distribution(0, flv.data.size());
+    std::uniform_int_distribution<std::uint32_t> size_distribution(1, 100000);
+    // Half of the seeks go to a hot spot that fits in the cache.
+    std::uniform_int_distribution<std::uint64_t> hot_distribution(300000, 400000);
+    for (int i = 0; i < 5000; ++i) {
+        auto pos = i % 2 == 0 ? position_distribution(engine) : hot_distribution(engine);
+        auto size = size_distribution(engine);
+        proxy.seek(pos);
+        CHECK(read_some(proxy, size) == slice(flv.data, pos, size));
+    }
+    auto stats = proxy.get_stats();
+    CHECK(stats.hit_count > 0 && stats.miss_count > 0);
+    CHECK(stats.eviction_count > 0);
+    CHECK_EQUAL(inner->get_read_bytes(), stats.miss_bytes);
+}
+
+TEST_CASE(sequential_read_passes_through)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto inner = std::make_shared<counting_read_stream_proxy>(dir.get_file_path("a.flv"), true);
+    io::block_cache_read_stream_proxy proxy(inner, 256 * 1024, 64 * 1024);
+    CHECK(read_to_end(proxy, 10000) == flv.data);
+    CHECK_EQUAL(std::size_t(0), inner->get_seek_count());
+    CHECK_EQUAL(std::uint64_t(flv.data.size()), inner->get_read_bytes());
+}
+
+TEST_CASE(seek_back_is_served_from_memory)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto inner = std::make_shared<counting_read_stream_proxy>(dir.get_file_path("a.flv"), true);
+    io::block_cache_read_stream_proxy proxy(inner, 1024 * 1024, 64 * 1024);
+    CHECK(read_some(proxy, 500000) == slice(flv.data, 0, 500000));
+    auto read_bytes = inner->get_read_bytes();
+    proxy.seek(100000);
+    CHECK(read_some(proxy, 300000) == slice(flv.data, 100000, 300000));
+    CHECK_EQUAL(std::size_t(0), inner->get_seek_count());
+    CHECK_EQUAL(read_bytes, inner->get_read_bytes());
+    CHECK_EQUAL(std::uint64_t(300000), proxy.get_stats().hit_bytes);
+    // A miss past what was read seeks the inner proxy once.
+    proxy.seek(900000);
+    CHECK(read_some(proxy, 1000) == slice(flv.data, 900000, 1000));
+    CHECK_EQUAL(std::size_t(1), inner->get_seek_count());
+}
+
+TEST_CASE(live_input_seeks_within_window)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto inner = std::make_shared<counting_read_stream_proxy>(dir.get_file_path("a.flv"), false);
+    io::block_cache_read_stream_proxy proxy(inner, 256 * 1024, 64 * 1024);
+    CHECK(!proxy.can_seek());
+    CHECK(read_some(proxy, 600000) == slice(flv.data, 0, 600000));
+    for (std::uint64_t pos : { std::uint64_t(500000), std::uint64_t(420000), std::uint64_t(599999) }) {
+        proxy.seek(pos);
+        CHECK(read_some(proxy, 600000 - pos) == slice(flv.data, pos, 600000 - pos));
+    }
+    // The first blocks are evicted by now.
+    CHECK_THROWS(proxy.seek(0), std::runtime_error);
+    CHECK_THROWS(proxy.seek(700000), std::runtime_error);
+    proxy.seek(600000);
+    CHECK(read_to_end(proxy) == slice(flv.data, 600000, flv.data.size()));
+}
+
+TEST_CASE(player_plays_through_cache)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.has_keyframes_index = true;
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto result = play(std::make_shared<io::block_cache_read_stream_proxy>(std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv"))));
+    CHECK_EQUAL(flv.video_samples, result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+    check_seeks(flv, std::make_shared<io::block_cache_read_stream_proxy>(std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")), 512 * 1024, 64 * 1024));
+}
@@ -0,0 +1,190 @@
+/*
+ *    disk_cache_io_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <filesystem>
+#include <future>
+#include <random>
+
+#include "coroutine/sync_wait.hpp"
+#include "disk_cache_io.hpp"
+#include "http_io.hpp"
+#include "http_test_server.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+std::shared_ptr<io::disk_cache_read_stream_proxy> open_cached(const http_test_server& server, const std::string& path, const temp_directory& dir, const std::string& key)
+{
+    return std::make_shared<io::disk_cache_read_stream_proxy>(std::make_shared<io::http_range_read_stream_proxy>(server.get_url(path)), dir.get_path(), key);
+}
+
+std::vector<std::uint8_t> read_some(io::read_stream_proxy& proxy, std::uint32_t size)
+{
+    std::vector<std::uint8_t> data(size);
+    std::uint32_t offset = 0;
+    while (offset < size) {
+        auto result = coroutine::sync_wait_task(proxy.read(data.data() + offset, size - offset));
+        if (result == 0) {
+            break;
+        }
+        offset += result;
+    }
+    data.resize(offset);
+    return data;
+}
+
+std::string find_index_file(const temp_directory& dir)
+{
+    for (const auto& entry : std::filesystem::directory_iterator(dir.get_path())) {
+        if (entry.path().extension() == ".index") {
+            return entry.path().string();
+        }
+    }
+    return std::string();
+}
+
+} // namespace
+
+TEST_CASE(probe_gets_entity_tag_and_length)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    auto info = io::probe_http_resource(server.get_url("/moved"));
+    CHECK_EQUAL(std::string("\"v1\""), info.entity_tag);
+    CHECK_EQUAL(std::uint64_t(flv.data.size()), info.content_length);
+    CHECK_EQUAL(std::string("bytes=0-0"), server.get_range_headers().back());
+    auto url = server.get_url("/a.flv");
+    auto key = io::make_disk_cache_key(url, info.entity_tag, info.content_length);
+    CHECK(key == io::make_disk_cache_key(url, info.entity_tag, info.content_length));
+    CHECK(key != io::make_disk_cache_key(url, "\"v2\"", info.content_length));
+    CHECK(key != io::make_disk_cache_key(url, info.entity_tag, info.content_length + 1));
+    CHECK(key != io::make_disk_cache_key(url + "?b", info.entity_tag, info.content_length));
+}
+
+TEST_CASE(second_playback_reads_only_cache)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.has_keyframes_index = true;
+    auto flv = make_synthetic_flv(options);
+    http_test_server server(flv.data);
+    auto url = server.get_url("/a.flv");
+    auto info = io::probe_http_resource(url);
+    auto key = io::make_disk_cache_key(url, info.entity_tag, info.content_length);
+    auto first = play(open_cached(server, "/a.flv", dir, key));
+    CHECK_EQUAL(flv.video_samples, first.video_samples);
+    auto request_count = server.get_request_count();
+    auto proxy = open_cached(server, "/a.flv", dir, key);
+    CHECK_EQUAL(std::uint64_t(flv.data.size()), proxy->get_cached_size());
+    auto second = play(proxy);
+    CHECK_EQUAL(flv.video_samples, second.video_samples);
+    CHECK_EQUAL(flv.audio_samples, second.audio_samples);
+    check_seeks(flv, open_cached(server, "/a.flv", dir, key));
+    CHECK_EQUAL(request_count, server.get_request_count());
+}
+
+TEST_CASE(concurrent_readers_share_cold_entry)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    auto key = io::make_disk_cache_key(server.get_url("/a.flv"), "\"v1\"", flv.data.size());
+    std::vector<std::future<int>> readers;
+    for (unsigned int seed = 1; seed <= 4; ++seed) {
+        readers.push_back(std::async(std::launch::async, [&, seed]() {
+            // Each reader has its own descriptors, like a process would.
+            auto proxy = open_cached(server, "/a.flv", dir, key);
+            std::mt19937 engine(seed);
+            std::uniform_int_distribution<std::uint64_t> position_distribution(0, flv.data.size() - 1);
+            std::uniform_int_distribution<std::uint32_t> size_distribution(1, 200000);
+            int mismatch_count = 0;
+            for (int i = 0; i < 100; ++i) {
+                auto pos = position_distribution(engine);
+                auto size = std::min<std::uint64_t>(size_distribution(engine), flv.data.size() - pos);
+                proxy->seek(pos);
+                if (read_some(*proxy, static_cast<std::uint32_t>(size)) != std::vector<std::uint8_t>(flv.data.begin() + pos, flv.data.begin() + pos + size)) {
+                    ++mismatch_count;
+                }
+            }
+            return mismatch_count;
+        }));
+    }
+    for (auto& reader : readers) {
+        CHECK_EQUAL(0, reader.get());
+    }
+    // What the readers fetched is cached for the next one.
+    auto proxy = open_cached(server, "/a.flv", dir, key);
+    CHECK(proxy->get_cached_size() > 0);
+    CHECK(read_to_end(*proxy) == flv.data);
+}
+
+TEST_CASE(complete_entry_makes_live_input_seekable)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    auto proxy = open_cached(server, "/norange", dir, "norange");
+    CHECK(!proxy->can_seek());
+    CHECK(read_to_end(*proxy) == flv.data);
+    CHECK(proxy->can_seek());
+    proxy->seek(300000);
+    CHECK(read_to_end(*proxy) == std::vector<std::uint8_t>(flv.data.begin() + 300000, flv.data.end()));
+    proxy.reset();
+    auto request_count = server.get_request_count();
+    proxy = open_cached(server, "/norange", dir, "norange");
+    CHECK(proxy->can_seek());
+    proxy->seek(600000);
+    CHECK(read_to_end(*proxy) == std::vector<std::uint8_t>(flv.data.begin() + 600000, flv.data.end()));
+    CHECK_EQUAL(request_count, server.get_request_count());
+}
+
+TEST_CASE(taken_over_entry_stays_readable)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    auto first = open_cached(server, "/a.flv", dir, "a");
+    CHECK(read_to_end(*first) == flv.data);
+    // As if a key hashing to the same name had the entry now.
+    auto index_path = find_index_file(dir);
+    auto index = read_file(index_path);
+    index[40] = 'b';
+    write_file(index_path, index);
+    auto second = open_cached(server, "/a.flv", dir, "a");
+    CHECK_EQUAL(std::uint64_t(0), second->get_cached_size());
+    CHECK(read_some(*second, 1000) == std::vector<std::uint8_t>(flv.data.begin(), flv.data.begin() + 1000));
+    // The first player keeps its data file, mapping included, and publishes
+    // nothing into the new entry.
+    first->seek(0);
+    CHECK(read_to_end(*first) == flv.data);
+    first.reset();
+    second.reset();
+    auto third = open_cached(server, "/a.flv", dir, "a");
+    CHECK_EQUAL(std::uint64_t(1000), third->get_cached_size());
+    CHECK(read_to_end(*third) == flv.data);
+}
+
+TEST_CASE(torn_index_is_rejected)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    CHECK(read_to_end(*open_cached(server, "/a.flv", dir, "a")) == flv.data);
+    // Stale extents after the end of a shorter index written over it.
+    auto index_path = find_index_file(dir);
+    auto index = read_file(index_path);
+    std::uint64_t stale[2] = { 0, flv.data.size() + 100 };
+    index.insert(index.end(), reinterpret_cast<std::uint8_t*>(stale), reinterpret_cast<std::uint8_t*>(stale + 2));
+    write_file(index_path, index);
+    auto proxy = open_cached(server, "/a.flv", dir, "a");
+    CHECK_EQUAL(std::uint64_t(0), proxy->get_cached_size());
+    CHECK(read_to_end(*proxy) == flv.data);
+}
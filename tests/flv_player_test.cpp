@@ -0,0 +1,216 @@
+/*
+ *    flv_player_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <thread>
+
+#include "default_task_service.hpp"
+#include "error.hpp"
+#include "posix_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::sample;
+using namespace dawn_player::test;
+
+namespace {
+
+// What a request_*_sample() callback was given, and where it ran.
+struct sample_request_result {
+    std::exception_ptr error;
+    sample_record record;
+    std::thread::id thread_id;
+};
+
+sample_request_result request_video(flv_player& player)
+{
+    std::promise<sample_request_result> promise;
+    player.request_video_sample([&promise](std::exception_ptr error, video_sample&& sample) {
+        sample_request_result result;
+        result.error = error;
+        if (!error) {
+            result.record = make_sample_record(sample);
+        }
+        result.thread_id = std::this_thread::get_id();
+        promise.set_value(result);
+    });
+    return promise.get_future().get();
+}
+
+sample_request_result request_audio(flv_player& player)
+{
+    std::promise<sample_request_result> promise;
+    player.request_audio_sample([&promise](std::exception_ptr error, audio_sample&& sample) {
+        sample_request_result result;
+        result.error = error;
+        if (!error) {
+            result.record = make_sample_record(sample);
+        }
+        result.thread_id = std::this_thread::get_id();
+        promise.set_value(result);
+    });
+    return promise.get_future().get();
+}
+
+// A video sample as a host gets it from request_video_sample(), packaged,
+// with the SPS info the player reports while handing it out.
+struct packaged_video_sample {
+    sample_record record;
+    std::vector<std::uint8_t> data;
+    std::uint32_t width = 0;
+};
+
+packaged_video_sample request_packaged_video(flv_player& player)
+{
+    std::promise<packaged_video_sample> promise;
+    player.request_video_sample([&promise, &player](std::exception_ptr error, video_sample&& sample) {
+        packaged_video_sample result;
+        if (!error) {
+            result.record = make_sample_record(sample);
+            result.data = player.package_video_sample(std::move(sample));
+            sps_info info;
+            if (player.get_sps_info(info)) {
+                result.width = info.width;
+            }
+        }
+        promise.set_value(std::move(result));
+    });
+    return promise.get_future().get();
+}
+
+// The first SPS of an avcC record.
+std::vector<std::uint8_t> get_record_sps(const std::vector<std::uint8_t>& record)
+{
+    std::size_t size = (static_cast<std::size_t>(record[6]) << 8) | record[7];
+    return std::vector<std::uint8_t>(record.begin() + 8, record.begin() + 8 + size);
+}
+
+bool starts_with_nalu(const std::vector<std::uint8_t>& data, const std::vector<std::uint8_t>& nalu)
+{
+    std::vector<std::uint8_t> prefix = { 0x00, 0x00, 0x01 };
+    prefix.insert(prefix.end(), nalu.begin(), nalu.end());
+    return data.size() >= prefix.size() && std::equal(prefix.begin(), prefix.end(), data.begin());
+}
+
+// The code of the get_sample_error in error, -1 for anything else.
+int get_error_code(std::exception_ptr error)
+{
+    try {
+        std::rethrow_exception(error);
+    }
+    catch (const get_sample_error& e) {
+        return static_cast<int>(e.code());
+    }
+    catch (...) {
+        return -1;
+    }
+}
+
+} // namespace
+
+TEST_CASE(sample_requests_deliver_samples)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto service = std::make_shared<default_task_service>();
+    auto player = std::make_shared<flv_player>(service, std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")));
+    open_player(*player);
+    for (std::size_t i = 0; i < 60; ++i) {
+        auto video = request_video(*player);
+        CHECK(!video.error);
+        CHECK_EQUAL(flv.video_samples[i], video.record);
+        CHECK(video.thread_id == service->get_thread_id());
+        auto audio = request_audio(*player);
+        CHECK(!audio.error);
+        CHECK_EQUAL(flv.audio_samples[i], audio.record);
+        CHECK(audio.thread_id == service->get_thread_id());
+    }
+    // Mixed with the coroutine interface, the samples stay in order.
+    CHECK_EQUAL(std::vector<sample_record>(flv.video_samples.begin() + 60, flv.video_samples.begin() + 70), read_video_samples(*player, 10));
+    CHECK_EQUAL(flv.video_samples[70], request_video(*player).record);
+    close_player(*player);
+}
+
+TEST_CASE(sample_requests_deliver_errors)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.frame_count = 30;
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto service = std::make_shared<default_task_service>();
+    auto player = std::make_shared<flv_player>(service, std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")));
+    open_player(*player);
+    CHECK_EQUAL(flv.video_samples, read_video_samples(*player));
+    auto result = request_video(*player);
+    CHECK(result.error != nullptr);
+    CHECK_EQUAL(static_cast<int>(get_sample_error_code::end_of_stream), get_error_code(result.error));
+    CHECK(result.thread_id == service->get_thread_id());
+    close_player(*player);
+    result = request_audio(*player);
+    CHECK_EQUAL(static_cast<int>(get_sample_error_code::cancel), get_error_code(result.error));
+    CHECK(result.thread_id == service->get_thread_id());
+}
+
+TEST_CASE(video_config_switch_follows_delivered_samples)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.has_keyframes_index = true;
+    options.config_switch_frame = 100;
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto first_sps = get_record_sps(get_synthetic_avc_config_record());
+    auto switched_sps = get_record_sps(get_synthetic_switched_avc_config_record());
+    auto service = std::make_shared<default_task_service>();
+    auto player = std::make_shared<flv_player>(service, std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")));
+    std::vector<std::vector<std::uint8_t>> changes;
+    player->set_video_format_changed_handler([&changes](const parameter_sets& sets) {
+        changes.push_back(sets.sps);
+    });
+    auto info = open_player(*player);
+    CHECK_EQUAL(std::string("1920"), info["Width"]);
+
+    std::vector<std::vector<std::uint8_t>> expected_changes;
+    auto delivered_sps = first_sps;
+    // Reads the samples [first, last), the format changes whenever a sample
+    // of the other configuration is handed out.
+    auto check_samples = [&](std::size_t first, std::size_t last) {
+        for (auto i = first; i < last; ++i) {
+            auto sample = request_packaged_video(*player);
+            CHECK_EQUAL(flv.video_samples[i], sample.record);
+            bool is_switched = i >= options.config_switch_frame;
+            const auto& sps = is_switched ? switched_sps : first_sps;
+            if (sps != delivered_sps) {
+                expected_changes.push_back(sps);
+                delivered_sps = sps;
+            }
+            CHECK(changes == expected_changes);
+            CHECK_EQUAL(is_switched ? std::uint32_t(1280) : std::uint32_t(1920), sample.width);
+            CHECK(player->get_sps() == sps);
+            if (sample.record.is_key_frame) {
+                CHECK(starts_with_nalu(sample.data, sps));
+            }
+        }
+    };
+    check_samples(0, 150);
+    CHECK_EQUAL(std::size_t(1), changes.size());
+    // Back across the switch, the samples get the first configuration again.
+    CHECK_EQUAL(std::int64_t(20000000), seek_player(*player, 20000000));
+    check_samples(50, 130);
+    CHECK_EQUAL(std::size_t(3), changes.size());
+    CHECK_EQUAL(std::int64_t(10000000), seek_player(*player, 10000000));
+    check_samples(25, 40);
+    // Forward past the switch, onto a key frame behind its sequence header.
+    CHECK_EQUAL(std::int64_t(50000000), seek_player(*player, 50000000));
+    check_samples(125, 150);
+    CHECK_EQUAL(std::size_t(5), changes.size());
+    close_player(*player);
+}
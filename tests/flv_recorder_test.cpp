@@ -0,0 +1,159 @@
+/*
+ *    flv_recorder_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <chrono>
+#include <thread>
+
+#include <unistd.h>
+
+#include "coroutine/sync_wait.hpp"
+#include "default_task_service.hpp"
+#include "flv_recorder.hpp"
+#include "flv_tools.hpp"
+#include "posix_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+// The player parses a tag only once the next byte is there, so the last
+// tag of a file, video in the synthetic ones, is never read back.
+std::vector<sample_record> drop_last(const std::vector<sample_record>& records)
+{
+    return std::vector<sample_record>(records.begin(), records.end() - 1);
+}
+
+bool file_exists(const std::string& path)
+{
+    return ::access(path.c_str(), F_OK) == 0;
+}
+
+std::shared_ptr<flv_player> make_file_player(const std::string& path)
+{
+    return std::make_shared<flv_player>(std::make_shared<default_task_service>(), std::make_shared<io::file_read_stream_proxy>(path));
+}
+
+// Records the file at source_path, attaching the recorder before the player
+// is opened, or once skipped_count video samples have been read.
+void record(const std::string& source_path, const std::shared_ptr<flv_recorder>& recorder, std::size_t skipped_count)
+{
+    auto player = make_file_player(source_path);
+    if (skipped_count == 0) {
+        coroutine::sync_wait_task(player->set_recorder(recorder));
+    }
+    open_player(*player);
+    if (skipped_count != 0) {
+        read_video_samples(*player, skipped_count);
+        coroutine::sync_wait_task(player->set_recorder(recorder));
+    }
+    read_video_samples(*player);
+    read_audio_samples(*player);
+    coroutine::sync_wait_task(player->set_recorder(nullptr));
+    close_player(*player);
+    recorder->finalize();
+}
+
+} // namespace
+
+TEST_CASE(records_whole_stream)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto path = dir.get_file_path("rec.flv");
+    auto recorder = std::make_shared<flv_recorder>(path);
+    record(dir.get_file_path("a.flv"), recorder, 0);
+    CHECK(!file_exists(path + ".index"));
+    auto stats = recorder->get_stats();
+    CHECK_EQUAL(std::uint64_t(10), stats.keyframe_count);
+    CHECK_EQUAL(std::uint64_t(0), stats.dropped_size);
+    auto result = play_file(path);
+    CHECK_EQUAL(std::string("True"), result.info.at("CanSeek"));
+    CHECK_EQUAL(drop_last(flv.video_samples), result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+    check_seeks(flv, std::make_shared<io::mmap_read_stream_proxy>(path));
+}
+
+TEST_CASE(records_from_mid_stream)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.first_timestamp = 100000;
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto path = dir.get_file_path("rec.flv");
+    record(dir.get_file_path("a.flv"), std::make_shared<flv_recorder>(path), 60);
+    auto result = play_file(path);
+    CHECK_EQUAL(std::string("True"), result.info.at("CanSeek"));
+    // The recording starts at a keyframe after the attach, rebased to 0.
+    CHECK(!result.video_samples.empty());
+    auto first = flv.video_samples.size() - 1 - result.video_samples.size();
+    CHECK(first > 60 && first % 25 == 0);
+    CHECK_EQUAL(shift_records(flv.video_samples, first, flv.video_samples.size() - 1, flv.video_samples[first].dts), result.video_samples);
+    auto info = scan_flv_file(path);
+    CHECK_EQUAL((250 - first) / 25, info.keyframes.size());
+    CHECK_EQUAL(0.0, info.keyframes.front().first);
+}
+
+TEST_CASE(rewrites_file_when_keyframes_outgrow_padding)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto path = dir.get_file_path("rec.flv");
+    record(dir.get_file_path("a.flv"), std::make_shared<flv_recorder>(path, 2), 0);
+    auto info = scan_flv_file(path);
+    CHECK_EQUAL(flv.keyframes.size(), info.keyframes.size());
+    CHECK_EQUAL(info.file_size, info.end_offset);
+    auto result = play_file(path);
+    CHECK_EQUAL(drop_last(flv.video_samples), result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+    check_seeks(flv, std::make_shared<io::mmap_read_stream_proxy>(path));
+}
+
+TEST_CASE(writes_index_while_recording)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto path = dir.get_file_path("rec.flv");
+    auto player = make_file_player(dir.get_file_path("a.flv"));
+    auto recorder = std::make_shared<flv_recorder>(path);
+    coroutine::sync_wait_task(player->set_recorder(recorder));
+    open_player(*player);
+    read_video_samples(*player);
+    read_audio_samples(*player);
+    // The index is replaced every 2 s.
+    for (int i = 0; i < 50 && !file_exists(path + ".index"); ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    CHECK(file_exists(path + ".index"));
+    coroutine::sync_wait_task(player->set_recorder(nullptr));
+    close_player(*player);
+    recorder->finalize();
+    CHECK(!file_exists(path + ".index"));
+}
+
+TEST_CASE(drops_batches_past_pending_limit)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto path = dir.get_file_path("rec.flv");
+    // Only the last batch, which is never dropped, fits.
+    auto recorder = std::make_shared<flv_recorder>(path, 4096, 1);
+    record(dir.get_file_path("a.flv"), recorder, 0);
+    CHECK(recorder->get_stats().dropped_size > 0);
+    // The recording resumes at a keyframe, the time of what was dropped
+    // stays a gap.
+    auto result = play_file(path);
+    auto first = flv.video_samples.size() - 1 - result.video_samples.size();
+    CHECK(first > 0 && first % 25 == 0);
+    CHECK_EQUAL(std::vector<sample_record>(flv.video_samples.begin() + first, flv.video_samples.end() - 1), result.video_samples);
+}
@@ -0,0 +1,231 @@
+/*
+ *    flv_tools_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/stat.h>
+
+#include "flv_tools.hpp"
+#include "posix_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+synthetic_flv make_flv_without_meta_data()
+{
+    synthetic_flv_options options;
+    options.has_meta_data = false;
+    return make_synthetic_flv(options);
+}
+
+ino_t get_inode(const std::string& path)
+{
+    struct stat st;
+    CHECK(::stat(path.c_str(), &st) == 0);
+    return st.st_ino;
+}
+
+// A tag of type 15, which no FLV tag type is.
+std::vector<std::uint8_t> make_unknown_tag()
+{
+    return { 15, 0, 0, 5, 0, 0, 0, 0, 0, 0, 0, 'x', 'x', 'x', 'x', 'x', 0, 0, 0, 16 };
+}
+
+} // namespace
+
+TEST_CASE(inject_makes_file_seekable)
+{
+    temp_directory dir;
+    auto path = dir.get_file_path("a.flv");
+    auto flv = make_flv_without_meta_data();
+    write_file(path, flv.data);
+    inject_flv_meta_data(path);
+    auto info = scan_flv_file(path);
+    CHECK(info.meta_data != nullptr);
+    CHECK_EQUAL(flv.keyframes.size(), info.keyframes.size());
+    CHECK_EQUAL(info.file_size, info.end_offset);
+    auto result = play_file(path);
+    CHECK_EQUAL(std::string("True"), result.info.at("CanSeek"));
+    CHECK_EQUAL(flv.video_samples, result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+    check_seeks(flv, std::make_shared<io::mmap_read_stream_proxy>(path));
+}
+
+TEST_CASE(inject_rewrites_padded_meta_data_in_place)
+{
+    temp_directory dir;
+    auto path = dir.get_file_path("a.flv");
+    auto flv = make_synthetic_flv();
+    write_file(path, flv.data);
+    inject_flv_meta_data(path);
+    auto size = read_file(path).size();
+    auto inode = get_inode(path);
+    inject_flv_meta_data(path);
+    CHECK_EQUAL(size, read_file(path).size());
+    CHECK_EQUAL(inode, get_inode(path));
+    // The values not about the layout are kept.
+    auto info = scan_flv_file(path);
+    CHECK(info.meta_data != nullptr && info.meta_data->find("width") != info.meta_data->end());
+    check_seeks(flv, std::make_shared<io::mmap_read_stream_proxy>(path));
+}
+
+TEST_CASE(inject_cuts_off_partial_tag)
+{
+    temp_directory dir;
+    auto path = dir.get_file_path("a.flv");
+    auto flv = make_flv_without_meta_data();
+    // Cut short in the keyframe tag of second 4.
+    write_file(path, std::vector<std::uint8_t>(flv.data.begin(), flv.data.begin() + flv.keyframes[4].second + 100));
+    inject_flv_meta_data(path);
+    auto info = scan_flv_file(path);
+    CHECK_EQUAL(std::size_t(4), info.keyframes.size());
+    CHECK_EQUAL(info.file_size, info.end_offset);
+    // The audio tag before the keyframe is the last tag now.
+    auto result = play_file(path);
+    CHECK_EQUAL(std::vector<sample_record>(flv.video_samples.begin(), flv.video_samples.begin() + 100), result.video_samples);
+    CHECK_EQUAL(std::vector<sample_record>(flv.audio_samples.begin(), flv.audio_samples.begin() + 99), result.audio_samples);
+}
+
+TEST_CASE(inject_keeps_unknown_tags)
+{
+    temp_directory dir;
+    auto path = dir.get_file_path("a.flv");
+    auto flv = make_flv_without_meta_data();
+    auto data = flv.data;
+    auto tag = make_unknown_tag();
+    data.insert(data.begin() + flv.keyframes[3].second, tag.begin(), tag.end());
+    write_file(path, data);
+    inject_flv_meta_data(path);
+    auto info = scan_flv_file(path);
+    CHECK_EQUAL(flv.keyframes.size(), info.keyframes.size());
+    CHECK_EQUAL(info.file_size, info.end_offset);
+    CHECK_EQUAL(std::uint64_t(data.size()), info.end_offset - info.meta_data_end + 13);
+    auto result = play_file(path);
+    CHECK_EQUAL(flv.video_samples, result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+}
+
+TEST_CASE(inject_refuses_broken_tag_header)
+{
+    temp_directory dir;
+    auto path = dir.get_file_path("a.flv");
+    auto flv = make_flv_without_meta_data();
+    auto data = flv.data;
+    // StreamID of the keyframe tag of second 5.
+    data[flv.keyframes[5].second + 9] = 1;
+    write_file(path, data);
+    CHECK_THROWS(inject_flv_meta_data(path), std::runtime_error);
+    CHECK(read_file(path) == data);
+    // A DataSize running past the end with a type no writer uses.
+    data = flv.data;
+    data[flv.keyframes[5].second] = 15;
+    data[flv.keyframes[5].second + 1] = 0xff;
+    write_file(path, data);
+    CHECK_THROWS(inject_flv_meta_data(path), std::runtime_error);
+    CHECK(read_file(path) == data);
+}
+
+TEST_CASE(export_clip_starts_at_keyframe)
+{
+    temp_directory dir;
+    auto path = dir.get_file_path("a.flv");
+    auto flv = make_synthetic_flv();
+    write_file(path, flv.data);
+    // From the keyframe at 2 s to the one at 6 s.
+    export_flv_clip(path, dir.get_file_path("clip.flv"), 2.5, 5.2);
+    auto info = scan_flv_file(dir.get_file_path("clip.flv"));
+    CHECK_EQUAL(std::size_t(4), info.keyframes.size());
+    CHECK_EQUAL(0.0, info.keyframes.front().first);
+    CHECK_EQUAL(std::size_t(1), info.video_config_offsets.size());
+    CHECK_EQUAL(std::size_t(1), info.audio_config_offsets.size());
+    auto result = play_file(dir.get_file_path("clip.flv"));
+    CHECK_EQUAL(std::string("True"), result.info.at("CanSeek"));
+    CHECK_EQUAL(shift_records(flv.video_samples, 50, 150, 20000000), result.video_samples);
+    CHECK_EQUAL(shift_records(flv.audio_samples, 50, 149, 20000000), result.audio_samples);
+    CHECK_THROWS(export_flv_clip(path, dir.get_file_path("bad.flv"), 3.0, 2.0), std::runtime_error);
+}
+
+TEST_CASE(export_segments_splits_at_keyframes)
+{
+    temp_directory dir;
+    auto path = dir.get_file_path("a.flv");
+    auto flv = make_synthetic_flv();
+    write_file(path, flv.data);
+    auto paths = export_flv_segments(path, dir.get_file_path("seg"), 3.0);
+    CHECK(paths == std::vector<std::string>({ dir.get_file_path("seg0000.flv"), dir.get_file_path("seg0001.flv"),
+        dir.get_file_path("seg0002.flv"), dir.get_file_path("seg0003.flv") }));
+    const std::size_t keyframe_counts[] = { 3, 3, 3, 1 };
+    for (std::size_t i = 0; i < paths.size(); ++i) {
+        CHECK_EQUAL(keyframe_counts[i], scan_flv_file(paths[i]).keyframes.size());
+        auto result = play_file(paths[i]);
+        auto first = i * 75;
+        auto last = std::min(first + 75, flv.video_samples.size());
+        CHECK_EQUAL(shift_records(flv.video_samples, first, last, static_cast<std::int64_t>(i) * 30000000), result.video_samples);
+    }
+}
+
+TEST_CASE(concat_restores_split_file)
+{
+    temp_directory dir;
+    auto path = dir.get_file_path("a.flv");
+    auto flv = make_synthetic_flv();
+    write_file(path, flv.data);
+    auto paths = export_flv_segments(path, dir.get_file_path("seg"), 3.0);
+    auto output_path = dir.get_file_path("joined.flv");
+    concat_flv_files(paths, output_path);
+    auto info = scan_flv_file(output_path);
+    CHECK_EQUAL(flv.keyframes.size(), info.keyframes.size());
+    CHECK_EQUAL(std::int64_t(249 * 40), info.last_timestamp);
+    // Each segment follows the last frame of the one before it.
+    auto result = play_file(output_path);
+    CHECK_EQUAL(flv.video_samples, result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+    check_seeks(flv, std::make_shared<io::mmap_read_stream_proxy>(output_path));
+}
+
+TEST_CASE(concat_ignores_config_tag_timestamps)
+{
+    temp_directory dir;
+    // Frames from 5 s on behind decoder configurations stamped 0.
+    synthetic_flv_options options;
+    options.first_timestamp = 5000;
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto data = flv.data;
+    auto info = scan_flv_file(dir.get_file_path("a.flv"));
+    for (auto offset : { info.audio_config_offsets.front(), info.video_config_offsets.front() }) {
+        std::fill(data.begin() + offset + 4, data.begin() + offset + 8, 0);
+    }
+    write_file(dir.get_file_path("a.flv"), data);
+    CHECK_EQUAL(std::int64_t(5000 + 249 * 40), scan_flv_file(dir.get_file_path("a.flv")).last_timestamp);
+    auto output_path = dir.get_file_path("joined.flv");
+    concat_flv_files({ dir.get_file_path("a.flv"), dir.get_file_path("a.flv") }, output_path);
+    info = scan_flv_file(output_path);
+    CHECK_EQUAL(2 * flv.keyframes.size(), info.keyframes.size());
+    CHECK_EQUAL(0.0, info.keyframes.front().first);
+    CHECK_EQUAL(10.0, info.keyframes[flv.keyframes.size()].first);
+    CHECK_EQUAL(std::int64_t(499 * 40), info.last_timestamp);
+    auto expected = shift_records(flv.video_samples, 0, 250, 50000000);
+    auto second = shift_records(flv.video_samples, 0, 250, -50000000);
+    expected.insert(expected.end(), second.begin(), second.end());
+    CHECK_EQUAL(expected, play_file(output_path).video_samples);
+}
+
+TEST_CASE(concat_rejects_other_streams)
+{
+    temp_directory dir;
+    write_file(dir.get_file_path("a.flv"), make_synthetic_flv().data);
+    synthetic_flv_options options;
+    options.has_audio = false;
+    write_file(dir.get_file_path("b.flv"), make_synthetic_flv(options).data);
+    CHECK_THROWS(concat_flv_files({ dir.get_file_path("a.flv"), dir.get_file_path("b.flv") }, dir.get_file_path("joined.flv")), std::runtime_error);
+    CHECK_THROWS(concat_flv_files({}, dir.get_file_path("joined.flv")), std::runtime_error);
+}
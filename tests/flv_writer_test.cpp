@@ -0,0 +1,220 @@
+/*
+ *    flv_writer_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <cerrno>
+#include <iterator>
+#include <random>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "amf_decode.hpp"
+#include "amf_encode.hpp"
+#include "annexb.hpp"
+#include "coroutine/sync_wait.hpp"
+#include "default_task_service.hpp"
+#include "flv_writer.hpp"
+#include "posix_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::amf;
+using namespace dawn_player::sample;
+using namespace dawn_player::test;
+
+namespace {
+
+const std::uint8_t* find_start_code_naive(const std::uint8_t* begin, const std::uint8_t* end)
+{
+    for (auto p = begin; end - p >= 3; ++p) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1) {
+            return p;
+        }
+    }
+    return end;
+}
+
+std::vector<std::uint8_t> encode(const amf_base& value)
+{
+    std::vector<std::uint8_t> out;
+    encode_amf(value, std::back_inserter(out));
+    return out;
+}
+
+// Queues the same tags every time, about 320 KB of them, too few to be
+// flushed on their own.
+void write_tags(flv_writer& writer)
+{
+    writer.write_header(false, true);
+    std::mt19937 engine(1);
+    for (int i = 0; i < 40; ++i) {
+        video_sample sample;
+        sample.dts = i * 400000;
+        sample.timestamp = sample.dts;
+        sample.is_key_frame = i == 0;
+        sample.data = { 0, 0, 0, 1, 0x41 };
+        for (int j = 0; j < 8000; ++j) {
+            // Random bytes, never a start code.
+            sample.data.push_back(static_cast<std::uint8_t>(engine() | 0x80));
+        }
+        writer.write_video_sample(std::move(sample));
+    }
+}
+
+void read_available(int fd, std::vector<std::uint8_t>& out)
+{
+    std::uint8_t buffer[65536];
+    for (;;) {
+        auto result = ::read(fd, buffer, sizeof(buffer));
+        if (result <= 0) {
+            return;
+        }
+        out.insert(out.end(), buffer, buffer + result);
+    }
+}
+
+} // namespace
+
+TEST_CASE(find_start_code_agrees_with_naive_scan)
+{
+    std::mt19937 engine(3);
+    // Mostly zeros and ones, so start codes and near misses are everywhere.
+    std::discrete_distribution<int> byte_distribution({ 6, 3, 1 });
+    std::uniform_int_distribution<std::size_t> size_distribution(0, 100);
+    std::vector<std::uint8_t> buffer;
+    for (int i = 0; i < 20000; ++i) {
+        buffer.resize(size_distribution(engine) + 16);
+        for (auto& byte : buffer) {
+            auto value = byte_distribution(engine);
+            byte = static_cast<std::uint8_t>(value == 2 ? 0x65 : value);
+        }
+        // Unaligned starts and ends of every length.
+        const std::uint8_t* begin = buffer.data() + i % 16;
+        const std::uint8_t* end = buffer.data() + buffer.size() - i % 7;
+        for (auto p = begin;;) {
+            auto start_code = find_start_code(p, end);
+            CHECK(start_code == find_start_code_naive(p, end));
+            if (start_code == end) {
+                break;
+            }
+            p = start_code + 1;
+        }
+    }
+}
+
+TEST_CASE(splits_annexb_and_converts_to_avcc)
+{
+    const std::vector<std::uint8_t> data = { 0x09, 0xf0, 0x00, 0x00, 0x00, 0x01, 0x67, 0x42, 0x00, 0x00, 0x01, 0x68, 0x00, 0x00, 0x01, 0x65, 0x88, 0x00 };
+    std::vector<std::pair<std::size_t, std::size_t>> nalus;
+    split_annexb(data.data(), data.size(), nalus);
+    // Bytes before the first start code are a NAL unit. Neither the zero
+    // byte of a 4-byte start code nor trailing zero bytes belong to one.
+    CHECK((nalus == std::vector<std::pair<std::size_t, std::size_t>>({ { 0, 2 }, { 6, 2 }, { 11, 1 }, { 15, 2 } })));
+    std::vector<std::uint8_t> avcc;
+    annexb_to_avcc(data.data() + 2, data.size() - 2, avcc);
+    CHECK(avcc == std::vector<std::uint8_t>({ 0, 0, 0, 2, 0x67, 0x42, 0, 0, 0, 1, 0x68, 0, 0, 0, 2, 0x65, 0x88 }));
+}
+
+TEST_CASE(amf_round_trips)
+{
+    CHECK(encode(amf_number(1.0)) == std::vector<std::uint8_t>({ 0x00, 0x3f, 0xf0, 0, 0, 0, 0, 0, 0 }));
+    CHECK(encode(amf_boolean(true)) == std::vector<std::uint8_t>({ 0x01, 0x01 }));
+    CHECK(encode(amf_string("ab")) == std::vector<std::uint8_t>({ 0x02, 0x00, 0x02, 'a', 'b' }));
+    amf_ecma_array meta_data;
+    meta_data.push_back({ amf_string("duration"), std::make_shared<amf_number>(10.0) });
+    meta_data.push_back({ amf_string("stereo"), std::make_shared<amf_boolean>(true) });
+    meta_data.push_back({ amf_string("encoder"), std::make_shared<amf_string>("dawn") });
+    meta_data.push_back({ amf_string("created"), std::make_shared<amf_date>(1.5e12) });
+    auto times = std::make_shared<amf_strict_array>();
+    times->push_back(std::make_shared<amf_number>(0.0));
+    times->push_back(std::make_shared<amf_number>(1.0));
+    auto keyframes = std::make_shared<amf_object>();
+    keyframes->push_back({ amf_string("times"), times });
+    meta_data.push_back({ amf_string("keyframes"), keyframes });
+    auto data = encode(meta_data);
+    auto decoded = decode_amf(data.data(), data.data() + data.size());
+    // The decoder reads as many entries as the ECMA array's count says and
+    // leaves the object end marker behind them.
+    CHECK(decoded.second + 3 == data.data() + data.size());
+    CHECK(decoded.first->get_type() == amf_type::ecma_array);
+    auto& array = static_cast<amf_ecma_array&>(*decoded.first);
+    CHECK_EQUAL(10.0, static_cast<amf_number&>(*array.find("duration")->second).get_value());
+    CHECK_EQUAL(std::string("dawn"), static_cast<amf_string&>(*array.find("encoder")->second).get_value());
+    CHECK(encode(array) == data);
+}
+
+TEST_CASE(remuxed_file_reads_back_same_samples)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto player = std::make_shared<flv_player>(std::make_shared<default_task_service>(), std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")));
+    open_player(*player);
+    auto fd = ::open(dir.get_file_path("b.flv").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0);
+    {
+        flv_writer writer(fd);
+        writer.write_header(true, true);
+        amf_ecma_array meta_data;
+        meta_data.push_back({ amf_string("duration"), std::make_shared<amf_number>(10.0) });
+        writer.write_script_data("onMetaData", meta_data);
+        writer.write_audio_config(player->get_audio_config_record());
+        writer.write_video_config(player->get_video_codec(), player->get_video_config_record());
+        for (std::size_t i = 0; i < flv.video_samples.size(); ++i) {
+            writer.write_video_sample(coroutine::sync_wait_task(player->get_video_sample()));
+            if (i < flv.audio_samples.size()) {
+                writer.write_audio_sample(coroutine::sync_wait_task(player->get_audio_sample()));
+            }
+        }
+        writer.flush();
+        CHECK_EQUAL(writer.get_position(), static_cast<std::uint64_t>(::lseek(fd, 0, SEEK_END)));
+    }
+    ::close(fd);
+    close_player(*player);
+    auto result = play_file(dir.get_file_path("b.flv"));
+    // The last tag is only parsed once a byte follows it, see
+    // make_synthetic_flv().
+    CHECK_EQUAL(std::vector<sample_record>(flv.video_samples.begin(), flv.video_samples.end() - 1), result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+}
+
+TEST_CASE(flush_continues_after_partial_write)
+{
+    temp_directory dir;
+    auto fd = ::open(dir.get_file_path("a.flv").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0);
+    {
+        flv_writer writer(fd);
+        write_tags(writer);
+    }
+    ::close(fd);
+    auto expected = read_file(dir.get_file_path("a.flv"));
+    // A non-blocking pipe takes a part of the tags, then fails with EAGAIN.
+    int fds[2];
+    CHECK_EQUAL(0, ::pipe2(fds, O_NONBLOCK));
+    std::vector<std::uint8_t> result;
+    {
+        flv_writer writer(fds[1]);
+        write_tags(writer);
+        CHECK_THROWS(writer.flush(), std::runtime_error);
+        for (int i = 0; i < 100; ++i) {
+            read_available(fds[0], result);
+            try {
+                writer.flush();
+                break;
+            }
+            catch (const std::runtime_error&) {
+                CHECK_EQUAL(EAGAIN, errno);
+            }
+        }
+    }
+    read_available(fds[0], result);
+    ::close(fds[0]);
+    ::close(fds[1]);
+    CHECK_EQUAL(expected.size(), result.size());
+    CHECK(expected == result);
+}
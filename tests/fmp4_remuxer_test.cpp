@@ -0,0 +1,409 @@
+/*
+ *    fmp4_remuxer_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <cstring>
+#include <future>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "annexb.hpp"
+#include "coroutine/sync_wait.hpp"
+#include "default_task_service.hpp"
+#include "fmp4_remuxer.hpp"
+#include "posix_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::sample;
+using namespace dawn_player::test;
+
+namespace {
+
+struct box {
+    std::string type;
+    // Offset of the box header in the file, and the body behind it.
+    std::size_t offset = 0;
+    const std::uint8_t* body = nullptr;
+    std::size_t size = 0;
+};
+
+std::uint32_t read_uint32(const std::uint8_t* p)
+{
+    return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) | (static_cast<std::uint32_t>(p[2]) << 8) | p[3];
+}
+
+std::uint16_t read_uint16(const std::uint8_t* p)
+{
+    return static_cast<std::uint16_t>((p[0] << 8) | p[1]);
+}
+
+std::uint64_t read_uint64(const std::uint8_t* p)
+{
+    return (static_cast<std::uint64_t>(read_uint32(p)) << 32) | read_uint32(p + 4);
+}
+
+// The boxes of [data, data + size), with 32-bit sizes only as the remuxer
+// writes them. base is the offset of data in the file.
+std::vector<box> parse_boxes(const std::uint8_t* data, std::size_t size, std::size_t base = 0)
+{
+    std::vector<box> boxes;
+    std::size_t offset = 0;
+    while (offset < size) {
+        CHECK(size - offset >= 8);
+        auto box_size = read_uint32(data + offset);
+        CHECK(box_size >= 8 && box_size <= size - offset);
+        box b;
+        b.type.assign(reinterpret_cast<const char*>(data + offset + 4), 4);
+        b.offset = base + offset;
+        b.body = data + offset + 8;
+        b.size = box_size - 8;
+        boxes.push_back(b);
+        offset += box_size;
+    }
+    return boxes;
+}
+
+std::vector<box> parse_children(const box& parent, std::size_t skip = 0)
+{
+    return parse_boxes(parent.body + skip, parent.size - skip, parent.offset + 8 + skip);
+}
+
+box find_box(const std::vector<box>& boxes, const std::string& type)
+{
+    for (const auto& b : boxes) {
+        if (b.type == type) {
+            return b;
+        }
+    }
+    CHECK(!"box not found");
+    return box();
+}
+
+// The sample entry of trak, from its stsd.
+box find_sample_entry(const box& trak)
+{
+    auto stbl = find_box(parse_children(find_box(parse_children(find_box(parse_children(trak), "mdia")), "minf")), "stbl");
+    auto stsd = find_box(parse_children(stbl), "stsd");
+    // version and flags, entry_count
+    CHECK_EQUAL(std::uint32_t(1), read_uint32(stsd.body + 4));
+    return parse_children(stsd, 8).front();
+}
+
+// The DecoderSpecificInfo of an esds, whose descriptor headers are 2 bytes.
+std::vector<std::uint8_t> get_audio_specific_config(const box& esds)
+{
+    const std::uint8_t* p = esds.body + 4;
+    CHECK_EQUAL(0x03, int(p[0]));
+    p += 2 + 3;
+    CHECK_EQUAL(0x04, int(p[0]));
+    p += 2 + 13;
+    CHECK_EQUAL(0x05, int(p[0]));
+    return std::vector<std::uint8_t>(p + 2, p + 2 + p[1]);
+}
+
+// The timescale in the mdhd of trak.
+std::uint32_t get_timescale(const box& trak)
+{
+    auto mdhd = find_box(parse_children(find_box(parse_children(trak), "mdia")), "mdhd");
+    // version and flags, creation_time, modification_time
+    return read_uint32(mdhd.body + 12);
+}
+
+struct fragmented_samples {
+    std::vector<sample_record> video_samples;
+    std::vector<sample_record> audio_samples;
+    // Decode times of the audio samples in units of the track timescale.
+    std::vector<std::int64_t> audio_dts;
+    std::vector<std::uint32_t> sequence_numbers;
+};
+
+// Rebuilds the samples of the moof/mdat fragments from their trun, with
+// payloads read at the data offsets. Video has a timescale of 1000.
+fragmented_samples read_fragments(const std::vector<std::uint8_t>& file, const std::vector<box>& boxes, std::uint32_t video_track_id, std::uint32_t audio_timescale)
+{
+    fragmented_samples result;
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        if (boxes[i].type != "moof") {
+            continue;
+        }
+        CHECK(i + 1 < boxes.size() && boxes[i + 1].type == "mdat");
+        const auto& moof = boxes[i];
+        auto children = parse_children(moof);
+        result.sequence_numbers.push_back(read_uint32(find_box(children, "mfhd").body + 4));
+        for (const auto& traf : children) {
+            if (traf.type != "traf") {
+                continue;
+            }
+            auto traf_children = parse_children(traf);
+            auto tfhd = find_box(traf_children, "tfhd");
+            // default-base-is-moof
+            CHECK_EQUAL(std::uint32_t(0x020000), read_uint32(tfhd.body) & 0xffffff);
+            auto track_id = read_uint32(tfhd.body + 4);
+            auto tfdt = find_box(traf_children, "tfdt");
+            CHECK_EQUAL(1, int(tfdt.body[0]));
+            auto dts = static_cast<std::int64_t>(read_uint64(tfdt.body + 4));
+            auto trun = find_box(traf_children, "trun");
+            auto flags = read_uint32(trun.body) & 0xffffff;
+            bool has_composition_offsets = (flags & 0x000800) != 0;
+            auto count = read_uint32(trun.body + 4);
+            std::size_t data_offset = moof.offset + read_uint32(trun.body + 8);
+            const std::uint8_t* p = trun.body + 12;
+            for (std::uint32_t j = 0; j < count; ++j) {
+                auto duration = read_uint32(p);
+                auto size = read_uint32(p + 4);
+                auto sample_flags = read_uint32(p + 8);
+                std::int32_t composition_offset = has_composition_offsets ? static_cast<std::int32_t>(read_uint32(p + 12)) : 0;
+                p += has_composition_offsets ? 16 : 12;
+                CHECK(data_offset + size <= file.size());
+                auto timescale = track_id == video_track_id ? 1000 : audio_timescale;
+                sample_record record;
+                record.dts = dts * 10000000 / timescale;
+                record.timestamp = (dts + composition_offset) * 10000000 / timescale;
+                record.is_key_frame = sample_flags == 0x02000000;
+                CHECK(record.is_key_frame || sample_flags == 0x01010000);
+                record.size = size;
+                record.hash = hash_bytes(file.data() + data_offset, size);
+                (track_id == video_track_id ? result.video_samples : result.audio_samples).push_back(record);
+                if (track_id != video_track_id) {
+                    result.audio_dts.push_back(dts);
+                }
+                dts += duration;
+                data_offset += size;
+            }
+        }
+    }
+    return result;
+}
+
+// A video sample of the player as package_video_sample() makes it, key
+// frames with their parameter sets in front.
+video_sample request_packaged_video_sample(flv_player& player)
+{
+    std::promise<video_sample> promise;
+    player.request_video_sample([&promise, &player](std::exception_ptr error, video_sample&& sample) {
+        if (error) {
+            promise.set_exception(error);
+            return;
+        }
+        sample.data = player.package_video_sample(video_sample(sample));
+        sample.has_parameter_sets = true;
+        promise.set_value(std::move(sample));
+    });
+    return promise.get_future().get();
+}
+
+} // namespace
+
+TEST_CASE(remuxed_file_has_source_samples)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto player = std::make_shared<flv_player>(std::make_shared<default_task_service>(), std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")));
+    open_player(*player);
+    auto fd = ::open(dir.get_file_path("a.mp4").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0);
+    auto audio_specific_config = player->get_audio_config_record();
+    auto video_config_record = player->get_video_config_record();
+    // The samples the remuxer is expected to write, video ones as AVCC.
+    std::vector<sample_record> video_samples;
+    std::vector<sample_record> audio_samples;
+    {
+        fmp4_remuxer remuxer(fd);
+        remuxer.write_init_segment(player->get_video_codec(), video_config_record, audio_specific_config);
+        for (std::size_t i = 0; i < flv.video_samples.size(); ++i) {
+            auto video = coroutine::sync_wait_task(player->get_video_sample());
+            auto record = make_sample_record(video);
+            std::vector<std::uint8_t> avcc;
+            annexb_to_avcc(video.data.data(), video.data.size(), avcc);
+            record.size = avcc.size();
+            record.hash = hash_bytes(avcc.data(), avcc.size());
+            video_samples.push_back(record);
+            remuxer.write_video_sample(std::move(video));
+            if (i < flv.audio_samples.size()) {
+                auto audio = coroutine::sync_wait_task(player->get_audio_sample());
+                audio_samples.push_back(make_sample_record(audio));
+                remuxer.write_audio_sample(std::move(audio));
+            }
+        }
+        remuxer.flush();
+    }
+    ::close(fd);
+    close_player(*player);
+    CHECK_EQUAL(flv.audio_samples, audio_samples);
+
+    auto file = read_file(dir.get_file_path("a.mp4"));
+    auto boxes = parse_boxes(file.data(), file.size());
+    CHECK(boxes.size() >= 2 && boxes[0].type == "ftyp" && boxes[1].type == "moov");
+    auto moov = parse_children(boxes[1]);
+    CHECK(find_box(moov, "mvex").size != 0);
+    std::uint32_t video_track_id = 0;
+    std::uint32_t audio_timescale = 0;
+    std::size_t track_count = 0;
+    for (const auto& trak : moov) {
+        if (trak.type != "trak") {
+            continue;
+        }
+        ++track_count;
+        auto tkhd = find_box(parse_children(trak), "tkhd");
+        auto track_id = read_uint32(tkhd.body + 12);
+        auto entry = find_sample_entry(trak);
+        if (entry.type == "avc3") {
+            video_track_id = track_id;
+            CHECK_EQUAL(std::uint32_t(1000), get_timescale(trak));
+            auto avcc = find_box(parse_children(entry, 78), "avcC");
+            CHECK(std::vector<std::uint8_t>(avcc.body, avcc.body + avcc.size) == video_config_record);
+        }
+        else {
+            CHECK_EQUAL(std::string("mp4a"), entry.type);
+            // channelcount, and samplerate as 16.16
+            CHECK_EQUAL(2, int(read_uint16(entry.body + 16)));
+            CHECK_EQUAL(std::uint32_t(44100), read_uint32(entry.body + 24) >> 16);
+            audio_timescale = get_timescale(trak);
+            CHECK_EQUAL(std::uint32_t(44100), audio_timescale);
+            CHECK(get_audio_specific_config(find_box(parse_children(entry, 28), "esds")) == audio_specific_config);
+        }
+    }
+    CHECK_EQUAL(std::size_t(2), track_count);
+    CHECK(video_track_id != 0);
+
+    // One fragment per keyframe, numbered from 1.
+    auto fragments = read_fragments(file, boxes, video_track_id, audio_timescale);
+    CHECK_EQUAL(flv.keyframes.size(), fragments.sequence_numbers.size());
+    for (std::size_t i = 0; i < fragments.sequence_numbers.size(); ++i) {
+        CHECK_EQUAL(std::uint32_t(i + 1), fragments.sequence_numbers[i]);
+    }
+    CHECK_EQUAL(video_samples, fragments.video_samples);
+    CHECK_EQUAL(audio_samples, fragments.audio_samples);
+}
+
+TEST_CASE(audio_only_fragments_every_second)
+{
+    temp_directory dir;
+    auto fd = ::open(dir.get_file_path("a.mp4").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0);
+    std::vector<sample_record> audio_samples;
+    {
+        fmp4_remuxer remuxer(fd);
+        remuxer.write_init_segment(video_codec::h264, {}, { 0x12, 0x10 });
+        for (int i = 0; i < 100; ++i) {
+            audio_sample audio;
+            audio.timestamp = static_cast<std::int64_t>(i) * 40 * 10000;
+            audio.data.assign(100 + i, static_cast<unsigned char>(i + 1));
+            audio_samples.push_back(make_sample_record(audio));
+            remuxer.write_audio_sample(std::move(audio));
+        }
+    }
+    ::close(fd);
+    auto file = read_file(dir.get_file_path("a.mp4"));
+    auto boxes = parse_boxes(file.data(), file.size());
+    auto moov = parse_children(boxes.at(1));
+    std::size_t track_count = 0;
+    for (const auto& b : moov) {
+        track_count += b.type == "trak" ? 1 : 0;
+    }
+    CHECK_EQUAL(std::size_t(1), track_count);
+    CHECK_EQUAL(std::uint32_t(44100), get_timescale(find_box(moov, "trak")));
+    // 4 s of audio, the rest written when the remuxer is destroyed.
+    auto fragments = read_fragments(file, boxes, 0, 44100);
+    CHECK_EQUAL(std::size_t(4), fragments.sequence_numbers.size());
+    CHECK(fragments.video_samples.empty());
+    CHECK_EQUAL(audio_samples, fragments.audio_samples);
+}
+
+TEST_CASE(aac_frames_are_laid_end_to_end)
+{
+    temp_directory dir;
+    auto fd = ::open(dir.get_file_path("a.mp4").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0);
+    {
+        fmp4_remuxer remuxer(fd);
+        // AAC LC, 48 kHz, stereo.
+        remuxer.write_init_segment(video_codec::h264, {}, { 0x11, 0x90 });
+        for (int i = 0; i < 200; ++i) {
+            audio_sample audio;
+            // 21.33 ms frames, rounded to milliseconds as in FLV.
+            audio.timestamp = (static_cast<std::int64_t>(i) * 1024 * 1000 + 24000) / 48000 * 10000;
+            audio.data.assign(100, static_cast<unsigned char>(i + 1));
+            remuxer.write_audio_sample(std::move(audio));
+        }
+        // After a gap, the timestamps are taken as they are.
+        audio_sample audio;
+        audio.timestamp = 50000000;
+        audio.data.assign(100, 1);
+        remuxer.write_audio_sample(std::move(audio));
+    }
+    ::close(fd);
+    auto file = read_file(dir.get_file_path("a.mp4"));
+    auto boxes = parse_boxes(file.data(), file.size());
+    CHECK_EQUAL(std::uint32_t(48000), get_timescale(find_box(parse_children(boxes.at(1)), "trak")));
+    auto fragments = read_fragments(file, boxes, 0, 48000);
+    CHECK_EQUAL(std::size_t(201), fragments.audio_dts.size());
+    for (std::size_t i = 0; i < 200; ++i) {
+        CHECK_EQUAL(std::int64_t(i * 1024), fragments.audio_dts[i]);
+    }
+    CHECK_EQUAL(std::int64_t(5 * 48000), fragments.audio_dts[200]);
+}
+
+TEST_CASE(config_switch_goes_in_band)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.config_switch_frame = 100;
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto player = std::make_shared<flv_player>(std::make_shared<default_task_service>(), std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")));
+    open_player(*player);
+    auto fd = ::open(dir.get_file_path("a.mp4").c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    CHECK(fd >= 0);
+    std::vector<sample_record> video_samples;
+    std::vector<std::vector<std::uint8_t>> key_frames;
+    {
+        fmp4_remuxer remuxer(fd);
+        remuxer.write_init_segment(player->get_video_codec(), get_synthetic_avc_config_record(), {});
+        for (std::size_t i = 0; i < flv.video_samples.size(); ++i) {
+            auto video = request_packaged_video_sample(*player);
+            auto record = make_sample_record(video);
+            std::vector<std::uint8_t> avcc;
+            annexb_to_avcc(video.data.data(), video.data.size(), avcc);
+            record.size = avcc.size();
+            record.hash = hash_bytes(avcc.data(), avcc.size());
+            video_samples.push_back(record);
+            if (video.is_key_frame) {
+                key_frames.push_back(avcc);
+            }
+            remuxer.write_video_sample(std::move(video));
+        }
+    }
+    ::close(fd);
+    close_player(*player);
+    auto file = read_file(dir.get_file_path("a.mp4"));
+    auto boxes = parse_boxes(file.data(), file.size());
+    // One init segment, whose configuration key frames override in-band.
+    auto trak = find_box(parse_children(boxes.at(1)), "trak");
+    auto entry = find_sample_entry(trak);
+    CHECK_EQUAL(std::string("avc3"), entry.type);
+    auto avcc = find_box(parse_children(entry, 78), "avcC");
+    CHECK(std::vector<std::uint8_t>(avcc.body, avcc.body + avcc.size) == get_synthetic_avc_config_record());
+    std::size_t init_segment_count = 0;
+    for (const auto& b : boxes) {
+        init_segment_count += b.type == "moov" ? 1 : 0;
+    }
+    CHECK_EQUAL(std::size_t(1), init_segment_count);
+    auto fragments = read_fragments(file, boxes, read_uint32(find_box(parse_children(trak), "tkhd").body + 12), 0);
+    CHECK_EQUAL(video_samples, fragments.video_samples);
+    // Each key frame starts with the SPS of its configuration.
+    for (std::size_t i = 0; i < key_frames.size(); ++i) {
+        const auto& record = i * options.keyframe_interval < options.config_switch_frame ? get_synthetic_avc_config_record() : get_synthetic_switched_avc_config_record();
+        std::size_t sps_size = (static_cast<std::size_t>(record[6]) << 8) | record[7];
+        CHECK(key_frames[i].size() > 4 + sps_size);
+        CHECK_EQUAL(std::uint32_t(sps_size), read_uint32(key_frames[i].data()));
+        CHECK(std::equal(record.begin() + 8, record.begin() + 8 + sps_size, key_frames[i].begin() + 4));
+    }
+}
@@ -0,0 +1,148 @@
+/*
+ *    frame_allocator_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "coroutine/frame_allocator.hpp"
+#include "coroutine/sync_wait.hpp"
+#include "coroutine/task.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::coroutine;
+using namespace dawn_player::test;
+
+using dawn_player::coroutine::impl::frame_cache;
+
+namespace {
+
+std::vector<void*> allocate_frames(std::size_t count, std::size_t size)
+{
+    std::vector<void*> frames;
+    for (std::size_t i = 0; i < count; ++i) {
+        frames.push_back(frame_cache::allocate(size));
+        // Touch every byte, a block too small shows up under a sanitizer.
+        std::memset(frames.back(), 0xa5, size);
+    }
+    return frames;
+}
+
+void deallocate_frames(const std::vector<void*>& frames, std::size_t size)
+{
+    for (auto frame : frames) {
+        frame_cache::deallocate(frame, size);
+    }
+}
+
+bool contains(const std::vector<void*>& frames, void* frame)
+{
+    return std::find(frames.begin(), frames.end(), frame) != frames.end();
+}
+
+task<int> add(int a, int b)
+{
+    co_return a + b;
+}
+
+// Releases its frames when the thread exits, after the frame cache of the
+// thread when constructed before it.
+struct frame_holder {
+    std::vector<void*> frames;
+    ~frame_holder()
+    {
+        deallocate_frames(this->frames, 100);
+    }
+};
+
+} // namespace
+
+TEST_CASE(frames_are_reused)
+{
+    auto frames = allocate_frames(4, 100);
+    deallocate_frames(frames, 100);
+    // Same size class, handed out again before anything new is allocated.
+    auto again = allocate_frames(4, 98);
+    for (auto frame : again) {
+        CHECK(contains(frames, frame));
+    }
+    deallocate_frames(again, 98);
+    CHECK_EQUAL(12, sync_wait_task(add(5, 7)));
+}
+
+TEST_CASE(block_sizes_fit_frames)
+{
+    for (std::size_t size = 1; size <= 128 * 1024; size += 97) {
+        auto block_size = frame_cache::get_block_size(size);
+        CHECK(block_size >= size);
+        CHECK(block_size - size <= std::max<std::size_t>(64, size / 8 + 32));
+    }
+    // The frame of flv_player::read_some_data() holds a 64 KiB buffer.
+    CHECK_EQUAL(std::size_t(72 * 1024), frame_cache::get_block_size(64 * 1024 + 512));
+    // Anything larger than the biggest class is allocated exactly.
+    CHECK_EQUAL(std::size_t(1024 * 1024) + 16, frame_cache::get_block_size(1024 * 1024));
+    auto large = frame_cache::allocate(1024 * 1024);
+    std::memset(large, 0, 1024 * 1024);
+    frame_cache::deallocate(large, 1024 * 1024);
+}
+
+TEST_CASE(cross_thread_frees_return_to_owner)
+{
+    // Frames allocated here and released by a consumer thread, many times.
+    std::vector<void*> first_frames;
+    for (int round = 0; round < 20; ++round) {
+        auto frames = allocate_frames(8, 200);
+        if (round == 0) {
+            first_frames = frames;
+        }
+        else {
+            // Blocks came back to this thread, nothing new was needed.
+            for (auto frame : frames) {
+                CHECK(contains(first_frames, frame));
+            }
+        }
+        std::vector<void*> consumer_frames;
+        std::thread consumer([&]() {
+            deallocate_frames(frames, 200);
+            // The consumer does not get the blocks it released.
+            consumer_frames = allocate_frames(8, 200);
+            deallocate_frames(consumer_frames, 200);
+        });
+        consumer.join();
+        for (auto frame : consumer_frames) {
+            CHECK(!contains(first_frames, frame));
+        }
+    }
+}
+
+TEST_CASE(frames_outlive_owner_thread)
+{
+    std::vector<void*> frames;
+    std::thread owner([&]() {
+        frames = allocate_frames(16, 300);
+        // Released here, freed with the cache when the thread exits.
+        deallocate_frames(std::vector<void*>(frames.begin() + 8, frames.end()), 300);
+        frames.resize(8);
+    });
+    owner.join();
+    // The last block to come back releases the cache of the exited thread.
+    deallocate_frames(frames, 300);
+}
+
+TEST_CASE(frames_released_during_thread_exit)
+{
+    std::thread worker([]() {
+        // Constructed before the frame cache, so destroyed after it.
+        static thread_local frame_holder holder;
+        holder.frames = allocate_frames(4, 100);
+        CHECK_EQUAL(3, sync_wait_task(add(1, 2)));
+    });
+    worker.join();
+    CHECK(frame_cache::local() != nullptr);
+}
@@ -0,0 +1,99 @@
+/*
+ *    http_io_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <stdexcept>
+
+#include "coroutine/sync_wait.hpp"
+#include "http_io.hpp"
+#include "http_test_server.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+void check_streamed(const std::string& path)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    auto proxy = std::make_shared<io::http_read_stream_proxy>(server.get_url(path));
+    CHECK(read_to_end(*proxy, 10000) == flv.data);
+    auto result = play(std::make_shared<io::http_read_stream_proxy>(server.get_url(path)));
+    CHECK_EQUAL(std::string("False"), result.info.at("CanSeek"));
+    CHECK_EQUAL(flv.video_samples, result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+}
+
+} // namespace
+
+TEST_CASE(parses_urls)
+{
+    io::http_url url;
+    CHECK(io::http_url::parse("http://example.com:8080/live/a.flv?token=1", url));
+    CHECK_EQUAL(std::string("example.com"), url.host);
+    CHECK_EQUAL(8080, url.port);
+    CHECK_EQUAL(std::string("/live/a.flv?token=1"), url.target);
+    CHECK(io::http_url::parse("http://example.com", url));
+    CHECK_EQUAL(80, url.port);
+    CHECK_EQUAL(std::string("/"), url.target);
+    CHECK(!io::http_url::parse("https://example.com/a.flv", url));
+    CHECK_THROWS(io::http_read_stream_proxy("ftp://example.com/a.flv"), std::runtime_error);
+}
+
+TEST_CASE(streams_content_length_body)
+{
+    check_streamed("/norange");
+}
+
+TEST_CASE(streams_chunked_body)
+{
+    // Random chunk sizes with extensions and a trailer, behind an interim
+    // 100 Continue response.
+    check_streamed("/chunked");
+}
+
+TEST_CASE(streams_close_delimited_body)
+{
+    check_streamed("/close");
+}
+
+TEST_CASE(follows_redirects)
+{
+    check_streamed("/redirect");
+}
+
+TEST_CASE(reuses_keep_alive_connection)
+{
+    http_test_server server({ 'x' });
+    io::http_url url;
+    CHECK(io::http_url::parse(server.get_url("/small"), url));
+    io::http_connection connection;
+    for (int i = 0; i < 3; ++i) {
+        io::http_response response;
+        connection.request(url, {}, response);
+        CHECK_EQUAL(200, response.status_code);
+        CHECK(response.find_header("x-connection") != nullptr && *response.find_header("X-Connection") == "1");
+        std::uint8_t body[16];
+        std::size_t size = 0;
+        while (auto result = connection.read_body(body + size, sizeof(body) - size)) {
+            size += result;
+        }
+        CHECK_EQUAL(std::string("hello"), std::string(reinterpret_cast<char*>(body), size));
+        CHECK(connection.is_reusable());
+    }
+    CHECK_EQUAL(std::size_t(1), server.get_connection_count());
+}
+
+TEST_CASE(rejects_error_status)
+{
+    http_test_server server({ 'x' });
+    io::http_read_stream_proxy proxy(server.get_url("/missing"));
+    std::uint8_t buffer[16];
+    CHECK_THROWS(coroutine::sync_wait_task(proxy.read(buffer, sizeof(buffer))), std::runtime_error);
+    CHECK(!proxy.can_seek());
+}
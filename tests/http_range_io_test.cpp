@@ -0,0 +1,165 @@
+/*
+ *    http_range_io_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+
+#include "coroutine/sync_wait.hpp"
+#include "default_task_service.hpp"
+#include "http_io.hpp"
+#include "http_test_server.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+std::vector<std::uint8_t> read_some(io::read_stream_proxy& proxy, std::uint32_t size)
+{
+    std::vector<std::uint8_t> data(size);
+    std::uint32_t offset = 0;
+    while (offset < size) {
+        auto result = coroutine::sync_wait_task(proxy.read(data.data() + offset, size - offset));
+        if (result == 0) {
+            break;
+        }
+        offset += result;
+    }
+    data.resize(offset);
+    return data;
+}
+
+std::vector<std::uint8_t> slice(const std::vector<std::uint8_t>& data, std::uint64_t first, std::uint64_t size)
+{
+    return std::vector<std::uint8_t>(data.begin() + first, data.begin() + std::min<std::uint64_t>(first + size, data.size()));
+}
+
+// The Range headers the server has seen, separated by '|'.
+std::string get_ranges(const http_test_server& server)
+{
+    std::string result;
+    for (const auto& range : server.get_range_headers()) {
+        result += (result.empty() ? "" : "|") + range;
+    }
+    return result;
+}
+
+} // namespace
+
+TEST_CASE(reads_and_seeks)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    io::http_range_read_stream_proxy proxy(server.get_url("/a.flv"));
+    CHECK(!proxy.can_seek());
+    CHECK(read_some(proxy, 1000) == slice(flv.data, 0, 1000));
+    CHECK(proxy.can_seek());
+    for (std::uint64_t pos : { std::uint64_t(700000), std::uint64_t(20), flv.data.size() - 5, std::uint64_t(300000) }) {
+        proxy.seek(pos);
+        CHECK(read_some(proxy, 100000) == slice(flv.data, pos, 100000));
+    }
+    proxy.seek(0);
+    CHECK(read_to_end(proxy) == flv.data);
+    proxy.seek(flv.data.size() + 10);
+    CHECK(read_to_end(proxy).empty());
+}
+
+TEST_CASE(far_seek_sends_one_range_request)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    io::http_range_read_stream_proxy proxy(server.get_url("/a.flv"));
+    CHECK(read_some(proxy, 1000) == slice(flv.data, 0, 1000));
+    proxy.seek(900000);
+    CHECK(read_some(proxy, 1000) == slice(flv.data, 900000, 1000));
+    CHECK_EQUAL(std::string("bytes=0-|bytes=900000-"), get_ranges(server));
+}
+
+TEST_CASE(short_forward_seek_skips_bytes)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    io::http_range_read_stream_proxy proxy(server.get_url("/a.flv"));
+    CHECK(read_some(proxy, 1000) == slice(flv.data, 0, 1000));
+    proxy.seek(200000);
+    CHECK(read_some(proxy, 1000) == slice(flv.data, 200000, 1000));
+    CHECK_EQUAL(std::size_t(1), server.get_request_count());
+}
+
+TEST_CASE(speculative_range_serves_seek_to_next_seek_point)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    io::http_range_read_stream_proxy proxy(server.get_url("/a.flv"), {}, true);
+    std::vector<std::uint64_t> seek_points;
+    for (const auto& keyframe : flv.keyframes) {
+        seek_points.push_back(keyframe.second);
+    }
+    proxy.set_seek_points(seek_points);
+    // The first seek point past the 256 KiB skip distance.
+    auto target = *std::upper_bound(seek_points.begin(), seek_points.end(), std::uint64_t(1000) + 256 * 1024);
+    auto expected_range = "bytes=" + std::to_string(target) + "-" + std::to_string(target + 512 * 1024 - 1);
+    // The speculative request goes out once its connection is up.
+    std::uint64_t position = 0;
+    for (int i = 0; i < 100; ++i) {
+        auto headers = server.get_range_headers();
+        if (std::find(headers.begin(), headers.end(), expected_range) != headers.end()) {
+            break;
+        }
+        CHECK(read_some(proxy, 10) == slice(flv.data, position, 10));
+        position += 10;
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+    auto get_ranges_before = get_ranges(server);
+    CHECK(get_ranges_before.find(expected_range) != std::string::npos);
+    proxy.seek(target);
+    CHECK(read_to_end(proxy) == slice(flv.data, target, flv.data.size()));
+    // The seek sent no request of its own, the next one asks for the rest
+    // behind the speculative range.
+    auto followup_range = "|bytes=" + std::to_string(target + 512 * 1024) + "-";
+    CHECK_EQUAL(get_ranges_before + followup_range, get_ranges(server).substr(0, get_ranges_before.size() + followup_range.size()));
+}
+
+TEST_CASE(resumes_broken_response)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    server.break_next_response_after(100000);
+    io::http_range_read_stream_proxy proxy(server.get_url("/a.flv"));
+    CHECK(read_to_end(proxy) == flv.data);
+    CHECK_EQUAL(std::string("bytes=0-|bytes=100000-"), get_ranges(server));
+}
+
+TEST_CASE(plays_without_range_support)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    auto result = play(std::make_shared<io::http_range_read_stream_proxy>(server.get_url("/norange")));
+    CHECK_EQUAL(std::string("False"), result.info.at("CanSeek"));
+    CHECK_EQUAL(flv.video_samples, result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+}
+
+TEST_CASE(player_seeks_through_redirect)
+{
+    synthetic_flv_options options;
+    options.has_keyframes_index = true;
+    auto flv = make_synthetic_flv(options);
+    http_test_server server(flv.data);
+    server.set_latency(std::chrono::milliseconds(5));
+    auto player = std::make_shared<flv_player>(std::make_shared<default_task_service>(),
+        std::make_shared<io::http_range_read_stream_proxy>(server.get_url("/moved"), std::vector<std::string>(), true));
+    auto info = open_player(*player);
+    CHECK_EQUAL(std::string("True"), info.at("CanSeek"));
+    for (std::size_t second : { 5, 1, 2, 8, 0, 9 }) {
+        CHECK_EQUAL(static_cast<std::int64_t>(second) * 10000000, seek_player(*player, static_cast<std::int64_t>(second) * 10000000 + 3000000));
+        auto begin = second * 25;
+        CHECK_EQUAL(std::vector<sample_record>(flv.video_samples.begin() + begin, flv.video_samples.begin() + std::min(begin + 30, flv.video_samples.size())), read_video_samples(*player, 30));
+        CHECK_EQUAL(std::vector<sample_record>(flv.audio_samples.begin() + begin, flv.audio_samples.begin() + std::min(begin + 30, flv.audio_samples.size())), read_audio_samples(*player, 30));
+    }
+    close_player(*player);
+}
@@ -0,0 +1,310 @@
+/*
+ *    http_test_server.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <stdexcept>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "http_test_server.hpp"
+
+namespace dawn_player {
+namespace test {
+namespace {
+
+std::string to_lower(std::string value)
+{
+    std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return value;
+}
+
+// Returns the value of the header name (lowercase) in the request head, or
+// an empty string.
+std::string find_request_header(const std::string& head, const std::string& name)
+{
+    std::size_t line_start = head.find("\r\n");
+    while (line_start != std::string::npos && line_start + 2 < head.size()) {
+        line_start += 2;
+        auto line_end = head.find("\r\n", line_start);
+        auto line = head.substr(line_start, line_end - line_start);
+        auto colon = line.find(':');
+        if (colon != std::string::npos && to_lower(line.substr(0, colon)) == name) {
+            auto value_start = line.find_first_not_of(' ', colon + 1);
+            return value_start == std::string::npos ? std::string() : line.substr(value_start);
+        }
+        line_start = line_end;
+    }
+    return std::string();
+}
+
+} // namespace
+
+http_test_server::http_test_server(std::vector<std::uint8_t> body)
+    : body(std::move(body))
+    , listen_fd(-1)
+    , port(0)
+    , is_stopped(false)
+    , connection_count(0)
+    , request_count(0)
+    , latency(0)
+    , send_block_size(256 * 1024)
+    , break_after(std::numeric_limits<std::uint64_t>::max())
+{
+    this->listen_fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (this->listen_fd == -1) {
+        throw std::runtime_error("failed to create socket");
+    }
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t address_size = sizeof(address);
+    if (::bind(this->listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+        || ::listen(this->listen_fd, 64) != 0
+        || ::getsockname(this->listen_fd, reinterpret_cast<sockaddr*>(&address), &address_size) != 0) {
+        ::close(this->listen_fd);
+        throw std::runtime_error("failed to listen");
+    }
+    this->port = ntohs(address.sin_port);
+    this->accept_thread = std::thread([this]() {
+        this->accept_proc();
+    });
+}
+
+http_test_server::~http_test_server()
+{
+    this->is_stopped = true;
+    ::shutdown(this->listen_fd, SHUT_RDWR);
+    this->accept_thread.join();
+    ::close(this->listen_fd);
+    std::vector<std::thread> threads;
+    {
+        std::lock_guard<std::mutex> lck(this->mtx);
+        for (auto fd : this->connection_fds) {
+            ::shutdown(fd, SHUT_RDWR);
+        }
+        threads.swap(this->connection_threads);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+std::string http_test_server::get_url(const std::string& path) const
+{
+    return "http://127.0.0.1:" + std::to_string(this->port) + path;
+}
+
+void http_test_server::set_latency(std::chrono::milliseconds latency, std::size_t send_block_size)
+{
+    std::lock_guard<std::mutex> lck(this->mtx);
+    this->latency = latency;
+    this->send_block_size = send_block_size;
+}
+
+void http_test_server::break_next_response_after(std::uint64_t size)
+{
+    std::lock_guard<std::mutex> lck(this->mtx);
+    this->break_after = size;
+}
+
+std::size_t http_test_server::get_connection_count() const
+{
+    std::lock_guard<std::mutex> lck(this->mtx);
+    return this->connection_count;
+}
+
+std::size_t http_test_server::get_request_count() const
+{
+    std::lock_guard<std::mutex> lck(this->mtx);
+    return this->request_count;
+}
+
+std::vector<std::string> http_test_server::get_range_headers() const
+{
+    std::lock_guard<std::mutex> lck(this->mtx);
+    return this->range_headers;
+}
+
+void http_test_server::accept_proc()
+{
+    while (!this->is_stopped) {
+        auto fd = ::accept4(this->listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd == -1) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lck(this->mtx);
+        if (this->is_stopped) {
+            ::close(fd);
+            break;
+        }
+        auto connection_number = ++this->connection_count;
+        this->connection_fds.push_back(fd);
+        this->connection_threads.emplace_back([this, fd, connection_number]() {
+            this->connection_proc(fd, connection_number);
+        });
+    }
+}
+
+void http_test_server::connection_proc(int fd, std::size_t connection_number)
+{
+    std::string received;
+    char buffer[16 * 1024];
+    bool is_open = true;
+    while (is_open) {
+        auto head_end = received.find("\r\n\r\n");
+        if (head_end == std::string::npos) {
+            auto result = ::recv(fd, buffer, sizeof(buffer), 0);
+            if (result <= 0) {
+                break;
+            }
+            received.append(buffer, static_cast<std::size_t>(result));
+            continue;
+        }
+        auto head = received.substr(0, head_end + 2);
+        received.erase(0, head_end + 4);
+        is_open = this->handle_request(fd, connection_number, head);
+    }
+    std::lock_guard<std::mutex> lck(this->mtx);
+    this->connection_fds.erase(std::find(this->connection_fds.begin(), this->connection_fds.end(), fd));
+    ::close(fd);
+}
+
+bool http_test_server::handle_request(int fd, std::size_t connection_number, const std::string& head)
+{
+    auto target_start = head.find(' ') + 1;
+    auto target = head.substr(target_start, head.find(' ', target_start) - target_start);
+    auto range = find_request_header(head, "range");
+    std::chrono::milliseconds latency;
+    std::uint64_t break_after = std::numeric_limits<std::uint64_t>::max();
+    {
+        std::lock_guard<std::mutex> lck(this->mtx);
+        ++this->request_count;
+        this->range_headers.push_back(range);
+        latency = this->latency;
+        if (target == "/a.flv" || target == "/norange") {
+            std::swap(break_after, this->break_after);
+        }
+    }
+    std::this_thread::sleep_for(latency);
+
+    auto send_text = [this, fd](const std::string& text) {
+        return this->send_all(fd, reinterpret_cast<const std::uint8_t*>(text.data()), text.size(), false);
+    };
+    // Sends the head and body[first, last], cut short by break_after.
+    auto send_body_response = [&](const std::string& response_head, std::uint64_t first, std::uint64_t last) {
+        if (!send_text(response_head)) {
+            return false;
+        }
+        auto size = last + 1 - first;
+        auto sent_size = std::min(size, break_after);
+        if (!this->send_all(fd, this->body.data() + first, static_cast<std::size_t>(sent_size), true)) {
+            return false;
+        }
+        return sent_size == size;
+    };
+
+    if (target == "/a.flv") {
+        unsigned long long first = 0;
+        unsigned long long last = 0;
+        int count = std::sscanf(range.c_str(), "bytes=%llu-%llu", &first, &last);
+        if (count < 1) {
+            return send_body_response("HTTP/1.1 200 OK\r\nETag: \"v1\"\r\nContent-Length: " + std::to_string(this->body.size()) + "\r\n\r\n", 0, this->body.size() - 1);
+        }
+        if (first >= this->body.size()) {
+            return send_text("HTTP/1.1 416 Range Not Satisfiable\r\nContent-Range: bytes */" + std::to_string(this->body.size()) + "\r\nContent-Length: 0\r\n\r\n");
+        }
+        if (count < 2 || last >= this->body.size()) {
+            last = this->body.size() - 1;
+        }
+        return send_body_response("HTTP/1.1 206 Partial Content\r\nETag: \"v1\"\r\nContent-Range: bytes " + std::to_string(first) + "-" + std::to_string(last) + "/" + std::to_string(this->body.size())
+            + "\r\nContent-Length: " + std::to_string(last + 1 - first) + "\r\n\r\n", first, last);
+    }
+    if (target == "/norange") {
+        return send_body_response("HTTP/1.1 200 OK\r\nContent-Length: " + std::to_string(this->body.size()) + "\r\n\r\n", 0, this->body.size() - 1);
+    }
+    if (target == "/chunked") {
+        std::mt19937 engine(static_cast<std::uint32_t>(connection_number));
+        const std::size_t chunk_sizes[] = { 1, 7, 100, 4096, 70000, 300000 };
+        const std::size_t fragment_sizes[] = { 1, 3, 1000, 65536, 200000 };
+        std::string response = "HTTP/1.1 100 Continue\r\n\r\nHTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n";
+        for (std::size_t offset = 0; offset < this->body.size();) {
+            auto size = std::min(chunk_sizes[engine() % 6], this->body.size() - offset);
+            char chunk_head[32];
+            std::snprintf(chunk_head, sizeof(chunk_head), "%zx;ext=1\r\n", size);
+            response += chunk_head;
+            response.append(reinterpret_cast<const char*>(this->body.data() + offset), size);
+            response += "\r\n";
+            offset += size;
+        }
+        response += "0\r\nX-Trailer: y\r\n\r\n";
+        for (std::size_t offset = 0; offset < response.size();) {
+            auto size = std::min(fragment_sizes[engine() % 5], response.size() - offset);
+            if (!this->send_all(fd, reinterpret_cast<const std::uint8_t*>(response.data() + offset), size, false)) {
+                return false;
+            }
+            offset += size;
+        }
+        return true;
+    }
+    if (target == "/close") {
+        send_text("HTTP/1.0 200 OK\r\n\r\n");
+        this->send_all(fd, this->body.data(), this->body.size(), true);
+        return false;
+    }
+    if (target == "/redirect") {
+        return send_text("HTTP/1.1 302 Found\r\nLocation: /chunked\r\nContent-Length: 0\r\n\r\n");
+    }
+    if (target == "/moved") {
+        return send_text("HTTP/1.1 301 Moved Permanently\r\nLocation: " + this->get_url("/a.flv") + "\r\nContent-Length: 0\r\n\r\n");
+    }
+    if (target == "/small") {
+        return send_text("HTTP/1.1 200 OK\r\nContent-Length: 5\r\nX-Connection: " + std::to_string(connection_number) + "\r\n\r\nhello");
+    }
+    return send_text("HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n\r\n");
+}
+
+bool http_test_server::send_all(int fd, const std::uint8_t* data, std::size_t size, bool is_throttled)
+{
+    std::chrono::milliseconds latency;
+    std::size_t block_size;
+    {
+        std::lock_guard<std::mutex> lck(this->mtx);
+        latency = this->latency;
+        block_size = this->send_block_size;
+    }
+    if (!is_throttled || latency.count() == 0) {
+        block_size = std::max<std::size_t>(size, 1);
+    }
+    std::size_t offset = 0;
+    while (offset < size) {
+        auto block_end = std::min(size, offset + block_size);
+        while (offset < block_end) {
+            auto result = ::send(fd, data + offset, block_end - offset, MSG_NOSIGNAL);
+            if (result <= 0) {
+                return false;
+            }
+            offset += static_cast<std::size_t>(result);
+        }
+        if (offset < size) {
+            std::this_thread::sleep_for(latency);
+        }
+    }
+    return true;
+}
+
+} // namespace test
+} // namespace dawn_player
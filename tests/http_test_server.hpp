@@ -0,0 +1,80 @@
+/*
+ *    http_test_server.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_HTTP_TEST_SERVER_HPP
+#define DAWN_PLAYER_HTTP_TEST_SERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dawn_player {
+namespace test {
+
+// A loopback HTTP/1.1 server for the proxy tests, one thread per
+// connection. It serves one body under several paths:
+//
+//   /a.flv      Range requests answered with 206 (416 past the end), 200
+//               without a Range header. Carries ETag "v1".
+//   /norange    200 with Content-Length, Range is ignored.
+//   /chunked    An interim 100 Continue, then the body in chunks of random
+//               sizes with chunk extensions and a trailer, written in
+//               random fragments.
+//   /close      HTTP/1.0 style, the body ends when the connection closes.
+//   /redirect   302 to /chunked.
+//   /moved      301 to /a.flv.
+//   /small      "hello" with X-Connection, the number of the connection.
+//
+// Requests may be pipelined. Latency is injected before each response and
+// after every send_block_size bytes sent, which makes a single connection
+// window limited the way a long round trip does.
+class http_test_server {
+public:
+    explicit http_test_server(std::vector<std::uint8_t> body);
+    http_test_server(const http_test_server&) = delete;
+    http_test_server& operator=(const http_test_server&) = delete;
+    ~http_test_server();
+    std::string get_url(const std::string& path) const;
+    void set_latency(std::chrono::milliseconds latency, std::size_t send_block_size = 256 * 1024);
+    // The next /a.flv or /norange response stops after size body bytes and
+    // its connection is closed.
+    void break_next_response_after(std::uint64_t size);
+    std::size_t get_connection_count() const;
+    std::size_t get_request_count() const;
+    // The Range header of each request, empty if it had none.
+    std::vector<std::string> get_range_headers() const;
+private:
+    void accept_proc();
+    void connection_proc(int fd, std::size_t connection_number);
+    bool handle_request(int fd, std::size_t connection_number, const std::string& head);
+    bool send_all(int fd, const std::uint8_t* data, std::size_t size, bool is_throttled);
+private:
+    std::vector<std::uint8_t> body;
+    int listen_fd;
+    std::uint16_t port;
+    std::atomic<bool> is_stopped;
+    std::thread accept_thread;
+    mutable std::mutex mtx;
+    std::vector<std::thread> connection_threads;
+    std::vector<int> connection_fds;
+    std::size_t connection_count;
+    std::size_t request_count;
+    std::vector<std::string> range_headers;
+    std::chrono::milliseconds latency;
+    std::size_t send_block_size;
+    std::uint64_t break_after;
+};
+
+} // namespace test
+} // namespace dawn_player
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ *    parallel_io_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+
+#include "coroutine/sync_wait.hpp"
+#include "default_task_service.hpp"
+#include "http_io.hpp"
+#include "http_test_server.hpp"
+#include "parallel_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+std::shared_ptr<io::parallel_read_stream_proxy> open_parallel(const http_test_server& server, const std::string& path, std::size_t connection_count)
+{
+    auto url = server.get_url(path);
+    return std::make_shared<io::parallel_read_stream_proxy>([url]() {
+        return std::make_shared<io::http_range_read_stream_proxy>(url);
+    }, connection_count);
+}
+
+} // namespace
+
+TEST_CASE(reads_same_bytes_with_any_connection_count)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    server.set_latency(std::chrono::milliseconds(2), 64 * 1024);
+    for (std::size_t connection_count : { 1, 4, 8 }) {
+        auto proxy = open_parallel(server, "/a.flv", connection_count);
+        CHECK(read_to_end(*proxy, 10000) == flv.data);
+        for (std::uint64_t pos : { std::uint64_t(900000), std::uint64_t(100), std::uint64_t(400000) }) {
+            proxy->seek(pos);
+            auto data = read_to_end(*proxy);
+            CHECK(data == std::vector<std::uint8_t>(flv.data.begin() + pos, flv.data.end()));
+        }
+    }
+}
+
+TEST_CASE(knows_seekability_before_first_byte)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    // The first range takes several round trips to complete.
+    server.set_latency(std::chrono::milliseconds(20), 16 * 1024);
+    auto proxy = open_parallel(server, "/a.flv", 4);
+    std::uint8_t byte = 0;
+    CHECK_EQUAL(1u, coroutine::sync_wait_task(proxy->read(&byte, 1)));
+    CHECK(proxy->can_seek());
+}
+
+TEST_CASE(player_seeks_from_open)
+{
+    synthetic_flv_options options;
+    options.has_keyframes_index = true;
+    auto flv = make_synthetic_flv(options);
+    http_test_server server(flv.data);
+    server.set_latency(std::chrono::milliseconds(5), 64 * 1024);
+    auto player = std::make_shared<flv_player>(std::make_shared<default_task_service>(), open_parallel(server, "/a.flv", 4));
+    auto info = open_player(*player);
+    CHECK_EQUAL(std::string("True"), info.at("CanSeek"));
+    for (std::size_t second : { 6, 2, 9, 0 }) {
+        CHECK_EQUAL(static_cast<std::int64_t>(second) * 10000000, seek_player(*player, static_cast<std::int64_t>(second) * 10000000 + 5000000));
+        auto begin = second * 25;
+        CHECK_EQUAL(std::vector<sample_record>(flv.video_samples.begin() + begin, flv.video_samples.begin() + std::min(begin + 20, flv.video_samples.size())), read_video_samples(*player, 20));
+    }
+    close_player(*player);
+}
+
+TEST_CASE(falls_back_to_one_sequential_connection)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    auto proxy = open_parallel(server, "/norange", 4);
+    CHECK(read_to_end(*proxy) == flv.data);
+    CHECK(!proxy->can_seek());
+    CHECK_EQUAL(std::size_t(1), server.get_request_count());
+    auto result = play(open_parallel(server, "/norange", 4));
+    CHECK_EQUAL(std::string("False"), result.info.at("CanSeek"));
+    CHECK_EQUAL(flv.video_samples, result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+}
+
+TEST_CASE(destruction_shuts_connections_down)
+{
+    auto flv = make_synthetic_flv();
+    http_test_server server(flv.data);
+    // Each block of the responses takes two seconds.
+    server.set_latency(std::chrono::milliseconds(2000), 16 * 1024);
+    auto proxy = open_parallel(server, "/a.flv", 4);
+    std::uint8_t byte = 0;
+    CHECK_EQUAL(1u, coroutine::sync_wait_task(proxy->read(&byte, 1)));
+    // The workers are blocked in reads, the destructor does not wait for
+    // the server to send more.
+    auto start = std::chrono::steady_clock::now();
+    proxy.reset();
+    CHECK(std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1500));
+}
@@ -0,0 +1,106 @@
+/*
+ *    posix_io_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <stdexcept>
+
+#include "coroutine/sync_wait.hpp"
+#include "posix_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+synthetic_flv write_synthetic_flv(const temp_directory& dir, const synthetic_flv_options& options = synthetic_flv_options())
+{
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    return flv;
+}
+
+void check_playback(const synthetic_flv& flv, const playback& result)
+{
+    // From the SPS, onMetaData says 1280x720.
+    CHECK_EQUAL(std::string("1920"), result.info.at("Width"));
+    CHECK_EQUAL(std::string("1080"), result.info.at("Height"));
+    CHECK_EQUAL(std::string("1088"), result.info.at("CodedHeight"));
+    CHECK_EQUAL(std::string("2"), result.info.at("MaxNumReorderFrames"));
+    CHECK_EQUAL(flv.video_samples, result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+}
+
+} // namespace
+
+TEST_CASE(file_proxy_reads_and_seeks)
+{
+    temp_directory dir;
+    auto flv = write_synthetic_flv(dir);
+    io::file_read_stream_proxy proxy(dir.get_file_path("a.flv"));
+    CHECK(proxy.can_seek());
+    CHECK(read_to_end(proxy, 1000) == flv.data);
+    proxy.seek(1000);
+    CHECK(read_to_end(proxy) == std::vector<std::uint8_t>(flv.data.begin() + 1000, flv.data.end()));
+    proxy.seek(flv.data.size() + 10);
+    CHECK(read_to_end(proxy).empty());
+}
+
+TEST_CASE(mmap_proxy_reads_views_and_seeks)
+{
+    temp_directory dir;
+    auto flv = write_synthetic_flv(dir);
+    io::mmap_read_stream_proxy proxy(dir.get_file_path("a.flv"));
+    CHECK(proxy.can_seek());
+    CHECK(read_to_end(proxy, 1000) == flv.data);
+    proxy.seek(100);
+    const std::uint8_t* data = nullptr;
+    std::uint64_t size = 0;
+    CHECK(proxy.get_view(data, size));
+    CHECK(size == flv.data.size() - 100);
+    CHECK(std::equal(data, data + size, flv.data.begin() + 100));
+    proxy.consume(size - 10);
+    CHECK(read_to_end(proxy) == std::vector<std::uint8_t>(flv.data.end() - 10, flv.data.end()));
+}
+
+TEST_CASE(missing_file_throws)
+{
+    temp_directory dir;
+    CHECK_THROWS(io::file_read_stream_proxy(dir.get_file_path("missing.flv")), std::runtime_error);
+    CHECK_THROWS(io::mmap_read_stream_proxy(dir.get_file_path("missing.flv")), std::runtime_error);
+}
+
+TEST_CASE(file_proxy_demuxes_every_sample)
+{
+    temp_directory dir;
+    auto flv = write_synthetic_flv(dir);
+    check_playback(flv, play(std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv"))));
+}
+
+TEST_CASE(mmap_proxy_demuxes_every_sample)
+{
+    temp_directory dir;
+    auto flv = write_synthetic_flv(dir);
+    check_playback(flv, play(std::make_shared<io::mmap_read_stream_proxy>(dir.get_file_path("a.flv"))));
+}
+
+TEST_CASE(file_proxy_seeks_to_keyframes)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.has_keyframes_index = true;
+    auto flv = write_synthetic_flv(dir, options);
+    check_seeks(flv, std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")));
+}
+
+TEST_CASE(mmap_proxy_seeks_to_keyframes)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.has_keyframes_index = true;
+    auto flv = write_synthetic_flv(dir, options);
+    check_seeks(flv, std::make_shared<io::mmap_read_stream_proxy>(dir.get_file_path("a.flv")));
+}
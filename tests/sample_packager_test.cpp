@@ -0,0 +1,117 @@
+/*
+ *    sample_packager_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include "coroutine/sync_wait.hpp"
+#include "default_task_service.hpp"
+#include "posix_io.hpp"
+#include "sample_packager.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::sample;
+using namespace dawn_player::test;
+
+namespace {
+
+video_sample make_video_sample(std::vector<std::uint8_t> data, bool is_key_frame, std::uint32_t config_generation)
+{
+    video_sample sample;
+    sample.dts = 0;
+    sample.timestamp = 0;
+    sample.data = std::move(data);
+    sample.is_key_frame = is_key_frame;
+    sample.has_parameter_sets = false;
+    sample.config_generation = config_generation;
+    return sample;
+}
+
+std::vector<std::uint8_t> concat(std::initializer_list<std::vector<std::uint8_t>> parts)
+{
+    std::vector<std::uint8_t> result;
+    for (const auto& part : parts) {
+        result.insert(result.end(), part.begin(), part.end());
+    }
+    return result;
+}
+
+const std::vector<std::uint8_t> start_code = { 0x00, 0x00, 0x01 };
+const std::vector<std::uint8_t> frame = { 0x00, 0x00, 0x01, 0x65, 0x88, 0x84 };
+
+} // namespace
+
+TEST_CASE(prefixes_key_frames_with_parameter_sets)
+{
+    video_sample_packager packager;
+    CHECK_EQUAL(std::uint32_t(0), packager.get_config_generation());
+    // Nothing to prefix with yet.
+    CHECK(packager.package(make_video_sample(frame, true, 1)) == frame);
+    packager.set_parameter_sets(1, {}, { 0x67, 0x42 }, { 0x68, 0xce });
+    CHECK_EQUAL(std::uint32_t(1), packager.get_config_generation());
+    CHECK(packager.package(make_video_sample(frame, true, 1)) == concat({ start_code, { 0x67, 0x42 }, start_code, { 0x68, 0xce }, frame }));
+    // HEVC puts the VPS first.
+    packager.set_parameter_sets(2, { 0x40, 0x01 }, { 0x42, 0x01 }, { 0x44, 0x01 });
+    CHECK(packager.package(make_video_sample(frame, true, 2)) == concat({ start_code, { 0x40, 0x01 }, start_code, { 0x42, 0x01 }, start_code, { 0x44, 0x01 }, frame }));
+}
+
+TEST_CASE(moves_other_frames_through)
+{
+    video_sample_packager packager;
+    packager.set_parameter_sets(1, {}, { 0x67 }, { 0x68 });
+    auto sample = make_video_sample(frame, false, 1);
+    auto data = sample.data.data();
+    auto result = packager.package(std::move(sample));
+    CHECK(result == frame);
+    CHECK(result.data() == data);
+    // Key frames that carry their own parameter sets are not prefixed again.
+    sample = make_video_sample(frame, true, 1);
+    sample.has_parameter_sets = true;
+    data = sample.data.data();
+    result = packager.package(std::move(sample));
+    CHECK(result == frame);
+    CHECK(result.data() == data);
+}
+
+TEST_CASE(keeps_parameter_sets_of_every_generation)
+{
+    video_sample_packager packager;
+    packager.set_parameter_sets(1, {}, { 0x67, 0x01 }, { 0x68, 0x01 });
+    packager.set_parameter_sets(2, {}, { 0x67, 0x02 }, { 0x68, 0x02 });
+    // A key frame queued before the switch keeps its own parameter sets.
+    CHECK(packager.package(make_video_sample(frame, true, 1)) == concat({ start_code, { 0x67, 0x01 }, start_code, { 0x68, 0x01 }, frame }));
+    CHECK(packager.package(make_video_sample(frame, true, 2)) == concat({ start_code, { 0x67, 0x02 }, start_code, { 0x68, 0x02 }, frame }));
+    // Setting the same generation again replaces its sets.
+    packager.set_parameter_sets(2, {}, { 0x67, 0x03 }, { 0x68, 0x03 });
+    CHECK(packager.find_parameter_sets(2)->sps == std::vector<std::uint8_t>({ 0x67, 0x03 }));
+    // Earlier generations are kept, a seek may go back to them.
+    CHECK(packager.package(make_video_sample(frame, true, 1)) == concat({ start_code, { 0x67, 0x01 }, start_code, { 0x68, 0x01 }, frame }));
+    CHECK_EQUAL(std::uint32_t(2), packager.get_config_generation());
+    // Unknown generations fall back to the newest sets.
+    CHECK(packager.find_parameter_sets(7) == nullptr);
+    CHECK(packager.package(make_video_sample(frame, true, 7)) == concat({ start_code, { 0x67, 0x03 }, start_code, { 0x68, 0x03 }, frame }));
+}
+
+TEST_CASE(player_packages_key_frames)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto player = std::make_shared<flv_player>(std::make_shared<default_task_service>(), std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")));
+    open_player(*player);
+    // The SPS and the PPS of the synthetic AVC configuration record.
+    const auto& record = get_synthetic_avc_config_record();
+    std::vector<std::uint8_t> sps(record.begin() + 8, record.begin() + 35);
+    std::vector<std::uint8_t> pps(record.begin() + 38, record.end());
+    for (int i = 0; i < 30; ++i) {
+        auto sample = coroutine::sync_wait_task(player->get_video_sample());
+        auto data = sample.data;
+        auto expected = sample.is_key_frame ? concat({ start_code, sps, start_code, pps, data }) : data;
+        CHECK_EQUAL(i % 25 == 0, sample.is_key_frame);
+        CHECK(!sample.has_parameter_sets);
+        CHECK(player->package_video_sample(std::move(sample)) == expected);
+    }
+    close_player(*player);
+}
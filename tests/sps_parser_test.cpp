@@ -0,0 +1,268 @@
+/*
+ *    sps_parser_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "bit_reader.hpp"
+#include "sps_parser.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::parser;
+using namespace dawn_player::test;
+
+namespace {
+
+// Written by x264: High 4.2, 1920x1088 cropped to 1920x1080, VUI with SAR
+// 1:1, 30 fps and max_num_reorder_frames 2.
+const std::vector<std::uint8_t> x264_high_sps = {
+    0x67, 0x64, 0x00, 0x2a, 0xac, 0xd9, 0x40, 0x78, 0x02, 0x27, 0xe5, 0xc0, 0x44, 0x00, 0x00, 0x03,
+    0x00, 0x04, 0x00, 0x00, 0x03, 0x00, 0xf0, 0x3c, 0x60, 0xc6, 0x58,
+};
+
+// High 4.0, 1920x1088 cropped to 1920x1080, no VUI.
+const std::vector<std::uint8_t> high_cropped_sps = {
+    0x67, 0x64, 0x00, 0x28, 0xac, 0xe5, 0x01, 0xe0, 0x08, 0x9f, 0x95,
+};
+
+// Main 3.1 with constraint_set1_flag, 1280x720, pic_order_cnt_type 1. VUI
+// with an Extended_SAR of 4:3, colour description, 1001/60000 timing, NAL
+// HRD parameters and bitstream restriction with max_num_reorder_frames 2.
+const std::vector<std::uint8_t> main_vui_sps = {
+    0x67, 0x4d, 0x40, 0x1f, 0xd1, 0x91, 0x98, 0x49, 0x00, 0x50, 0x05, 0xbb, 0xff, 0x00, 0x04, 0x00,
+    0x03, 0x6a, 0x02, 0x02, 0x02, 0x80, 0x00, 0x01, 0xf4, 0x80, 0x00, 0x75, 0x30, 0x70, 0x00, 0x01,
+    0x38, 0x80, 0x01, 0x38, 0x85, 0xef, 0x7c, 0x0f, 0x08, 0x84, 0x59, 0x60,
+};
+
+// High 4:4:4 Predictive 3.0, 4:4:4 10-bit, with scaling lists 0, 6 and 7 of
+// twelve present, interlaced 720x576, VUI with SAR 12:11 only.
+const std::vector<std::uint8_t> high_444_scaling_sps = {
+    0x67, 0xf4, 0x00, 0x1e, 0x44, 0x36, 0xd1, 0x0c, 0x20, 0x50, 0x2f, 0x05, 0x10, 0xc2, 0x05, 0x02,
+    0xfa, 0x21, 0x84, 0x0a, 0x05, 0xe0, 0xdb, 0x02, 0xd0, 0x93, 0x60, 0x40, 0x10,
+};
+
+// Written by x265 with --min-cu-size 16: Main 4.1, 1920x1088 with a
+// conformance window down to 1920x1080, SAR 1:1, 50 fps, B-pyramid.
+const std::vector<std::uint8_t> x265_main_sps = {
+    0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00, 0x90, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03,
+    0x00, 0x7b, 0xa0, 0x03, 0xc0, 0x80, 0x11, 0x07, 0xcb, 0x96, 0x56, 0x64, 0xe4, 0xca, 0xe0, 0x10,
+    0x00, 0x00, 0x3e, 0x80, 0x00, 0x0c, 0x35, 0x00, 0x80,
+};
+
+// Written by x265 with a custom --scaling-list, --sar 40:33, --fps
+// 30000/1001 and --bframes 0: Main 3.1, 1280x720.
+const std::vector<std::uint8_t> x265_scaling_list_sps = {
+    0x42, 0x01, 0x01, 0x01, 0x60, 0x00, 0x00, 0x03, 0x00, 0x90, 0x00, 0x00, 0x03, 0x00, 0x00, 0x03,
+    0x00, 0x5d, 0xa0, 0x02, 0x80, 0x80, 0x2d, 0x16, 0x59, 0x2a, 0x49, 0x3e, 0x10, 0x55, 0xae, 0xb5,
+    0x44, 0x44, 0x45, 0x08, 0x2a, 0xd7, 0x5e, 0xbe, 0xbf, 0x1b, 0xfd, 0x7e, 0xbe, 0xbd, 0x75, 0xa8,
+    0xd2, 0x22, 0x22, 0x85, 0x0a, 0xab, 0x5d, 0x7a, 0xfa, 0xfc, 0x6f, 0xf5, 0xfa, 0xfa, 0xf5, 0xd6,
+    0xa3, 0x48, 0x88, 0x8a, 0x14, 0x2a, 0xad, 0x75, 0xeb, 0xeb, 0xf1, 0xbf, 0xd7, 0xeb, 0xeb, 0xd7,
+    0x5a, 0x8d, 0x25, 0x78, 0x28, 0x08, 0x00, 0x00, 0x1f, 0x48, 0x00, 0x03, 0xa9, 0x80, 0x40,
+};
+
+using parse_function = bool (*)(const std::uint8_t*, std::size_t, sps_info&);
+
+// Parses the first size bytes of sps from an allocation of exactly that
+// size, so that a read past the end shows up under AddressSanitizer.
+bool parse_prefix(parse_function parse, const std::vector<std::uint8_t>& sps, std::size_t size, sps_info& info)
+{
+    std::unique_ptr<std::uint8_t[]> data(new std::uint8_t[size]);
+    std::copy(sps.begin(), sps.begin() + size, data.get());
+    return parse(data.get(), size, info);
+}
+
+sps_info parse_all(parse_function parse, const std::vector<std::uint8_t>& sps)
+{
+    sps_info info;
+    CHECK(parse_prefix(parse, sps, sps.size(), info));
+    return info;
+}
+
+bool is_near(double expected, double actual)
+{
+    return std::fabs(expected - actual) < 1e-6;
+}
+
+// Every prefix either fails or yields the picture size of the whole SPS,
+// and the ones that stop inside the picture size fail.
+void check_truncations(parse_function parse, const std::vector<std::uint8_t>& sps, std::size_t min_size)
+{
+    auto full = parse_all(parse, sps);
+    for (std::size_t size = 0; size < sps.size(); ++size) {
+        sps_info info;
+        auto is_parsed = parse_prefix(parse, sps, size, info);
+        if (size < min_size) {
+            CHECK(!is_parsed);
+        }
+        if (is_parsed) {
+            CHECK_EQUAL(full.width, info.width);
+            CHECK_EQUAL(full.height, info.height);
+        }
+    }
+}
+
+// Flips every bit in turn, the result must stay within the limits the
+// parser enforces.
+void check_bit_flips(parse_function parse, const std::vector<std::uint8_t>& sps)
+{
+    for (std::size_t bit = 0; bit < sps.size() * 8; ++bit) {
+        auto corrupt = sps;
+        corrupt[bit / 8] ^= static_cast<std::uint8_t>(0x80 >> (bit % 8));
+        sps_info info;
+        if (parse_prefix(parse, corrupt, corrupt.size(), info)) {
+            CHECK(info.width > 0 && info.width <= info.coded_width);
+            CHECK(info.height > 0 && info.height <= info.coded_height);
+            CHECK(info.coded_width <= 16896 && info.coded_height <= 16896 * 2);
+            CHECK(info.sar_width > 0 && info.sar_height > 0);
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE(bit_reader_drops_emulation_prevention_bytes)
+{
+    const std::uint8_t data[] = { 0x00, 0x00, 0x03, 0x01, 0x00, 0x00, 0x03, 0x03, 0xa0 };
+    bit_reader reader(data, sizeof(data));
+    CHECK_EQUAL(std::uint32_t(0x000001), reader.read_bits(24));
+    CHECK_EQUAL(std::uint32_t(0x000003), reader.read_bits(24));
+    // 0xa0 is 1 010 0000: ue(v) 0, then se(v) 1, then four bits left.
+    CHECK_EQUAL(std::uint32_t(0), reader.read_ue());
+    CHECK_EQUAL(1, reader.read_se());
+    reader.skip_bits(4);
+    CHECK_THROWS(reader.read_bit(), bit_reader_error);
+}
+
+TEST_CASE(bit_reader_rejects_long_exp_golomb_codes)
+{
+    const std::uint8_t data[] = { 0x00, 0x00, 0x00, 0x00, 0x80 };
+    bit_reader reader(data, sizeof(data));
+    CHECK_THROWS(reader.read_ue(), bit_reader_error);
+}
+
+TEST_CASE(h264_high_profile_with_cropping)
+{
+    auto info = parse_all(parse_h264_sps, high_cropped_sps);
+    CHECK_EQUAL(std::uint32_t(100), info.profile_idc);
+    CHECK_EQUAL(std::uint32_t(40), info.level_idc);
+    CHECK_EQUAL(std::uint32_t(1920), info.coded_width);
+    CHECK_EQUAL(std::uint32_t(1088), info.coded_height);
+    CHECK_EQUAL(std::uint32_t(1920), info.width);
+    CHECK_EQUAL(std::uint32_t(1080), info.height);
+    // Nothing signalled.
+    CHECK_EQUAL(std::uint32_t(1), info.sar_width);
+    CHECK_EQUAL(std::uint32_t(1), info.sar_height);
+    CHECK(info.frame_rate == 0.0);
+    CHECK_EQUAL(-1, info.max_num_reorder_frames);
+}
+
+TEST_CASE(h264_vui_timing_and_sar)
+{
+    auto info = parse_all(parse_h264_sps, x264_high_sps);
+    CHECK_EQUAL(std::uint32_t(100), info.profile_idc);
+    CHECK_EQUAL(std::uint32_t(42), info.level_idc);
+    CHECK_EQUAL(std::uint32_t(1088), info.coded_height);
+    CHECK_EQUAL(std::uint32_t(1920), info.width);
+    CHECK_EQUAL(std::uint32_t(1080), info.height);
+    CHECK_EQUAL(std::uint32_t(1), info.sar_width);
+    CHECK_EQUAL(std::uint32_t(1), info.sar_height);
+    CHECK(is_near(30.0, info.frame_rate));
+    CHECK_EQUAL(2, info.max_num_reorder_frames);
+
+    info = parse_all(parse_h264_sps, main_vui_sps);
+    CHECK_EQUAL(std::uint32_t(77), info.profile_idc);
+    CHECK_EQUAL(std::uint32_t(31), info.level_idc);
+    CHECK_EQUAL(std::uint32_t(1280), info.width);
+    CHECK_EQUAL(std::uint32_t(720), info.height);
+    CHECK_EQUAL(std::uint32_t(4), info.sar_width);
+    CHECK_EQUAL(std::uint32_t(3), info.sar_height);
+    CHECK(is_near(30000.0 / 1001.0, info.frame_rate));
+    CHECK_EQUAL(2, info.max_num_reorder_frames);
+}
+
+TEST_CASE(h264_scaling_lists)
+{
+    // The SAR after the scaling lists comes out right only if the lists
+    // were skipped bit for bit.
+    auto info = parse_all(parse_h264_sps, high_444_scaling_sps);
+    CHECK_EQUAL(std::uint32_t(244), info.profile_idc);
+    CHECK_EQUAL(std::uint32_t(30), info.level_idc);
+    CHECK_EQUAL(std::uint32_t(720), info.width);
+    CHECK_EQUAL(std::uint32_t(576), info.height);
+    CHECK_EQUAL(std::uint32_t(12), info.sar_width);
+    CHECK_EQUAL(std::uint32_t(11), info.sar_height);
+    CHECK_EQUAL(-1, info.max_num_reorder_frames);
+}
+
+TEST_CASE(hevc_sps)
+{
+    auto info = parse_all(parse_hevc_sps, x265_main_sps);
+    CHECK_EQUAL(std::uint32_t(1), info.profile_idc);
+    CHECK_EQUAL(std::uint32_t(123), info.level_idc);
+    CHECK_EQUAL(std::uint32_t(1920), info.coded_width);
+    CHECK_EQUAL(std::uint32_t(1088), info.coded_height);
+    CHECK_EQUAL(std::uint32_t(1920), info.width);
+    CHECK_EQUAL(std::uint32_t(1080), info.height);
+    CHECK_EQUAL(std::uint32_t(1), info.sar_width);
+    CHECK_EQUAL(std::uint32_t(1), info.sar_height);
+    CHECK(is_near(50.0, info.frame_rate));
+    CHECK_EQUAL(2, info.max_num_reorder_frames);
+
+    info = parse_all(parse_hevc_sps, x265_scaling_list_sps);
+    CHECK_EQUAL(std::uint32_t(1), info.profile_idc);
+    CHECK_EQUAL(std::uint32_t(93), info.level_idc);
+    CHECK_EQUAL(std::uint32_t(1280), info.width);
+    CHECK_EQUAL(std::uint32_t(720), info.height);
+    CHECK_EQUAL(std::uint32_t(40), info.sar_width);
+    CHECK_EQUAL(std::uint32_t(33), info.sar_height);
+    CHECK(is_near(30000.0 / 1001.0, info.frame_rate));
+    CHECK_EQUAL(0, info.max_num_reorder_frames);
+}
+
+TEST_CASE(truncated_sps_is_rejected)
+{
+    // Minimum sizes: up to the byte holding vui_parameters_present_flag, or
+    // the end of the HEVC sub-layer ordering info. A truncated VUI or HEVC
+    // tail keeps what was read.
+    check_truncations(parse_h264_sps, x264_high_sps, 12);
+    check_truncations(parse_h264_sps, high_cropped_sps, 11);
+    check_truncations(parse_h264_sps, main_vui_sps, 12);
+    check_truncations(parse_h264_sps, high_444_scaling_sps, 27);
+    check_truncations(parse_hevc_sps, x265_main_sps, 28);
+    check_truncations(parse_hevc_sps, x265_scaling_list_sps, 26);
+}
+
+TEST_CASE(corrupt_sps_is_rejected)
+{
+    sps_info info;
+    // A PPS, and an H.264 SPS given to the HEVC parser.
+    const std::vector<std::uint8_t> pps = { 0x68, 0xeb, 0xe3, 0xcb, 0x22, 0xc0 };
+    CHECK(!parse_prefix(parse_h264_sps, pps, pps.size(), info));
+    CHECK(!parse_prefix(parse_hevc_sps, x264_high_sps, x264_high_sps.size(), info));
+    CHECK(!parse_prefix(parse_h264_sps, x265_main_sps, x265_main_sps.size(), info));
+    // Nothing but zeros after the header, an exp-Golomb code that never ends.
+    std::vector<std::uint8_t> zeros = { 0x67, 0x64, 0x00, 0x28 };
+    zeros.resize(64, 0x00);
+    CHECK(!parse_prefix(parse_h264_sps, zeros, zeros.size(), info));
+    // high_cropped_sps with frame_crop_bottom_offset 544, as large as the
+    // picture.
+    const std::vector<std::uint8_t> cropped_away = {
+        0x67, 0x64, 0x00, 0x28, 0xac, 0xe5, 0x01, 0xe0, 0x08, 0x9f, 0x80, 0x22, 0x14,
+    };
+    CHECK(!parse_prefix(parse_h264_sps, cropped_away, cropped_away.size(), info));
+    check_bit_flips(parse_h264_sps, x264_high_sps);
+    check_bit_flips(parse_h264_sps, main_vui_sps);
+    check_bit_flips(parse_h264_sps, high_444_scaling_sps);
+    check_bit_flips(parse_hevc_sps, x265_main_sps);
+    check_bit_flips(parse_hevc_sps, x265_scaling_list_sps);
+    // Failed parses leave info alone.
+    CHECK_EQUAL(std::uint32_t(0), info.width);
+}
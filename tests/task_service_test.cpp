@@ -0,0 +1,274 @@
+/*
+ *    task_service_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <atomic>
+#include <array>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "coroutine/sync_wait.hpp"
+#include "coroutine/task.hpp"
+#include "default_task_service.hpp"
+#include "posix_io.hpp"
+#include "pooled_task_service.hpp"
+#include "strand.hpp"
+#include "work_stealing_task_service.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+// Posts tasks from several threads at once and checks that they never
+// overlap, run on the thread get_thread_id() names, and keep the order of
+// each producer.
+void check_serial(task_service& service)
+{
+    constexpr int producer_count = 4;
+    constexpr int task_count = 20000;
+    std::atomic<bool> is_running{ false };
+    std::atomic<int> overlap_count{ 0 };
+    std::atomic<int> wrong_thread_count{ 0 };
+    std::atomic<int> done_count{ 0 };
+    std::vector<int> last_seen(producer_count, -1);
+    int out_of_order_count = 0;
+    std::promise<void> done;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < producer_count; ++p) {
+        producers.emplace_back([&, p]() {
+            for (int i = 0; i < task_count; ++i) {
+                service.post_task([&, p, i]() {
+                    if (is_running.exchange(true)) {
+                        ++overlap_count;
+                    }
+                    if (service.get_thread_id() != std::this_thread::get_id()) {
+                        ++wrong_thread_count;
+                    }
+                    if (last_seen[p] != i - 1) {
+                        ++out_of_order_count;
+                    }
+                    last_seen[p] = i;
+                    is_running.store(false);
+                    if (++done_count == producer_count * task_count) {
+                        done.set_value();
+                    }
+                });
+            }
+        });
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    done.get_future().wait();
+    CHECK_EQUAL(0, overlap_count.load());
+    CHECK_EQUAL(0, wrong_thread_count.load());
+    CHECK_EQUAL(0, out_of_order_count);
+}
+
+coroutine::task<bool> hop(task_service* from, task_service* to)
+{
+    co_await switch_to_task_service(from);
+    bool is_on_from = from->get_thread_id() == std::this_thread::get_id();
+    co_await switch_to_task_service(to);
+    co_return is_on_from && to->get_thread_id() == std::this_thread::get_id() && from->get_thread_id() != std::this_thread::get_id();
+}
+
+// Plays one file on each service at once.
+void check_concurrent_players(const std::vector<std::shared_ptr<task_service>>& services)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.frame_count = 100;
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    std::vector<std::future<playback>> results;
+    for (auto& service : services) {
+        results.push_back(std::async(std::launch::async, [&dir, service]() {
+            return play(std::make_shared<io::file_read_stream_proxy>(dir.get_file_path("a.flv")), service);
+        }));
+    }
+    for (auto& result : results) {
+        auto samples = result.get();
+        CHECK_EQUAL(flv.video_samples, samples.video_samples);
+        CHECK_EQUAL(flv.audio_samples, samples.audio_samples);
+    }
+}
+
+// A strand that counts how often it is queued, run by the test itself.
+struct counting_strand_context : public impl::strand_context {
+    int schedule_count = 0;
+    virtual void schedule()
+    {
+        ++this->schedule_count;
+    }
+};
+
+// Posts small, large and move-only callables through task_service::post().
+void check_posts_any_callable(task_service& service)
+{
+    std::promise<int> small;
+    std::array<int, 32> values{};
+    values.back() = 2;
+    std::promise<int> large;
+    auto owned = std::make_unique<int>(3);
+    std::promise<int> move_only;
+    service.post([&small]() { small.set_value(1); });
+    // Too big to be stored in the node.
+    service.post([&large, values]() { large.set_value(values.back()); });
+    service.post([&move_only, owned = std::move(owned)]() { move_only.set_value(*owned); });
+    CHECK_EQUAL(1, small.get_future().get());
+    CHECK_EQUAL(2, large.get_future().get());
+    CHECK_EQUAL(3, move_only.get_future().get());
+    // What a task captured goes with it once it has run.
+    auto shared = std::make_shared<int>(0);
+    std::promise<void> done;
+    service.post([shared]() {});
+    service.post([&done]() { done.set_value(); });
+    done.get_future().wait();
+    CHECK_EQUAL(1L, shared.use_count());
+}
+
+} // namespace
+
+TEST_CASE(strand_survives_throwing_task)
+{
+    auto strand_ctx = std::make_shared<counting_strand_context>();
+    std::vector<int> ran;
+    impl::post_to_strand(*strand_ctx, [&]() { ran.push_back(1); });
+    impl::post_to_strand(*strand_ctx, [&]() {
+        CHECK(impl::is_running_strand(*strand_ctx));
+        throw std::runtime_error("task failed");
+    });
+    impl::post_to_strand(*strand_ctx, [&]() { ran.push_back(3); });
+    CHECK_EQUAL(1, strand_ctx->schedule_count);
+    CHECK_THROWS(impl::run_strand(*strand_ctx, 64), std::runtime_error);
+    // The thread is no longer running the strand, and the task left over
+    // has the strand queued again.
+    CHECK(!impl::is_running_strand(*strand_ctx));
+    CHECK_EQUAL(2, strand_ctx->schedule_count);
+    impl::run_strand(*strand_ctx, 64);
+    CHECK(ran == std::vector<int>({ 1, 3 }));
+    // Drained, the next task queues the strand again.
+    impl::post_to_strand(*strand_ctx, [&]() { throw std::runtime_error("task failed"); });
+    CHECK_EQUAL(3, strand_ctx->schedule_count);
+    CHECK_THROWS(impl::run_strand(*strand_ctx, 64), std::runtime_error);
+    impl::post_to_strand(*strand_ctx, [&]() { ran.push_back(5); });
+    CHECK_EQUAL(4, strand_ctx->schedule_count);
+    impl::run_strand(*strand_ctx, 64);
+    CHECK(ran == std::vector<int>({ 1, 3, 5 }));
+}
+
+TEST_CASE(default_task_service_is_serial)
+{
+    default_task_service service;
+    check_serial(service);
+}
+
+TEST_CASE(task_services_post_any_callable)
+{
+    default_task_service service;
+    check_posts_any_callable(service);
+    task_service_pool pool(2);
+    check_posts_any_callable(*pool.create_task_service());
+}
+
+TEST_CASE(default_task_service_released_by_its_task)
+{
+    // The last reference goes away on the service thread while the posting
+    // thread may still be inside post_task().
+    for (int i = 0; i < 500; ++i) {
+        auto service = std::make_shared<default_task_service>();
+        auto raw_service = service.get();
+        std::promise<void> released;
+        raw_service->post_task([&service, &released]() {
+            service.reset();
+            released.set_value();
+        });
+        released.get_future().wait();
+    }
+}
+
+TEST_CASE(pooled_task_service_is_serial)
+{
+    task_service_pool pool(4);
+    auto service = pool.create_task_service();
+    check_serial(*service);
+}
+
+TEST_CASE(work_stealing_strand_is_serial)
+{
+    work_stealing_task_service service(4);
+    auto strand = service.create_strand();
+    check_serial(*strand);
+}
+
+// Its tasks run in parallel, only its strands can be handed to a player.
+static_assert(!std::is_convertible_v<work_stealing_task_service*, task_service*>);
+
+TEST_CASE(work_stealing_task_service_runs_nested_tasks)
+{
+    work_stealing_task_service service(4);
+    constexpr int task_count = 1000;
+    std::atomic<int> done_count{ 0 };
+    std::promise<void> done;
+    for (int i = 0; i < task_count; ++i) {
+        service.post_task([&]() {
+            CHECK(service.get_thread_id() == std::this_thread::get_id());
+            // Lands in the deque of this worker.
+            service.post_task([&]() {
+                if (++done_count == task_count) {
+                    done.set_value();
+                }
+            });
+        });
+    }
+    done.get_future().wait();
+    CHECK_EQUAL(task_count, done_count.load());
+}
+
+TEST_CASE(switch_hops_between_strands)
+{
+    work_stealing_task_service service(4);
+    auto a = service.create_strand();
+    auto b = service.create_strand();
+    for (int i = 0; i < 100; ++i) {
+        CHECK(coroutine::sync_wait_task(hop(a.get(), b.get())));
+        CHECK(coroutine::sync_wait_task(hop(b.get(), a.get())));
+    }
+    task_service_pool pool(4);
+    auto c = pool.create_task_service();
+    auto d = pool.create_task_service();
+    for (int i = 0; i < 100; ++i) {
+        CHECK(coroutine::sync_wait_task(hop(c.get(), d.get())));
+    }
+}
+
+TEST_CASE(players_run_on_work_stealing_strands)
+{
+    work_stealing_task_service service(4);
+    std::vector<std::shared_ptr<task_service>> strands;
+    for (int i = 0; i < 6; ++i) {
+        strands.push_back(service.create_strand());
+    }
+    check_concurrent_players(strands);
+}
+
+TEST_CASE(players_run_on_pooled_task_services)
+{
+    task_service_pool pool(2);
+    std::vector<std::shared_ptr<task_service>> services;
+    for (int i = 0; i < 6; ++i) {
+        services.push_back(pool.create_task_service());
+    }
+    check_concurrent_players(services);
+}
@@ -0,0 +1,452 @@
+/*
+ *    test_support.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "amf_encode.hpp"
+#include "coroutine/sync_wait.hpp"
+#include "default_task_service.hpp"
+#include "error.hpp"
+#include "posix_io.hpp"
+#include "test_support.hpp"
+
+namespace dawn_player {
+namespace test {
+namespace {
+
+int failure_count = 0;
+
+void append_uint24(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    out.push_back(static_cast<std::uint8_t>(value >> 16));
+    out.push_back(static_cast<std::uint8_t>(value >> 8));
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+void append_uint32(std::vector<std::uint8_t>& out, std::uint32_t value)
+{
+    out.push_back(static_cast<std::uint8_t>(value >> 24));
+    append_uint24(out, value);
+}
+
+void append_tag(std::vector<std::uint8_t>& out, std::uint8_t type, std::uint32_t timestamp, const std::vector<std::uint8_t>& body)
+{
+    out.push_back(type);
+    append_uint24(out, static_cast<std::uint32_t>(body.size()));
+    append_uint24(out, timestamp & 0xffffff);
+    out.push_back(static_cast<std::uint8_t>(timestamp >> 24));
+    append_uint24(out, 0);
+    out.insert(out.end(), body.begin(), body.end());
+    append_uint32(out, static_cast<std::uint32_t>(body.size() + 11));
+}
+
+std::vector<std::uint8_t> make_meta_data_body(const synthetic_flv_options& options, const std::vector<std::pair<double, std::uint64_t>>& keyframes)
+{
+    amf::amf_ecma_array meta_data;
+    // Not the size in the SPS, as written by a muxer that does not know it,
+    // so that tests can tell which one the player reports.
+    meta_data.push_back(std::make_pair(amf::amf_string("width"), std::make_shared<amf::amf_number>(1280)));
+    meta_data.push_back(std::make_pair(amf::amf_string("height"), std::make_shared<amf::amf_number>(720)));
+    meta_data.push_back(std::make_pair(amf::amf_string("duration"), std::make_shared<amf::amf_number>(options.frame_count * options.frame_duration / 1000.0)));
+    if (options.has_keyframes_index) {
+        auto times = std::make_shared<amf::amf_strict_array>();
+        auto file_positions = std::make_shared<amf::amf_strict_array>();
+        for (const auto& keyframe : keyframes) {
+            times->push_back(std::make_shared<amf::amf_number>(keyframe.first));
+            file_positions->push_back(std::make_shared<amf::amf_number>(static_cast<double>(keyframe.second)));
+        }
+        auto keyframes_object = std::make_shared<amf::amf_object>();
+        keyframes_object->push_back(std::make_pair(amf::amf_string("times"), times));
+        keyframes_object->push_back(std::make_pair(amf::amf_string("filepositions"), file_positions));
+        meta_data.push_back(std::make_pair(amf::amf_string("keyframes"), keyframes_object));
+    }
+    std::vector<std::uint8_t> body;
+    amf::encode_amf_string(amf::amf_string("onMetaData"), std::back_inserter(body));
+    amf::encode_amf_ecma_array(meta_data, std::back_inserter(body));
+    return body;
+}
+
+} // namespace
+
+std::vector<test_case>& get_test_cases()
+{
+    static std::vector<test_case> test_cases;
+    return test_cases;
+}
+
+test_registrar::test_registrar(const char* name, void (*run)())
+{
+    get_test_cases().push_back(test_case{ name, run });
+}
+
+void report_failure(const char* file, int line, const std::string& message)
+{
+    ++failure_count;
+    std::cerr << file << ":" << line << ": " << message << std::endl;
+}
+
+temp_directory::temp_directory()
+{
+    const char* tmpdir = std::getenv("TMPDIR");
+    std::string path_template = std::string(tmpdir != nullptr && *tmpdir != '\0' ? tmpdir : "/tmp") + "/dawn_player_test.XXXXXX";
+    if (::mkdtemp(path_template.data()) == nullptr) {
+        throw std::runtime_error("failed to create temporary directory");
+    }
+    this->path = path_template;
+}
+
+temp_directory::~temp_directory()
+{
+    std::error_code ec;
+    std::filesystem::remove_all(this->path, ec);
+}
+
+const std::string& temp_directory::get_path() const
+{
+    return this->path;
+}
+
+std::string temp_directory::get_file_path(const std::string& name) const
+{
+    return this->path + "/" + name;
+}
+
+std::vector<std::uint8_t> read_file(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("failed to open " + path);
+    }
+    return std::vector<std::uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void write_file(const std::string& path, const std::vector<std::uint8_t>& data)
+{
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    if (!file) {
+        throw std::runtime_error("failed to write " + path);
+    }
+}
+
+std::vector<std::uint8_t> read_to_end(io::read_stream_proxy& proxy, std::uint32_t chunk_size)
+{
+    std::vector<std::uint8_t> data;
+    for (;;) {
+        auto offset = data.size();
+        data.resize(offset + chunk_size);
+        auto size = coroutine::sync_wait_task(proxy.read(data.data() + offset, chunk_size));
+        data.resize(offset + size);
+        if (size == 0) {
+            return data;
+        }
+    }
+}
+
+std::uint64_t hash_bytes(const std::uint8_t* data, std::size_t size)
+{
+    // FNV-1a
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::ostream& operator<<(std::ostream& os, const sample_record& record)
+{
+    return os << "{dts " << record.dts << ", timestamp " << record.timestamp << ", key " << record.is_key_frame
+        << ", size " << record.size << ", hash " << std::hex << record.hash << std::dec << "}";
+}
+
+std::ostream& operator<<(std::ostream& os, const std::vector<sample_record>& records)
+{
+    os << records.size() << " samples";
+    if (!records.empty()) {
+        os << " from " << records.front() << " to " << records.back();
+    }
+    return os;
+}
+
+std::vector<sample_record> shift_records(const std::vector<sample_record>& records, std::size_t first, std::size_t last, std::int64_t offset)
+{
+    std::vector<sample_record> result(records.begin() + first, records.begin() + last);
+    for (auto& record : result) {
+        record.dts -= offset;
+        record.timestamp -= offset;
+    }
+    return result;
+}
+
+sample_record make_sample_record(const audio_sample& sample)
+{
+    sample_record record;
+    record.dts = sample.timestamp;
+    record.timestamp = sample.timestamp;
+    record.is_key_frame = true;
+    record.size = sample.data.size();
+    record.hash = hash_bytes(sample.data.data(), sample.data.size());
+    return record;
+}
+
+sample_record make_sample_record(const video_sample& sample)
+{
+    sample_record record;
+    record.dts = sample.dts;
+    record.timestamp = sample.timestamp;
+    record.is_key_frame = sample.is_key_frame;
+    record.size = sample.data.size();
+    record.hash = hash_bytes(sample.data.data(), sample.data.size());
+    return record;
+}
+
+const std::vector<std::uint8_t>& get_synthetic_avc_config_record()
+{
+    static const std::vector<std::uint8_t> record = {
+        0x01, 0x64, 0x00, 0x28, 0xff, 0xe1,
+        0x00, 0x1b, 0x67, 0x64, 0x00, 0x2a, 0xac, 0xd9, 0x40, 0x78, 0x02, 0x27, 0xe5, 0xc0, 0x44, 0x00,
+        0x00, 0x03, 0x00, 0x04, 0x00, 0x00, 0x03, 0x00, 0xf0, 0x3c, 0x60, 0xc6, 0x58,
+        0x01, 0x00, 0x06, 0x68, 0xeb, 0xe3, 0xcb, 0x22, 0xc0,
+    };
+    return record;
+}
+
+const std::vector<std::uint8_t>& get_synthetic_switched_avc_config_record()
+{
+    static const std::vector<std::uint8_t> record = {
+        0x01, 0x4d, 0x40, 0x1f, 0xff, 0xe1,
+        0x00, 0x2c, 0x67, 0x4d, 0x40, 0x1f, 0xd1, 0x91, 0x98, 0x49, 0x00, 0x50, 0x05, 0xbb, 0xff, 0x00,
+        0x04, 0x00, 0x03, 0x6a, 0x02, 0x02, 0x02, 0x80, 0x00, 0x01, 0xf4, 0x80, 0x00, 0x75, 0x30, 0x70,
+        0x00, 0x01, 0x38, 0x80, 0x01, 0x38, 0x85, 0xef, 0x7c, 0x0f, 0x08, 0x84, 0x59, 0x60,
+        0x01, 0x00, 0x04, 0x68, 0xee, 0x3c, 0x80,
+    };
+    return record;
+}
+
+synthetic_flv make_synthetic_flv(const synthetic_flv_options& options)
+{
+    synthetic_flv flv;
+    std::mt19937 engine(options.seed);
+    std::uniform_int_distribution<int> byte_distribution(1, 255);
+    auto random_bytes = [&](std::vector<std::uint8_t>& out, std::size_t min_size, std::size_t max_size) {
+        auto size = std::uniform_int_distribution<std::size_t>(min_size, max_size)(engine);
+        for (std::size_t i = 0; i < size; ++i) {
+            out.push_back(static_cast<std::uint8_t>(byte_distribution(engine)));
+        }
+    };
+
+    // The tags behind onMetaData, with offsets relative to their start.
+    std::vector<std::uint8_t> tags;
+    std::vector<std::pair<double, std::uint64_t>> keyframes;
+    if (options.has_audio) {
+        append_tag(tags, 8, options.first_timestamp, { 0xaf, 0x00, 0x12, 0x10 });
+    }
+    std::vector<std::uint8_t> video_config = { 0x17, 0x00, 0x00, 0x00, 0x00 };
+    video_config.insert(video_config.end(), get_synthetic_avc_config_record().begin(), get_synthetic_avc_config_record().end());
+    append_tag(tags, 9, options.first_timestamp, video_config);
+    for (std::size_t i = 0; i < options.frame_count; ++i) {
+        auto timestamp = static_cast<std::uint32_t>(options.first_timestamp + i * options.frame_duration);
+        bool is_key_frame = i % options.keyframe_interval == 0;
+        if (i != 0 && i == options.config_switch_frame) {
+            std::vector<std::uint8_t> switched_config = { 0x17, 0x00, 0x00, 0x00, 0x00 };
+            const auto& record = get_synthetic_switched_avc_config_record();
+            switched_config.insert(switched_config.end(), record.begin(), record.end());
+            append_tag(tags, 9, timestamp, switched_config);
+        }
+        if (is_key_frame) {
+            keyframes.emplace_back(timestamp / 1000.0, tags.size());
+        }
+        std::vector<std::uint8_t> nalu = { static_cast<std::uint8_t>(is_key_frame ? 0x65 : 0x41) };
+        random_bytes(nalu, is_key_frame ? 2000 : 200, is_key_frame ? 60000 : 8000);
+        std::vector<std::uint8_t> body = { static_cast<std::uint8_t>(is_key_frame ? 0x17 : 0x27), 0x01, 0x00, 0x00, 0x00 };
+        append_uint32(body, static_cast<std::uint32_t>(nalu.size()));
+        body.insert(body.end(), nalu.begin(), nalu.end());
+        append_tag(tags, 9, timestamp, body);
+
+        std::vector<std::uint8_t> sample_data = { 0x00, 0x00, 0x01 };
+        sample_data.insert(sample_data.end(), nalu.begin(), nalu.end());
+        sample_record video_record;
+        video_record.dts = static_cast<std::int64_t>(timestamp) * 10000;
+        video_record.timestamp = video_record.dts;
+        video_record.is_key_frame = is_key_frame;
+        video_record.size = sample_data.size();
+        video_record.hash = hash_bytes(sample_data.data(), sample_data.size());
+        flv.video_samples.push_back(video_record);
+
+        if (options.has_audio) {
+            std::vector<std::uint8_t> audio_body = { 0xaf, 0x01 };
+            random_bytes(audio_body, 50, 400);
+            append_tag(tags, 8, timestamp, audio_body);
+            sample_record audio_record;
+            audio_record.dts = static_cast<std::int64_t>(timestamp) * 10000;
+            audio_record.timestamp = audio_record.dts;
+            audio_record.is_key_frame = true;
+            audio_record.size = audio_body.size() - 2;
+            audio_record.hash = hash_bytes(audio_body.data() + 2, audio_body.size() - 2);
+            flv.audio_samples.push_back(audio_record);
+        }
+    }
+    if (options.has_audio) {
+        flv.audio_samples.pop_back();
+    }
+    else {
+        flv.video_samples.pop_back();
+    }
+
+    flv.data = { 'F', 'L', 'V', 0x01, static_cast<std::uint8_t>(options.has_audio ? 0x05 : 0x01), 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x00 };
+    std::uint64_t tags_offset = flv.data.size();
+    if (options.has_meta_data) {
+        // The positions are encoded as doubles, so the tag size does not
+        // depend on their values.
+        tags_offset += 11 + make_meta_data_body(options, keyframes).size() + 4;
+        for (auto& keyframe : keyframes) {
+            keyframe.second += tags_offset;
+        }
+        append_tag(flv.data, 18, 0, make_meta_data_body(options, keyframes));
+    }
+    else {
+        for (auto& keyframe : keyframes) {
+            keyframe.second += tags_offset;
+        }
+    }
+    flv.data.insert(flv.data.end(), tags.begin(), tags.end());
+    flv.keyframes = std::move(keyframes);
+    return flv;
+}
+
+std::map<std::string, std::string> open_player(flv_player& player)
+{
+    return coroutine::sync_wait_task(player.open());
+}
+
+std::vector<sample_record> read_video_samples(flv_player& player, std::size_t max_count)
+{
+    std::vector<sample_record> records;
+    while (records.size() < max_count) {
+        try {
+            records.push_back(make_sample_record(coroutine::sync_wait_task(player.get_video_sample())));
+        }
+        catch (const get_sample_error& e) {
+            if (e.code() != get_sample_error_code::end_of_stream) {
+                throw;
+            }
+            break;
+        }
+    }
+    return records;
+}
+
+std::vector<sample_record> read_audio_samples(flv_player& player, std::size_t max_count)
+{
+    std::vector<sample_record> records;
+    while (records.size() < max_count) {
+        try {
+            records.push_back(make_sample_record(coroutine::sync_wait_task(player.get_audio_sample())));
+        }
+        catch (const get_sample_error& e) {
+            if (e.code() != get_sample_error_code::end_of_stream) {
+                throw;
+            }
+            break;
+        }
+    }
+    return records;
+}
+
+std::int64_t seek_player(flv_player& player, std::int64_t seek_to_time)
+{
+    return coroutine::sync_wait_task(player.seek(seek_to_time));
+}
+
+void close_player(flv_player& player)
+{
+    coroutine::sync_wait_task(player.close());
+}
+
+playback play(const std::shared_ptr<io::read_stream_proxy>& proxy, const std::shared_ptr<task_service>& service)
+{
+    auto player = std::make_shared<flv_player>(service ? service : std::make_shared<default_task_service>(), proxy);
+    playback result;
+    result.info = open_player(*player);
+    result.video_samples = read_video_samples(*player);
+    result.audio_samples = read_audio_samples(*player);
+    close_player(*player);
+    return result;
+}
+
+playback play_file(const std::string& path)
+{
+    return play(std::make_shared<io::mmap_read_stream_proxy>(path));
+}
+
+void check_seeks(const synthetic_flv& flv, const std::shared_ptr<io::read_stream_proxy>& proxy)
+{
+    auto player = std::make_shared<flv_player>(std::make_shared<default_task_service>(), proxy);
+    auto info = open_player(*player);
+    CHECK_EQUAL(std::string("True"), info.at("CanSeek"));
+    CHECK_EQUAL(std::vector<sample_record>(flv.video_samples.begin(), flv.video_samples.begin() + 10), read_video_samples(*player, 10));
+    // Keyframes are 1 s apart, a seek lands on the one at or before the
+    // position.
+    for (double position : { 3.3, 1.0, 7.9, 0.0 }) {
+        auto keyframe_index = static_cast<std::size_t>(position) * 25;
+        CHECK_EQUAL(static_cast<std::int64_t>(position) * 10000000, seek_player(*player, static_cast<std::int64_t>(position * 10000000)));
+        CHECK_EQUAL(std::vector<sample_record>(flv.video_samples.begin() + keyframe_index, flv.video_samples.begin() + keyframe_index + 30), read_video_samples(*player, 30));
+        CHECK_EQUAL(std::vector<sample_record>(flv.audio_samples.begin() + keyframe_index, flv.audio_samples.begin() + keyframe_index + 30), read_audio_samples(*player, 30));
+    }
+    close_player(*player);
+}
+
+} // namespace test
+} // namespace dawn_player
+
+int main(int argc, char** argv)
+{
+    using namespace dawn_player::test;
+    int failed_test_count = 0;
+    int run_test_count = 0;
+    for (const auto& test : get_test_cases()) {
+        bool is_selected = argc < 2;
+        for (int i = 1; i < argc; ++i) {
+            is_selected = is_selected || std::strcmp(argv[i], test.name) == 0;
+        }
+        if (!is_selected) {
+            continue;
+        }
+        ++run_test_count;
+        std::cout << "[ RUN    ] " << test.name << std::endl;
+        auto failures_before = failure_count;
+        try {
+            test.run();
+        }
+        catch (const std::exception& e) {
+            report_failure(__FILE__, __LINE__, std::string("unexpected exception: ") + e.what());
+        }
+        catch (...) {
+            report_failure(__FILE__, __LINE__, "unexpected exception");
+        }
+        if (failure_count != failures_before) {
+            ++failed_test_count;
+            std::cout << "[ FAILED ] " << test.name << std::endl;
+        }
+        else {
+            std::cout << "[     OK ] " << test.name << std::endl;
+        }
+    }
+    std::cout << run_test_count - failed_test_count << "/" << run_test_count << " tests passed" << std::endl;
+    return failed_test_count == 0 && run_test_count != 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,190 @@
+/*
+ *    test_support.hpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#ifndef DAWN_PLAYER_TEST_SUPPORT_HPP
+#define DAWN_PLAYER_TEST_SUPPORT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "flv_player.hpp"
+#include "io.hpp"
+#include "task_service.hpp"
+
+namespace dawn_player {
+namespace test {
+
+// A test executable is one or more TEST_CASE()s linked with test_support.cpp,
+// whose main() runs them all, or those named on the command line, and exits
+// with 1 if a check failed or a test threw.
+struct test_case {
+    const char* name;
+    void (*run)();
+};
+
+std::vector<test_case>& get_test_cases();
+
+struct test_registrar {
+    test_registrar(const char* name, void (*run)());
+};
+
+void report_failure(const char* file, int line, const std::string& message);
+
+#define TEST_CASE(name) \
+    static void name(); \
+    static ::dawn_player::test::test_registrar name##_registrar(#name, &name); \
+    static void name()
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            ::dawn_player::test::report_failure(__FILE__, __LINE__, "CHECK(" #expr ") failed"); \
+        } \
+    } while (false)
+
+template <typename Expected, typename Actual>
+void check_equal(const Expected& expected, const Actual& actual, const char* expected_text, const char* actual_text, const char* file, int line)
+{
+    if (!(expected == actual)) {
+        std::ostringstream stream;
+        stream << "CHECK_EQUAL(" << expected_text << ", " << actual_text << ") failed: " << expected << " != " << actual;
+        report_failure(file, line, stream.str());
+    }
+}
+
+// Both sides are evaluated in one full expression, so references into
+// temporaries stay valid.
+#define CHECK_EQUAL(expected, actual) \
+    ::dawn_player::test::check_equal((expected), (actual), #expected, #actual, __FILE__, __LINE__)
+
+#define CHECK_THROWS(expr, exception_type) \
+    do { \
+        bool check_thrown_ = false; \
+        try { \
+            expr; \
+        } \
+        catch (const exception_type&) { \
+            check_thrown_ = true; \
+        } \
+        if (!check_thrown_) { \
+            ::dawn_player::test::report_failure(__FILE__, __LINE__, "CHECK_THROWS(" #expr ", " #exception_type ") failed"); \
+        } \
+    } while (false)
+
+// A directory under $TMPDIR (or /tmp) removed with its contents on
+// destruction.
+class temp_directory {
+    std::string path;
+public:
+    temp_directory();
+    temp_directory(const temp_directory&) = delete;
+    temp_directory& operator=(const temp_directory&) = delete;
+    ~temp_directory();
+    const std::string& get_path() const;
+    std::string get_file_path(const std::string& name) const;
+};
+
+std::vector<std::uint8_t> read_file(const std::string& path);
+void write_file(const std::string& path, const std::vector<std::uint8_t>& data);
+
+// Reads from the position of proxy to its end, chunk_size bytes at a time.
+std::vector<std::uint8_t> read_to_end(io::read_stream_proxy& proxy, std::uint32_t chunk_size = 64 * 1024);
+
+std::uint64_t hash_bytes(const std::uint8_t* data, std::size_t size);
+
+// A sample as flv_player hands it out, with its payload hashed. Times are
+// in 100 ns units like those of the samples.
+struct sample_record {
+    std::int64_t dts = 0;
+    std::int64_t timestamp = 0;
+    bool is_key_frame = false;
+    std::size_t size = 0;
+    std::uint64_t hash = 0;
+    bool operator==(const sample_record& other) const = default;
+};
+
+std::ostream& operator<<(std::ostream& os, const sample_record& record);
+std::ostream& operator<<(std::ostream& os, const std::vector<sample_record>& records);
+
+// records[first, last) with their times moved back by offset (100 ns).
+std::vector<sample_record> shift_records(const std::vector<sample_record>& records, std::size_t first, std::size_t last, std::int64_t offset);
+
+sample_record make_sample_record(const audio_sample& sample);
+sample_record make_sample_record(const video_sample& sample);
+
+struct synthetic_flv_options {
+    std::size_t frame_count = 250;
+    // Milliseconds.
+    std::uint32_t frame_duration = 40;
+    std::size_t keyframe_interval = 25;
+    std::uint32_t first_timestamp = 0;
+    bool has_audio = true;
+    bool has_meta_data = true;
+    // Adds keyframes.times/filepositions to onMetaData, which makes the file
+    // seekable.
+    bool has_keyframes_index = false;
+    // The key frame from which on the video uses the second decoder
+    // configuration, whose sequence header is put in front of it. 0 keeps
+    // the first configuration throughout.
+    std::size_t config_switch_frame = 0;
+    std::uint32_t seed = 1;
+};
+
+// An H.264/AAC FLV file with random payloads: a video tag for each frame,
+// each followed by an audio tag of the same timestamp. The payload bytes are
+// never 0, so no start code shows up inside a NAL unit.
+struct synthetic_flv {
+    std::vector<std::uint8_t> data;
+    // The samples flv_player demuxes from data, in order. flv_player never
+    // sees the last tag of a file, so the last audio sample is left out.
+    std::vector<sample_record> video_samples;
+    std::vector<sample_record> audio_samples;
+    // (time in seconds, tag offset) of the keyframes.
+    std::vector<std::pair<double, std::uint64_t>> keyframes;
+};
+
+synthetic_flv make_synthetic_flv(const synthetic_flv_options& options = synthetic_flv_options());
+
+// The avcC record the synthetic files carry, a 1920x1080 High profile SPS.
+const std::vector<std::uint8_t>& get_synthetic_avc_config_record();
+// The avcC record synthetic files switch to, a 1280x720 Main profile SPS.
+const std::vector<std::uint8_t>& get_synthetic_switched_avc_config_record();
+
+constexpr std::size_t all_samples = std::numeric_limits<std::size_t>::max();
+
+std::map<std::string, std::string> open_player(flv_player& player);
+// Reads samples until max_count or the end of the stream.
+std::vector<sample_record> read_video_samples(flv_player& player, std::size_t max_count = all_samples);
+std::vector<sample_record> read_audio_samples(flv_player& player, std::size_t max_count = all_samples);
+std::int64_t seek_player(flv_player& player, std::int64_t seek_to_time);
+void close_player(flv_player& player);
+
+struct playback {
+    std::map<std::string, std::string> info;
+    std::vector<sample_record> video_samples;
+    std::vector<sample_record> audio_samples;
+};
+
+// Opens a player on proxy, on its own default_task_service unless one is
+// given, and reads every sample, video first.
+playback play(const std::shared_ptr<io::read_stream_proxy>& proxy, const std::shared_ptr<task_service>& service = nullptr);
+playback play_file(const std::string& path);
+// Opens a player on proxy for flv, which must have the default keyframe
+// interval and be seekable, and checks where seeks land.
+void check_seeks(const synthetic_flv& flv, const std::shared_ptr<io::read_stream_proxy>& proxy);
+
+} // namespace test
+} // namespace dawn_player
+
+#endif
@@ -0,0 +1,246 @@
+/*
+ *    timeshift_io_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+
+#include "coroutine/sync_wait.hpp"
+#include "default_task_service.hpp"
+#include "posix_io.hpp"
+#include "timeshift_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+// A timeshift proxy over the file at path, once it has taken in all of it.
+std::shared_ptr<io::timeshift_read_stream_proxy> open_timeshift(const temp_directory& dir, const std::string& path, std::uint64_t size, std::uint64_t capacity)
+{
+    auto proxy = std::make_shared<io::timeshift_read_stream_proxy>(std::make_shared<io::file_read_stream_proxy>(path), dir.get_path(), capacity);
+    for (int i = 0; i < 5000 && proxy->get_live_position() < size; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK_EQUAL(size, proxy->get_live_position());
+    return proxy;
+}
+
+// A live origin that delivers first_size bytes at once and the rest once
+// the gate opens.
+class gated_read_stream_proxy : public io::read_stream_proxy {
+    std::vector<std::uint8_t> data;
+    std::size_t first_size;
+    std::size_t position = 0;
+    std::shared_future<void> gate;
+public:
+    gated_read_stream_proxy(const std::vector<std::uint8_t>& data, std::size_t first_size, std::shared_future<void> gate)
+        : data(data)
+        , first_size(first_size)
+        , gate(gate)
+    {
+    }
+    virtual bool can_seek() const
+    {
+        return false;
+    }
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size)
+    {
+        if (this->position >= this->first_size) {
+            this->gate.wait();
+        }
+        auto end = this->position < this->first_size ? this->first_size : this->data.size();
+        auto length = static_cast<std::uint32_t>(std::min<std::size_t>(size, end - this->position));
+        std::copy(this->data.begin() + this->position, this->data.begin() + this->position + length, buf);
+        this->position += length;
+        co_return length;
+    }
+    virtual void seek(std::uint64_t)
+    {
+        throw std::runtime_error("bad operation");
+    }
+};
+
+// A live index that lags behind the stream: the keyframes before held_from
+// can no longer be seeked to, but get_keyframes() lists them once more.
+class lagging_index_read_stream_proxy : public io::read_stream_proxy {
+    io::file_read_stream_proxy inner;
+    std::vector<std::pair<double, std::uint64_t>> keyframes;
+public:
+    std::size_t listed_from = 0;
+    std::size_t held_from = 0;
+
+    lagging_index_read_stream_proxy(const std::string& path, const std::vector<std::pair<double, std::uint64_t>>& keyframes)
+        : inner(path)
+        , keyframes(keyframes)
+    {
+    }
+    virtual bool can_seek() const
+    {
+        return true;
+    }
+    virtual coroutine::task<std::uint32_t> read(std::uint8_t* buf, std::uint32_t size)
+    {
+        return this->inner.read(buf, size);
+    }
+    virtual void seek(std::uint64_t pos)
+    {
+        if (pos < this->keyframes[this->held_from].second) {
+            throw std::runtime_error("position is no longer buffered");
+        }
+        this->inner.seek(pos);
+    }
+    virtual bool get_keyframes(std::vector<std::pair<double, std::uint64_t>>& keyframes)
+    {
+        keyframes.assign(this->keyframes.begin() + this->listed_from, this->keyframes.end());
+        this->listed_from = this->held_from;
+        return true;
+    }
+};
+
+// Reads on the service thread, started is set right before the read.
+coroutine::task<std::uint32_t> read_on(task_service& service, io::read_stream_proxy& proxy, std::uint8_t* buf, std::uint32_t size, std::promise<void>& started)
+{
+    co_await switch_to_task_service(&service);
+    started.set_value();
+    co_return co_await proxy.read(buf, size);
+}
+
+} // namespace
+
+TEST_CASE(reads_and_seeks_in_ring)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto proxy = open_timeshift(dir, dir.get_file_path("a.flv"), flv.data.size(), 64 * 1024 * 1024);
+    CHECK(proxy->can_seek());
+    CHECK(read_to_end(*proxy, 10000) == flv.data);
+    proxy->seek(500000);
+    CHECK(read_to_end(*proxy) == std::vector<std::uint8_t>(flv.data.begin() + 500000, flv.data.end()));
+    std::vector<std::pair<double, std::uint64_t>> keyframes;
+    CHECK(proxy->get_keyframes(keyframes));
+    CHECK(keyframes == flv.keyframes);
+}
+
+TEST_CASE(seeks_only_within_ring)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto proxy = open_timeshift(dir, dir.get_file_path("a.flv"), flv.data.size(), 400 * 1024);
+    auto oldest = proxy->get_oldest_position();
+    CHECK_EQUAL(std::uint64_t(flv.data.size() - 400 * 1024), oldest);
+    std::vector<std::pair<double, std::uint64_t>> keyframes;
+    proxy->get_keyframes(keyframes);
+    CHECK(!keyframes.empty() && keyframes.front().second >= oldest && keyframes.back() == flv.keyframes.back());
+    proxy->seek(keyframes.front().second);
+    CHECK(read_to_end(*proxy) == std::vector<std::uint8_t>(flv.data.begin() + keyframes.front().second, flv.data.end()));
+    CHECK_THROWS(proxy->seek(0), std::runtime_error);
+    CHECK_THROWS(proxy->seek(flv.data.size() + 1), std::runtime_error);
+}
+
+TEST_CASE(player_rebases_live_stream)
+{
+    temp_directory dir;
+    // Joined 100 s into the broadcast, onMetaData without keyframes.
+    synthetic_flv_options options;
+    options.first_timestamp = 100000;
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto player = std::make_shared<flv_player>(std::make_shared<default_task_service>(),
+        open_timeshift(dir, dir.get_file_path("a.flv"), flv.data.size(), 64 * 1024 * 1024));
+    auto info = open_player(*player);
+    CHECK_EQUAL(std::string("True"), info.at("CanSeek"));
+    const std::int64_t offset = 100000 * 10000;
+    CHECK_EQUAL(shift_records(flv.video_samples, 0, 10, offset), read_video_samples(*player, 10));
+    CHECK_EQUAL(shift_records(flv.audio_samples, 0, 10, offset), read_audio_samples(*player, 10));
+    for (double position : { 3.3, 1.0, 7.9, 0.0 }) {
+        auto keyframe_index = static_cast<std::size_t>(position) * 25;
+        CHECK_EQUAL(static_cast<std::int64_t>(position) * 10000000, seek_player(*player, static_cast<std::int64_t>(position * 10000000)));
+        CHECK_EQUAL(shift_records(flv.video_samples, keyframe_index, keyframe_index + 30, offset), read_video_samples(*player, 30));
+        CHECK_EQUAL(shift_records(flv.audio_samples, keyframe_index, keyframe_index + 30, offset), read_audio_samples(*player, 30));
+    }
+    // Past the newest keyframe is the live edge.
+    CHECK_EQUAL(std::int64_t(90000000), seek_player(*player, 200000000));
+    CHECK_EQUAL(shift_records(flv.video_samples, 225, 235, offset), read_video_samples(*player, 10));
+    close_player(*player);
+}
+
+TEST_CASE(read_at_live_edge_does_not_block_service)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    std::promise<void> gate;
+    auto proxy = std::make_shared<io::timeshift_read_stream_proxy>(
+        std::make_shared<gated_read_stream_proxy>(flv.data, 1000, gate.get_future().share()), dir.get_path(), 64 * 1024 * 1024);
+    for (int i = 0; i < 5000 && proxy->get_live_position() < 1000; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CHECK_EQUAL(std::uint64_t(1000), proxy->get_live_position());
+    proxy->seek(1000);
+    auto service = std::make_shared<default_task_service>();
+    std::vector<std::uint8_t> buf(5000);
+    std::uint32_t size = 0;
+    std::promise<void> started;
+    std::thread reader([&]() {
+        size = coroutine::sync_wait_task(read_on(*service, *proxy, buf.data(), 5000, started));
+    });
+    started.get_future().wait();
+    // The read waits at the live edge without holding the service thread, a
+    // task posted behind it runs.
+    std::promise<void> ran;
+    service->post_task([&ran]() {
+        ran.set_value();
+    });
+    CHECK(ran.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    gate.set_value();
+    reader.join();
+    CHECK(size != 0);
+    CHECK(std::equal(buf.begin(), buf.begin() + size, flv.data.begin() + 1000));
+}
+
+TEST_CASE(keyframe_index_resyncs_after_corrupt_tag)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    // Garbage in front of the sixth keyframe, it reads as a video tag header
+    // with a bogus size.
+    const std::size_t garbage_size = 37;
+    auto data = flv.data;
+    data.insert(data.begin() + flv.keyframes[5].second, garbage_size, 0x09);
+    auto expected_keyframes = flv.keyframes;
+    for (std::size_t i = 5; i < expected_keyframes.size(); ++i) {
+        expected_keyframes[i].second += garbage_size;
+    }
+    write_file(dir.get_file_path("a.flv"), data);
+    auto proxy = open_timeshift(dir, dir.get_file_path("a.flv"), data.size(), 64 * 1024 * 1024);
+    std::vector<std::pair<double, std::uint64_t>> keyframes;
+    proxy->get_keyframes(keyframes);
+    CHECK(keyframes == expected_keyframes);
+}
+
+TEST_CASE(player_seek_clamps_to_oldest_held_keyframe)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto proxy = std::make_shared<lagging_index_read_stream_proxy>(dir.get_file_path("a.flv"), flv.keyframes);
+    auto player = std::make_shared<flv_player>(std::make_shared<default_task_service>(), proxy);
+    auto info = open_player(*player);
+    CHECK_EQUAL(std::string("True"), info.at("CanSeek"));
+    CHECK_EQUAL(flv.video_samples.size(), read_video_samples(*player).size());
+    // The keyframes before 3 s went out of the stream after the player took
+    // its last index.
+    proxy->held_from = 3;
+    CHECK_EQUAL(std::int64_t(30000000), seek_player(*player, 10000000));
+    CHECK_EQUAL(std::vector<sample_record>(flv.video_samples.begin() + 75, flv.video_samples.begin() + 100), read_video_samples(*player, 25));
+    close_player(*player);
+}
@@ -0,0 +1,156 @@
+/*
+ *    uring_io_test.cpp:
+ *
+ *    Copyright (C) 2026 Light Lin <blog.poxiao.me> All Rights Reserved.
+ *
+ */
+
+#include <iostream>
+
+#include <unistd.h>
+
+#include "coroutine/sync_wait.hpp"
+#include "coroutine/task.hpp"
+#include "default_task_service.hpp"
+#include "uring_io.hpp"
+#include "test_support.hpp"
+
+using namespace dawn_player;
+using namespace dawn_player::test;
+
+namespace {
+
+// Null if the kernel has no io_uring for us, the tests pass then.
+std::shared_ptr<io::uring_read_stream_proxy> make_uring_proxy(const std::shared_ptr<task_service>& service, const std::string& path, std::uint32_t queue_depth, std::uint32_t block_size)
+{
+    try {
+        return std::make_shared<io::uring_read_stream_proxy>(service, path, queue_depth, block_size);
+    }
+    catch (const io::uring_unavailable_error&) {
+        std::cout << "io_uring is not available, skipped" << std::endl;
+        return nullptr;
+    }
+}
+
+// Seeks to pos and reads to the end on the task service, where the proxy
+// wants read() and seek() called.
+coroutine::task<std::vector<std::uint8_t>> read_on_service(std::shared_ptr<task_service> service, std::shared_ptr<io::read_stream_proxy> proxy, std::uint64_t pos, std::uint32_t chunk_size)
+{
+    co_await switch_to_task_service(service.get());
+    proxy->seek(pos);
+    std::vector<std::uint8_t> data;
+    for (;;) {
+        auto offset = data.size();
+        data.resize(offset + chunk_size);
+        auto size = co_await proxy->read(data.data() + offset, chunk_size);
+        data.resize(offset + size);
+        if (size == 0) {
+            co_return data;
+        }
+    }
+}
+
+// Reads size bytes at each of positions, seeking away while the read-ahead
+// behind them is still in flight.
+coroutine::task<std::vector<std::vector<std::uint8_t>>> read_at_positions(std::shared_ptr<task_service> service, std::shared_ptr<io::read_stream_proxy> proxy, std::vector<std::uint64_t> positions, std::uint32_t size)
+{
+    co_await switch_to_task_service(service.get());
+    std::vector<std::vector<std::uint8_t>> chunks;
+    for (auto pos : positions) {
+        proxy->seek(pos);
+        std::vector<std::uint8_t> chunk(size);
+        chunk.resize(co_await proxy->read(chunk.data(), size));
+        chunks.push_back(std::move(chunk));
+    }
+    co_return chunks;
+}
+
+} // namespace
+
+TEST_CASE(reads_and_seeks)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto service = std::make_shared<default_task_service>();
+    auto proxy = make_uring_proxy(service, dir.get_file_path("a.flv"), 4, 16 * 1024);
+    if (!proxy) {
+        return;
+    }
+    CHECK(proxy->can_seek());
+    CHECK(coroutine::sync_wait_task(read_on_service(service, proxy, 0, 5000)) == flv.data);
+    for (std::uint64_t pos : { std::uint64_t(1000), std::uint64_t(300000), std::uint64_t(17), flv.data.size() - 1 }) {
+        auto expected = std::vector<std::uint8_t>(flv.data.begin() + pos, flv.data.end());
+        CHECK(coroutine::sync_wait_task(read_on_service(service, proxy, pos, 7000)) == expected);
+    }
+}
+
+TEST_CASE(seeks_past_reads_in_flight)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto service = std::make_shared<default_task_service>();
+    auto proxy = make_uring_proxy(service, dir.get_file_path("a.flv"), 8, 16 * 1024);
+    if (!proxy) {
+        return;
+    }
+    std::vector<std::uint64_t> positions;
+    for (std::uint64_t i = 0; i < 200; ++i) {
+        positions.push_back(i * 7919 * 13 % (flv.data.size() - 100));
+    }
+    auto chunks = coroutine::sync_wait_task(read_at_positions(service, proxy, positions, 100));
+    CHECK_EQUAL(positions.size(), chunks.size());
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        CHECK(chunks[i] == std::vector<std::uint8_t>(flv.data.begin() + positions[i], flv.data.begin() + positions[i] + 100));
+    }
+}
+
+TEST_CASE(short_read_restarts_read_ahead)
+{
+    // The file shrinks behind the proxy's back. The second block comes back
+    // short while the blocks behind it are still in flight, which the reader
+    // drains before it queues reads from the new position.
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto service = std::make_shared<default_task_service>();
+    auto proxy = make_uring_proxy(service, dir.get_file_path("a.flv"), 8, 64 * 1024);
+    if (!proxy) {
+        return;
+    }
+    CHECK(::truncate(dir.get_file_path("a.flv").c_str(), 100000) == 0);
+    auto expected = std::vector<std::uint8_t>(flv.data.begin(), flv.data.begin() + 100000);
+    CHECK(coroutine::sync_wait_task(read_on_service(service, proxy, 0, 64 * 1024)) == expected);
+    CHECK(coroutine::sync_wait_task(read_on_service(service, proxy, 50000, 64 * 1024)) == std::vector<std::uint8_t>(expected.begin() + 50000, expected.end()));
+}
+
+TEST_CASE(demuxes_every_sample)
+{
+    temp_directory dir;
+    auto flv = make_synthetic_flv();
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto service = std::make_shared<default_task_service>();
+    auto proxy = io::uring_read_stream_proxy::create(service, dir.get_file_path("a.flv"), 4, 64 * 1024);
+    auto result = play(proxy, service);
+    CHECK_EQUAL(flv.video_samples, result.video_samples);
+    CHECK_EQUAL(flv.audio_samples, result.audio_samples);
+}
+
+TEST_CASE(seeks_to_keyframes)
+{
+    temp_directory dir;
+    synthetic_flv_options options;
+    options.has_keyframes_index = true;
+    auto flv = make_synthetic_flv(options);
+    write_file(dir.get_file_path("a.flv"), flv.data);
+    auto service = std::make_shared<default_task_service>();
+    auto player = std::make_shared<flv_player>(service, io::uring_read_stream_proxy::create(service, dir.get_file_path("a.flv"), 4, 64 * 1024));
+    CHECK_EQUAL(std::string("True"), open_player(*player).at("CanSeek"));
+    for (std::size_t second : { 6, 2, 9, 0 }) {
+        CHECK_EQUAL(static_cast<std::int64_t>(second) * 10000000, seek_player(*player, static_cast<std::int64_t>(second) * 10000000 + 2000000));
+        auto begin = flv.video_samples.begin() + second * 25;
+        CHECK_EQUAL(std::vector<sample_record>(begin, begin + 20), read_video_samples(*player, 20));
+    }
+    close_player(*player);
+}